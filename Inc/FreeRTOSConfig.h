@@ -169,6 +169,79 @@ standard names. */
 
 /* USER CODE BEGIN Defines */   	      
 /* Section where parameter definitions can be added (for instance, to override default ones in FreeRTOS.h) */
+
+/* Set to 1 to store the kernel and FreeRTOS+TCP trace events in the binary
+trace ring of Src/trace_ring.c, see Inc/trace_ring.h. */
+#define configUSE_TRACE_RING					0
+
+#if( configUSE_TRACE_RING == 1 )
+	#define configTRACE_RING_RECORDS			256u
+	#define configTRACE_RING_UDP_PORT			5005u
+
+	#if defined(__ICCARM__) || defined(__CC_ARM) || defined(__GNUC__)
+		#include <stdint.h>
+		#include "trace_ring.h"
+	#endif
+
+	#define traceTASK_SWITCHED_IN()				vTraceRingWrite( traceringTASK_SWITCHED_IN, ( uint32_t ) ( uintptr_t ) pxCurrentTCB, 0u )
+	#define traceTASK_CREATE( pxNewTCB )		vTraceRingTaskCreated( ( uint32_t ) ( uintptr_t ) ( pxNewTCB ), ( pxNewTCB )->pcTaskName, ( pxNewTCB )->uxPriority )
+	#define traceTASK_DELETE( pxTCB )			vTraceRingWrite( traceringTASK_DELETE, ( uint32_t ) ( uintptr_t ) ( pxTCB ), 0u )
+	#define traceTASK_DELAY()					vTraceRingWrite( traceringTASK_DELAY, ( uint32_t ) ( uintptr_t ) pxCurrentTCB, xTicksToDelay )
+	#define traceBLOCKING_ON_QUEUE_RECEIVE( pxQueue )	vTraceRingWrite( traceringQUEUE_RECEIVE_BLOCK, ( uint32_t ) ( uintptr_t ) ( pxQueue ), 0u )
+	#define traceBLOCKING_ON_QUEUE_SEND( pxQueue )	vTraceRingWrite( traceringQUEUE_SEND_BLOCK, ( uint32_t ) ( uintptr_t ) ( pxQueue ), 0u )
+	#define traceTASK_NOTIFY_TAKE_BLOCK()		vTraceRingWrite( traceringNOTIFY_TAKE_BLOCK, ( uint32_t ) ( uintptr_t ) pxCurrentTCB, 0u )
+	#define traceTASK_NOTIFY_GIVE_FROM_ISR()	vTraceRingWrite( traceringNOTIFY_GIVE_FROM_ISR, ( uint32_t ) ( uintptr_t ) pxTCB, 0u )
+#endif
+
+/* Set to 1 to capture the RNDIS traffic in the RAM ring of Src/pcap_ring.c,
+see Inc/pcap_ring.h. */
+#define configUSE_PCAP_RING						0
+
+#if( configUSE_PCAP_RING == 1 )
+	#define configPCAP_RING_SLOTS				32u
+	#define configPCAP_RING_SNAPLEN				128u
+	#define configPCAP_RING_TCP_PORT			5006u
+#endif
+
+/* Set to 1 to measure the CPU time of every task and of the USB interrupt in
+cycles, and to send snapshots to the host, see Inc/run_time_stats.h. */
+#define configUSE_RUN_TIME_STATS				0
+
+#if( configUSE_RUN_TIME_STATS == 1 )
+	#define configRUN_TIME_STATS_UDP_PORT		5007u
+	#define configRUN_TIME_STATS_PERIOD_MS		1000u
+
+	#if defined(__ICCARM__) || defined(__CC_ARM) || defined(__GNUC__)
+		#include "hr_gettime.h"
+	#endif
+
+	/* The clock of hr_gettime.h is started in main(), before the scheduler. */
+	#define configGENERATE_RUN_TIME_STATS		1
+	#define configUSE_TRACE_FACILITY			1
+	#define portCONFIGURE_TIMER_FOR_RUN_TIME_STATS()
+	#define portGET_RUN_TIME_COUNTER_VALUE()	ulGetHighResolutionCycles()
+#endif
+
+/* Set to 1 to measure the duration and the call site of every critical
+section and masked region, and the entry latency of the USB interrupt, see
+Inc/critical_profiler.h. */
+#define configUSE_CRITICAL_PROFILER				0
+
+#if( configUSE_CRITICAL_PROFILER == 1 )
+	#define configCRITICAL_PROFILER_SITES		64u
+	#define configCRITICAL_PROFILER_TCP_PORT	5008u
+
+	#if defined(__ICCARM__) || defined(__CC_ARM) || defined(__GNUC__)
+		#include "critical_profiler.h"
+	#endif
+
+	/* Called by port.c with the call site of vPortEnterCritical(), or with the
+	address of xPortSysTickHandler() for the tick interrupt. */
+	#define traceCRITICAL_SECTION_ENTER( pvSite )	vCriticalProfilerEnter( pvSite )
+	#define traceCRITICAL_SECTION_EXIT()		vCriticalProfilerExit()
+	#define portSET_INTERRUPT_MASK_FROM_ISR()		ulCriticalProfilerMaskFromISR()
+	#define portCLEAR_INTERRUPT_MASK_FROM_ISR( x )	vCriticalProfilerUnmaskFromISR( x )
+#endif
 /* USER CODE END Defines */ 
 
 #endif /* FREERTOS_CONFIG_H */
@@ -114,8 +114,8 @@ socket has been destroyed, the result will be stored into the cache.  The next
 call to FreeRTOS_gethostbyname() will return immediately, without even creating
 a socket. */
 #define ipconfigUSE_DNS_CACHE				( 1 )
-#define ipconfigDNS_CACHE_NAME_LENGTH		( 16 )
-#define ipconfigDNS_CACHE_ENTRIES			( 4 )
+#define ipconfigDNS_CACHE_NAME_LENGTH		( 64 )
+#define ipconfigDNS_CACHE_ENTRIES			( 8 )
 #define ipconfigDNS_REQUEST_ATTEMPTS		( 4 )
 
 /* The IP stack executes it its own task (although any application task can make
@@ -193,8 +193,10 @@ address the MAC address and IP address are added to the ARP cache.  When a UDP
 message is sent to a remote IP address that does not already appear in the ARP
 cache then the UDP message is replaced by a ARP message that solicits the
 required MAC address information.  ipconfigARP_CACHE_ENTRIES defines the maximum
-number of entries that can exist in the ARP table at any one time. */
-#define ipconfigARP_CACHE_ENTRIES		6
+number of entries that can exist in the ARP table at any one time.  The table is
+indexed by a hash of the IP address, so a lookup does not become slower when
+the table gets bigger. */
+#define ipconfigARP_CACHE_ENTRIES		16
 
 /* ARP requests that do not result in an ARP response will be re-transmitted a
 maximum of ipconfigMAX_ARP_RETRANSMISSIONS times before the ARP request is
@@ -208,6 +210,15 @@ age.  ipconfigMAX_ARP_AGE is specified in tens of seconds, so a value of 150 is
 equal to 1500 seconds (or 25 minutes). */
 #define ipconfigMAX_ARP_AGE			150
 
+/* Rather than replacing a UDP message by an ARP request, park up to
+ipconfigARP_PENDING_QUEUE_LENGTH messages (at most
+ipconfigARP_PENDING_PER_DESTINATION per next hop) until the ARP reply arrives.
+Parked messages are dropped after ipconfigARP_PENDING_TIMEOUT_MS.  Each parked
+message holds on to a network buffer. */
+#define ipconfigARP_PENDING_QUEUE_LENGTH		4
+#define ipconfigARP_PENDING_PER_DESTINATION		2
+#define ipconfigARP_PENDING_TIMEOUT_MS			3000
+
 /* Implementing FreeRTOS_inet_addr() necessitates the use of string handling
 routines, which are relatively large.  To save code space the full
 FreeRTOS_inet_addr() implementation is made optional, and a smaller and faster
@@ -261,6 +272,49 @@ aborted. */
 /* USE_WIN: Let TCP use windowing mechanism. */
 #define ipconfigUSE_TCP_WIN			( 1 )
 
+/* Keep a congestion window per TCP connection.  NewReno is used unless a
+socket selects CUBIC with FREERTOS_SO_TCP_CONGESTION. */
+#define ipconfigUSE_TCP_CONGESTION_CONTROL		( 1 )
+#define ipconfigTCP_CONGESTION_CONTROL_DEFAULT	( 0 )
+
+/* ACK request/response traffic immediately and delay ACK's only while
+full-size segments stream in, with at least one ACK per two segments. */
+#define ipconfigTCP_ACK_POLICY					( 2 )
+#define ipconfigTCP_ACK_EVERY_N_SEGMENTS		( 2 )
+
+/* Measure TCP round-trip times with the DWT cycle counter, the low 32 bits of
+the clock in Src/hr_gettime.c.  The host is only a USB cable away, so the RTO
+may go down to a few ms instead of the tick-based 2 x 50 ms. */
+#define ipconfigTCP_HIGH_RESOLUTION_RTT			( 1 )
+extern uint32_t ulApplicationGetCycleCount( void );
+#define ipconfigTCP_HR_TIMER_VALUE()			ulApplicationGetCycleCount()
+#define ipconfigTCP_HR_TIMER_COUNTS_PER_US		( configCPU_CLOCK_HZ / 1000000UL )
+#define ipconfigTCP_RTO_MIN_US					( 5000UL )
+
+/* Let reception streams grow with the measured bandwidth-delay product, up to
+6 x 1460 bytes per socket and 6 x 1460 extra bytes in total, and give back the
+stream of a socket that has not received anything for 2 seconds.  The FreeRTOS
+heap is only 15 KB. */
+#define ipconfigTCP_RX_AUTOTUNE					( 1 )
+#define ipconfigTCP_RX_AUTOTUNE_MAX_LENGTH		( 6 * 1460 )
+#define ipconfigTCP_RX_AUTOTUNE_BUDGET			( 6 * 1460 )
+#define ipconfigTCP_RX_AUTOTUNE_IDLE_MS			( 2000 )
+
+/* Answer connection requests from a table of 8 half-open connections, so a
+burst of SYN's does not eat sockets and heap before anything is accepted. */
+#define ipconfigUSE_TCP_SYN_CACHE				( 1 )
+#define ipconfigTCP_SYN_CACHE_ENTRIES			( 8 )
+
+/* Keep closed connections in a table of 8 entries for 10 seconds, so their
+sockets can be freed as soon as the owner closes them. */
+#define ipconfigUSE_TCP_TIME_WAIT				( 1 )
+#define ipconfigTCP_TIME_WAIT_ENTRIES			( 8 )
+#define ipconfigTCP_TIME_WAIT_MS				( 10000 )
+
+/* Maintain per-connection counters for FreeRTOS_GetTCPMetrics(), which are
+used to diagnose slow connections. */
+#define ipconfigUSE_TCP_METRICS					( 1 )
+
 /* The MTU is the maximum number of bytes the payload of a network frame can
 contain.  For normal Ethernet V2 frames the maximum MTU is 1500.  Setting a
 lower value can save RAM, depending on the buffer management scheme used.  If
@@ -323,6 +377,15 @@ maximum size.  Define the size of Rx buffer for TCP sockets. */
 /* Define the size of Tx buffer for TCP sockets. */
 #define ipconfigTCP_TX_BUFFER_LENGTH			( 2 * 1460 )
 
+/* Take sockets and their Tx and Rx streams from static pools, so that
+connection churn does not fragment the 15 KB FreeRTOS heap.  The pools take
+about 30 KB of RAM.  Auto-tuned Rx streams that grow beyond the large class
+still come from the heap. */
+#define ipconfigUSE_SOCKET_POOL					1
+#define ipconfigSOCKET_POOL_SOCKETS				( 6 )
+#define ipconfigSOCKET_POOL_SMALL_STREAMS		( 4 )
+#define ipconfigSOCKET_POOL_LARGE_STREAMS		( 4 )
+
 /* When using call-back handlers, the driver may check if the handler points to
 real program memory (RAM or flash) or just has a random non-zero value. */
 #define ipconfigIS_VALID_PROG_ADDRESS(x) ( (x) != NULL )
@@ -375,10 +438,40 @@ BaseType_t xApplicationDNSQueryHook( const char *pcName );
 The function must return pdTRUE if pcName matches a test name assigned to the
 device, and pdFALSE in all other cases.  */
 #define ipconfigDNS_USE_CALLBACKS			1
+
+/* Resolve names on a single, long-lived socket with up to 4 look-ups in
+flight.  Cached answers honour the TTL of the DNS record, and names that do not
+exist are remembered for ipconfigDNS_NEGATIVE_CACHE_TTL_SEC seconds. */
+#define ipconfigDNS_MAX_PENDING_QUERIES		( 4 )
+#define ipconfigDNS_QUERY_NAME_LENGTH		( 64 )
+#define ipconfigDNS_NEGATIVE_CACHE_TTL_SEC	( 30 )
 #define ipconfigSUPPORT_SIGNALS				1
 
+/* Set to 1 to include FreeRTOS_sendmsg() and FreeRTOS_recvmsg(), which send
+and receive data from/into an array of fragments without the need to first
+assemble the data in a contiguous buffer. */
+#define ipconfigSUPPORT_MSG_FUNCTIONS		1
+
 /* The example IP trace macros are included here so the definitions are
 available in all the FreeRTOS+TCP source files. */
+#if( configUSE_TRACE_RING == 1 )
+	#define iptraceNETWORK_BUFFER_OBTAINED( pxBufferAddress )			vTraceRingWrite( traceringNETWORK_BUFFER_OBTAINED, ( uint32_t ) ( uintptr_t ) ( pxBufferAddress ), 0u )
+	#define iptraceNETWORK_BUFFER_OBTAINED_FROM_ISR( pxBufferAddress )	vTraceRingWrite( traceringNETWORK_BUFFER_OBTAINED, ( uint32_t ) ( uintptr_t ) ( pxBufferAddress ), 0u )
+	#define iptraceNETWORK_BUFFER_RELEASED( pxBufferAddress )			vTraceRingWrite( traceringNETWORK_BUFFER_RELEASED, ( uint32_t ) ( uintptr_t ) ( pxBufferAddress ), 0u )
+	#define iptraceFAILED_TO_OBTAIN_NETWORK_BUFFER()					vTraceRingWrite( traceringNETWORK_BUFFER_FAILED, 0u, 0u )
+	#define iptraceFAILED_TO_OBTAIN_NETWORK_BUFFER_FROM_ISR()			vTraceRingWrite( traceringNETWORK_BUFFER_FAILED, 0u, 0u )
+	#define iptraceETHERNET_RX_EVENT_LOST()								vTraceRingWrite( traceringETHERNET_RX_EVENT_LOST, 0u, 0u )
+	#define iptraceSTACK_TX_EVENT_LOST( xEvent )						vTraceRingWrite( traceringSTACK_TX_EVENT_LOST, 0u, ( uint32_t ) ( xEvent ) )
+	#define iptraceNETWORK_EVENT_RECEIVED( eEvent )						vTraceRingWrite( traceringNETWORK_EVENT_RECEIVED, 0u, ( uint32_t ) ( eEvent ) )
+	#define iptraceNETWORK_INTERFACE_RECEIVE()							vTraceRingWrite( traceringNETWORK_INTERFACE_RECEIVE, 0u, 0u )
+	#define iptraceNETWORK_INTERFACE_TRANSMIT()							vTraceRingWrite( traceringNETWORK_INTERFACE_TRANSMIT, 0u, 0u )
+	#define iptraceSENDING_UDP_PACKET( ulIPAddress )					vTraceRingWrite( traceringSENDING_UDP_PACKET, 0u, ( ulIPAddress ) )
+	#define iptracePACKET_DROPPED_TO_GENERATE_ARP( ulIPAddress )		vTraceRingWrite( traceringPACKET_DROPPED_FOR_ARP, 0u, ( ulIPAddress ) )
+	#define iptraceARP_TABLE_ENTRY_CREATED( ulIPAddress, ucMACAddress )	vTraceRingWrite( traceringARP_ENTRY_CREATED, 0u, ( ulIPAddress ) )
+	#define iptraceARP_TABLE_ENTRY_EXPIRED( ulIPAddress )				vTraceRingWrite( traceringARP_ENTRY_EXPIRED, 0u, ( ulIPAddress ) )
+	#define iptraceRECVFROM_DISCARDING_BYTES( xNumberOfBytesDiscarded )	vTraceRingWrite( traceringRECVFROM_DISCARDING, 0u, ( uint32_t ) ( xNumberOfBytesDiscarded ) )
+	#define iptraceNETWORK_DOWN()										vTraceRingWrite( traceringNETWORK_DOWN, 0u, 0u )
+#endif /* configUSE_TRACE_RING */
 
 #ifdef __cplusplus
 } /* extern "C" */
@@ -0,0 +1,109 @@
+/*
+ * critical_profiler.h
+ *
+ * Measures how long interrupts are masked, and where.  The port layer calls
+ * the profiler at the start and at the end of every outermost critical
+ * section, of every masked region of the FromISR API functions and of the
+ * tick interrupt.  Every region is charged to its call site, the return
+ * address of vPortEnterCritical() or of the FromISR mask function.  The tick
+ * interrupt is charged to the address of xPortSysTickHandler().  A site
+ * keeps its count, minimum, mean and maximum duration and a histogram.
+ *
+ * The profiler also watches one interrupt, the USB OTG FS interrupt.  When
+ * it is pending at the end of a masked region, the region has held it off.
+ * The time from the start of that region until the handler is entered is an
+ * upper bound of its entry latency.  The Cortex-M4 does not record when an
+ * interrupt became pending, so no exact latency can be given.
+ *
+ * vCriticalProfilerStartServer() starts a task that writes a text report to
+ * every TCP client, e.g.:
+ *
+ *     nc 10.10.10.2 5008
+ *
+ * The sites are code addresses; arm-none-eabi-addr2line -f -e <elf file>
+ * turns them into functions and lines.
+ *
+ * Enabled with configUSE_CRITICAL_PROFILER in FreeRTOSConfig.h.  This header
+ * is included by FreeRTOSConfig.h, so it may not depend on FreeRTOS.h.
+ */
+
+#ifndef CRITICAL_PROFILER_H
+#define CRITICAL_PROFILER_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Bucket 0 holds the durations below 32 counts, bucket 'n' those from
+2^(n+4) up to 2^(n+5) counts.  The last bucket holds all longer ones. */
+#define criticalprofilerBUCKETS				16u
+
+typedef struct xCRITICAL_PROFILER_SITE
+{
+	uint64_t ullTotal;				/* Counts */
+	uint32_t ulSite;				/* The code address */
+	uint32_t ulCount;
+	uint32_t ulMin;					/* Counts */
+	uint32_t ulMax;					/* Counts */
+	uint32_t ulBuckets[ criticalprofilerBUCKETS ];
+} CriticalProfilerSite_t;
+
+typedef struct xCRITICAL_PROFILER_IRQ
+{
+	uint32_t ulEntries;				/* Number of times the handler was entered */
+	uint32_t ulHeldOff;				/* ... while held off by a masked region */
+	uint32_t ulMaxLatency;			/* Counts, upper bound */
+	uint32_t ulMaxLatencySite;		/* The region that caused ulMaxLatency */
+	uint32_t ulBuckets[ criticalprofilerBUCKETS ];
+} CriticalProfilerIrq_t;
+
+/*
+ * Called by the port layer, with interrupts masked, see
+ * traceCRITICAL_SECTION_ENTER() and traceCRITICAL_SECTION_EXIT().
+ */
+void vCriticalProfilerEnter( void *pvSite );
+void vCriticalProfilerExit( void );
+
+/*
+ * Replace portSET_INTERRUPT_MASK_FROM_ISR() and
+ * portCLEAR_INTERRUPT_MASK_FROM_ISR().
+ */
+uint32_t ulCriticalProfilerMaskFromISR( void );
+void vCriticalProfilerUnmaskFromISR( uint32_t ulNewMaskValue );
+
+/*
+ * Called at the start of the handler of the watched interrupt.
+ */
+void vCriticalProfilerIrqEntry( void );
+
+/*
+ * Copy the sites that have been seen, returns their number.  The counts of
+ * regions whose site did not fit in the table are returned in
+ * *pulLostRegions.  Must be called from a task.
+ */
+size_t uxCriticalProfilerGetSites( CriticalProfilerSite_t *pxSites, size_t uxMaxSites, uint32_t *pulLostRegions );
+
+/*
+ * Copy the statistics of the watched interrupt.
+ */
+void vCriticalProfilerGetIrq( CriticalProfilerIrq_t *pxIrq );
+
+/*
+ * Forget all measurements.
+ */
+void vCriticalProfilerReset( void );
+
+/*
+ * Start a task that writes a report to every client that connects to the
+ * TCP port.
+ */
+void vCriticalProfilerStartServer( uint16_t usPort );
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /* CRITICAL_PROFILER_H */
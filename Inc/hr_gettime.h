@@ -0,0 +1,54 @@
+/*
+ * hr_gettime.h
+ *
+ * A monotonic high-resolution clock for the whole firmware.  On the target it
+ * is the DWT cycle counter, extended to 64 bits.  On a host simulation it is
+ * clock_gettime( CLOCK_MONOTONIC ), in nanoseconds.
+ *
+ * The 64-bit functions may be called from tasks and from interrupts of any
+ * priority.  The 32-bit extension needs to see every wrap-around of the cycle
+ * counter, about every 43 seconds at 100 MHz, so something has to call
+ * ullGetHighResolutionCycles() more often than that: main.c does it from the
+ * HAL time base interrupt.
+ */
+
+#ifndef HR_GETTIME_H
+#define HR_GETTIME_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Start the clock.  Called once from main(), before the scheduler starts.
+ */
+void vStartHighResolutionTimer( void );
+
+/*
+ * The low 32 bits of the clock.  The cheapest reading: use it for intervals
+ * that are shorter than one wrap-around.
+ */
+uint32_t ulGetHighResolutionCycles( void );
+
+/*
+ * The clock in counts since vStartHighResolutionTimer().
+ */
+uint64_t ullGetHighResolutionCycles( void );
+
+/*
+ * The clock in microseconds since vStartHighResolutionTimer().
+ */
+uint64_t ullGetHighResolutionTime( void );
+
+/*
+ * The number of counts per microsecond.
+ */
+uint32_t ulGetHighResolutionCountsPerUs( void );
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /* HR_GETTIME_H */
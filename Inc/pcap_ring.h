@@ -0,0 +1,90 @@
+/*
+ * pcap_ring.h
+ *
+ * A capture tap in the RNDIS receive and transmit paths.  Frames that pass
+ * the filters are copied, up to the snap length, into a ring of fixed-size
+ * slots in RAM, together with a timestamp.  When the ring is full the oldest
+ * frames are overwritten, so it always holds the most recent traffic.
+ *
+ * The ring is exported in the pcapng format with xPcapRingExport(), through
+ * any byte stream.  vPcapRingStartServer() starts a task that streams the
+ * capture to every TCP client, e.g.:
+ *
+ *     nc 10.10.10.2 5006 > unit.pcapng
+ *
+ * The cost of a capture is bounded: a fixed number of filters is evaluated
+ * and at most configPCAP_RING_SNAPLEN bytes are copied.
+ *
+ * Enabled with configUSE_PCAP_RING in FreeRTOSConfig.h.  When it is 0, the
+ * tap in usbd_rndis_if.c is compiled out.
+ */
+
+#ifndef PCAP_RING_H
+#define PCAP_RING_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* The direction of a frame, as seen from the device.  The values are those of
+the direction bits of the pcapng epb_flags option. */
+#define pcapringDIR_IN				0x01u
+#define pcapringDIR_OUT				0x02u
+
+/* A frame is captured when it matches one of the filters, or when no
+filters are set.  A field that is zero matches anything. */
+typedef struct xPCAP_RING_FILTER
+{
+	uint16_t usEtherType;		/* e.g. 0x0806 for ARP, host byte order */
+	uint16_t usPort;			/* UDP or TCP source or destination port, host byte order */
+	uint8_t ucProtocol;			/* IPv4 protocol, e.g. 6 for TCP */
+	uint8_t ucDirections;		/* pcapringDIR_XXX */
+} PcapRingFilter_t;
+
+/* Used by xPcapRingExport() to write the pcapng data.  Returns pdFAIL to
+abort the export. */
+typedef BaseType_t ( * PcapRingWrite_t )( void *pvContext, const void *pvData, size_t uxLength );
+
+/*
+ * The tap, called by the network interface for every frame.  Must be called
+ * from a task.
+ */
+void vPcapRingCapture( uint8_t ucDirection, const uint8_t *pucFrame, size_t uxLength );
+
+/*
+ * Replace the filters.  Returns pdFAIL when there are more than
+ * configPCAP_RING_FILTERS.  A count of 0 captures all frames.
+ */
+BaseType_t xPcapRingSetFilters( const PcapRingFilter_t *pxFilters, size_t uxCount );
+
+/*
+ * Set the number of bytes stored of each frame, e.g. 54 for the Ethernet,
+ * IP and TCP headers.  It is limited to configPCAP_RING_SNAPLEN.
+ */
+void vPcapRingSetSnapLength( size_t uxSnapLength );
+
+/*
+ * Start or stop capturing.  Capturing starts at boot.  vPcapRingClear()
+ * forgets all captured frames.
+ */
+void vPcapRingStart( void );
+void vPcapRingStop( void );
+void vPcapRingClear( void );
+
+/*
+ * Write the captured frames, oldest first, as a pcapng section.  Capturing
+ * is paused during the export, the frames stay in the ring.
+ */
+BaseType_t xPcapRingExport( PcapRingWrite_t pxWrite, void *pvContext );
+
+/*
+ * Start a task that exports the capture to every client that connects to
+ * the TCP port.
+ */
+void vPcapRingStartServer( uint16_t usPort );
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /* PCAP_RING_H */
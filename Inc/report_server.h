@@ -0,0 +1,54 @@
+/*
+ * report_server.h
+ *
+ * A TCP server that writes one report to every client and then closes the
+ * connection, e.g. the capture of pcap_ring.c or the text report of
+ * critical_profiler.c.  The module that owns the data supplies a function
+ * that writes the report through a write callback; the server handles the
+ * sockets, the time-outs and the graceful close.
+ *
+ * Clients are served one at a time, by one task per server.
+ *
+ * Include FreeRTOS.h and task.h before this header.
+ */
+
+#ifndef REPORT_SERVER_H
+#define REPORT_SERVER_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Writes uxLength bytes to the client.  Returns pdFAIL when the connection
+failed or the send timeout expired. */
+typedef BaseType_t ( * ReportServerWrite_t )( void *pvContext, const void *pvData, size_t uxLength );
+
+/* Writes the report with pxWrite, passing pvContext unchanged.  Returning
+pdFAIL only stops the report, the connection is closed anyway. */
+typedef BaseType_t ( * ReportServerReport_t )( ReportServerWrite_t pxWrite, void *pvContext );
+
+/* One server.  It must stay valid while the server runs, so it is normally
+a static variable of the module that owns the report. */
+typedef struct xREPORT_SERVER
+{
+	ReportServerReport_t pxReport;
+	uint16_t usPort;
+	TaskHandle_t xTaskHandle;
+} ReportServer_t;
+
+/*
+ * Start a task that writes a report with pxReport to every client that
+ * connects to the TCP port.  Nothing happens when pxServer already runs.
+ * usStackDepth is that of the task, in words, and must hold pxReport.
+ */
+void vReportServerStart( ReportServer_t *pxServer, const char *pcName, uint16_t usStackDepth,
+	uint16_t usPort, ReportServerReport_t pxReport );
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /* REPORT_SERVER_H */
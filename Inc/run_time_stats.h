@@ -0,0 +1,96 @@
+/*
+ * run_time_stats.h
+ *
+ * CPU accounting for capacity planning.  The kernel run-time statistics are
+ * driven by the DWT cycle counter (see hr_gettime.h), so every task gets the
+ * number of cycles it has been running.  Interrupts that are instrumented
+ * with ulRunTimeStatsIsrEnter() / vRunTimeStatsIsrExit() get their own
+ * count and cycles; their time is also included in the time of the task that
+ * they interrupted.
+ *
+ * A snapshot holds, for every task, its run time, priority, state and stack
+ * high-water mark, followed by the interrupts and the heap usage.
+ * vRunTimeStatsStartUDP() starts a task that sends a snapshot to the host
+ * periodically.  tools/run_time_stats.py shows the CPU load per task from the
+ * difference between two snapshots.
+ *
+ * All run times are 32-bit counters that wrap, so two snapshots must be less
+ * than one wrap-around apart: about 43 seconds at 100 MHz.
+ *
+ * Enabled with configUSE_RUN_TIME_STATS in FreeRTOSConfig.h.
+ */
+
+#ifndef RUN_TIME_STATS_H
+#define RUN_TIME_STATS_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* The interrupts that are measured. */
+#define runtimestatsISR_OTG_FS				0u
+#define runtimestatsISR_COUNT				1u
+
+#define runtimestatsNAME_LENGTH				16u
+
+/* The snapshot, all fields in little-endian byte order.  The header is
+followed by usTaskCount RunTimeStatsTask_t and usIsrCount RunTimeStatsIsr_t. */
+typedef struct xRUN_TIME_STATS_HEADER
+{
+	uint32_t ulMagic;				/* "RTST" */
+	uint32_t ulCountsPerUs;
+	uint32_t ulTimestamp;			/* The run-time counter at the snapshot */
+	uint32_t ulFreeHeap;			/* Bytes */
+	uint32_t ulMinimumFreeHeap;		/* Bytes */
+	uint16_t usTaskCount;
+	uint16_t usIsrCount;
+} RunTimeStatsHeader_t;
+
+typedef struct xRUN_TIME_STATS_TASK
+{
+	uint32_t ulTask;				/* The task handle */
+	char pcName[ runtimestatsNAME_LENGTH ];
+	uint32_t ulRunTime;				/* Counts */
+	uint16_t usStackHighWaterMark;	/* Words */
+	uint8_t ucPriority;
+	uint8_t ucState;				/* eTaskState */
+} RunTimeStatsTask_t;
+
+typedef struct xRUN_TIME_STATS_ISR
+{
+	char pcName[ runtimestatsNAME_LENGTH ];
+	uint32_t ulCount;				/* Number of interrupts */
+	uint32_t ulRunTime;				/* Counts */
+} RunTimeStatsIsr_t;
+
+/*
+ * Called at the start and at the end of an instrumented interrupt handler,
+ * uxIsr is a runtimestatsISR_XXX:
+ *
+ *     uint32_t ulStart = ulRunTimeStatsIsrEnter();
+ *     ...
+ *     vRunTimeStatsIsrExit( runtimestatsISR_OTG_FS, ulStart );
+ */
+uint32_t ulRunTimeStatsIsrEnter( void );
+void vRunTimeStatsIsrExit( size_t uxIsr, uint32_t ulStart );
+
+/*
+ * Write a snapshot to pucBuffer.  Returns its length, or 0 when it does not
+ * fit.  Must be called from a task.
+ */
+size_t uxRunTimeStatsSnapshot( uint8_t *pucBuffer, size_t uxLength );
+
+/*
+ * Start a task that sends a snapshot to the UDP port of the host every
+ * configRUN_TIME_STATS_PERIOD_MS.
+ */
+void vRunTimeStatsStartUDP( uint32_t ulHostIP, uint16_t usPort );
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /* RUN_TIME_STATS_H */
@@ -0,0 +1,105 @@
+/*
+ * trace_ring.h
+ *
+ * A low-overhead tracing back-end for the FreeRTOS kernel trace hooks and the
+ * FreeRTOS+TCP iptrace hooks.  Every event is stored as a fixed-size binary
+ * record with a cycle-counter timestamp in a ring in RAM.  Writers reserve a
+ * record with an atomic increment, so tasks and interrupts can trace without
+ * a critical section.
+ *
+ * The ring is read with uxTraceRingRead(), e.g. to send it over a CDC
+ * interface, or by the UDP drain task that is started with
+ * vTraceRingStartUDP().  tools/trace_decode.py turns the datagrams into a
+ * Chrome trace / Perfetto timeline.
+ *
+ * Enabled with configUSE_TRACE_RING in FreeRTOSConfig.h.  This header is
+ * included by FreeRTOSConfig.h, so it may not depend on FreeRTOS.h.
+ */
+
+#ifndef TRACE_RING_H
+#define TRACE_RING_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Kernel events, ulObject is a task handle unless noted otherwise. */
+#define traceringTASK_SWITCHED_IN			0x01u
+#define traceringTASK_CREATE				0x02u	/* ulValue: priority */
+#define traceringTASK_DELETE				0x03u
+#define traceringTASK_DELAY					0x04u	/* ulValue: ticks */
+#define traceringQUEUE_RECEIVE_BLOCK		0x05u	/* ulObject: queue */
+#define traceringQUEUE_SEND_BLOCK			0x06u	/* ulObject: queue */
+#define traceringNOTIFY_TAKE_BLOCK			0x07u
+#define traceringNOTIFY_GIVE_FROM_ISR		0x08u	/* ulObject: the task notified */
+
+/* FreeRTOS+TCP events, ulObject is a network buffer unless noted otherwise. */
+#define traceringNETWORK_BUFFER_OBTAINED	0x20u
+#define traceringNETWORK_BUFFER_RELEASED	0x21u
+#define traceringNETWORK_BUFFER_FAILED		0x22u
+#define traceringETHERNET_RX_EVENT_LOST		0x23u
+#define traceringSTACK_TX_EVENT_LOST		0x24u	/* ulValue: event type */
+#define traceringNETWORK_EVENT_RECEIVED		0x25u	/* ulValue: event type */
+#define traceringNETWORK_INTERFACE_RECEIVE	0x26u
+#define traceringNETWORK_INTERFACE_TRANSMIT	0x27u
+#define traceringSENDING_UDP_PACKET			0x28u	/* ulValue: IP address */
+#define traceringPACKET_DROPPED_FOR_ARP		0x29u	/* ulValue: IP address */
+#define traceringARP_ENTRY_CREATED			0x2Au	/* ulValue: IP address */
+#define traceringARP_ENTRY_EXPIRED			0x2Bu	/* ulValue: IP address */
+#define traceringRECVFROM_DISCARDING		0x2Cu	/* ulValue: bytes */
+#define traceringNETWORK_DOWN				0x2Du
+
+/* Driver events. */
+#define traceringUSB_RX_FRAME				0x40u	/* ulValue: length */
+#define traceringUSB_TX_FRAME				0x41u	/* ulValue: length */
+
+/* Events from 0x80 upwards are free for the application. */
+#define traceringFIRST_USER_EVENT			0x80u
+
+/* Set in ucFlags when the event was written from an interrupt. */
+#define traceringFLAG_ISR					0x01u
+
+/* One trace record, 16 bytes. */
+typedef struct xTRACE_RECORD
+{
+	uint32_t ulTimestamp;		/* configTRACE_RING_TIMESTAMP() */
+	uint8_t ucEvent;			/* traceringXXX */
+	uint8_t ucFlags;			/* traceringFLAG_XXX */
+	uint16_t usSequence;		/* Low bits of the record number, written last */
+	uint32_t ulObject;			/* A task, queue or buffer */
+	uint32_t ulValue;			/* An event specific value */
+} TraceRecord_t;
+
+/*
+ * Store an event.  May be called from tasks and interrupts.
+ */
+void vTraceRingWrite( uint8_t ucEvent, uint32_t ulObject, uint32_t ulValue );
+
+/*
+ * Called from traceTASK_CREATE(): remembers the name of the task, so that the
+ * decoder can show it, and stores a traceringTASK_CREATE event.
+ */
+void vTraceRingTaskCreated( uint32_t ulTask, const char *pcName, uint32_t ulPriority );
+
+/*
+ * Copy at most uxMaxCount of the oldest records that were not read yet.
+ * Records that were overwritten before they could be read are added to
+ * *pulLost.  There may only be one reader.
+ */
+size_t uxTraceRingRead( TraceRecord_t *pxRecords, size_t uxMaxCount, uint32_t *pulLost );
+
+/*
+ * Start a task that sends the trace records and the task names to a UDP port
+ * of a host, e.g. the PC at the other end of the RNDIS link.  The address is
+ * in network byte order, the port in host byte order.
+ */
+void vTraceRingStartUDP( uint32_t ulHostIP, uint16_t usPort );
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /* TRACE_RING_H */
@@ -60,6 +60,13 @@ void _Error_Handler(char * file, int line);
 void SystemClock_Config(void);
 
 /* USER CODE BEGIN 0 */
+#include "FreeRTOS.h"
+#if( configUSE_RUN_TIME_STATS == 1 )
+	#include "run_time_stats.h"
+#endif
+#if( configUSE_CRITICAL_PROFILER == 1 )
+	#include "critical_profiler.h"
+#endif
 /* USER CODE END 0 */
 
 /* Private function prototypes -----------------------------------------------*/
@@ -801,11 +808,18 @@ void  USBD_LL_Delay (uint32_t Delay)
 void OTG_FS_IRQHandler(void)
 {
   /* USER CODE BEGIN OTG_FS_IRQn 0 */
-
+#if( configUSE_CRITICAL_PROFILER == 1 )
+  vCriticalProfilerIrqEntry();
+#endif
+#if( configUSE_RUN_TIME_STATS == 1 )
+  uint32_t ulStart = ulRunTimeStatsIsrEnter();
+#endif
   /* USER CODE END OTG_FS_IRQn 0 */
   HAL_PCD_IRQHandler(&hpcd_USB_OTG_FS);
   /* USER CODE BEGIN OTG_FS_IRQn 1 */
-
+#if( configUSE_RUN_TIME_STATS == 1 )
+  vRunTimeStatsIsrExit( runtimestatsISR_OTG_FS, ulStart );
+#endif
   /* USER CODE END OTG_FS_IRQn 1 */
 }
 
@@ -54,7 +54,9 @@
 #include "FreeRTOS_IP.h"
 #include "NetworkBufferManagement.h"
 #include "FreeRTOS_IP_Private.h"
-//#include "hr_gettime.h"
+#if( configUSE_PCAP_RING == 1 )
+	#include "pcap_ring.h"
+#endif
 
 /* USER CODE BEGIN INCLUDE */
 /* USER CODE END INCLUDE */
@@ -497,7 +499,10 @@ static int8_t RNDIS_Control_FS  (uint8_t cmd, uint8_t* pbuf, uint16_t length)
  * @param  Len: Number of data received (in bytes)
  * @retval Result of the operation: USBD_OK if all operations are OK else USBD_FAIL
  */
-uint64_t timestamp;
+#if( ipconfigUSE_LATENCY_HISTOGRAMS == 1 )
+/* The moment the last frame was completed, taken over by prvEMACHandlerTask. */
+static volatile uint32_t ulRxFrameTime;
+#endif
 static int8_t RNDIS_Receive_FS (uint8_t* Buf, uint32_t *Len)
 {
 	BaseType_t xHigherPriorityTaskWoken;
@@ -511,7 +516,12 @@ static int8_t RNDIS_Receive_FS (uint8_t* Buf, uint32_t *Len)
 
 	if(*Len!=64 && xEMACTaskHandle!=0){
 		UserRxSize=len;
-		//timestamp=ullGetHighResolutionTime();
+#if( ipconfigUSE_LATENCY_HISTOGRAMS == 1 )
+		ulRxFrameTime = ipLATENCY_TIME();
+#endif
+#if( configUSE_TRACE_RING == 1 )
+		vTraceRingWrite( traceringUSB_RX_FRAME, 0u, len );
+#endif
 		len=0;
 		vTaskNotifyGiveFromISR(xEMACTaskHandle, &xHigherPriorityTaskWoken);
 		portYIELD_FROM_ISR( xHigherPriorityTaskWoken );
@@ -604,6 +614,18 @@ BaseType_t xNetworkInterfaceOutput( NetworkBufferDescriptor_t * const pxDescript
 	    by pxDescriptor->xDataLength. */
 
 	uint8_t retries=0;
+#if( ipconfigUSE_LATENCY_HISTOGRAMS == 1 )
+	uint32_t ulOutputStart;
+
+	ipLATENCY_STAGE( pxDescriptor, eLatencyTxProcess );
+	ulOutputStart = pxDescriptor->ulLatencyStamp;
+#endif
+#if( configUSE_TRACE_RING == 1 )
+	vTraceRingWrite( traceringUSB_TX_FRAME, ( uint32_t ) ( uintptr_t ) pxDescriptor, pxDescriptor->xDataLength );
+#endif
+#if( configUSE_PCAP_RING == 1 )
+	vPcapRingCapture( pcapringDIR_OUT, pxDescriptor->pucEthernetBuffer, pxDescriptor->xDataLength );
+#endif
 	while(RNDIS_Transmit_FS( pxDescriptor->pucEthernetBuffer, pxDescriptor->xDataLength) ){
 		vTaskDelay(5);
 		retries++;
@@ -613,6 +635,9 @@ BaseType_t xNetworkInterfaceOutput( NetworkBufferDescriptor_t * const pxDescript
 	}
 
 	iptraceNETWORK_INTERFACE_TRANSMIT();
+#if( ipconfigUSE_LATENCY_HISTOGRAMS == 1 )
+	vLatencyRecord( eLatencyTxDriver, ulOutputStart );
+#endif
 
 	/* Call the standard trace macro to log the send event. */
 
@@ -666,11 +691,15 @@ static void prvEMACHandlerTask( void *pvParameters ){
 	        received Ethernet frame. */
 
 		xBytesReceived = UserRxSize;
-		//timestamp=ullGetHighResolutionTime()-timestamp;
 
 		if( xBytesReceived > 44 )
 		{
 			xBytesReceived-=44;
+#if( configUSE_PCAP_RING == 1 )
+			/* Captured before a network buffer is needed, so that frames
+			which are dropped are seen as well. */
+			vPcapRingCapture( pcapringDIR_IN, UserRxBufferFS+44, xBytesReceived );
+#endif
 			/* Allocate a network buffer descriptor that points to a buffer
 	            large enough to hold the received frame.  As this is the simple
 	            rather than efficient example the received data will just be copied
@@ -690,6 +719,10 @@ static void prvEMACHandlerTask( void *pvParameters ){
 				memcpy(pxBufferDescriptor->pucEthernetBuffer, UserRxBufferFS+44, xBytesReceived);
 				UserRxSize=0;
 				pxBufferDescriptor->xDataLength = xBytesReceived;
+#if( ipconfigUSE_LATENCY_HISTOGRAMS == 1 )
+				pxBufferDescriptor->ulLatencyStamp = ulRxFrameTime;
+				ipLATENCY_STAGE( pxBufferDescriptor, eLatencyRxDriver );
+#endif
 
 				/* See if the data contained in the received Ethernet frame needs
 	                to be processed.  NOTE! It is preferable to do this in
@@ -89,6 +89,20 @@ entry is still valid and can therefore be refreshed. */
 	#define arpGRATUITOUS_ARP_PERIOD					( pdMS_TO_TICKS( 20000 ) )
 #endif
 
+/* The number of slots in the hash table that indexes the ARP cache by IP
+address.  Keep it well above ipconfigARP_CACHE_ENTRIES so that the probe
+sequences stay short. */
+#ifndef arpHASH_TABLE_SIZE
+	#define arpHASH_TABLE_SIZE							( 2 * ipconfigARP_CACHE_ENTRIES )
+#endif
+
+#if( arpHASH_TABLE_SIZE <= ipconfigARP_CACHE_ENTRIES )
+	#error arpHASH_TABLE_SIZE must be larger than ipconfigARP_CACHE_ENTRIES
+#endif
+
+/* The hash slot where the probe for an IP address starts. */
+#define arpHASH( ulIPAddress )	( ( BaseType_t ) ( ( ( ( uint32_t ) ( ulIPAddress ) * 0x9E3779B1UL ) >> 16 ) % ( uint32_t ) arpHASH_TABLE_SIZE ) )
+
 /*-----------------------------------------------------------*/
 
 /*
@@ -96,11 +110,65 @@ entry is still valid and can therefore be refreshed. */
  */
 static eARPLookupResult_t prvCacheLookup( uint32_t ulAddressToLookup, MACAddress_t * const pxMACAddress );
 
+/*
+ * Return the index of the ARP cache row holding ulIPAddress, or -1 if there
+ * is no such row.
+ */
+static BaseType_t prvFindEntry( uint32_t ulIPAddress );
+
+/*
+ * Add or remove ARP cache row xEntry to/from the hash table, using its
+ * current IP address as the key.
+ */
+static void prvHashInsert( BaseType_t xEntry );
+static void prvHashRemove( BaseType_t xEntry );
+
+/*
+ * Clear an ARP cache row and remove it from the hash table.
+ */
+static void prvClearEntry( BaseType_t xEntry );
+
+#if( ipconfigARP_PENDING_QUEUE_LENGTH > 0 )
+	/*
+	 * The MAC address of ulIPAddress has become known: send all packets that
+	 * were parked for it.
+	 */
+	static void prvARPFlushPendingPackets( uint32_t ulIPAddress );
+
+	/*
+	 * Drop parked packets that have timed out, or all packets for ulIPAddress
+	 * when its ARP resolution has failed.  An address of zero only drops the
+	 * packets that have timed out.
+	 */
+	static void prvARPDropPendingPackets( uint32_t ulIPAddress );
+#endif /* ipconfigARP_PENDING_QUEUE_LENGTH */
+
 /*-----------------------------------------------------------*/
 
 /* The ARP cache. */
 static ARPCacheRow_t xARPCache[ ipconfigARP_CACHE_ENTRIES ];
 
+/* Open-addressed hash table (linear probing) of the rows in use: a slot holds
+the row index plus one, or zero when the slot is empty. */
+static uint16_t usARPHashTable[ arpHASH_TABLE_SIZE ];
+
+/* Incremented for every refresh or lookup, so that the least recently used
+row can be found when a row must be replaced. */
+static uint32_t ulARPUseCounter = 0UL;
+
+#if( ipconfigARP_PENDING_QUEUE_LENGTH > 0 )
+	/* Outgoing packets waiting for an ARP reply.  A free slot has a NULL
+	pxNetworkBuffer.  Only accessed from the IP-task. */
+	typedef struct xARP_PENDING_PACKET
+	{
+		NetworkBufferDescriptor_t *pxNetworkBuffer;
+		uint32_t ulNextHopAddress;	/* The address being resolved, either the destination or the gateway. */
+		TickType_t xTimeParked;
+	} ARPPendingPacket_t;
+
+	static ARPPendingPacket_t xARPPendingPackets[ ipconfigARP_PENDING_QUEUE_LENGTH ];
+#endif /* ipconfigARP_PENDING_QUEUE_LENGTH */
+
 /* The time at which the last gratuitous ARP was sent.  Gratuitous ARPs are used
 to ensure ARP tables are up to date and to detect IP address conflicts. */
 static TickType_t xLastGratuitousARPTime = ( TickType_t ) 0;
@@ -164,6 +232,13 @@ ARPHeader_t *pxARPHeader;
 					already exists. */
 					vARPRefreshCacheEntry( &( pxARPHeader->xSenderHardwareAddress ), pxARPHeader->ulSenderProtocolAddress );
 
+					#if( ipconfigARP_PENDING_QUEUE_LENGTH > 0 )
+					{
+						/* The peer may be the one we're waiting for. */
+						prvARPFlushPendingPackets( pxARPHeader->ulSenderProtocolAddress );
+					}
+					#endif
+
 					/* Generate a reply payload in the same buffer. */
 					pxARPHeader->usOperation = ( uint16_t ) ipARP_REPLY;
 					if( pxARPHeader->ulTargetProtocolAddress == pxARPHeader->ulSenderProtocolAddress )
@@ -189,6 +264,11 @@ ARPHeader_t *pxARPHeader;
 			case ipARP_REPLY :
 				iptracePROCESSING_RECEIVED_ARP_REPLY( pxARPHeader->ulTargetProtocolAddress );
 				vARPRefreshCacheEntry( &( pxARPHeader->xSenderHardwareAddress ), pxARPHeader->ulSenderProtocolAddress );
+				#if( ipconfigARP_PENDING_QUEUE_LENGTH > 0 )
+				{
+					prvARPFlushPendingPackets( pxARPHeader->ulSenderProtocolAddress );
+				}
+				#endif
 				/* Process received ARP frame to see if there is a clash. */
 				#if( ipconfigARP_USE_CLASH_DETECTION != 0 )
 				{
@@ -224,7 +304,7 @@ ARPHeader_t *pxARPHeader;
 			if( ( memcmp( xARPCache[ x ].xMACAddress.ucBytes, pxMACAddress->ucBytes, sizeof( pxMACAddress->ucBytes ) ) == 0 ) )
 			{
 				lResult = xARPCache[ x ].ulIPAddress;
-				memset( &xARPCache[ x ], '\0', sizeof( xARPCache[ x ] ) );
+				prvClearEntry( x );
 				break;
 			}
 		}
@@ -237,8 +317,8 @@ ARPHeader_t *pxARPHeader;
 
 void vARPRefreshCacheEntry( const MACAddress_t * pxMACAddress, const uint32_t ulIPAddress )
 {
-BaseType_t x, xIpEntry = -1, xMacEntry = -1, xUseEntry = 0;
-uint8_t ucMinAgeFound = 0U;
+BaseType_t x, xIpEntry, xMacEntry = -1, xUseEntry = -1;
+uint32_t ulOldestAge = 0UL;
 
 	#if( ipconfigARP_STORES_REMOTE_ADDRESSES == 0 )
 		/* Only process the IP address if it is on the local network.
@@ -256,49 +336,59 @@ uint8_t ucMinAgeFound = 0U;
 		if( pdTRUE )
 	#endif
 	{
-		/* Start with the maximum possible number. */
-		ucMinAgeFound--;
+		/* Does the cache hold an entry for the IP address being queried? */
+		xIpEntry = prvFindEntry( ulIPAddress );
 
-		/* For each entry in the ARP cache table. */
-		for( x = 0; x < ipconfigARP_CACHE_ENTRIES; x++ )
+		if( xIpEntry >= 0 )
 		{
-			/* Does this line in the cache table hold an entry for the IP
-			address	being queried? */
-			if( xARPCache[ x ].ulIPAddress == ulIPAddress )
+			if( pxMACAddress == NULL )
 			{
-				if( pxMACAddress == NULL )
-				{
-					/* In case the parameter pxMACAddress is NULL, an entry will be reserved to
-					indicate that there is an outstanding ARP request, This entry will have
-					"ucValid == pdFALSE". */
-					xIpEntry = x;
-					break;
-				}
+				/* In case the parameter pxMACAddress is NULL, an entry will be
+				reserved to indicate that there is an outstanding ARP request.
+				There is already an entry for this address. */
+				return;
+			}
 
-				/* See if the MAC-address also matches. */
-				if( memcmp( xARPCache[ x ].xMACAddress.ucBytes, pxMACAddress->ucBytes, sizeof( pxMACAddress->ucBytes ) ) == 0 )
+			/* See if the MAC-address also matches. */
+			if( memcmp( xARPCache[ xIpEntry ].xMACAddress.ucBytes, pxMACAddress->ucBytes, sizeof( pxMACAddress->ucBytes ) ) == 0 )
+			{
+				/* This function will be called for each received packet
+				As this is by far the most common path the coding standard
+				is relaxed in this case and a return is permitted as an
+				optimisation. */
+				xARPCache[ xIpEntry ].ucAge = ( uint8_t ) ipconfigMAX_ARP_AGE;
+				xARPCache[ xIpEntry ].ucValid = ( uint8_t ) pdTRUE;
+				xARPCache[ xIpEntry ].ulLastUsed = ++ulARPUseCounter;
+				return;
+			}
+
+			/* Found an entry containing ulIPAddress, but the MAC address
+			doesn't match.  Might be an entry with ucValid=pdFALSE, waiting
+			for an ARP reply.  Still want to see if there is match with the
+			given MAC address.ucBytes.  If found, either of the two entries
+			must be cleared. */
+		}
+
+		/* A new IP address or a changed MAC address.  This is not the common
+		path, so the table may be traversed: look for a row with the given
+		MAC-address and remember the least recently used row, in case a row
+		must be replaced. */
+		for( x = 0; x < ipconfigARP_CACHE_ENTRIES; x++ )
+		{
+			if( xARPCache[ x ].ulIPAddress == 0UL )
+			{
+				/* A free row is always the first choice. */
+				if( ( xUseEntry < 0 ) || ( xARPCache[ xUseEntry ].ulIPAddress != 0UL ) )
 				{
-					/* This function will be called for each received packet
-					As this is by far the most common path the coding standard
-					is relaxed in this case and a return is permitted as an
-					optimisation. */
-					xARPCache[ x ].ucAge = ( uint8_t ) ipconfigMAX_ARP_AGE;
-					xARPCache[ x ].ucValid = ( uint8_t ) pdTRUE;
-					return;
+					xUseEntry = x;
 				}
-
-				/* Found an entry containing ulIPAddress, but the MAC address
-				doesn't match.  Might be an entry with ucValid=pdFALSE, waiting
-				for an ARP reply.  Still want to see if there is match with the
-				given MAC address.ucBytes.  If found, either of the two entries
-				must be cleared. */
-				xIpEntry = x;
+				continue;
 			}
-			else if( ( pxMACAddress != NULL ) && ( memcmp( xARPCache[ x ].xMACAddress.ucBytes, pxMACAddress->ucBytes, sizeof( pxMACAddress->ucBytes ) ) == 0 ) )
+
+			if( ( x != xIpEntry ) && ( pxMACAddress != NULL ) && ( memcmp( xARPCache[ x ].xMACAddress.ucBytes, pxMACAddress->ucBytes, sizeof( pxMACAddress->ucBytes ) ) == 0 ) )
 			{
 				/* Found an entry with the given MAC-address, but the IP-address
-				is different.  Continue looping to find a possible match with
-				ulIPAddress. */
+				is different. */
 	#if( ipconfigARP_STORES_REMOTE_ADDRESSES != 0 )
 				/* If ARP stores the MAC address of IP addresses outside the
 				network, than the MAC address of the gateway should not be
@@ -314,19 +404,24 @@ uint8_t ucMinAgeFound = 0U;
 				xMacEntry = x;
 	#endif
 			}
-			/* _HT_
-			Shouldn't we test for xARPCache[ x ].ucValid == pdFALSE here ? */
-			else if( xARPCache[ x ].ucAge < ucMinAgeFound )
+			else if( ( xUseEntry < 0 ) ||
+					 ( ( xARPCache[ xUseEntry ].ulIPAddress != 0UL ) && ( ( ulARPUseCounter - xARPCache[ x ].ulLastUsed ) > ulOldestAge ) ) )
 			{
-				/* As the table is traversed, remember the table row that
-				contains the oldest entry (the lowest age count, as ages are
-				decremented to zero) so the row can be re-used if this function
-				needs to add an entry that does not already exist. */
-				ucMinAgeFound = xARPCache[ x ].ucAge;
+				/* As the table is traversed, remember the least recently used
+				row so it can be re-used if this function needs to add an entry
+				that does not already exist. */
+				ulOldestAge = ulARPUseCounter - xARPCache[ x ].ulLastUsed;
 				xUseEntry = x;
 			}
 		}
 
+		if( xUseEntry < 0 )
+		{
+			/* Only possible when every row holds the MAC address of a remote
+			entry. */
+			xUseEntry = 0;
+		}
+
 		if( xMacEntry >= 0 )
 		{
 			xUseEntry = xMacEntry;
@@ -336,7 +431,7 @@ uint8_t ucMinAgeFound = 0U;
 				/* Both the MAC address as well as the IP address were found in
 				different locations: clear the entry which matches the
 				IP-address */
-				memset( &xARPCache[ xIpEntry ], '\0', sizeof( xARPCache[ xIpEntry ] ) );
+				prvClearEntry( xIpEntry );
 			}
 		}
 		else if( xIpEntry >= 0 )
@@ -345,8 +440,18 @@ uint8_t ucMinAgeFound = 0U;
 			xUseEntry = xIpEntry;
 		}
 
-		/* If the entry was not found, we use the oldest entry and set the IPaddress */
-		xARPCache[ xUseEntry ].ulIPAddress = ulIPAddress;
+		/* If the entry was not found, we use the least recently used entry and
+		set the IPaddress */
+		if( xARPCache[ xUseEntry ].ulIPAddress != ulIPAddress )
+		{
+			if( xARPCache[ xUseEntry ].ulIPAddress != 0UL )
+			{
+				prvHashRemove( xUseEntry );
+			}
+			xARPCache[ xUseEntry ].ulIPAddress = ulIPAddress;
+			prvHashInsert( xUseEntry );
+		}
+		xARPCache[ xUseEntry ].ulLastUsed = ++ulARPUseCounter;
 
 		if( pxMACAddress != NULL )
 		{
@@ -357,7 +462,7 @@ uint8_t ucMinAgeFound = 0U;
 			xARPCache[ xUseEntry ].ucAge = ( uint8_t ) ipconfigMAX_ARP_AGE;
 			xARPCache[ xUseEntry ].ucValid = ( uint8_t ) pdTRUE;
 		}
-		else if( xIpEntry < 0 )
+		else
 		{
 			xARPCache[ xUseEntry ].ucAge = ( uint8_t ) ipconfigMAX_ARP_RETRANSMISSIONS;
 			xARPCache[ xUseEntry ].ucValid = ( uint8_t ) pdFALSE;
@@ -366,6 +471,115 @@ uint8_t ucMinAgeFound = 0U;
 }
 /*-----------------------------------------------------------*/
 
+static BaseType_t prvFindEntry( uint32_t ulIPAddress )
+{
+BaseType_t xSlot, xEntry = -1, xCount;
+
+	if( ulIPAddress != 0UL )
+	{
+		xSlot = arpHASH( ulIPAddress );
+
+		/* The table is never full, so the probe ends at an empty slot. */
+		for( xCount = 0; xCount < arpHASH_TABLE_SIZE; xCount++ )
+		{
+			if( usARPHashTable[ xSlot ] == 0u )
+			{
+				break;
+			}
+
+			if( xARPCache[ usARPHashTable[ xSlot ] - 1u ].ulIPAddress == ulIPAddress )
+			{
+				xEntry = ( BaseType_t ) usARPHashTable[ xSlot ] - 1;
+				break;
+			}
+
+			if( ++xSlot == arpHASH_TABLE_SIZE )
+			{
+				xSlot = 0;
+			}
+		}
+	}
+
+	return xEntry;
+}
+/*-----------------------------------------------------------*/
+
+static void prvHashInsert( BaseType_t xEntry )
+{
+BaseType_t xSlot = arpHASH( xARPCache[ xEntry ].ulIPAddress );
+
+	while( usARPHashTable[ xSlot ] != 0u )
+	{
+		if( ++xSlot == arpHASH_TABLE_SIZE )
+		{
+			xSlot = 0;
+		}
+	}
+
+	usARPHashTable[ xSlot ] = ( uint16_t ) ( xEntry + 1 );
+}
+/*-----------------------------------------------------------*/
+
+static void prvHashRemove( BaseType_t xEntry )
+{
+BaseType_t xSlot = arpHASH( xARPCache[ xEntry ].ulIPAddress );
+BaseType_t xNext, xHome;
+
+	while( usARPHashTable[ xSlot ] != ( uint16_t ) ( xEntry + 1 ) )
+	{
+		if( usARPHashTable[ xSlot ] == 0u )
+		{
+			/* Not in the table. */
+			return;
+		}
+		if( ++xSlot == arpHASH_TABLE_SIZE )
+		{
+			xSlot = 0;
+		}
+	}
+
+	/* Empty the slot, and move back any entry further along the probe
+	sequence that would otherwise become unreachable, so that no 'deleted'
+	markers are needed. */
+	usARPHashTable[ xSlot ] = 0u;
+	xNext = xSlot;
+
+	for( ;; )
+	{
+		if( ++xNext == arpHASH_TABLE_SIZE )
+		{
+			xNext = 0;
+		}
+
+		if( usARPHashTable[ xNext ] == 0u )
+		{
+			break;
+		}
+
+		xHome = arpHASH( xARPCache[ usARPHashTable[ xNext ] - 1u ].ulIPAddress );
+
+		/* Can the entry at xNext be moved to the empty xSlot?  Only if its
+		home slot does not lie cyclically within ( xSlot, xNext ]. */
+		if( ( xSlot <= xNext ) ? ( ( xHome <= xSlot ) || ( xHome > xNext ) ) : ( ( xHome <= xSlot ) && ( xHome > xNext ) ) )
+		{
+			usARPHashTable[ xSlot ] = usARPHashTable[ xNext ];
+			usARPHashTable[ xNext ] = 0u;
+			xSlot = xNext;
+		}
+	}
+}
+/*-----------------------------------------------------------*/
+
+static void prvClearEntry( BaseType_t xEntry )
+{
+	if( xARPCache[ xEntry ].ulIPAddress != 0UL )
+	{
+		prvHashRemove( xEntry );
+	}
+	memset( &xARPCache[ xEntry ], '\0', sizeof( xARPCache[ xEntry ] ) );
+}
+/*-----------------------------------------------------------*/
+
 #if( ipconfigUSE_ARP_REVERSED_LOOKUP == 1 )
 	eARPLookupResult_t eARPGetCacheEntryByMac( MACAddress_t * const pxMACAddress, uint32_t *pulIPAddress )
 	{
@@ -460,9 +674,11 @@ uint32_t ulAddressToLookup;
 			{
 				eReturn = prvCacheLookup( ulAddressToLookup, pxMACAddress );
 
-				if( eReturn == eARPCacheMiss )
+				if( eReturn != eARPCacheHit )
 				{
-					/* It might be that the ARP has to go to the gateway. */
+					/* It might be that the ARP has to go to the gateway.  Also
+					when an ARP request is already outstanding, tell the caller
+					which address is being resolved. */
 					*pulIPAddress = ulAddressToLookup;
 				}
 			}
@@ -479,26 +695,23 @@ static eARPLookupResult_t prvCacheLookup( uint32_t ulAddressToLookup, MACAddress
 BaseType_t x;
 eARPLookupResult_t eReturn = eARPCacheMiss;
 
-	/* Loop through each entry in the ARP cache. */
-	for( x = 0; x < ipconfigARP_CACHE_ENTRIES; x++ )
+	/* Find the row for the IP address being queried. */
+	x = prvFindEntry( ulAddressToLookup );
+
+	if( x >= 0 )
 	{
-		/* Does this row in the ARP cache table hold an entry for the IP address
-		being queried? */
-		if( xARPCache[ x ].ulIPAddress == ulAddressToLookup )
+		/* A matching valid entry was found. */
+		if( xARPCache[ x ].ucValid == ( uint8_t ) pdFALSE )
 		{
-			/* A matching valid entry was found. */
-			if( xARPCache[ x ].ucValid == ( uint8_t ) pdFALSE )
-			{
-				/* This entry is waiting an ARP reply, so is not valid. */
-				eReturn = eCantSendPacket;
-			}
-			else
-			{
-				/* A valid entry was found. */
-				memcpy( pxMACAddress->ucBytes, xARPCache[ x ].xMACAddress.ucBytes, sizeof( MACAddress_t ) );
-				eReturn = eARPCacheHit;
-			}
-			break;
+			/* This entry is waiting an ARP reply, so is not valid. */
+			eReturn = eCantSendPacket;
+		}
+		else
+		{
+			/* A valid entry was found. */
+			memcpy( pxMACAddress->ucBytes, xARPCache[ x ].xMACAddress.ucBytes, sizeof( MACAddress_t ) );
+			xARPCache[ x ].ulLastUsed = ++ulARPUseCounter;
+			eReturn = eARPCacheHit;
 		}
 	}
 
@@ -543,11 +756,28 @@ TickType_t xTimeNow;
 			{
 				/* The entry is no longer valid.  Wipe it out. */
 				iptraceARP_TABLE_ENTRY_EXPIRED( xARPCache[ x ].ulIPAddress );
-				xARPCache[ x ].ulIPAddress = 0UL;
+
+				#if( ipconfigARP_PENDING_QUEUE_LENGTH > 0 )
+				{
+					if( xARPCache[ x ].ucValid == ( uint8_t ) pdFALSE )
+					{
+						/* The address could not be resolved. */
+						prvARPDropPendingPackets( xARPCache[ x ].ulIPAddress );
+					}
+				}
+				#endif
+
+				prvClearEntry( x );
 			}
 		}
 	}
 
+	#if( ipconfigARP_PENDING_QUEUE_LENGTH > 0 )
+	{
+		prvARPDropPendingPackets( 0UL );
+	}
+	#endif
+
 	xTimeNow = xTaskGetTickCount ();
 
 	if( ( xLastGratuitousARPTime == ( TickType_t ) 0 ) || ( ( xTimeNow - xLastGratuitousARPTime ) > ( TickType_t ) arpGRATUITOUS_ARP_PERIOD ) )
@@ -635,9 +865,139 @@ ARPPacket_t *pxARPPacket;
 void FreeRTOS_ClearARP( void )
 {
 	memset( xARPCache, '\0', sizeof( xARPCache ) );
+	memset( usARPHashTable, '\0', sizeof( usARPHashTable ) );
+
+	#if( ipconfigARP_PENDING_QUEUE_LENGTH > 0 )
+	{
+	BaseType_t x;
+
+		for( x = 0; x < ipconfigARP_PENDING_QUEUE_LENGTH; x++ )
+		{
+			if( xARPPendingPackets[ x ].pxNetworkBuffer != NULL )
+			{
+				vReleaseNetworkBufferAndDescriptor( xARPPendingPackets[ x ].pxNetworkBuffer );
+				xARPPendingPackets[ x ].pxNetworkBuffer = NULL;
+			}
+		}
+	}
+	#endif /* ipconfigARP_PENDING_QUEUE_LENGTH */
 }
 /*-----------------------------------------------------------*/
 
+#if( ipconfigARP_PENDING_QUEUE_LENGTH > 0 )
+
+	BaseType_t xARPQueuePendingPacket( NetworkBufferDescriptor_t * const pxNetworkBuffer, uint32_t ulNextHopAddress )
+	{
+	BaseType_t x, xFreeSlot = -1, xCount = 0, xResolving = pdFALSE;
+
+		/* Make room by dropping packets that have waited too long. */
+		prvARPDropPendingPackets( 0UL );
+
+		/* Only park the packet if an ARP request for the next hop is actually
+		outstanding, otherwise it would never be sent. */
+		x = prvFindEntry( ulNextHopAddress );
+
+		if( ( x >= 0 ) && ( xARPCache[ x ].ucValid == ( uint8_t ) pdFALSE ) && ( xARPCache[ x ].ucAge > 0u ) )
+		{
+			xResolving = pdTRUE;
+		}
+
+		if( xResolving != pdFALSE )
+		{
+			for( x = 0; x < ipconfigARP_PENDING_QUEUE_LENGTH; x++ )
+			{
+				if( xARPPendingPackets[ x ].pxNetworkBuffer == NULL )
+				{
+					if( xFreeSlot < 0 )
+					{
+						xFreeSlot = x;
+					}
+				}
+				else if( xARPPendingPackets[ x ].ulNextHopAddress == ulNextHopAddress )
+				{
+					xCount++;
+				}
+			}
+		}
+
+		if( ( xFreeSlot >= 0 ) && ( xCount < ( BaseType_t ) ipconfigARP_PENDING_PER_DESTINATION ) )
+		{
+			xARPPendingPackets[ xFreeSlot ].pxNetworkBuffer = pxNetworkBuffer;
+			xARPPendingPackets[ xFreeSlot ].ulNextHopAddress = ulNextHopAddress;
+			xARPPendingPackets[ xFreeSlot ].xTimeParked = xTaskGetTickCount();
+			xResolving = pdTRUE;
+		}
+		else
+		{
+			xResolving = pdFALSE;
+		}
+
+		return xResolving;
+	}
+
+#endif /* ipconfigARP_PENDING_QUEUE_LENGTH */
+/*-----------------------------------------------------------*/
+
+#if( ipconfigARP_PENDING_QUEUE_LENGTH > 0 )
+
+	static void prvARPFlushPendingPackets( uint32_t ulIPAddress )
+	{
+	BaseType_t x;
+	NetworkBufferDescriptor_t *pxNetworkBuffer;
+	MACAddress_t xMACAddress;
+
+		/* Only when the address has really been stored in the cache, otherwise
+		the packets would be parked once again. */
+		if( prvCacheLookup( ulIPAddress, &xMACAddress ) == eARPCacheHit )
+		{
+			for( x = 0; x < ipconfigARP_PENDING_QUEUE_LENGTH; x++ )
+			{
+				if( ( xARPPendingPackets[ x ].pxNetworkBuffer != NULL ) && ( xARPPendingPackets[ x ].ulNextHopAddress == ulIPAddress ) )
+				{
+					pxNetworkBuffer = xARPPendingPackets[ x ].pxNetworkBuffer;
+					xARPPendingPackets[ x ].pxNetworkBuffer = NULL;
+
+					/* The packet is still untouched, process it once more. */
+					vProcessGeneratedUDPPacket( pxNetworkBuffer );
+				}
+			}
+
+			#if( ipconfigUSE_TCP == 1 )
+			{
+				vTCPARPResolved( ulIPAddress );
+			}
+			#endif
+		}
+	}
+
+#endif /* ipconfigARP_PENDING_QUEUE_LENGTH */
+/*-----------------------------------------------------------*/
+
+#if( ipconfigARP_PENDING_QUEUE_LENGTH > 0 )
+
+	static void prvARPDropPendingPackets( uint32_t ulIPAddress )
+	{
+	BaseType_t x;
+	TickType_t xTimeNow = xTaskGetTickCount();
+
+		for( x = 0; x < ipconfigARP_PENDING_QUEUE_LENGTH; x++ )
+		{
+			if( xARPPendingPackets[ x ].pxNetworkBuffer != NULL )
+			{
+				if( ( xARPPendingPackets[ x ].ulNextHopAddress == ulIPAddress ) ||
+					( ( xTimeNow - xARPPendingPackets[ x ].xTimeParked ) >= pdMS_TO_TICKS( ipconfigARP_PENDING_TIMEOUT_MS ) ) )
+				{
+					iptracePACKET_DROPPED_TO_GENERATE_ARP( xARPPendingPackets[ x ].pxNetworkBuffer->ulIPAddress );
+					vReleaseNetworkBufferAndDescriptor( xARPPendingPackets[ x ].pxNetworkBuffer );
+					xARPPendingPackets[ x ].pxNetworkBuffer = NULL;
+				}
+			}
+		}
+	}
+
+#endif /* ipconfigARP_PENDING_QUEUE_LENGTH */
+/*-----------------------------------------------------------*/
+
 #if( ipconfigHAS_PRINTF != 0 ) || ( ipconfigHAS_DEBUG_PRINTF != 0 )
 
 	void FreeRTOS_PrintARPCache( void )
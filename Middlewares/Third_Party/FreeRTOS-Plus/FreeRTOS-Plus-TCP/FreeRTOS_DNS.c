@@ -84,12 +84,16 @@
 	#define dnsOUTGOING_FLAGS				0x0001 /* Standard query. */
 	#define dnsRX_FLAGS_MASK				0x0f80 /* The bits of interest in the flags field of incoming DNS messages. */
 	#define dnsEXPECTED_RX_FLAGS			0x0080 /* Should be a response, without any errors. */
+	#define dnsRESPONSE_FLAG				0x0080 /* The message is a response. */
+	#define dnsNXDOMAIN_RX_FLAGS			0x0380 /* A response saying that the name does not exist. */
 #else
 	#define dnsDNS_PORT						0x0035
 	#define dnsONE_QUESTION					0x0001
 	#define dnsOUTGOING_FLAGS				0x0100 /* Standard query. */
 	#define dnsRX_FLAGS_MASK				0x800f /* The bits of interest in the flags field of incoming DNS messages. */
 	#define dnsEXPECTED_RX_FLAGS			0x8000 /* Should be a response, without any errors. */
+	#define dnsRESPONSE_FLAG				0x8000 /* The message is a response. */
+	#define dnsNXDOMAIN_RX_FLAGS			0x8003 /* A response saying that the name does not exist. */
 
 #endif /* ipconfigBYTE_ORDER */
 
@@ -128,6 +132,47 @@ name field is an offset to the string, rather than the string itself. */
 the query will be responded to with these flags: */
 #define dnsNBNS_QUERY_RESPONSE_FLAGS	( 0x8500 )
 
+#if( ipconfigUSE_DNS_CACHE == 1 )
+	/* The number of slots in the hash table that indexes the DNS cache.  It
+	must be larger than the number of entries, so an empty slot always ends a
+	search. */
+	#ifndef dnsHASH_TABLE_SIZE
+		#define dnsHASH_TABLE_SIZE			( 2 * ipconfigDNS_CACHE_ENTRIES )
+	#endif
+
+	#if( dnsHASH_TABLE_SIZE <= ipconfigDNS_CACHE_ENTRIES )
+		#error dnsHASH_TABLE_SIZE must be larger than ipconfigDNS_CACHE_ENTRIES
+	#endif
+
+	/* TTL values are stored as clock ticks, limit them to one day so they
+	can never overflow a TickType_t. */
+	#define dnsCACHE_MAX_TTL_SEC			( 24UL * 3600UL )
+#endif /* ipconfigUSE_DNS_CACHE == 1 */
+
+#if( ipconfigDNS_MAX_PENDING_QUERIES > 0 )
+	/* States of a row in the table of queries. */
+	#define dnsQUERY_FREE					( 0u )	/* The row is not in use. */
+	#define dnsQUERY_PENDING				( 1u )	/* Waiting for a reply. */
+	#define dnsQUERY_DONE					( 2u )	/* Finished, but still in use by a blocking caller. */
+
+	/* Time between two retransmissions of a query. */
+	#define dnsQUERY_RETRY_TICKS			( pdMS_TO_TICKS( ipconfigDNS_REQUEST_TIMEOUT_MS ) )
+
+	/* The period of the DNS timer while queries are outstanding. */
+	#define dnsQUERY_CHECK_TICKS			( ( dnsQUERY_RETRY_TICKS / 4u ) + 1u )
+
+	/* The longest time that FreeRTOS_gethostbyname() will block. */
+	#define dnsQUERY_WAIT_TICKS				( ( ipconfigDNS_REQUEST_ATTEMPTS * dnsQUERY_RETRY_TICKS ) + dnsQUERY_CHECK_TICKS )
+#endif /* ipconfigDNS_MAX_PENDING_QUERIES > 0 */
+
+/* The name field of a question is read when it is stored in the cache, or when
+it is compared with the name of an outstanding query. */
+#if( ( ipconfigUSE_DNS_CACHE == 1 ) || ( ipconfigDNS_MAX_PENDING_QUERIES > 0 ) )
+	#define dnsREAD_QUESTION_NAME			1
+#else
+	#define dnsREAD_QUESTION_NAME			0
+#endif
+
 /*
  * Create a socket and bind it to the standard DNS port number.  Return the
  * the created socket - or NULL if the socket could not be created or bound.
@@ -150,10 +195,60 @@ static uint8_t *prvSkipNameField( uint8_t *pucByte );
 static uint32_t prvParseDNSReply( uint8_t *pucUDPPayloadBuffer, TickType_t xIdentifier );
 
 /*
- * Prepare and send a message to a DNS server.  'xReadTimeOut_ms' will be passed as
- * zero, in case the user has supplied a call-back function.
+ * Fill in the address to which a query for 'pcHostName' must be sent: the DNS
+ * server, or the LLMNR multicast address when the name does not contain a dot.
+ * Returns pdTRUE when LLMNR is used.
  */
-static uint32_t prvGetHostByName( const char *pcHostName, TickType_t xIdentifier, TickType_t xReadTimeOut_ms );
+static BaseType_t prvGetQueryAddress( const char *pcHostName, struct freertos_sockaddr *pxAddress );
+
+#if( ipconfigDNS_MAX_PENDING_QUERIES == 0 )
+	/*
+	 * Prepare and send a message to a DNS server.  'xReadTimeOut_ms' will be passed as
+	 * zero, in case the user has supplied a call-back function.
+	 */
+	static uint32_t prvGetHostByName( const char *pcHostName, TickType_t xIdentifier, TickType_t xReadTimeOut_ms );
+#else
+	/*
+	 * Return the long-lived socket of the resolver, create it if necessary.
+	 */
+	static Socket_t prvGetResolverSocket( void );
+
+	/*
+	 * Find or create the query for 'pcHostName' and send it if it is new.  When
+	 * 'pCallback' is NULL, the caller is registered as a blocking waiter.
+	 * Returns the index of the query, or -1 if there was no free row.
+	 */
+	static BaseType_t prvStartQuery( const char *pcHostName, FOnDNSEvent pCallback, void *pvSearchID, TickType_t xTimeout );
+
+	/*
+	 * Block until the query has been answered or until dnsQUERY_WAIT_TICKS
+	 * have passed.  Returns the IP address found, or zero.
+	 */
+	static uint32_t prvWaitForQuery( BaseType_t xQuery );
+
+	/*
+	 * Send one request for a query, from either a user task or the IP-task.
+	 */
+	static void prvSendQuery( const char *pcHostName, uint16_t usIdentifier );
+
+	/*
+	 * Return the index of the outstanding query that has the given identifier
+	 * and name, or -1 when there is none.
+	 */
+	static BaseType_t prvFindQuery( uint16_t usIdentifier, const char *pcName );
+
+	/*
+	 * Store the result of a query, wake up blocking callers, and call the
+	 * call-back functions of asynchronous callers.  Called from the IP-task.
+	 */
+	static void prvCompleteQuery( BaseType_t xQuery, uint32_t ulIPAddress );
+
+	/*
+	 * Called from the IP-task by the DNS timer: repeat queries that have not
+	 * been answered in time and give up on the ones that ran out of attempts.
+	 */
+	static void prvCheckQueries( void );
+#endif /* ipconfigDNS_MAX_PENDING_QUERIES */
 
 /*
  * The NBNS and the LLMNR protocol share this reply function.
@@ -166,20 +261,77 @@ static uint32_t prvGetHostByName( const char *pcHostName, TickType_t xIdentifier
 	static portINLINE void prvTreatNBNS( uint8_t *pucUDPPayloadBuffer, uint32_t ulIPAddress );
 #endif /* ipconfigUSE_NBNS */
 
-#if( ipconfigUSE_DNS_CACHE == 1 )
+#if( dnsREAD_QUESTION_NAME == 1 )
 	static uint8_t *prvReadNameField( uint8_t *pucByte, char *pcName, BaseType_t xLen );
-	static void prvProcessDNSCache( const char *pcName, uint32_t *pulIP, BaseType_t xLookUp );
+#endif
+
+#if( ipconfigUSE_DNS_CACHE == 1 )
+	/*
+	 * Look up (xLookUp != pdFALSE) or store a name in the cache.  A stored
+	 * address of zero is a negative entry: the name is known not to exist.
+	 * 'ulTTL' is the lifetime of a new entry in seconds.  Returns pdTRUE when a
+	 * look-up found a valid entry, positive or negative.
+	 */
+	static BaseType_t prvProcessDNSCache( const char *pcName, uint32_t *pulIP, uint32_t ulTTL, BaseType_t xLookUp );
+
+	/*
+	 * Calculate the hash of a name, used as the key in the hash table.
+	 */
+	static uint32_t prvHashName( const char *pcName );
+
+	/*
+	 * Return the index of the cache entry that holds 'pcName', or -1.
+	 */
+	static BaseType_t prvFindCacheEntry( const char *pcName, uint32_t ulNameHash );
+
+	/*
+	 * Add an entry to or remove it from the hash table.
+	 */
+	static void prvCacheHashInsert( BaseType_t xEntry );
+	static void prvCacheHashRemove( BaseType_t xEntry );
+
+	/*
+	 * Returns the number of clock ticks that an entry is still valid.
+	 */
+	static TickType_t prvCacheTimeLeft( BaseType_t xEntry, TickType_t xNow );
 
 	typedef struct xDNS_CACHE_TABLE_ROW
 	{
-		uint32_t ulIPAddress;		/* The IP address of an ARP cache entry. */
-		char pcName[ipconfigDNS_CACHE_NAME_LENGTH];  /* The name of the host */
-		uint8_t ucAge;				/* A value that is periodically decremented but can also be refreshed by active communication.  The ARP cache entry is removed if the value reaches zero. */
+		uint32_t ulIPAddress;		/* The IP address of the host, or zero when the name does not exist. */
+		uint32_t ulNameHash;		/* A hash of pcName, compared before the names are. */
+		TickType_t xTimeStored;		/* The time at which the entry was stored. */
+		TickType_t xTimeToLive;		/* The lifetime of the entry in clock ticks. */
+		char pcName[ipconfigDNS_CACHE_NAME_LENGTH];  /* The name of the host, an empty string if the entry is free. */
 	} DNSCacheRow_t;
 
 	static DNSCacheRow_t xDNSCache[ ipconfigDNS_CACHE_ENTRIES ];
+
+	/* Open-addressed index into xDNSCache[], keyed by the name hash.  A slot
+	holds the entry number plus one, zero means that the slot is empty. */
+	static uint16_t usDNSHashTable[ dnsHASH_TABLE_SIZE ];
 #endif /* ipconfigUSE_DNS_CACHE == 1 */
 
+#if( ipconfigDNS_MAX_PENDING_QUERIES > 0 )
+	typedef struct xDNS_QUERY_ROW
+	{
+		uint32_t ulIPAddress;		/* The result, valid once ucState is dnsQUERY_DONE. */
+		TickType_t xTimeSent;		/* The time at which the last request was sent. */
+		uint16_t usIdentifier;		/* The transaction ID used in the requests. */
+		uint8_t ucState;			/* One of the dnsQUERY_xxx values. */
+		uint8_t ucAttempts;			/* The number of requests sent so far. */
+		uint8_t ucWaiters;			/* The number of tasks blocked in FreeRTOS_gethostbyname(). */
+		char pcName[ ipconfigDNS_QUERY_NAME_LENGTH ];	/* The name being resolved. */
+	} DNSQueryRow_t;
+
+	static DNSQueryRow_t xDNSQueries[ ipconfigDNS_MAX_PENDING_QUERIES ];
+
+	/* The socket on which all queries are sent and answered. */
+	static Socket_t xResolverSocket = NULL;
+
+	/* Bit 'x' is set when query 'x' has finished. */
+	static EventGroupHandle_t xQueryEventGroup = NULL;
+#endif /* ipconfigDNS_MAX_PENDING_QUERIES > 0 */
+
 #if( ipconfigUSE_LLMNR == 1 )
 	const MACAddress_t xLLMNR_MacAdress = { { 0x01, 0x00, 0x5e, 0x00, 0x00, 0xfc } };
 #endif	/* ipconfigUSE_LLMNR == 1 */
@@ -271,7 +423,7 @@ typedef struct xDNSTail DNSTail_t;
 	uint32_t FreeRTOS_dnslookup( const char *pcHostName )
 	{
 	uint32_t ulIPAddress = 0UL;
-		prvProcessDNSCache( pcHostName, &ulIPAddress, pdTRUE );
+		prvProcessDNSCache( pcHostName, &ulIPAddress, 0UL, pdTRUE );
 		return ulIPAddress;
 	}
 #endif /* ipconfigUSE_DNS_CACHE == 1 */
@@ -290,6 +442,12 @@ typedef struct xDNSTail DNSTail_t;
 
 	static List_t xCallbackList;
 
+	/*
+	 * The DNS timer must run as long as there are call-backs waiting, or
+	 * queries outstanding.  Called with the scheduler suspended.
+	 */
+	static BaseType_t prvDNSTimerIsNeeded( void );
+
 	/* Define FreeRTOS_gethostbyname() as a normal blocking call. */
 	uint32_t FreeRTOS_gethostbyname( const char *pcHostName )
 	{
@@ -302,6 +460,43 @@ typedef struct xDNSTail DNSTail_t;
 	void vDNSInitialise( void )
 	{
 		vListInitialise( &xCallbackList );
+
+		#if( ipconfigDNS_MAX_PENDING_QUERIES > 0 )
+		{
+			if( xQueryEventGroup == NULL )
+			{
+				xQueryEventGroup = xEventGroupCreate();
+				configASSERT( xQueryEventGroup );
+			}
+		}
+		#endif /* ipconfigDNS_MAX_PENDING_QUERIES > 0 */
+	}
+	/*-----------------------------------------------------------*/
+
+	static BaseType_t prvDNSTimerIsNeeded( void )
+	{
+	BaseType_t xReturn = pdFALSE;
+
+		if( listLIST_IS_EMPTY( &xCallbackList ) == pdFALSE )
+		{
+			xReturn = pdTRUE;
+		}
+
+		#if( ipconfigDNS_MAX_PENDING_QUERIES > 0 )
+		{
+		BaseType_t x;
+
+			for( x = 0; ( x < ipconfigDNS_MAX_PENDING_QUERIES ) && ( xReturn == pdFALSE ); x++ )
+			{
+				if( xDNSQueries[ x ].ucState == dnsQUERY_PENDING )
+				{
+					xReturn = pdTRUE;
+				}
+			}
+		}
+		#endif /* ipconfigDNS_MAX_PENDING_QUERIES > 0 */
+
+		return xReturn;
 	}
 	/*-----------------------------------------------------------*/
 
@@ -316,6 +511,17 @@ typedef struct xDNSTail DNSTail_t;
 	const ListItem_t *pxIterator;
 	const MiniListItem_t* xEnd = ( const MiniListItem_t* )listGET_END_MARKER( &xCallbackList );
 
+		#if( ipconfigDNS_MAX_PENDING_QUERIES > 0 )
+		{
+			if( pvSearchID == NULL )
+			{
+				/* Called by the DNS timer: repeat or give up on outstanding
+				queries first. */
+				prvCheckQueries();
+			}
+		}
+		#endif /* ipconfigDNS_MAX_PENDING_QUERIES > 0 */
+
 		vTaskSuspendAll();
 		{
 			for( pxIterator  = ( const ListItem_t * ) listGET_NEXT( xEnd );
@@ -337,13 +543,15 @@ typedef struct xDNSTail DNSTail_t;
 					vPortFree( ( void * ) pxCallback );
 				}
 			}
-		}
-		xTaskResumeAll();
 
-		if( listLIST_IS_EMPTY( &xCallbackList ) )
-		{
-			vIPSetDnsTimerEnableState( pdFALSE );
+			/* Tested while the scheduler is suspended, so a query that is
+			being started can not have its timer stopped. */
+			if( prvDNSTimerIsNeeded() == pdFALSE )
+			{
+				vIPSetDnsTimerEnableState( pdFALSE );
+			}
 		}
+		xTaskResumeAll();
 	}
 	/*-----------------------------------------------------------*/
 
@@ -366,11 +574,15 @@ typedef struct xDNSTail DNSTail_t;
 		xTimeout /= portTICK_PERIOD_MS;
 		if( pxCallback != NULL )
 		{
-			if( listLIST_IS_EMPTY( &xCallbackList ) )
+			#if( ipconfigDNS_MAX_PENDING_QUERIES == 0 )
 			{
-				/* This is the first one, start the DNS timer to check for timeouts */
-				vIPReloadDNSTimer( FreeRTOS_min_uint32( 1000U, xTimeout ) );
+				if( listLIST_IS_EMPTY( &xCallbackList ) )
+				{
+					/* This is the first one, start the DNS timer to check for timeouts */
+					vIPReloadDNSTimer( FreeRTOS_min_uint32( 1000U, xTimeout ) );
+				}
 			}
+			#endif /* ipconfigDNS_MAX_PENDING_QUERIES == 0 */
 			strcpy( pxCallback->pcName, pcHostName );
 			pxCallback->pCallbackFunction = pCallbackFunction;
 			pxCallback->pvSearchID = pvSearchID;
@@ -387,8 +599,8 @@ typedef struct xDNSTail DNSTail_t;
 	}
 	/*-----------------------------------------------------------*/
 
-	/* A DNS reply was received, see if there is any matching entry and
-	call the handler. */
+	/* A DNS reply was received, see if there are any matching entries and
+	call their handlers.  Several callers may share the same query. */
 	static void vDNSDoCallback( TickType_t xIdentifier, const char *pcName, uint32_t ulIPAddress );
 	static void vDNSDoCallback( TickType_t xIdentifier, const char *pcName, uint32_t ulIPAddress )
 	{
@@ -399,21 +611,23 @@ typedef struct xDNSTail DNSTail_t;
 		{
 			for( pxIterator  = ( const ListItem_t * ) listGET_NEXT( xEnd );
 				 pxIterator != ( const ListItem_t * ) xEnd;
-				 pxIterator  = ( const ListItem_t * ) listGET_NEXT( pxIterator ) )
+				  )
 			{
-				if( listGET_LIST_ITEM_VALUE( pxIterator ) == xIdentifier )
+				DNSCallback_t *pxCallback = ( DNSCallback_t * ) listGET_LIST_ITEM_OWNER( pxIterator );
+				/* Move to the next item because we might remove this item */
+				pxIterator  = ( const ListItem_t * ) listGET_NEXT( pxIterator );
+				if( listGET_LIST_ITEM_VALUE( &( pxCallback->xListItem ) ) == xIdentifier )
 				{
-					DNSCallback_t *pxCallback = ( DNSCallback_t * ) listGET_LIST_ITEM_OWNER( pxIterator );
 					pxCallback->pCallbackFunction( pcName, pxCallback->pvSearchID, ulIPAddress );
 					uxListRemove( &pxCallback->xListItem );
 					vPortFree( pxCallback );
-					if( listLIST_IS_EMPTY( &xCallbackList ) )
-					{
-						vIPSetDnsTimerEnableState( pdFALSE );
-					}
-					break;
 				}
 			}
+
+			if( prvDNSTimerIsNeeded() == pdFALSE )
+			{
+				vIPSetDnsTimerEnableState( pdFALSE );
+			}
 		}
 		xTaskResumeAll();
 	}
@@ -421,6 +635,46 @@ typedef struct xDNSTail DNSTail_t;
 #endif	/* ipconfigDNS_USE_CALLBACKS != 0 */
 /*-----------------------------------------------------------*/
 
+static BaseType_t prvGetQueryAddress( const char *pcHostName, struct freertos_sockaddr *pxAddress )
+{
+BaseType_t xUseLLMNR = pdFALSE;
+uint32_t ulDNSServerAddress;
+
+	/* If LLMNR is being used then determine if the host name includes a '.' -
+	if not then LLMNR can be used as the lookup method. */
+	#if( ipconfigUSE_LLMNR == 1 )
+	{
+		if( strchr( pcHostName, '.' ) == NULL )
+		{
+			xUseLLMNR = pdTRUE;
+		}
+	}
+	#else
+	{
+		( void ) pcHostName;
+	}
+	#endif /* ipconfigUSE_LLMNR == 1 */
+
+	if( xUseLLMNR != pdFALSE )
+	{
+		/* Use LLMNR addressing. */
+		pxAddress->sin_addr = ipLLMNR_IP_ADDR;	/* Is in network byte order. */
+		pxAddress->sin_port = FreeRTOS_ntohs( ipLLMNR_PORT );
+	}
+	else
+	{
+		/* Use DNS server. */
+		FreeRTOS_GetAddressConfiguration( NULL, NULL, NULL, &ulDNSServerAddress );
+		pxAddress->sin_addr = ulDNSServerAddress;
+		pxAddress->sin_port = dnsDNS_PORT;
+	}
+
+	return xUseLLMNR;
+}
+/*-----------------------------------------------------------*/
+
+#if( ipconfigDNS_MAX_PENDING_QUERIES == 0 )
+
 #if( ipconfigDNS_USE_CALLBACKS == 0 )
 uint32_t FreeRTOS_gethostbyname( const char *pcHostName )
 #else
@@ -490,26 +744,6 @@ int32_t lBytes;
 size_t xPayloadLength, xExpectedPayloadLength;
 TickType_t xWriteTimeOut_ms = 100U;
 
-#if( ipconfigUSE_LLMNR == 1 )
-	BaseType_t bHasDot = pdFALSE;
-#endif /* ipconfigUSE_LLMNR == 1 */
-
-	/* If LLMNR is being used then determine if the host name includes a '.' -
-	if not then LLMNR can be used as the lookup method. */
-	#if( ipconfigUSE_LLMNR == 1 )
-	{
-		const char *pucPtr;
-		for( pucPtr = pcHostName; *pucPtr; pucPtr++ )
-		{
-			if( *pucPtr == '.' )
-			{
-				bHasDot = pdTRUE;
-				break;
-			}
-		}
-	}
-	#endif /* ipconfigUSE_LLMNR == 1 */
-
 	/* Two is added at the end for the count of characters in the first
 	subdomain part and the string end byte. */
 	xExpectedPayloadLength = sizeof( DNSMessage_t ) + strlen( pcHostName ) + sizeof( uint16_t ) + sizeof( uint16_t ) + 2u;
@@ -535,28 +769,14 @@ TickType_t xWriteTimeOut_ms = 100U;
 
 				iptraceSENDING_DNS_REQUEST();
 
-				/* Obtain the DNS server address. */
-				FreeRTOS_GetAddressConfiguration( NULL, NULL, NULL, &ulIPAddress );
-
-				/* Send the DNS message. */
-#if( ipconfigUSE_LLMNR == 1 )
-				if( bHasDot == pdFALSE )
+				/* Obtain the address of the DNS server, or of the LLMNR
+				group. */
+				if( prvGetQueryAddress( pcHostName, &xAddress ) != pdFALSE )
 				{
-					/* Use LLMNR addressing. */
 					( ( DNSMessage_t * ) pucUDPPayloadBuffer) -> usFlags = 0;
-					xAddress.sin_addr = ipLLMNR_IP_ADDR;	/* Is in network byte order. */
-					xAddress.sin_port = FreeRTOS_ntohs( ipLLMNR_PORT );
-				}
-				else
-#endif
-				{
-					/* Use DNS server. */
-					xAddress.sin_addr = ulIPAddress;
-					xAddress.sin_port = dnsDNS_PORT;
 				}
 
-				ulIPAddress = 0UL;
-
+				/* Send the DNS message. */
 				if( FreeRTOS_sendto( xDNSSocket, pucUDPPayloadBuffer, xPayloadLength, FREERTOS_ZERO_COPY, &xAddress, sizeof( xAddress ) ) != 0 )
 				{
 					/* Wait for the reply. */
@@ -596,6 +816,386 @@ TickType_t xWriteTimeOut_ms = 100U;
 }
 /*-----------------------------------------------------------*/
 
+#endif /* ipconfigDNS_MAX_PENDING_QUERIES == 0 */
+
+#if( ipconfigDNS_MAX_PENDING_QUERIES > 0 )
+
+	uint32_t FreeRTOS_gethostbyname_a( const char *pcHostName, FOnDNSEvent pCallback, void *pvSearchID, TickType_t xTimeout )
+	{
+	uint32_t ulIPAddress = 0UL;
+	BaseType_t xFound = pdFALSE;
+	BaseType_t xQuery;
+
+		/* An answer from the cache is returned at once, also when it says that
+		the name does not exist. */
+		#if( ipconfigUSE_DNS_CACHE == 1 )
+		{
+			xFound = prvProcessDNSCache( pcHostName, &ulIPAddress, 0UL, pdTRUE );
+		}
+		#endif /* ipconfigUSE_DNS_CACHE == 1 */
+
+		if( xFound != pdFALSE )
+		{
+			FreeRTOS_debug_printf( ( "FreeRTOS_gethostbyname: found '%s' in cache: %lxip\n", pcHostName, ulIPAddress ) );
+
+			if( pCallback != NULL )
+			{
+				pCallback( pcHostName, pvSearchID, ulIPAddress );
+			}
+		}
+		else
+		{
+			xQuery = prvStartQuery( pcHostName, pCallback, pvSearchID, xTimeout );
+
+			if( xQuery < 0 )
+			{
+				/* The name is too long or there is no free row in the
+				table of queries. */
+				if( pCallback != NULL )
+				{
+					pCallback( pcHostName, pvSearchID, 0UL );
+				}
+			}
+			else if( pCallback == NULL )
+			{
+				ulIPAddress = prvWaitForQuery( xQuery );
+			}
+		}
+
+		return ulIPAddress;
+	}
+	/*-----------------------------------------------------------*/
+
+	BaseType_t xIsDNSSocket( Socket_t xSocket )
+	{
+	BaseType_t xReturn;
+
+		if( ( xResolverSocket != NULL ) && ( xResolverSocket == xSocket ) )
+		{
+			xReturn = pdTRUE;
+		}
+		else
+		{
+			xReturn = pdFALSE;
+		}
+
+		return xReturn;
+	}
+	/*-----------------------------------------------------------*/
+
+	static Socket_t prvGetResolverSocket( void )
+	{
+	Socket_t xSocket;
+
+		if( xResolverSocket == NULL )
+		{
+			/* The socket is created by the first look-up and it will not be
+			closed again. */
+			xSocket = prvCreateDNSSocket();
+
+			if( xSocket != NULL )
+			{
+				vTaskSuspendAll();
+				{
+					if( xResolverSocket == NULL )
+					{
+						xResolverSocket = xSocket;
+						xSocket = NULL;
+					}
+				}
+				xTaskResumeAll();
+
+				if( xSocket != NULL )
+				{
+					/* Another task has created the socket in the meantime. */
+					FreeRTOS_closesocket( xSocket );
+				}
+			}
+		}
+
+		return xResolverSocket;
+	}
+	/*-----------------------------------------------------------*/
+
+	static BaseType_t prvStartQuery( const char *pcHostName, FOnDNSEvent pCallback, void *pvSearchID, TickType_t xTimeout )
+	{
+	BaseType_t x, xQuery = -1, xFreeRow = -1;
+	BaseType_t xIsNew = pdFALSE, xWasIdle = pdTRUE;
+	DNSQueryRow_t *pxQuery;
+	uint16_t usIdentifier = 0u;
+
+		if( ( xQueryEventGroup != NULL ) &&
+			( strlen( pcHostName ) < ( size_t ) ipconfigDNS_QUERY_NAME_LENGTH ) &&
+			( prvGetResolverSocket() != NULL ) )
+		{
+			vTaskSuspendAll();
+			{
+				for( x = 0; x < ipconfigDNS_MAX_PENDING_QUERIES; x++ )
+				{
+					pxQuery = &( xDNSQueries[ x ] );
+
+					if( pxQuery->ucState == dnsQUERY_PENDING )
+					{
+						xWasIdle = pdFALSE;
+
+						if( ( xQuery < 0 ) && ( strcmp( pxQuery->pcName, pcHostName ) == 0 ) )
+						{
+							/* The name is being resolved already, share the
+							outstanding query. */
+							xQuery = x;
+						}
+					}
+					else if( ( pxQuery->ucState == dnsQUERY_FREE ) && ( xFreeRow < 0 ) )
+					{
+						xFreeRow = x;
+					}
+				}
+
+				if( ( xQuery < 0 ) && ( xFreeRow >= 0 ) )
+				{
+					/* Use a random transaction ID that is not in use by any
+					other outstanding query. */
+					do
+					{
+						usIdentifier = ( uint16_t ) ipconfigRAND32();
+					} while( prvFindQuery( usIdentifier, NULL ) >= 0 );
+
+					xQuery = xFreeRow;
+					pxQuery = &( xDNSQueries[ xQuery ] );
+					pxQuery->usIdentifier = usIdentifier;
+					pxQuery->ucState = dnsQUERY_PENDING;
+					pxQuery->ucAttempts = 1u;
+					pxQuery->ucWaiters = 0u;
+					pxQuery->ulIPAddress = 0UL;
+					pxQuery->xTimeSent = xTaskGetTickCount();
+					strcpy( pxQuery->pcName, pcHostName );
+					xEventGroupClearBits( xQueryEventGroup, ( EventBits_t ) ( 1u << xQuery ) );
+					xIsNew = pdTRUE;
+
+					if( xWasIdle != pdFALSE )
+					{
+						/* This is the only outstanding query, start the DNS
+						timer to check for timeouts. */
+						vIPReloadDNSTimer( dnsQUERY_CHECK_TICKS );
+					}
+				}
+
+				if( xQuery >= 0 )
+				{
+					pxQuery = &( xDNSQueries[ xQuery ] );
+					usIdentifier = pxQuery->usIdentifier;
+
+					/* Register the caller before the scheduler is resumed, so
+					the reply can not be handled before the caller is known. */
+					if( pCallback != NULL )
+					{
+						vDNSSetCallBack( pcHostName, pvSearchID, pCallback, xTimeout, ( TickType_t ) usIdentifier );
+					}
+					else
+					{
+						pxQuery->ucWaiters++;
+					}
+				}
+			}
+			xTaskResumeAll();
+
+			if( xIsNew != pdFALSE )
+			{
+				prvSendQuery( pcHostName, usIdentifier );
+			}
+		}
+
+		return xQuery;
+	}
+	/*-----------------------------------------------------------*/
+
+	static uint32_t prvWaitForQuery( BaseType_t xQuery )
+	{
+	DNSQueryRow_t *pxQuery = &( xDNSQueries[ xQuery ] );
+	EventBits_t uxBit = ( EventBits_t ) ( 1u << xQuery );
+	TickType_t xRemainingTime = dnsQUERY_WAIT_TICKS;
+	TimeOut_t xTimeOut;
+	uint32_t ulIPAddress = 0UL;
+
+		vTaskSetTimeOutState( &xTimeOut );
+
+		/* The bit is not cleared here: it stays set until the row is used
+		for a new query, which can not happen while this task is a waiter. */
+		while( pxQuery->ucState == dnsQUERY_PENDING )
+		{
+			xEventGroupWaitBits( xQueryEventGroup, uxBit, pdFALSE, pdFALSE, xRemainingTime );
+
+			if( xTaskCheckForTimeOut( &xTimeOut, &xRemainingTime ) != pdFALSE )
+			{
+				break;
+			}
+		}
+
+		vTaskSuspendAll();
+		{
+			if( pxQuery->ucState == dnsQUERY_DONE )
+			{
+				ulIPAddress = pxQuery->ulIPAddress;
+			}
+
+			pxQuery->ucWaiters--;
+
+			if( ( pxQuery->ucWaiters == 0u ) && ( pxQuery->ucState == dnsQUERY_DONE ) )
+			{
+				/* The last waiter releases the row.  A query that is still
+				pending will be released by the IP-task when it finishes. */
+				pxQuery->ucState = dnsQUERY_FREE;
+			}
+		}
+		xTaskResumeAll();
+
+		return ulIPAddress;
+	}
+	/*-----------------------------------------------------------*/
+
+	static void prvSendQuery( const char *pcHostName, uint16_t usIdentifier )
+	{
+	struct freertos_sockaddr xAddress;
+	uint8_t *pucUDPPayloadBuffer;
+	size_t xPayloadLength;
+	TickType_t xBlockTime = portMAX_DELAY;
+	BaseType_t xFlags = FREERTOS_ZERO_COPY;
+
+		if( xIsCallingFromIPTask() != pdFALSE )
+		{
+			/* Retransmissions are sent by the IP-task, which may not wait
+			for itself. */
+			xBlockTime = ( TickType_t ) 0;
+			xFlags |= FREERTOS_MSG_DONTWAIT;
+		}
+
+		/* Two is added at the end for the count of characters in the first
+		subdomain part and the string end byte. */
+		xPayloadLength = sizeof( DNSMessage_t ) + strlen( pcHostName ) + sizeof( uint16_t ) + sizeof( uint16_t ) + 2u;
+
+		pucUDPPayloadBuffer = ( uint8_t * ) FreeRTOS_GetUDPPayloadBuffer( xPayloadLength, xBlockTime );
+
+		/* When no buffer is available, the request will be repeated by
+		prvCheckQueries(). */
+		if( pucUDPPayloadBuffer != NULL )
+		{
+			xPayloadLength = prvCreateDNSMessage( pucUDPPayloadBuffer, pcHostName, ( TickType_t ) usIdentifier );
+
+			iptraceSENDING_DNS_REQUEST();
+
+			if( prvGetQueryAddress( pcHostName, &xAddress ) != pdFALSE )
+			{
+				( ( DNSMessage_t * ) pucUDPPayloadBuffer) -> usFlags = 0;
+			}
+
+			if( FreeRTOS_sendto( xResolverSocket, pucUDPPayloadBuffer, xPayloadLength, xFlags, &xAddress, sizeof( xAddress ) ) == 0 )
+			{
+				/* The message was not sent so the stack will not be
+				releasing the zero copy - it must be released here. */
+				FreeRTOS_ReleaseUDPPayloadBuffer( ( void * ) pucUDPPayloadBuffer );
+			}
+		}
+	}
+	/*-----------------------------------------------------------*/
+
+	static BaseType_t prvFindQuery( uint16_t usIdentifier, const char *pcName )
+	{
+	BaseType_t x, xReturn = -1;
+
+		vTaskSuspendAll();
+		{
+			for( x = 0; x < ipconfigDNS_MAX_PENDING_QUERIES; x++ )
+			{
+				if( ( xDNSQueries[ x ].ucState == dnsQUERY_PENDING ) &&
+					( xDNSQueries[ x ].usIdentifier == usIdentifier ) &&
+					( ( pcName == NULL ) || ( strcmp( xDNSQueries[ x ].pcName, pcName ) == 0 ) ) )
+				{
+					xReturn = x;
+					break;
+				}
+			}
+		}
+		xTaskResumeAll();
+
+		return xReturn;
+	}
+	/*-----------------------------------------------------------*/
+
+	static void prvCompleteQuery( BaseType_t xQuery, uint32_t ulIPAddress )
+	{
+	DNSQueryRow_t *pxQuery = &( xDNSQueries[ xQuery ] );
+
+		vTaskSuspendAll();
+		{
+			pxQuery->ulIPAddress = ulIPAddress;
+
+			if( pxQuery->ucWaiters != 0u )
+			{
+				pxQuery->ucState = dnsQUERY_DONE;
+			}
+			else
+			{
+				pxQuery->ucState = dnsQUERY_FREE;
+			}
+
+			/* The row can not be re-used before the scheduler is resumed, so
+			its name is still valid. */
+			vDNSDoCallback( ( TickType_t ) pxQuery->usIdentifier, pxQuery->pcName, ulIPAddress );
+		}
+		xTaskResumeAll();
+
+		xEventGroupSetBits( xQueryEventGroup, ( EventBits_t ) ( 1u << xQuery ) );
+	}
+	/*-----------------------------------------------------------*/
+
+	static void prvCheckQueries( void )
+	{
+	BaseType_t x, xResend, xExpired;
+	DNSQueryRow_t *pxQuery;
+	TickType_t xNow = xTaskGetTickCount();
+
+		for( x = 0; x < ipconfigDNS_MAX_PENDING_QUERIES; x++ )
+		{
+			pxQuery = &( xDNSQueries[ x ] );
+			xResend = pdFALSE;
+			xExpired = pdFALSE;
+
+			vTaskSuspendAll();
+			{
+				if( ( pxQuery->ucState == dnsQUERY_PENDING ) &&
+					( ( TickType_t ) ( xNow - pxQuery->xTimeSent ) >= dnsQUERY_RETRY_TICKS ) )
+				{
+					if( pxQuery->ucAttempts >= ( uint8_t ) ipconfigDNS_REQUEST_ATTEMPTS )
+					{
+						xExpired = pdTRUE;
+					}
+					else
+					{
+						pxQuery->ucAttempts++;
+						pxQuery->xTimeSent = xNow;
+						xResend = pdTRUE;
+					}
+				}
+			}
+			xTaskResumeAll();
+
+			/* Only the IP-task releases a pending row, so its name and
+			identifier can be used without a copy. */
+			if( xExpired != pdFALSE )
+			{
+				FreeRTOS_debug_printf( ( "prvCheckQueries: no answer for '%s'\n", pxQuery->pcName ) );
+				prvCompleteQuery( x, 0UL );
+			}
+			else if( xResend != pdFALSE )
+			{
+				prvSendQuery( pxQuery->pcName, pxQuery->usIdentifier );
+			}
+		}
+	}
+	/*-----------------------------------------------------------*/
+
+#endif /* ipconfigDNS_MAX_PENDING_QUERIES > 0 */
+
 static size_t prvCreateDNSMessage( uint8_t *pucUDPPayloadBuffer, const char *pcHostName, TickType_t xIdentifier )
 {
 DNSMessage_t *pxDNSMessageHeader;
@@ -668,7 +1268,7 @@ static const DNSMessage_t xDefaultPartDNSHeader =
 }
 /*-----------------------------------------------------------*/
 
-#if( ipconfigUSE_DNS_CACHE == 1 )
+#if( dnsREAD_QUESTION_NAME == 1 )
 
 	static uint8_t *prvReadNameField( uint8_t *pucByte, char *pcName, BaseType_t xLen )
 	{
@@ -701,7 +1301,7 @@ static const DNSMessage_t xDefaultPartDNSHeader =
 
 		return pucByte;
 	}
-#endif	/* ipconfigUSE_DNS_CACHE == 1 */
+#endif	/* dnsREAD_QUESTION_NAME == 1 */
 /*-----------------------------------------------------------*/
 
 static uint8_t *prvSkipNameField( uint8_t *pucByte )
@@ -772,6 +1372,13 @@ uint16_t x, usDataLength, usQuestions;
 	uint16_t usType = 0, usClass = 0;
 #endif
 #if( ipconfigUSE_DNS_CACHE == 1 )
+	uint32_t ulTTL;
+#endif
+#if( ipconfigDNS_MAX_PENDING_QUERIES > 0 )
+	BaseType_t xQuery = -1;
+	BaseType_t xAnswered = pdFALSE;
+#endif
+#if( dnsREAD_QUESTION_NAME == 1 )
 	char pcName[128] = ""; /*_RB_ What is the significance of 128?  Probably too big to go on the stack for a small MCU but don't know how else it could be made re-entrant.  Might be necessary. */
 #endif
 
@@ -795,13 +1402,13 @@ uint16_t x, usDataLength, usQuestions;
 			}
 			#endif
 
-#if( ipconfigUSE_DNS_CACHE == 1 )
+#if( dnsREAD_QUESTION_NAME == 1 )
 			if( x == 0 )
 			{
 				pucByte = prvReadNameField( pucByte, pcName, sizeof( pcName ) );
 			}
 			else
-#endif /* ipconfigUSE_DNS_CACHE */
+#endif /* dnsREAD_QUESTION_NAME */
 			{
 				/* Skip the variable length pcName field. */
 				pucByte = prvSkipNameField( pucByte );
@@ -822,8 +1429,33 @@ uint16_t x, usDataLength, usQuestions;
 		/* Search through the answers records. */
 		pxDNSMessageHeader->usAnswers = FreeRTOS_ntohs( pxDNSMessageHeader->usAnswers );
 
+		#if( ipconfigDNS_MAX_PENDING_QUERIES > 0 )
+		{
+			if( ( pxDNSMessageHeader->usFlags & dnsRESPONSE_FLAG ) != 0 )
+			{
+				xQuery = prvFindQuery( pxDNSMessageHeader->usIdentifier, pcName );
+			}
+		}
+		#endif /* ipconfigDNS_MAX_PENDING_QUERIES > 0 */
+
+		#if( ipconfigDNS_MAX_PENDING_QUERIES > 0 )
+		if( ( ( pxDNSMessageHeader->usFlags & dnsRESPONSE_FLAG ) != 0 ) && ( xQuery < 0 ) )
+		{
+			/* Only answers to outstanding queries are accepted.  This one
+			came in too late, or it was never asked for. */
+		}
+		else
+		#endif /* ipconfigDNS_MAX_PENDING_QUERIES > 0 */
 		if( ( pxDNSMessageHeader->usFlags & dnsRX_FLAGS_MASK ) == dnsEXPECTED_RX_FLAGS )
 		{
+			#if( ipconfigDNS_MAX_PENDING_QUERIES > 0 )
+			{
+				/* A valid answer, even when it does not contain an A
+				record. */
+				xAnswered = pdTRUE;
+			}
+			#endif /* ipconfigDNS_MAX_PENDING_QUERIES > 0 */
+
 			for( x = 0; x < pxDNSMessageHeader->usAnswers; x++ )
 			{
 				pucByte = prvSkipNameField( pucByte );
@@ -831,6 +1463,13 @@ uint16_t x, usDataLength, usQuestions;
 				/* Is the type field that of an A record? */
 				if( usChar2u16( pucByte ) == dnsTYPE_A_HOST )
 				{
+					#if( ipconfigUSE_DNS_CACHE == 1 )
+					{
+						/* The time to live follows the type and class. */
+						ulTTL = ulChar2u32( pucByte + sizeof( uint32_t ) );
+					}
+					#endif /* ipconfigUSE_DNS_CACHE */
+
 					/* This is the required record.  Skip the type, class, and
 					time to live fields, plus the first byte of the data
 					length. */
@@ -847,10 +1486,10 @@ uint16_t x, usDataLength, usQuestions;
 
 						#if( ipconfigUSE_DNS_CACHE == 1 )
 						{
-							prvProcessDNSCache( pcName, &ulIPAddress, pdFALSE );
+							prvProcessDNSCache( pcName, &ulIPAddress, ulTTL, pdFALSE );
 						}
 						#endif /* ipconfigUSE_DNS_CACHE */
-						#if( ipconfigDNS_USE_CALLBACKS != 0 )
+						#if( ( ipconfigDNS_USE_CALLBACKS != 0 ) && ( ipconfigDNS_MAX_PENDING_QUERIES == 0 ) )
 						{
 							/* See if any asynchronous call was made to FreeRTOS_gethostbyname_a() */
 							vDNSDoCallback( ( TickType_t ) pxDNSMessageHeader->usIdentifier, pcName, ulIPAddress );
@@ -874,6 +1513,13 @@ uint16_t x, usDataLength, usQuestions;
 				}
 			}
 		}
+		#if( ipconfigDNS_MAX_PENDING_QUERIES > 0 )
+		else if( ( pxDNSMessageHeader->usFlags & dnsRX_FLAGS_MASK ) == dnsNXDOMAIN_RX_FLAGS )
+		{
+			/* The name does not exist. */
+			xAnswered = pdTRUE;
+		}
+		#endif /* ipconfigDNS_MAX_PENDING_QUERIES > 0 */
 #if( ipconfigUSE_LLMNR == 1 )
 		else if( usQuestions && ( usType == dnsTYPE_A_HOST ) && ( usClass == dnsCLASS_IN ) )
 		{
@@ -948,6 +1594,25 @@ uint16_t x, usDataLength, usQuestions;
 			}
 		}
 #endif /* ipconfigUSE_LLMNR == 1 */
+
+		#if( ipconfigDNS_MAX_PENDING_QUERIES > 0 )
+		{
+			if( xAnswered != pdFALSE )
+			{
+				#if( ipconfigUSE_DNS_CACHE == 1 )
+				{
+					if( ulIPAddress == 0UL )
+					{
+						/* Remember for a while that the name has no address. */
+						prvProcessDNSCache( pcName, &ulIPAddress, ipconfigDNS_NEGATIVE_CACHE_TTL_SEC, pdFALSE );
+					}
+				}
+				#endif /* ipconfigUSE_DNS_CACHE */
+
+				prvCompleteQuery( xQuery, ulIPAddress );
+			}
+		}
+		#endif /* ipconfigDNS_MAX_PENDING_QUERIES > 0 */
 	}
 
 	return ulIPAddress;
@@ -1007,7 +1672,7 @@ uint16_t x, usDataLength, usQuestions;
 				{
 					/* If this is a response from another device,
 					add the name to the DNS cache */
-					prvProcessDNSCache( ( char * ) ucNBNSName, &ulIPAddress, pdFALSE );
+					prvProcessDNSCache( ( char * ) ucNBNSName, &ulIPAddress, dnsNBNS_TTL_VALUE, pdFALSE );
 				}
 			}
 			#else
@@ -1164,60 +1829,232 @@ TickType_t xTimeoutTime = pdMS_TO_TICKS( 200 );
 
 #if( ipconfigUSE_DNS_CACHE == 1 )
 
-	static void prvProcessDNSCache( const char *pcName, uint32_t *pulIP, BaseType_t xLookUp )
+	/* FNV-1a hash of a host name. */
+	static uint32_t prvHashName( const char *pcName )
+	{
+	uint32_t ulHash = 0x811C9DC5UL;
+
+		while( *pcName != '\0' )
+		{
+			ulHash ^= ( uint32_t ) ( uint8_t ) *( pcName++ );
+			ulHash *= 0x01000193UL;
+		}
+
+		return ulHash;
+	}
+	/*-----------------------------------------------------------*/
+
+	static BaseType_t prvProcessDNSCache( const char *pcName, uint32_t *pulIP, uint32_t ulTTL, BaseType_t xLookUp )
 	{
-	BaseType_t x;
+	BaseType_t x, xEntry;
 	BaseType_t xFound = pdFALSE;
-	static BaseType_t xFreeEntry = 0;
+	uint32_t ulNameHash = prvHashName( pcName );
+	TickType_t xNow = xTaskGetTickCount();
+	TickType_t xTimeLeft, xShortestTime = portMAX_DELAY;
 
-		/* For each entry in the DNS cache table. */
-		for( x = 0; x < ipconfigDNS_CACHE_ENTRIES; x++ )
+		/* The cache is written by the IP-task and read by the tasks that call
+		FreeRTOS_gethostbyname(). */
+		vTaskSuspendAll();
 		{
-			if( xDNSCache[ x ].pcName[ 0 ] == 0 )
+			xEntry = prvFindCacheEntry( pcName, ulNameHash );
+
+			if( ( xEntry >= 0 ) && ( prvCacheTimeLeft( xEntry, xNow ) == ( TickType_t ) 0 ) )
 			{
-				break;
+				/* The TTL of the entry has expired. */
+				prvCacheHashRemove( xEntry );
+				xDNSCache[ xEntry ].pcName[ 0 ] = '\0';
+				xEntry = -1;
 			}
 
-			if( strncmp( xDNSCache[ x ].pcName, pcName, sizeof( xDNSCache[ x ].pcName ) ) == 0 )
+			/* Is this function called for a lookup or to add/update an IP address? */
+			if( xLookUp != pdFALSE )
 			{
-				/* Is this function called for a lookup or to add/update an IP address? */
-				if( xLookUp != pdFALSE )
+				if( xEntry >= 0 )
 				{
-					*pulIP = xDNSCache[ x ].ulIPAddress;
+					*pulIP = xDNSCache[ xEntry ].ulIPAddress;
+					xFound = pdTRUE;
 				}
 				else
 				{
-					xDNSCache[ x ].ulIPAddress = *pulIP;
+					*pulIP = 0;
+				}
+			}
+			else if( ( ulTTL != 0UL ) && ( strlen( pcName ) < sizeof( xDNSCache[ 0 ].pcName ) ) )
+			{
+				if( xEntry < 0 )
+				{
+					/* Called to add an item.  Take a free entry, or else the
+					one that would expire first. */
+					for( x = 0; x < ipconfigDNS_CACHE_ENTRIES; x++ )
+					{
+						if( xDNSCache[ x ].pcName[ 0 ] == '\0' )
+						{
+							xEntry = x;
+							break;
+						}
+
+						xTimeLeft = prvCacheTimeLeft( x, xNow );
+
+						if( ( xEntry < 0 ) || ( xTimeLeft < xShortestTime ) )
+						{
+							xEntry = x;
+							xShortestTime = xTimeLeft;
+						}
+					}
+
+					if( xDNSCache[ xEntry ].pcName[ 0 ] != '\0' )
+					{
+						prvCacheHashRemove( xEntry );
+					}
+
+					strcpy( xDNSCache[ xEntry ].pcName, pcName );
+					xDNSCache[ xEntry ].ulNameHash = ulNameHash;
+					prvCacheHashInsert( xEntry );
+				}
+
+				if( ulTTL > dnsCACHE_MAX_TTL_SEC )
+				{
+					ulTTL = dnsCACHE_MAX_TTL_SEC;
 				}
 
-				xFound = pdTRUE;
+				xDNSCache[ xEntry ].ulIPAddress = *pulIP;
+				xDNSCache[ xEntry ].xTimeStored = xNow;
+				xDNSCache[ xEntry ].xTimeToLive = pdMS_TO_TICKS( ulTTL * 1000UL );
+			}
+			else if( xEntry >= 0 )
+			{
+				/* A TTL of zero means that the answer may not be cached, and
+				a name that does not fit can not be stored. */
+				prvCacheHashRemove( xEntry );
+				xDNSCache[ xEntry ].pcName[ 0 ] = '\0';
+			}
+		}
+		xTaskResumeAll();
+
+		if( ( xLookUp == 0 ) || ( *pulIP != 0 ) )
+		{
+			FreeRTOS_debug_printf( ( "prvProcessDNSCache: %s: '%s' @ %lxip\n", xLookUp ? "look-up" : "add", pcName, FreeRTOS_ntohl( *pulIP ) ) );
+		}
+
+		return xFound;
+	}
+	/*-----------------------------------------------------------*/
+
+	static TickType_t prvCacheTimeLeft( BaseType_t xEntry, TickType_t xNow )
+	{
+	TickType_t xAge = xNow - xDNSCache[ xEntry ].xTimeStored;
+	TickType_t xReturn;
+
+		if( xAge >= xDNSCache[ xEntry ].xTimeToLive )
+		{
+			xReturn = ( TickType_t ) 0;
+		}
+		else
+		{
+			xReturn = xDNSCache[ xEntry ].xTimeToLive - xAge;
+		}
+
+		return xReturn;
+	}
+	/*-----------------------------------------------------------*/
+
+	static BaseType_t prvFindCacheEntry( const char *pcName, uint32_t ulNameHash )
+	{
+	BaseType_t xSlot = ( BaseType_t ) ( ulNameHash % ( uint32_t ) dnsHASH_TABLE_SIZE );
+	BaseType_t xCount, xEntry = -1;
+	DNSCacheRow_t *pxRow;
+
+		for( xCount = 0; xCount < dnsHASH_TABLE_SIZE; xCount++ )
+		{
+			if( usDNSHashTable[ xSlot ] == 0u )
+			{
+				/* An empty slot ends the probe sequence. */
 				break;
 			}
+
+			pxRow = &( xDNSCache[ usDNSHashTable[ xSlot ] - 1u ] );
+
+			if( ( pxRow->ulNameHash == ulNameHash ) && ( strcmp( pxRow->pcName, pcName ) == 0 ) )
+			{
+				xEntry = ( BaseType_t ) usDNSHashTable[ xSlot ] - 1;
+				break;
+			}
+
+			if( ++xSlot == dnsHASH_TABLE_SIZE )
+			{
+				xSlot = 0;
+			}
 		}
 
-		if( xFound == pdFALSE )
+		return xEntry;
+	}
+	/*-----------------------------------------------------------*/
+
+	static void prvCacheHashInsert( BaseType_t xEntry )
+	{
+	BaseType_t xSlot = ( BaseType_t ) ( xDNSCache[ xEntry ].ulNameHash % ( uint32_t ) dnsHASH_TABLE_SIZE );
+
+		/* There are more slots than entries, so a free slot will be found. */
+		while( usDNSHashTable[ xSlot ] != 0u )
 		{
-			if( xLookUp != pdFALSE )
+			if( ++xSlot == dnsHASH_TABLE_SIZE )
 			{
-				*pulIP = 0;
+				xSlot = 0;
 			}
-			else
+		}
+
+		usDNSHashTable[ xSlot ] = ( uint16_t ) ( xEntry + 1 );
+	}
+	/*-----------------------------------------------------------*/
+
+	static void prvCacheHashRemove( BaseType_t xEntry )
+	{
+	BaseType_t xSlot = ( BaseType_t ) ( xDNSCache[ xEntry ].ulNameHash % ( uint32_t ) dnsHASH_TABLE_SIZE );
+	BaseType_t xNext, xHome;
+
+		while( usDNSHashTable[ xSlot ] != ( uint16_t ) ( xEntry + 1 ) )
+		{
+			if( usDNSHashTable[ xSlot ] == 0u )
 			{
-				/* Called to add or update an item */
-				strncpy( xDNSCache[ xFreeEntry ].pcName, pcName, sizeof( xDNSCache[ xFreeEntry ].pcName ) );
-				xDNSCache[ xFreeEntry ].ulIPAddress = *pulIP;
+				/* The entry was not indexed. */
+				return;
+			}
 
-				xFreeEntry++;
-				if( xFreeEntry == ipconfigDNS_CACHE_ENTRIES )
-				{
-					xFreeEntry = 0;
-				}
+			if( ++xSlot == dnsHASH_TABLE_SIZE )
+			{
+				xSlot = 0;
 			}
 		}
 
-		if( ( xLookUp == 0 ) || ( *pulIP != 0 ) )
+		usDNSHashTable[ xSlot ] = 0u;
+
+		/* Move back the entries that follow in the same cluster, so that no
+		probe sequence is interrupted by the new hole. */
+		xNext = xSlot;
+
+		for( ;; )
 		{
-			FreeRTOS_debug_printf( ( "prvProcessDNSCache: %s: '%s' @ %lxip\n", xLookUp ? "look-up" : "add", pcName, FreeRTOS_ntohl( *pulIP ) ) );
+			if( ++xNext == dnsHASH_TABLE_SIZE )
+			{
+				xNext = 0;
+			}
+
+			if( usDNSHashTable[ xNext ] == 0u )
+			{
+				break;
+			}
+
+			xHome = ( BaseType_t ) ( xDNSCache[ usDNSHashTable[ xNext ] - 1u ].ulNameHash % ( uint32_t ) dnsHASH_TABLE_SIZE );
+
+			/* Can the entry in xNext be moved to xSlot?  Only when its home
+			slot does not lie cyclically in ( xSlot, xNext ]. */
+			if( ( ( xNext > xSlot ) && ( ( xHome <= xSlot ) || ( xHome > xNext ) ) ) ||
+				( ( xNext < xSlot ) && ( ( xHome <= xSlot ) && ( xHome > xNext ) ) ) )
+			{
+				usDNSHashTable[ xSlot ] = usDNSHashTable[ xNext ];
+				usDNSHashTable[ xNext ] = 0u;
+				xSlot = xNext;
+			}
 		}
 	}
 
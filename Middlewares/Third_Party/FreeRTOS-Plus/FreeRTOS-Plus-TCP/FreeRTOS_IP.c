@@ -264,6 +264,14 @@ static TickType_t prvCalculateSleepTime( void );
  */
 static void prvHandleEthernetPacket( NetworkBufferDescriptor_t *pxBuffer );
 
+#if( ipconfigSUPPORT_MSG_FUNCTIONS == 1 )
+	/*
+	 * FreeRTOS_sendmmsg() has queued a chain of UDP packets, linked through
+	 * pxNextBuffer.  Send each of them.
+	 */
+	static void prvProcessGeneratedUDPChain( NetworkBufferDescriptor_t *pxBuffer );
+#endif
+
 /*
  * Utility functions for the light weight IP timers.
  */
@@ -341,6 +349,23 @@ static BaseType_t xIPTaskInitialised = pdFALSE;
 	static UBaseType_t uxQueueMinimumSpace = ipconfigEVENT_QUEUE_LENGTH;
 #endif
 
+#if( ipconfigUSE_LATENCY_HISTOGRAMS == 1 )
+	/* The latency histograms, updated by the network interface, the IP-task
+	and the tasks that read from sockets. */
+	static LatencyHistogram_t xLatencyHistograms[ eLatencyStageCount ];
+
+	static const char * const pcLatencyStageNames[ eLatencyStageCount ] =
+	{
+		"rx driver",
+		"rx queue",
+		"rx process",
+		"rx socket",
+		"tx queue",
+		"tx process",
+		"tx driver"
+	};
+#endif
+
 /*-----------------------------------------------------------*/
 
 static void prvIPTask( void *pvParameters )
@@ -460,6 +485,7 @@ struct freertos_sockaddr xAddress;
 				/* The network stack has generated a packet to send.  A
 				pointer to the generated buffer is located in the pvData
 				member of the received event structure. */
+				ipLATENCY_STAGE( ( NetworkBufferDescriptor_t * ) ( xReceivedEvent.pvData ), eLatencyTxQueue );
 				vProcessGeneratedUDPPacket( ( NetworkBufferDescriptor_t * ) ( xReceivedEvent.pvData ) );
 				break;
 
@@ -493,6 +519,16 @@ struct freertos_sockaddr xAddress;
 				#endif /* ipconfigSUPPORT_SIGNALS */
 				break;
 
+			case eStackTxChainEvent :
+				#if( ipconfigSUPPORT_MSG_FUNCTIONS == 1 )
+				{
+					/* FreeRTOS_sendmmsg() has queued a number of packets
+					with a single event. */
+					prvProcessGeneratedUDPChain( ( NetworkBufferDescriptor_t * ) ( xReceivedEvent.pvData ) );
+				}
+				#endif /* ipconfigSUPPORT_MSG_FUNCTIONS */
+				break;
+
 			case eTCPTimerEvent :
 				#if( ipconfigUSE_TCP == 1 )
 				{
@@ -599,6 +635,28 @@ static void prvHandleEthernetPacket( NetworkBufferDescriptor_t *pxBuffer )
 }
 /*-----------------------------------------------------------*/
 
+#if( ipconfigSUPPORT_MSG_FUNCTIONS == 1 )
+
+	static void prvProcessGeneratedUDPChain( NetworkBufferDescriptor_t *pxBuffer )
+	{
+	NetworkBufferDescriptor_t *pxNextBuffer;
+
+		while( pxBuffer != NULL )
+		{
+			pxNextBuffer = pxBuffer->pxNextBuffer;
+
+			/* Unlink it before it is sent, the driver may release it. */
+			pxBuffer->pxNextBuffer = NULL;
+
+			ipLATENCY_STAGE( pxBuffer, eLatencyTxQueue );
+			vProcessGeneratedUDPPacket( pxBuffer );
+			pxBuffer = pxNextBuffer;
+		}
+	}
+
+#endif /* ipconfigSUPPORT_MSG_FUNCTIONS */
+/*-----------------------------------------------------------*/
+
 static TickType_t prvCalculateSleepTime( void )
 {
 TickType_t xMaximumSleepTime;
@@ -880,6 +938,12 @@ NetworkBufferDescriptor_t * pxNewBuffer;
 		pxNewBuffer->ulIPAddress = pxNetworkBuffer->ulIPAddress;
 		pxNewBuffer->usPort = pxNetworkBuffer->usPort;
 		pxNewBuffer->usBoundPort = pxNetworkBuffer->usBoundPort;
+		#if( ipconfigUSE_LATENCY_HISTOGRAMS == 1 )
+		{
+			/* The copy continues the stage of the original. */
+			pxNewBuffer->ulLatencyStamp = pxNetworkBuffer->ulLatencyStamp;
+		}
+		#endif
 		memcpy( pxNewBuffer->pucEthernetBuffer, pxNetworkBuffer->pucEthernetBuffer, pxNetworkBuffer->xDataLength );
 	}
 
@@ -1157,7 +1221,7 @@ void FreeRTOS_SetAddressConfiguration( const uint32_t *pulIPAddress, const uint3
 				if( xSendEventStructToIPTask( &xStackTxEvent, xBlockTimeTicks) != pdPASS )
 				{
 					vReleaseNetworkBufferAndDescriptor( pxNetworkBuffer );
-					iptraceSTACK_TX_EVENT_LOST( ipSTACK_TX_EVENT );
+					iptraceSTACK_TX_EVENT_LOST( eStackTxEvent );
 				}
 				else
 				{
@@ -1384,9 +1448,31 @@ static void prvProcessEthernetPacket( NetworkBufferDescriptor_t * const pxNetwor
 {
 EthernetHeader_t *pxEthernetHeader;
 volatile eFrameProcessingResult_t eReturned; /* Volatile to prevent complier warnings when ipCONSIDER_FRAME_FOR_PROCESSING just sets it to eProcessBuffer. */
+#if( ipconfigUSE_PCAP_REPLAY == 1 )
+	uint32_t ulReplayStart = ipconfigBENCHMARK_TIMER_VALUE();
+	BaseType_t xReplayClass;
+#endif
+#if( ipconfigUSE_LATENCY_HISTOGRAMS == 1 )
+	uint32_t ulProcessStart;
+#endif
 
 	configASSERT( pxNetworkBuffer );
 
+	#if( ipconfigUSE_LATENCY_HISTOGRAMS == 1 )
+	{
+		/* The buffer is stamped again here, so a reply that is sent from
+		the same buffer is timed from the start of the processing. */
+		ipLATENCY_STAGE( pxNetworkBuffer, eLatencyRxQueue );
+		ulProcessStart = pxNetworkBuffer->ulLatencyStamp;
+	}
+	#endif
+
+	#if( ipconfigUSE_PCAP_REPLAY == 1 )
+	{
+		xReplayClass = xPcapReplayClassify( pxNetworkBuffer->pucEthernetBuffer );
+	}
+	#endif
+
 	/* Interpret the Ethernet frame. */
 	eReturned = ipCONSIDER_FRAME_FOR_PROCESSING( pxNetworkBuffer->pucEthernetBuffer );
 	pxEthernetHeader = ( EthernetHeader_t * ) ( pxNetworkBuffer->pucEthernetBuffer );
@@ -1437,6 +1523,19 @@ volatile eFrameProcessingResult_t eReturned; /* Volatile to prevent complier war
 			vReleaseNetworkBufferAndDescriptor( pxNetworkBuffer );
 			break;
 	}
+
+	#if( ipconfigUSE_PCAP_REPLAY == 1 )
+	{
+		vPcapReplayPacketProcessed( xReplayClass, ulReplayStart );
+	}
+	#endif
+
+	#if( ipconfigUSE_LATENCY_HISTOGRAMS == 1 )
+	{
+		/* The buffer may have been released or passed on already. */
+		vLatencyRecord( eLatencyRxProcess, ulProcessStart );
+	}
+	#endif
 }
 /*-----------------------------------------------------------*/
 
@@ -2193,3 +2292,115 @@ BaseType_t FreeRTOS_IsNetworkUp( void )
 	}
 #endif
 /*-----------------------------------------------------------*/
+
+#if( ipconfigUSE_LATENCY_HISTOGRAMS == 1 )
+
+	void vLatencyRecord( eLatencyStage_t eStage, uint32_t ulStartTime )
+	{
+	uint32_t ulLatency = ipLATENCY_TIME() - ulStartTime;
+	uint32_t ulValue = ulLatency;
+	UBaseType_t uxBucket = 0u;
+	LatencyHistogram_t *pxHistogram = &( xLatencyHistograms[ eStage ] );
+
+		/* Bucket 'n' holds the latencies from 2^n up to 2^(n+1) counts. */
+		while( ( ulValue > 1ul ) && ( uxBucket < ( UBaseType_t ) ( ipconfigLATENCY_HISTOGRAM_BUCKETS - 1 ) ) )
+		{
+			ulValue >>= 1;
+			uxBucket++;
+		}
+
+		/* Called from several tasks, and the updates are not atomic. */
+		taskENTER_CRITICAL();
+		{
+			if( ( pxHistogram->ulCount == 0ul ) || ( ulLatency < pxHistogram->ulMin ) )
+			{
+				pxHistogram->ulMin = ulLatency;
+			}
+			if( ulLatency > pxHistogram->ulMax )
+			{
+				pxHistogram->ulMax = ulLatency;
+			}
+			pxHistogram->ulCount++;
+			pxHistogram->ullTotal += ulLatency;
+			pxHistogram->ulBuckets[ uxBucket ]++;
+		}
+		taskEXIT_CRITICAL();
+	}
+	/*-----------------------------------------------------------*/
+
+	void vLatencyStage( NetworkBufferDescriptor_t *pxNetworkBuffer, eLatencyStage_t eStage )
+	{
+	uint32_t ulStartTime = pxNetworkBuffer->ulLatencyStamp;
+
+		/* The next stage starts at the moment this one ends. */
+		ipLATENCY_STAMP( pxNetworkBuffer );
+		vLatencyRecord( eStage, ulStartTime );
+	}
+	/*-----------------------------------------------------------*/
+
+	BaseType_t FreeRTOS_GetLatencyHistogram( eLatencyStage_t eStage, LatencyHistogram_t *pxHistogram )
+	{
+	BaseType_t xResult = pdFAIL;
+
+		if( ( ( UBaseType_t ) eStage < ( UBaseType_t ) eLatencyStageCount ) && ( pxHistogram != NULL ) )
+		{
+			taskENTER_CRITICAL();
+			{
+				memcpy( pxHistogram, &( xLatencyHistograms[ eStage ] ), sizeof( *pxHistogram ) );
+			}
+			taskEXIT_CRITICAL();
+			xResult = pdPASS;
+		}
+
+		return xResult;
+	}
+	/*-----------------------------------------------------------*/
+
+	void FreeRTOS_ResetLatencyHistograms( void )
+	{
+		taskENTER_CRITICAL();
+		{
+			memset( xLatencyHistograms, '\0', sizeof( xLatencyHistograms ) );
+		}
+		taskEXIT_CRITICAL();
+	}
+	/*-----------------------------------------------------------*/
+
+	void FreeRTOS_PrintLatencyHistograms( void )
+	{
+	LatencyHistogram_t xHistogram;
+	BaseType_t xStage;
+	UBaseType_t uxBucket;
+
+		FreeRTOS_printf( ( "Latency in timer counts, %lu counts per us\n", ( uint32_t ) ipconfigBENCHMARK_COUNTS_PER_US ) );
+
+		for( xStage = 0; xStage < ( BaseType_t ) eLatencyStageCount; xStage++ )
+		{
+			( void ) FreeRTOS_GetLatencyHistogram( ( eLatencyStage_t ) xStage, &xHistogram );
+
+			if( xHistogram.ulCount == 0ul )
+			{
+				continue;
+			}
+
+			FreeRTOS_printf( ( "%-10s: %lu packets min %lu mean %lu max %lu\n",
+				pcLatencyStageNames[ xStage ],
+				xHistogram.ulCount,
+				xHistogram.ulMin,
+				( uint32_t ) ( xHistogram.ullTotal / xHistogram.ulCount ),
+				xHistogram.ulMax ) );
+
+			for( uxBucket = 0u; uxBucket < ( UBaseType_t ) ipconfigLATENCY_HISTOGRAM_BUCKETS; uxBucket++ )
+			{
+				if( xHistogram.ulBuckets[ uxBucket ] != 0ul )
+				{
+					FreeRTOS_printf( ( "    >= %10lu: %lu\n",
+						( uxBucket == 0u ) ? 0ul : ( 1ul << uxBucket ),
+						xHistogram.ulBuckets[ uxBucket ] ) );
+				}
+			}
+		}
+	}
+	/*-----------------------------------------------------------*/
+
+#endif /* ipconfigUSE_LATENCY_HISTOGRAMS */
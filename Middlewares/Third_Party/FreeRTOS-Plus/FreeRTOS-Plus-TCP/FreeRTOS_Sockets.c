@@ -109,6 +109,28 @@ it is reset back to the value defined by this constant. */
 	#define ipTCP_TIMER_PERIOD_MS	( 1000 )
 #endif
 
+#if( ipconfigTCP_RX_AUTOTUNE == 1 )
+	/* Time stamps used to measure the reception of a socket: in units of the
+	high-resolution RTT timer when available, otherwise in clock ticks. */
+	#if( ipconfigTCP_HIGH_RESOLUTION_RTT == 1 )
+		#define socketRX_STAMP()			( ( uint32_t ) ipconfigTCP_HR_TIMER_VALUE() )
+	#else
+		#define socketRX_STAMP()			( ( uint32_t ) xTaskGetTickCount() )
+	#endif
+
+	/* Under memory pressure, streams of sockets that have been quiet for this
+	time will be released. */
+	#define socketRX_PRESSURE_IDLE_TICKS	( pdMS_TO_TICKS( ipconfigTCP_RX_AUTOTUNE_IDLE_MS ) / 8u )
+
+	/* The IP-task may replace or release rxStream, so other tasks only access
+	it with the scheduler suspended. */
+	#define socketRX_STREAM_ENTER()			vTaskSuspendAll()
+	#define socketRX_STREAM_EXIT()			( void ) xTaskResumeAll()
+#else
+	#define socketRX_STREAM_ENTER()
+	#define socketRX_STREAM_EXIT()
+#endif
+
 /* The next private port number to use when binding a client socket is stored in
 the usNextPortToUse[] array - which has either 1 or two indexes depending on
 whether TCP is being supported. */
@@ -151,6 +173,36 @@ static BaseType_t prvValidSocket( FreeRTOS_Socket_t *pxSocket, BaseType_t xProto
  */
 static BaseType_t prvDetermineSocketSize( BaseType_t xDomain, BaseType_t xType, BaseType_t xProtocol, size_t *pxSocketSize );
 
+/*
+ * Called from FreeRTOS_recvfrom() and FreeRTOS_recvmmsg(): wait until a UDP socket has received a
+ * packet, the timeout expires, or the socket gets signalled.  Returns the
+ * number of packets waiting.
+ */
+static BaseType_t prvUDPWaitForPacket( FreeRTOS_Socket_t *pxSocket, BaseType_t xFlags, EventBits_t *pxEventBits );
+
+/*
+ * The common part of FreeRTOS_sendto(), FreeRTOS_sendmsg() and
+ * FreeRTOS_sendmmsg(): bind the socket if it is not bound yet, and fill in
+ * the fields that the IP-task needs to send the UDP payload in
+ * 'pxNetworkBuffer' to 'pxDestinationAddress'.  Returns pdFAIL when the socket
+ * can not be bound.
+ */
+static BaseType_t prvUDPPrepareBuffer( FreeRTOS_Socket_t *pxSocket, NetworkBufferDescriptor_t *pxNetworkBuffer, const struct freertos_sockaddr *pxDestinationAddress );
+
+/*
+ * Pass a prepared network buffer to the IP-task with an eStackTxEvent, or a
+ * chain of them, linked through pxNextBuffer, with an eStackTxChainEvent.
+ * Returns pdPASS when the IP-task has taken the buffers, otherwise they still
+ * belong to the caller.
+ */
+static BaseType_t prvUDPSendToIPTask( eIPEvent_t eEventType, NetworkBufferDescriptor_t *pxFirstBuffer, TickType_t xTicksToWait );
+
+/*
+ * Call the sent handler of a UDP socket, if it has one, for a datagram of
+ * 'uxLength' bytes that was taken by the IP-task.
+ */
+static void prvUDPHandleSent( FreeRTOS_Socket_t *pxSocket, size_t uxLength );
+
 #if( ipconfigUSE_TCP == 1 )
 	/*
 	 * Create a txStream or a rxStream, depending on the parameter 'xIsInputStream'
@@ -158,6 +210,41 @@ static BaseType_t prvDetermineSocketSize( BaseType_t xDomain, BaseType_t xType,
 	static StreamBuffer_t *prvTCPCreateStream (FreeRTOS_Socket_t *pxSocket, BaseType_t xIsInputStream );
 #endif /* ipconfigUSE_TCP == 1 */
 
+#if( ipconfigTCP_RX_AUTOTUNE == 1 )
+	/*
+	 * Called for data that was received in-order: measure the round-trip time
+	 * and the reception rate, and let rxStream grow when the window is the
+	 * limiting factor.
+	 */
+	static void prvTCPRxAutoTune( FreeRTOS_Socket_t *pxSocket, uint32_t ulByteCount );
+
+	/*
+	 * Enlarge the reception window to ulTarget bytes, within the budget.
+	 */
+	static void prvTCPRxGrow( FreeRTOS_Socket_t *pxSocket, uint32_t ulTarget );
+
+	/*
+	 * Give rxStream a new size while keeping its contents.
+	 */
+	static BaseType_t prvTCPRxResize( FreeRTOS_Socket_t *pxSocket, size_t uxNewSize );
+
+	/*
+	 * Free an empty rxStream and return to the initial stream and window size.
+	 */
+	static BaseType_t prvTCPRxRelease( FreeRTOS_Socket_t *pxSocket );
+
+	/*
+	 * Release the reception streams of all sockets that did not receive any
+	 * data during the last xMinIdle ticks.  Returns the number released.
+	 */
+	static BaseType_t prvTCPRxReclaim( const FreeRTOS_Socket_t *pxExclude, TickType_t xMinIdle );
+
+	/*
+	 * The application sets the buffer size: stop auto-tuning.
+	 */
+	static void prvTCPRxAutoTuneStop( FreeRTOS_Socket_t *pxSocket );
+#endif /* ipconfigTCP_RX_AUTOTUNE */
+
 #if( ipconfigUSE_TCP == 1 )
 	/*
 	 * Called from FreeRTOS_send(): some checks which will be done before
@@ -166,6 +253,34 @@ static BaseType_t prvDetermineSocketSize( BaseType_t xDomain, BaseType_t xType,
 	static int32_t prvTCPSendCheck( FreeRTOS_Socket_t *pxSocket, size_t xDataLength );
 #endif /* ipconfigUSE_TCP */
 
+#if( ipconfigUSE_TCP == 1 )
+	/*
+	 * The common part of FreeRTOS_send() and FreeRTOS_sendmsg(): the data to
+	 * be sent is taken from an array of fragments.
+	 */
+	static BaseType_t prvTCPSendIOVec( FreeRTOS_Socket_t *pxSocket, const struct freertos_iovec *pxIOVec, size_t uxIOVecCount, BaseType_t xFlags );
+
+	/*
+	 * The common part of FreeRTOS_recv() and FreeRTOS_recvmsg(): the received
+	 * data is stored in an array of fragments.
+	 */
+	static BaseType_t prvTCPRecvIOVec( FreeRTOS_Socket_t *pxSocket, const struct freertos_iovec *pxIOVec, size_t uxIOVecCount, BaseType_t xFlags );
+
+	/*
+	 * After data has been taken from rxStream: see if the low-water flag can
+	 * be cleared.  Returns pdTRUE when the peer must be told about the bigger
+	 * window.
+	 */
+	static BaseType_t prvTCPRxLowWaterCheck( FreeRTOS_Socket_t *pxSocket );
+#endif /* ipconfigUSE_TCP */
+
+#if( ipconfigUSE_TCP == 1 ) || ( ipconfigSUPPORT_MSG_FUNCTIONS == 1 )
+	/*
+	 * Return the total number of bytes described by an array of fragments.
+	 */
+	static size_t prvIOVecLength( const struct freertos_iovec *pxIOVec, size_t uxIOVecCount );
+#endif
+
 #if( ipconfigUSE_TCP == 1 )
 	/*
 	 * When a child socket gets closed, make sure to update the child-count of the parent
@@ -173,6 +288,14 @@ static BaseType_t prvDetermineSocketSize( BaseType_t xDomain, BaseType_t xType,
 	static void prvTCPSetSocketCount( FreeRTOS_Socket_t *pxSocketToDelete );
 #endif  /* ipconfigUSE_TCP == 1 */
 
+#if( ipconfigUSE_TCP_SYN_CACHE == 1 )
+	/*
+	 * Remove a child socket from the accept queue of its parent, if it is
+	 * still queued.
+	 */
+	static void prvTCPAcceptQueueRemove( FreeRTOS_Socket_t *pxParent, FreeRTOS_Socket_t *pxChild );
+#endif /* ipconfigUSE_TCP_SYN_CACHE */
+
 #if( ipconfigUSE_TCP == 1 )
 	/*
 	 * Called from FreeRTOS_connect(): make some checks and if allowed, send a
@@ -206,6 +329,68 @@ when the IP stack is initialised.  Note ipconfigRAND32() is used, which must be
 seeded prior to the IP task being started. */
 static uint16_t usNextPortToUse[ socketPROTOCOL_COUNT ] = { 0 };
 
+#if( ipconfigTCP_RX_AUTOTUNE == 1 )
+	/* The number of bytes that auto-tuned reception streams use on top of their
+	initial size.  Changed by the IP-task, or with the scheduler suspended. */
+	static size_t uxRxAutoTuneTotal = 0u;
+#endif
+
+#if( ipconfigUSE_SOCKET_POOL == 1 )
+	/* Objects in the pools are aligned like the blocks returned by the heap. */
+	#define socketPOOL_ALIGN( x )			( ( ( x ) + ( portBYTE_ALIGNMENT - 1u ) ) & ~( ( size_t ) portBYTE_ALIGNMENT_MASK ) )
+
+	#define socketPOOL_SOCKET_SIZE			socketPOOL_ALIGN( sizeof( FreeRTOS_Socket_t ) )
+
+	/* The size of a stream that holds 'x' bytes, as calculated in
+	prvTCPCreateStream(). */
+	#define socketPOOL_STREAM_SIZE( x )		socketPOOL_ALIGN( ( sizeof( StreamBuffer_t ) - sizeof( ( ( StreamBuffer_t * ) 0 )->ucArray ) ) + \
+												( ( ( x ) + sizeof( size_t ) ) & ~( sizeof( size_t ) - 1u ) ) )
+
+	/* A free object is linked into the free list of its pool.  A socket keeps
+	its event group while it is in the pool, so it doesn't have to be created
+	again by the next FreeRTOS_socket(). */
+	typedef struct xSOCKET_POOL_ITEM
+	{
+		struct xSOCKET_POOL_ITEM *pxNext;
+		EventGroupHandle_t xEventGroup;
+	} SocketPoolItem_t;
+
+	typedef struct xSOCKET_POOL
+	{
+		uint8_t *pucStart;				/* The first byte of the pool's storage. */
+		uint8_t *pucEnd;				/* The first byte after the pool's storage. */
+		SocketPoolItem_t *pxFreeList;	/* Objects that can be taken. */
+		SocketPoolStats_t xStats;
+	} SocketPool_t;
+
+	/* The storage of the pools, declared as uint64_t to get it aligned. */
+	static uint64_t ullSocketPoolSockets[ ( ipconfigSOCKET_POOL_SOCKETS * socketPOOL_SOCKET_SIZE ) / sizeof( uint64_t ) ];
+
+	#if( ipconfigUSE_TCP == 1 )
+		static uint64_t ullSocketPoolSmallStreams[ ( ipconfigSOCKET_POOL_SMALL_STREAMS * socketPOOL_STREAM_SIZE( ipconfigSOCKET_POOL_SMALL_STREAM_LENGTH ) ) / sizeof( uint64_t ) ];
+		static uint64_t ullSocketPoolLargeStreams[ ( ipconfigSOCKET_POOL_LARGE_STREAMS * socketPOOL_STREAM_SIZE( ipconfigSOCKET_POOL_LARGE_STREAM_LENGTH ) ) / sizeof( uint64_t ) ];
+	#endif
+
+	/* Zero until vNetworkSocketsInit() has run: an empty pool without storage,
+	every allocation will go to the heap. */
+	static SocketPool_t xSocketPools[ FREERTOS_POOL_COUNT ];
+
+	static void prvSocketPoolInit( SocketPool_t *pxPool, void *pvStorage, size_t uxBlockSize, UBaseType_t uxCount );
+	static void *prvSocketPoolTake( SocketPool_t *pxPool, EventGroupHandle_t *pxEventGroup );
+	static BaseType_t prvSocketPoolGive( SocketPool_t *pxPool, void *pvObject, EventGroupHandle_t xEventGroup );
+
+	#if( ipconfigUSE_TCP == 1 )
+		static void *prvSocketPoolStreamMalloc( size_t uxSize );
+		static void prvSocketPoolStreamFree( void *pvStream );
+
+		#define socketSTREAM_MALLOC( x )	prvSocketPoolStreamMalloc( x )
+		#define socketSTREAM_FREE( x )		prvSocketPoolStreamFree( x )
+	#endif
+#else
+	#define socketSTREAM_MALLOC( x )		pvPortMallocLarge( x )
+	#define socketSTREAM_FREE( x )			vPortFreeLarge( x )
+#endif /* ipconfigUSE_SOCKET_POOL */
+
 /*-----------------------------------------------------------*/
 
 static BaseType_t prvValidSocket( FreeRTOS_Socket_t *pxSocket, BaseType_t xProtocol, BaseType_t xIsBound )
@@ -260,9 +445,189 @@ uint32_t ulRandomPort;
 		vListInitialise( &xBoundTCPSocketsList );
 	}
 	#endif  /* ipconfigUSE_TCP == 1 */
+
+	#if( ipconfigUSE_SOCKET_POOL == 1 )
+	{
+		prvSocketPoolInit( &( xSocketPools[ FREERTOS_POOL_SOCKETS ] ), ullSocketPoolSockets,
+			socketPOOL_SOCKET_SIZE, ipconfigSOCKET_POOL_SOCKETS );
+
+		#if( ipconfigUSE_TCP == 1 )
+		{
+			prvSocketPoolInit( &( xSocketPools[ FREERTOS_POOL_SMALL_STREAMS ] ), ullSocketPoolSmallStreams,
+				socketPOOL_STREAM_SIZE( ipconfigSOCKET_POOL_SMALL_STREAM_LENGTH ), ipconfigSOCKET_POOL_SMALL_STREAMS );
+			prvSocketPoolInit( &( xSocketPools[ FREERTOS_POOL_LARGE_STREAMS ] ), ullSocketPoolLargeStreams,
+				socketPOOL_STREAM_SIZE( ipconfigSOCKET_POOL_LARGE_STREAM_LENGTH ), ipconfigSOCKET_POOL_LARGE_STREAMS );
+		}
+		#endif /* ipconfigUSE_TCP */
+	}
+	#endif /* ipconfigUSE_SOCKET_POOL */
 }
 /*-----------------------------------------------------------*/
 
+#if( ipconfigUSE_SOCKET_POOL == 1 )
+
+	static void prvSocketPoolInit( SocketPool_t *pxPool, void *pvStorage, size_t uxBlockSize, UBaseType_t uxCount )
+	{
+	uint8_t *pucBlock;
+	SocketPoolItem_t *pxItem;
+	UBaseType_t uxIndex;
+
+		memset( pxPool, '\0', sizeof( *pxPool ) );
+		pxPool->pucStart = ( uint8_t * ) pvStorage;
+		pxPool->pucEnd = pxPool->pucStart + ( uxBlockSize * uxCount );
+		pxPool->xStats.uxBlockSize = uxBlockSize;
+		pxPool->xStats.uxCount = uxCount;
+
+		/* Link the blocks from last to first, so the first block is taken
+		first. */
+		for( uxIndex = uxCount; uxIndex > 0u; uxIndex-- )
+		{
+			pucBlock = pxPool->pucStart + ( uxBlockSize * ( uxIndex - 1u ) );
+			pxItem = ( SocketPoolItem_t * ) pucBlock;
+			pxItem->xEventGroup = NULL;
+			pxItem->pxNext = pxPool->pxFreeList;
+			pxPool->pxFreeList = pxItem;
+		}
+	}
+	/*-----------------------------------------------------------*/
+
+	/* Take an object from a pool, or return NULL if the pool is empty.  If
+	'pxEventGroup' is not NULL, it will receive the event group that was kept
+	with the object, which may be NULL. */
+	static void *prvSocketPoolTake( SocketPool_t *pxPool, EventGroupHandle_t *pxEventGroup )
+	{
+	SocketPoolItem_t *pxItem;
+
+		taskENTER_CRITICAL();
+		{
+			pxItem = pxPool->pxFreeList;
+
+			if( pxItem != NULL )
+			{
+				pxPool->pxFreeList = pxItem->pxNext;
+				pxPool->xStats.uxInUse++;
+
+				if( pxPool->xStats.uxMaxInUse < pxPool->xStats.uxInUse )
+				{
+					pxPool->xStats.uxMaxInUse = pxPool->xStats.uxInUse;
+				}
+			}
+		}
+		taskEXIT_CRITICAL();
+
+		if( pxEventGroup != NULL )
+		{
+			*pxEventGroup = ( pxItem != NULL ) ? pxItem->xEventGroup : NULL;
+		}
+
+		return ( void * ) pxItem;
+	}
+	/*-----------------------------------------------------------*/
+
+	/* Give an object back to its pool.  Returns pdFALSE if the object does not
+	belong to this pool, the caller must then free it to the heap. */
+	static BaseType_t prvSocketPoolGive( SocketPool_t *pxPool, void *pvObject, EventGroupHandle_t xEventGroup )
+	{
+	SocketPoolItem_t *pxItem = ( SocketPoolItem_t * ) pvObject;
+	BaseType_t xReturn;
+
+		if( ( ( uint8_t * ) pvObject < pxPool->pucStart ) || ( ( uint8_t * ) pvObject >= pxPool->pucEnd ) )
+		{
+			xReturn = pdFALSE;
+		}
+		else
+		{
+			pxItem->xEventGroup = xEventGroup;
+
+			taskENTER_CRITICAL();
+			{
+				pxItem->pxNext = pxPool->pxFreeList;
+				pxPool->pxFreeList = pxItem;
+				pxPool->xStats.uxInUse--;
+			}
+			taskEXIT_CRITICAL();
+
+			xReturn = pdTRUE;
+		}
+
+		return xReturn;
+	}
+	/*-----------------------------------------------------------*/
+
+	#if( ipconfigUSE_TCP == 1 )
+
+		/* Allocate a stream from the smallest class that is big enough and that
+		still has a free object.  Otherwise fall back to the heap. */
+		static void *prvSocketPoolStreamMalloc( size_t uxSize )
+		{
+		SocketPool_t *pxSmall = &( xSocketPools[ FREERTOS_POOL_SMALL_STREAMS ] );
+		SocketPool_t *pxLarge = &( xSocketPools[ FREERTOS_POOL_LARGE_STREAMS ] );
+		void *pvReturn = NULL;
+
+			if( uxSize <= pxSmall->xStats.uxBlockSize )
+			{
+				pvReturn = prvSocketPoolTake( pxSmall, NULL );
+			}
+
+			if( ( pvReturn == NULL ) && ( uxSize <= pxLarge->xStats.uxBlockSize ) )
+			{
+				pvReturn = prvSocketPoolTake( pxLarge, NULL );
+			}
+
+			if( pvReturn == NULL )
+			{
+				/* Count the heap allocation for the class that should have
+				served it.  Streams that are too big for any class, e.g. grown
+				by auto-tuning, are counted for the large class. */
+				taskENTER_CRITICAL();
+				{
+					if( ( uxSize <= pxSmall->xStats.uxBlockSize ) && ( pxSmall->xStats.uxBlockSize != 0u ) )
+					{
+						pxSmall->xStats.uxHeapCount++;
+					}
+					else
+					{
+						pxLarge->xStats.uxHeapCount++;
+					}
+				}
+				taskEXIT_CRITICAL();
+
+				pvReturn = pvPortMallocLarge( uxSize );
+			}
+
+			return pvReturn;
+		}
+		/*-----------------------------------------------------------*/
+
+		static void prvSocketPoolStreamFree( void *pvStream )
+		{
+			if( ( prvSocketPoolGive( &( xSocketPools[ FREERTOS_POOL_SMALL_STREAMS ] ), pvStream, NULL ) == pdFALSE ) &&
+				( prvSocketPoolGive( &( xSocketPools[ FREERTOS_POOL_LARGE_STREAMS ] ), pvStream, NULL ) == pdFALSE ) )
+			{
+				vPortFreeLarge( pvStream );
+			}
+		}
+		/*-----------------------------------------------------------*/
+
+	#endif /* ipconfigUSE_TCP */
+
+	void FreeRTOS_GetSocketPoolStats( SocketPoolStats_t pxStats[ FREERTOS_POOL_COUNT ] )
+	{
+	BaseType_t xIndex;
+
+		taskENTER_CRITICAL();
+		{
+			for( xIndex = 0; xIndex < FREERTOS_POOL_COUNT; xIndex++ )
+			{
+				pxStats[ xIndex ] = xSocketPools[ xIndex ].xStats;
+			}
+		}
+		taskEXIT_CRITICAL();
+	}
+	/*-----------------------------------------------------------*/
+
+#endif /* ipconfigUSE_SOCKET_POOL */
+
 static BaseType_t prvDetermineSocketSize( BaseType_t xDomain, BaseType_t xType, BaseType_t xProtocol, size_t *pxSocketSize )
 {
 BaseType_t xReturn = pdPASS;
@@ -324,7 +689,7 @@ Socket_t FreeRTOS_socket( BaseType_t xDomain, BaseType_t xType, BaseType_t xProt
 {
 FreeRTOS_Socket_t *pxSocket;
 size_t uxSocketSize;
-EventGroupHandle_t xEventGroup;
+EventGroupHandle_t xEventGroup = NULL;
 Socket_t xReturn;
 
 	if( prvDetermineSocketSize( xDomain, xType, xProtocol, &uxSocketSize ) == pdFAIL )
@@ -337,16 +702,42 @@ Socket_t xReturn;
 		size depends on the type of socket: UDP sockets need less space.  A
 		define 'pvPortMallocSocket' will used to allocate the necessary space.
 		By default it points to the FreeRTOS function 'pvPortMalloc()'. */
-		pxSocket = ( FreeRTOS_Socket_t * ) pvPortMallocSocket( uxSocketSize );
+		#if( ipconfigUSE_SOCKET_POOL == 1 )
+		{
+			/* Try the pool first, a recycled socket comes with its event
+			group. */
+			pxSocket = ( FreeRTOS_Socket_t * ) prvSocketPoolTake( &( xSocketPools[ FREERTOS_POOL_SOCKETS ] ), &xEventGroup );
+
+			if( pxSocket == NULL )
+			{
+				taskENTER_CRITICAL();
+				{
+					xSocketPools[ FREERTOS_POOL_SOCKETS ].xStats.uxHeapCount++;
+				}
+				taskEXIT_CRITICAL();
+
+				pxSocket = ( FreeRTOS_Socket_t * ) pvPortMallocSocket( uxSocketSize );
+			}
+		}
+		#else
+		{
+			pxSocket = ( FreeRTOS_Socket_t * ) pvPortMallocSocket( uxSocketSize );
+		}
+		#endif /* ipconfigUSE_SOCKET_POOL */
 
 		if( pxSocket == NULL )
 		{
 			pxSocket = ( FreeRTOS_Socket_t * ) FREERTOS_INVALID_SOCKET;
 			iptraceFAILED_TO_CREATE_SOCKET();
 		}
-		else if( ( xEventGroup = xEventGroupCreate() ) == NULL )
+		else if( ( xEventGroup == NULL ) && ( ( xEventGroup = xEventGroupCreate() ) == NULL ) )
 		{
-			vPortFreeSocket( pxSocket );
+			#if( ipconfigUSE_SOCKET_POOL == 1 )
+			if( prvSocketPoolGive( &( xSocketPools[ FREERTOS_POOL_SOCKETS ] ), pxSocket, NULL ) == pdFALSE )
+			#endif
+			{
+				vPortFreeSocket( pxSocket );
+			}
 			pxSocket = ( FreeRTOS_Socket_t * ) FREERTOS_INVALID_SOCKET;
 			iptraceFAILED_TO_CREATE_EVENT_GROUP();
 		}
@@ -357,6 +748,13 @@ Socket_t xReturn;
 
 			pxSocket->xEventGroup = xEventGroup;
 
+			#if( ipconfigUSE_SOCKET_POOL == 1 )
+			{
+				/* The event group may have been used by a previous socket. */
+				xEventGroupClearBits( xEventGroup, ( EventBits_t ) ( ( configUSE_16_BIT_TICKS != 0 ) ? 0x00ffu : 0x00ffffffUL ) );
+			}
+			#endif
+
 			/* Initialise the socket's members.  The semaphore will be created
 			if the socket is bound to an address, for now the pointer to the
 			semaphore is just set to NULL to show it has not been created. */
@@ -393,6 +791,8 @@ Socket_t xReturn;
 					{
 						pxSocket->u.xTCP.uxRxWinSize  = FreeRTOS_max_uint32( 1UL, ( uint32_t ) ( pxSocket->u.xTCP.uxRxStreamSize / 2 ) / ipconfigTCP_MSS );
 						pxSocket->u.xTCP.uxTxWinSize  = FreeRTOS_max_uint32( 1UL, ( uint32_t ) ( pxSocket->u.xTCP.uxTxStreamSize / 2 ) / ipconfigTCP_MSS );
+						pxSocket->u.xTCP.ucAckPolicy  = ( uint8_t ) ipconfigTCP_ACK_POLICY;
+						pxSocket->u.xTCP.ucAckSegments = ( uint8_t ) ipconfigTCP_ACK_EVERY_N_SEGMENTS;
 					}
 					#else
 					{
@@ -400,6 +800,17 @@ Socket_t xReturn;
 						pxSocket->u.xTCP.uxTxWinSize  = 1u;
 					}
 					#endif
+					#if( ipconfigUSE_TCP_CONGESTION_CONTROL == 1 )
+					{
+						pxSocket->u.xTCP.ucCongestionControl = ( uint8_t ) ipconfigTCP_CONGESTION_CONTROL_DEFAULT;
+					}
+					#endif
+					#if( ipconfigTCP_RX_AUTOTUNE == 1 )
+					{
+						pxSocket->u.xTCP.uxRxBaseSize = pxSocket->u.xTCP.uxRxStreamSize;
+						pxSocket->u.xTCP.bits.bRxAutoTune = pdTRUE_UNSIGNED;
+					}
+					#endif
 					/* The above values are just defaults, and can be overridden by
 					calling FreeRTOS_setsockopt().  No buffers will be allocated until a
 					socket is connected and data is exchanged. */
@@ -642,33 +1053,16 @@ Socket_t xReturn;
 #endif /* ipconfigSUPPORT_SELECT_FUNCTION == 1 */
 /*-----------------------------------------------------------*/
 
-/*
- * FreeRTOS_recvfrom: receive data from a bound socket
- * In this library, the function can only be used with connectionsless sockets
- * (UDP)
- */
-int32_t FreeRTOS_recvfrom( Socket_t xSocket, void *pvBuffer, size_t xBufferLength, BaseType_t xFlags, struct freertos_sockaddr *pxSourceAddress, socklen_t *pxSourceAddressLength )
+static BaseType_t prvUDPWaitForPacket( FreeRTOS_Socket_t *pxSocket, BaseType_t xFlags, EventBits_t *pxEventBits )
 {
-BaseType_t lPacketCount = 0;
-NetworkBufferDescriptor_t *pxNetworkBuffer;
-FreeRTOS_Socket_t *pxSocket = ( FreeRTOS_Socket_t * ) xSocket;
+BaseType_t lPacketCount;
 TickType_t xRemainingTime = ( TickType_t ) 0; /* Obsolete assignment, but some compilers output a warning if its not done. */
 BaseType_t xTimed = pdFALSE;
 TimeOut_t xTimeOut;
-int32_t lReturn;
 EventBits_t xEventBits = ( EventBits_t ) 0;
 
-	if( prvValidSocket( pxSocket, FREERTOS_IPPROTO_UDP, pdTRUE ) == pdFALSE )
-	{
-		return -pdFREERTOS_ERRNO_EINVAL;
-	}
-
 	lPacketCount = ( BaseType_t ) listCURRENT_LIST_LENGTH( &( pxSocket->u.xUDP.xWaitingPacketsList ) );
 
-	/* The function prototype is designed to maintain the expected Berkeley
-	sockets standard, but this implementation does not use all the parameters. */
-	( void ) pxSourceAddressLength;
-
 	while( lPacketCount == 0 )
 	{
 		if( xTimed == pdFALSE )
@@ -739,6 +1133,36 @@ EventBits_t xEventBits = ( EventBits_t ) 0;
 		}
 	} /* while( lPacketCount == 0 ) */
 
+	*pxEventBits = xEventBits;
+
+	return lPacketCount;
+}
+/*-----------------------------------------------------------*/
+
+/*
+ * FreeRTOS_recvfrom: receive data from a bound socket
+ * In this library, the function can only be used with connectionsless sockets
+ * (UDP)
+ */
+int32_t FreeRTOS_recvfrom( Socket_t xSocket, void *pvBuffer, size_t xBufferLength, BaseType_t xFlags, struct freertos_sockaddr *pxSourceAddress, socklen_t *pxSourceAddressLength )
+{
+BaseType_t lPacketCount;
+NetworkBufferDescriptor_t *pxNetworkBuffer;
+FreeRTOS_Socket_t *pxSocket = ( FreeRTOS_Socket_t * ) xSocket;
+int32_t lReturn;
+EventBits_t xEventBits;
+
+	if( prvValidSocket( pxSocket, FREERTOS_IPPROTO_UDP, pdTRUE ) == pdFALSE )
+	{
+		return -pdFREERTOS_ERRNO_EINVAL;
+	}
+
+	/* The function prototype is designed to maintain the expected Berkeley
+	sockets standard, but this implementation does not use all the parameters. */
+	( void ) pxSourceAddressLength;
+
+	lPacketCount = prvUDPWaitForPacket( pxSocket, xFlags, &xEventBits );
+
 	if( lPacketCount != 0 )
 	{
 		taskENTER_CRITICAL();
@@ -755,6 +1179,15 @@ EventBits_t xEventBits = ( EventBits_t ) 0;
 		}
 		taskEXIT_CRITICAL();
 
+		#if( ipconfigUSE_LATENCY_HISTOGRAMS == 1 )
+		{
+			if( ( xFlags & FREERTOS_MSG_PEEK ) == 0 )
+			{
+				ipLATENCY_STAGE( pxNetworkBuffer, eLatencyRxSocket );
+			}
+		}
+		#endif /* ipconfigUSE_LATENCY_HISTOGRAMS */
+
 		/* The returned value is the data length, which may have been capped to
 		the receive buffer size. */
 		lReturn = ( int32_t ) pxNetworkBuffer->xDataLength;
@@ -814,7 +1247,6 @@ EventBits_t xEventBits = ( EventBits_t ) 0;
 int32_t FreeRTOS_sendto( Socket_t xSocket, const void *pvBuffer, size_t xTotalDataLength, BaseType_t xFlags, const struct freertos_sockaddr *pxDestinationAddress, socklen_t xDestinationAddressLength )
 {
 NetworkBufferDescriptor_t *pxNetworkBuffer;
-IPStackEvent_t xStackTxEvent = { eStackTxEvent, NULL };
 TimeOut_t xTimeOut;
 TickType_t xTicksToWait;
 int32_t lReturn = 0;
@@ -830,111 +1262,78 @@ FreeRTOS_Socket_t *pxSocket;
 
 	if( xTotalDataLength <= ( size_t ) ipMAX_UDP_PAYLOAD_LENGTH )
 	{
-		/* If the socket is not already bound to an address, bind it now.
-		Passing NULL as the address parameter tells FreeRTOS_bind() to select
-		the address to bind to. */
-		if( ( socketSOCKET_IS_BOUND( pxSocket ) != pdFALSE ) ||
-			( FreeRTOS_bind( xSocket, NULL, 0u ) == 0 ) )
-		{
-			xTicksToWait = pxSocket->xSendBlockTime;
+		xTicksToWait = pxSocket->xSendBlockTime;
 
-			#if( ipconfigUSE_CALLBACKS != 0 )
+		#if( ipconfigUSE_CALLBACKS != 0 )
+		{
+			if( xIsCallingFromIPTask() != pdFALSE )
 			{
-				if( xIsCallingFromIPTask() != pdFALSE )
-				{
-					/* If this send function is called from within a call-back
-					handler it may not block, otherwise chances would be big to
-					get a deadlock: the IP-task waiting for itself. */
-					xTicksToWait = ( TickType_t )0;
-				}
+				/* If this send function is called from within a call-back
+				handler it may not block, otherwise chances would be big to
+				get a deadlock: the IP-task waiting for itself. */
+				xTicksToWait = ( TickType_t )0;
 			}
-			#endif /* ipconfigUSE_CALLBACKS */
+		}
+		#endif /* ipconfigUSE_CALLBACKS */
 
-			if( ( xFlags & FREERTOS_MSG_DONTWAIT ) != 0 )
-			{
-				xTicksToWait = ( TickType_t ) 0;
-			}
+		if( ( xFlags & FREERTOS_MSG_DONTWAIT ) != 0 )
+		{
+			xTicksToWait = ( TickType_t ) 0;
+		}
 
-			if( ( xFlags & FREERTOS_ZERO_COPY ) == 0 )
-			{
-				/* Zero copy is not set, so obtain a network buffer into
-				which the payload will be copied. */
-				vTaskSetTimeOutState( &xTimeOut );
+		if( ( xFlags & FREERTOS_ZERO_COPY ) == 0 )
+		{
+			/* Zero copy is not set, so obtain a network buffer into
+			which the payload will be copied. */
+			vTaskSetTimeOutState( &xTimeOut );
 
-				/* Block until a buffer becomes available, or until a
-				timeout has been reached */
-				pxNetworkBuffer = pxGetNetworkBufferWithDescriptor( xTotalDataLength + sizeof( UDPPacket_t ), xTicksToWait );
+			/* Block until a buffer becomes available, or until a
+			timeout has been reached */
+			pxNetworkBuffer = pxGetNetworkBufferWithDescriptor( xTotalDataLength + sizeof( UDPPacket_t ), xTicksToWait );
 
-				if( pxNetworkBuffer != NULL )
-				{
-					memcpy( ( void * ) &( pxNetworkBuffer->pucEthernetBuffer[ ipUDP_PAYLOAD_OFFSET_IPv4 ] ), ( void * ) pvBuffer, xTotalDataLength );
+			if( pxNetworkBuffer != NULL )
+			{
+				memcpy( ( void * ) &( pxNetworkBuffer->pucEthernetBuffer[ ipUDP_PAYLOAD_OFFSET_IPv4 ] ), ( void * ) pvBuffer, xTotalDataLength );
 
-					if( xTaskCheckForTimeOut( &xTimeOut, &xTicksToWait ) == pdTRUE )
-					{
-						/* The entire block time has been used up. */
-						xTicksToWait = ( TickType_t ) 0;
-					}
+				if( xTaskCheckForTimeOut( &xTimeOut, &xTicksToWait ) == pdTRUE )
+				{
+					/* The entire block time has been used up. */
+					xTicksToWait = ( TickType_t ) 0;
 				}
 			}
-			else
-			{
-				/* When zero copy is used, pvBuffer is a pointer to the
-				payload of a buffer that has already been obtained from the
-				stack.  Obtain the network buffer pointer from the buffer. */
-				pxNetworkBuffer = pxUDPPayloadBuffer_to_NetworkBuffer( (void*)pvBuffer );
-			}
-
-			if( pxNetworkBuffer != NULL )
-			{
-				pxNetworkBuffer->xDataLength = xTotalDataLength;
-				pxNetworkBuffer->usPort = pxDestinationAddress->sin_port;
-				pxNetworkBuffer->usBoundPort = ( uint16_t ) socketGET_SOCKET_PORT( pxSocket );
-				pxNetworkBuffer->ulIPAddress = pxDestinationAddress->sin_addr;
-
-				/* The socket options are passed to the IP layer in the
-				space that will eventually get used by the Ethernet header. */
-				pxNetworkBuffer->pucEthernetBuffer[ ipSOCKET_OPTIONS_OFFSET ] = pxSocket->ucSocketOptions;
+		}
+		else
+		{
+			/* When zero copy is used, pvBuffer is a pointer to the
+			payload of a buffer that has already been obtained from the
+			stack.  Obtain the network buffer pointer from the buffer. */
+			pxNetworkBuffer = pxUDPPayloadBuffer_to_NetworkBuffer( (void*)pvBuffer );
+		}
 
-				/* Tell the networking task that the packet needs sending. */
-				xStackTxEvent.pvData = pxNetworkBuffer;
+		if( pxNetworkBuffer != NULL )
+		{
+			pxNetworkBuffer->xDataLength = xTotalDataLength;
 
-				/* Ask the IP-task to send this packet */
-				if( xSendEventStructToIPTask( &xStackTxEvent, xTicksToWait ) == pdPASS )
-				{
-					/* The packet was successfully sent to the IP task. */
-					lReturn = ( int32_t ) xTotalDataLength;
-					#if( ipconfigUSE_CALLBACKS == 1 )
-					{
-						if( ipconfigIS_VALID_PROG_ADDRESS( pxSocket->u.xUDP.pxHandleSent ) )
-						{
-							pxSocket->u.xUDP.pxHandleSent( (Socket_t *)pxSocket, xTotalDataLength );
-						}
-					}
-					#endif /* ipconfigUSE_CALLBACKS */
-				}
-				else
-				{
-					/* If the buffer was allocated in this function, release
-					it. */
-					if( ( xFlags & FREERTOS_ZERO_COPY ) == 0 )
-					{
-						vReleaseNetworkBufferAndDescriptor( pxNetworkBuffer );
-					}
-					iptraceSTACK_TX_EVENT_LOST( ipSTACK_TX_EVENT );
-				}
+			if( ( prvUDPPrepareBuffer( pxSocket, pxNetworkBuffer, pxDestinationAddress ) != pdFAIL ) &&
+				( prvUDPSendToIPTask( eStackTxEvent, pxNetworkBuffer, xTicksToWait ) != pdFAIL ) )
+			{
+				/* The packet was successfully sent to the IP task. */
+				lReturn = ( int32_t ) xTotalDataLength;
+				prvUDPHandleSent( pxSocket, xTotalDataLength );
 			}
-			else
+			else if( ( xFlags & FREERTOS_ZERO_COPY ) == 0 )
 			{
-				/* If errno was available, errno would be set to
-				FREERTOS_ENOPKTS.  As it is, the function must return the
-				number of transmitted bytes, so the calling function knows
-				how	much data was actually sent. */
-				iptraceNO_BUFFER_FOR_SENDTO();
+				/* The buffer was allocated in this function, release it. */
+				vReleaseNetworkBufferAndDescriptor( pxNetworkBuffer );
 			}
 		}
 		else
 		{
-			iptraceSENDTO_SOCKET_NOT_BOUND();
+			/* If errno was available, errno would be set to
+			FREERTOS_ENOPKTS.  As it is, the function must return the
+			number of transmitted bytes, so the calling function knows
+			how	much data was actually sent. */
+			iptraceNO_BUFFER_FOR_SENDTO();
 		}
 	}
 	else
@@ -947,6 +1346,72 @@ FreeRTOS_Socket_t *pxSocket;
 } /* Tested */
 /*-----------------------------------------------------------*/
 
+static BaseType_t prvUDPPrepareBuffer( FreeRTOS_Socket_t *pxSocket, NetworkBufferDescriptor_t *pxNetworkBuffer, const struct freertos_sockaddr *pxDestinationAddress )
+{
+BaseType_t xResult = pdPASS;
+
+	/* If the socket is not already bound to an address, bind it now.
+	Passing NULL as the address parameter tells FreeRTOS_bind() to select
+	the address to bind to. */
+	if( ( socketSOCKET_IS_BOUND( pxSocket ) == pdFALSE ) &&
+		( FreeRTOS_bind( ( Socket_t ) pxSocket, NULL, 0u ) != 0 ) )
+	{
+		iptraceSENDTO_SOCKET_NOT_BOUND();
+		xResult = pdFAIL;
+	}
+	else
+	{
+		pxNetworkBuffer->usPort = pxDestinationAddress->sin_port;
+		pxNetworkBuffer->usBoundPort = ( uint16_t ) socketGET_SOCKET_PORT( pxSocket );
+		pxNetworkBuffer->ulIPAddress = pxDestinationAddress->sin_addr;
+
+		/* The socket options are passed to the IP layer in the
+		space that will eventually get used by the Ethernet header. */
+		pxNetworkBuffer->pucEthernetBuffer[ ipSOCKET_OPTIONS_OFFSET ] = pxSocket->ucSocketOptions;
+		ipLATENCY_STAMP( pxNetworkBuffer );
+	}
+
+	return xResult;
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvUDPSendToIPTask( eIPEvent_t eEventType, NetworkBufferDescriptor_t *pxFirstBuffer, TickType_t xTicksToWait )
+{
+IPStackEvent_t xStackTxEvent;
+BaseType_t xResult;
+
+	/* Tell the networking task that the packets need sending. */
+	xStackTxEvent.eEventType = eEventType;
+	xStackTxEvent.pvData = pxFirstBuffer;
+	xResult = xSendEventStructToIPTask( &xStackTxEvent, xTicksToWait );
+
+	if( xResult == pdFAIL )
+	{
+		iptraceSTACK_TX_EVENT_LOST( eEventType );
+	}
+
+	return xResult;
+}
+/*-----------------------------------------------------------*/
+
+static void prvUDPHandleSent( FreeRTOS_Socket_t *pxSocket, size_t uxLength )
+{
+	#if( ipconfigUSE_CALLBACKS == 1 )
+	{
+		if( ipconfigIS_VALID_PROG_ADDRESS( pxSocket->u.xUDP.pxHandleSent ) )
+		{
+			pxSocket->u.xUDP.pxHandleSent( ( Socket_t * ) pxSocket, uxLength );
+		}
+	}
+	#else
+	{
+		( void ) pxSocket;
+		( void ) uxLength;
+	}
+	#endif /* ipconfigUSE_CALLBACKS */
+}
+/*-----------------------------------------------------------*/
+
 /*
  * FreeRTOS_bind() : binds a sockt to a local port number.  If port 0 is
  * provided, a system provided port number will be assigned.  This function can
@@ -1193,12 +1658,24 @@ xCloseEvent.pvData = ( void * ) xSocket;
 void *vSocketClose( FreeRTOS_Socket_t *pxSocket )
 {
 NetworkBufferDescriptor_t *pxNetworkBuffer;
+#if( ipconfigUSE_TCP_SYN_CACHE == 1 )
+	FreeRTOS_Socket_t *pxUnaccepted = NULL;
+	FreeRTOS_Socket_t *pxChild;
+#endif
 
 	#if( ipconfigUSE_TCP == 1 )
 	{
 		/* For TCP: clean up a little more. */
 		if( pxSocket->ucProtocol == ( uint8_t ) FREERTOS_IPPROTO_TCP )
 		{
+			#if( ipconfigUSE_TCP_TIME_WAIT == 1 )
+			{
+				/* A connection that was closed by this side may still get a
+				repeated FIN from the peer. */
+				vTCPTimeWaitAdd( pxSocket );
+			}
+			#endif /* ipconfigUSE_TCP_TIME_WAIT */
+
 			#if( ipconfigUSE_TCP_WIN == 1 )
 			{
 				if( pxSocket->u.xTCP.pxAckMessage != NULL )
@@ -1213,13 +1690,36 @@ NetworkBufferDescriptor_t *pxNetworkBuffer;
 			/* Free the input and output streams */
 			if( pxSocket->u.xTCP.rxStream != NULL )
 			{
-				vPortFreeLarge( pxSocket->u.xTCP.rxStream );
+				socketSTREAM_FREE( pxSocket->u.xTCP.rxStream );
+			}
+
+			#if( ipconfigTCP_RX_AUTOTUNE == 1 )
+			{
+				uxRxAutoTuneTotal -= pxSocket->u.xTCP.uxRxStreamSize - pxSocket->u.xTCP.uxRxBaseSize;
 			}
+			#endif
 
 			if( pxSocket->u.xTCP.txStream != NULL )
 			{
-				vPortFreeLarge( pxSocket->u.xTCP.txStream );
+				socketSTREAM_FREE( pxSocket->u.xTCP.txStream );
+			}
+
+			#if( ipconfigUSE_TCP_SYN_CACHE == 1 )
+			{
+				if( pxSocket->u.xTCP.ucTCPState == eTCP_LISTEN )
+				{
+					/* Take the connections that were never accepted, they
+					are closed below, after this socket has been unbound. */
+					vTaskSuspendAll();
+					{
+						pxUnaccepted = pxSocket->u.xTCP.pxAcceptHead;
+						pxSocket->u.xTCP.pxAcceptHead = NULL;
+						pxSocket->u.xTCP.pxAcceptTail = NULL;
+					}
+					xTaskResumeAll();
+				}
 			}
+			#endif /* ipconfigUSE_TCP_SYN_CACHE */
 
 			/* In case this is a child socket, make sure the child-count of the
 			parent socket is decreased. */
@@ -1250,6 +1750,25 @@ NetworkBufferDescriptor_t *pxNetworkBuffer;
 		#endif /* ipconfigETHERNET_DRIVER_FILTERS_PACKETS */
 	}
 
+	#if( ipconfigUSE_TCP_SYN_CACHE == 1 )
+	{
+		/* Connections that were never accepted are closed along with their
+		listening socket.  This runs in the IP-task, so they are closed
+		directly: a close event could only be posted without blocking, and
+		would be lost when the event queue is full.  The listening socket has
+		left the bound list, so prvTCPSetSocketCount() does not find it for
+		these children. */
+		while( pxUnaccepted != NULL )
+		{
+			pxChild = pxUnaccepted;
+			pxUnaccepted = pxChild->u.xTCP.pxAcceptNext;
+			pxChild->u.xTCP.pxAcceptNext = NULL;
+			pxChild->u.xTCP.bits.bPassAccept = pdFALSE_UNSIGNED;
+			( void ) vSocketClose( pxChild );
+		}
+	}
+	#endif /* ipconfigUSE_TCP_SYN_CACHE */
+
 	/* Now the socket is not bound the list of waiting packets can be
 	drained. */
 	if( pxSocket->ucProtocol == ( uint8_t ) FREERTOS_IPPROTO_UDP )
@@ -1262,7 +1781,14 @@ NetworkBufferDescriptor_t *pxNetworkBuffer;
 		}
 	}
 
+	#if( ipconfigUSE_SOCKET_POOL == 1 )
+	/* A socket from the pool keeps its event group for the next user. */
+	if( ( pxSocket->xEventGroup != NULL ) &&
+		( ( ( uint8_t * ) pxSocket < xSocketPools[ FREERTOS_POOL_SOCKETS ].pucStart ) ||
+		  ( ( uint8_t * ) pxSocket >= xSocketPools[ FREERTOS_POOL_SOCKETS ].pucEnd ) ) )
+	#else
 	if( pxSocket->xEventGroup )
+	#endif
 	{
 		vEventGroupDelete( pxSocket->xEventGroup );
 	}
@@ -1282,13 +1808,58 @@ NetworkBufferDescriptor_t *pxNetworkBuffer;
 	#endif /* ( ipconfigUSE_TCP == 1 ) && ( ipconfigHAS_DEBUG_PRINTF != 0 ) */
 
 	/* Anf finally, after all resources have been freed, free the socket space */
-	vPortFreeSocket( pxSocket );
+	#if( ipconfigUSE_SOCKET_POOL == 1 )
+	if( prvSocketPoolGive( &( xSocketPools[ FREERTOS_POOL_SOCKETS ] ), pxSocket, pxSocket->xEventGroup ) == pdFALSE )
+	#endif
+	{
+		vPortFreeSocket( pxSocket );
+	}
 
 	return 0;
 } /* Tested */
 
 /*-----------------------------------------------------------*/
 
+#if( ipconfigUSE_TCP_SYN_CACHE == 1 )
+
+	static void prvTCPAcceptQueueRemove( FreeRTOS_Socket_t *pxParent, FreeRTOS_Socket_t *pxChild )
+	{
+	FreeRTOS_Socket_t *pxPrevious = NULL;
+	FreeRTOS_Socket_t *pxIterator;
+
+		vTaskSuspendAll();
+		{
+			for( pxIterator = pxParent->u.xTCP.pxAcceptHead;
+				 ( pxIterator != NULL ) && ( pxIterator != pxChild );
+				 pxIterator = pxIterator->u.xTCP.pxAcceptNext )
+			{
+				pxPrevious = pxIterator;
+			}
+
+			if( pxIterator != NULL )
+			{
+				if( pxPrevious == NULL )
+				{
+					pxParent->u.xTCP.pxAcceptHead = pxChild->u.xTCP.pxAcceptNext;
+				}
+				else
+				{
+					pxPrevious->u.xTCP.pxAcceptNext = pxChild->u.xTCP.pxAcceptNext;
+				}
+
+				if( pxParent->u.xTCP.pxAcceptTail == pxChild )
+				{
+					pxParent->u.xTCP.pxAcceptTail = pxPrevious;
+				}
+				pxChild->u.xTCP.pxAcceptNext = NULL;
+			}
+		}
+		xTaskResumeAll();
+	}
+
+#endif /* ipconfigUSE_TCP_SYN_CACHE */
+/*-----------------------------------------------------------*/
+
 #if ipconfigUSE_TCP == 1
 
 	/*
@@ -1313,6 +1884,14 @@ NetworkBufferDescriptor_t *pxNetworkBuffer;
 				( pxOtherSocket->u.xTCP.usChildCount ) )
 			{
 				pxOtherSocket->u.xTCP.usChildCount--;
+
+				#if( ipconfigUSE_TCP_SYN_CACHE == 1 )
+				{
+					/* A child that was never accepted leaves the accept queue. */
+					prvTCPAcceptQueueRemove( pxOtherSocket, pxSocketToDelete );
+				}
+				#endif /* ipconfigUSE_TCP_SYN_CACHE */
+
 				FreeRTOS_debug_printf( ( "Lost: Socket %u now has %u / %u child%s\n",
 					pxOtherSocket->usLocalPort,
 					pxOtherSocket->u.xTCP.usChildCount,
@@ -1501,6 +2080,12 @@ FreeRTOS_Socket_t *pxSocket;
 					}
 					else
 					{
+						#if( ipconfigTCP_RX_AUTOTUNE == 1 )
+						{
+							prvTCPRxAutoTuneStop( pxSocket );
+							pxSocket->u.xTCP.uxRxBaseSize = ulNewValue;
+						}
+						#endif
 						pxSocket->u.xTCP.uxRxStreamSize = ulNewValue;
 					}
 				}
@@ -1587,6 +2172,7 @@ FreeRTOS_Socket_t *pxSocket;
 				xReturn = 0;
 				break;
 
+			case FREERTOS_SO_TCP_CORK:			/* Hold data until a full MSS or an uncork */
 			case FREERTOS_SO_SET_FULL_SIZE:		/* Refuse to send packets smaller than MSS  */
 				{
 					if( pxSocket->ucProtocol != ( uint8_t ) FREERTOS_IPPROTO_TCP )
@@ -1594,12 +2180,16 @@ FreeRTOS_Socket_t *pxSocket;
 						break;	/* will return -pdFREERTOS_ERRNO_EINVAL */
 					}
 
+					/* The socket remembers the setting, the window is created
+					when the connection is made. */
 					if( *( ( BaseType_t * ) pvOptionValue ) != 0 )
 					{
+						pxSocket->u.xTCP.bits.bCork = pdTRUE_UNSIGNED;
 						pxSocket->u.xTCP.xTCPWindow.u.bits.bSendFullSize = pdTRUE_UNSIGNED;
 					}
 					else
 					{
+						pxSocket->u.xTCP.bits.bCork = pdFALSE_UNSIGNED;
 						pxSocket->u.xTCP.xTCPWindow.u.bits.bSendFullSize = pdFALSE_UNSIGNED;
 					}
 
@@ -1614,6 +2204,35 @@ FreeRTOS_Socket_t *pxSocket;
 				xReturn = 0;
 				break;
 
+			case FREERTOS_SO_TCP_NODELAY:	/* Send small segments immediately or use Nagle */
+				{
+					if( pxSocket->ucProtocol != ( uint8_t ) FREERTOS_IPPROTO_TCP )
+					{
+						break;	/* will return -pdFREERTOS_ERRNO_EINVAL */
+					}
+
+					if( *( ( BaseType_t * ) pvOptionValue ) != 0 )
+					{
+						pxSocket->u.xTCP.bits.bNagle = pdFALSE_UNSIGNED;
+						pxSocket->u.xTCP.xTCPWindow.u.bits.bNagle = pdFALSE_UNSIGNED;
+
+						/* Data held by the Nagle algorithm may go out now. */
+						if( ( pxSocket->u.xTCP.ucTCPState >= eESTABLISHED ) &&
+							( FreeRTOS_outstanding( pxSocket ) != 0 ) )
+						{
+							pxSocket->u.xTCP.usTimeout = 1u;
+							xSendEventToIPTask( eTCPTimerEvent );
+						}
+					}
+					else
+					{
+						pxSocket->u.xTCP.bits.bNagle = pdTRUE_UNSIGNED;
+						pxSocket->u.xTCP.xTCPWindow.u.bits.bNagle = pdTRUE_UNSIGNED;
+					}
+				}
+				xReturn = 0;
+				break;
+
 			case FREERTOS_SO_STOP_RX:		/* Refuse to receive more packts */
 				{
 					if( pxSocket->ucProtocol != ( uint8_t ) FREERTOS_IPPROTO_TCP )
@@ -1637,6 +2256,63 @@ FreeRTOS_Socket_t *pxSocket;
 				xReturn = 0;
 				break;
 
+			#if( ipconfigUSE_TCP_WIN == 1 )
+				case FREERTOS_SO_TCP_ACK_POLICY:	/* Delayed, quick or adaptive ACK's */
+					{
+					BaseType_t xPolicy = *( ( BaseType_t * ) pvOptionValue );
+
+						if( ( pxSocket->ucProtocol != ( uint8_t ) FREERTOS_IPPROTO_TCP ) ||
+							( xPolicy < FREERTOS_TCP_ACK_DELAYED ) || ( xPolicy > FREERTOS_TCP_ACK_ADAPTIVE ) )
+						{
+							break;	/* will return -pdFREERTOS_ERRNO_EINVAL */
+						}
+
+						pxSocket->u.xTCP.ucAckPolicy = ( uint8_t ) xPolicy;
+					}
+					xReturn = 0;
+					break;
+
+				case FREERTOS_SO_TCP_ACK_SEGMENTS:	/* ACK at least every N segments */
+					{
+					BaseType_t xCount = *( ( BaseType_t * ) pvOptionValue );
+
+						if( ( pxSocket->ucProtocol != ( uint8_t ) FREERTOS_IPPROTO_TCP ) ||
+							( xCount < 0 ) || ( xCount > 0xff ) )
+						{
+							break;	/* will return -pdFREERTOS_ERRNO_EINVAL */
+						}
+
+						pxSocket->u.xTCP.ucAckSegments = ( uint8_t ) xCount;
+					}
+					xReturn = 0;
+					break;
+			#endif /* ipconfigUSE_TCP_WIN */
+
+			#if( ipconfigUSE_TCP_CONGESTION_CONTROL == 1 )
+				case FREERTOS_SO_TCP_CONGESTION:	/* Select NewReno or CUBIC */
+					{
+					BaseType_t xAlgorithm = *( ( BaseType_t * ) pvOptionValue );
+
+						if( ( pxSocket->ucProtocol != ( uint8_t ) FREERTOS_IPPROTO_TCP ) ||
+							( ( xAlgorithm != FREERTOS_TCP_CC_NEWRENO ) && ( xAlgorithm != FREERTOS_TCP_CC_CUBIC ) ) )
+						{
+							break;	/* will return -pdFREERTOS_ERRNO_EINVAL */
+						}
+
+						pxSocket->u.xTCP.ucCongestionControl = ( uint8_t ) xAlgorithm;
+
+						/* A connection which already has a window will be switched
+						by the IP-task, in xTCPSocketCheck(). */
+						if( pxSocket->u.xTCP.xTCPWindow.u.bits.bHasInit != pdFALSE_UNSIGNED )
+						{
+							pxSocket->u.xTCP.usTimeout = 1u;
+							xSendEventToIPTask( eTCPTimerEvent );
+						}
+					}
+					xReturn = 0;
+					break;
+			#endif /* ipconfigUSE_TCP_CONGESTION_CONTROL */
+
 		#endif  /* ipconfigUSE_TCP == 1 */
 
 		default :
@@ -2114,7 +2790,25 @@ void vSocketWakeUpUser( FreeRTOS_Socket_t *pxSocket )
 				{
 					if( pxSocket->u.xTCP.bits.bReuseSocket == pdFALSE_UNSIGNED )
 					{
-						pxClientSocket = pxSocket->u.xTCP.pxPeerSocket;
+						#if( ipconfigUSE_TCP_SYN_CACHE == 1 )
+						{
+							/* Take the oldest connection from the accept queue. */
+							pxClientSocket = pxSocket->u.xTCP.pxAcceptHead;
+							if( pxClientSocket != NULL )
+							{
+								pxSocket->u.xTCP.pxAcceptHead = pxClientSocket->u.xTCP.pxAcceptNext;
+								if( pxSocket->u.xTCP.pxAcceptHead == NULL )
+								{
+									pxSocket->u.xTCP.pxAcceptTail = NULL;
+								}
+								pxClientSocket->u.xTCP.pxAcceptNext = NULL;
+							}
+						}
+						#else
+						{
+							pxClientSocket = pxSocket->u.xTCP.pxPeerSocket;
+						}
+						#endif /* ipconfigUSE_TCP_SYN_CACHE */
 					}
 					else
 					{
@@ -2152,10 +2846,16 @@ void vSocketWakeUpUser( FreeRTOS_Socket_t *pxSocket )
 						*pxAddressLength = sizeof( *pxAddress );
 					}
 
-					if( pxSocket->u.xTCP.bits.bReuseSocket == pdFALSE_UNSIGNED )
+					#if( ipconfigUSE_TCP_SYN_CACHE == 0 )
 					{
-						xAsk = pdTRUE;
+						/* With an accept queue, the next client is found
+						without the help of the IP-task. */
+						if( pxSocket->u.xTCP.bits.bReuseSocket == pdFALSE_UNSIGNED )
+						{
+							xAsk = pdTRUE;
+						}
 					}
+					#endif /* ipconfigUSE_TCP_SYN_CACHE */
 				}
 
 				if( xAsk != pdFALSE )
@@ -2212,8 +2912,23 @@ void vSocketWakeUpUser( FreeRTOS_Socket_t *pxSocket )
 	 */
 	BaseType_t FreeRTOS_recv( Socket_t xSocket, void *pvBuffer, size_t xBufferLength, BaseType_t xFlags )
 	{
+	struct freertos_iovec xIOVec;
+
+		/* In case of FREERTOS_ZERO_COPY, pvBuffer is a pointer to a pointer. */
+		xIOVec.iov_base = pvBuffer;
+		xIOVec.iov_len = xBufferLength;
+
+		return prvTCPRecvIOVec( ( FreeRTOS_Socket_t * ) xSocket, &xIOVec, 1u, xFlags );
+	}
+
+#endif /* ipconfigUSE_TCP */
+/*-----------------------------------------------------------*/
+
+#if( ipconfigUSE_TCP == 1 )
+
+	static BaseType_t prvTCPRecvIOVec( FreeRTOS_Socket_t *pxSocket, const struct freertos_iovec *pxIOVec, size_t uxIOVecCount, BaseType_t xFlags )
+	{
 	BaseType_t xByteCount;
-	FreeRTOS_Socket_t *pxSocket = ( FreeRTOS_Socket_t * ) xSocket;
 	TickType_t xRemainingTime;
 	BaseType_t xTimed = pdFALSE;
 	TimeOut_t xTimeOut;
@@ -2227,6 +2942,7 @@ void vSocketWakeUpUser( FreeRTOS_Socket_t *pxSocket )
 		}
 		else
 		{
+			socketRX_STREAM_ENTER();
 			if( pxSocket->u.xTCP.rxStream != NULL )
 			{
 				xByteCount = ( BaseType_t )uxStreamBufferGetSize ( pxSocket->u.xTCP.rxStream );
@@ -2235,6 +2951,7 @@ void vSocketWakeUpUser( FreeRTOS_Socket_t *pxSocket )
 			{
 				xByteCount = 0;
 			}
+			socketRX_STREAM_EXIT();
 
 			while( xByteCount == 0 )
 			{
@@ -2312,6 +3029,7 @@ void vSocketWakeUpUser( FreeRTOS_Socket_t *pxSocket )
 				}
 				#endif /* ipconfigSUPPORT_SIGNALS */
 
+				socketRX_STREAM_ENTER();
 				if( pxSocket->u.xTCP.rxStream != NULL )
 				{
 					xByteCount = ( BaseType_t ) uxStreamBufferGetSize ( pxSocket->u.xTCP.rxStream );
@@ -2320,6 +3038,7 @@ void vSocketWakeUpUser( FreeRTOS_Socket_t *pxSocket )
 				{
 					xByteCount = 0;
 				}
+				socketRX_STREAM_EXIT();
 			}
 
 		#if( ipconfigSUPPORT_SIGNALS != 0 )
@@ -2337,28 +3056,72 @@ void vSocketWakeUpUser( FreeRTOS_Socket_t *pxSocket )
 		#endif /* ipconfigSUPPORT_SIGNALS */
 			if( xByteCount > 0 )
 			{
+			BaseType_t xWinUpdate = pdFALSE;
+
+				socketRX_STREAM_ENTER();
 				if( ( xFlags & FREERTOS_ZERO_COPY ) == 0 )
 				{
-					xByteCount = ( BaseType_t ) uxStreamBufferGet( pxSocket->u.xTCP.rxStream, 0ul, ( uint8_t * ) pvBuffer, ( size_t ) xBufferLength, ( xFlags & FREERTOS_MSG_PEEK ) != 0 );
-					if( pxSocket->u.xTCP.bits.bLowWater != pdFALSE_UNSIGNED )
+				size_t uxIndex;
+				size_t uxCopied = 0u;
+				BaseType_t xPeek = ( ( xFlags & FREERTOS_MSG_PEEK ) != 0 ) ? pdTRUE : pdFALSE;
+
+					/* Fill the fragments in order.  When peeking, the data
+					stays in the stream, so the offset of each next fragment is
+					the number of bytes copied so far. */
+					for( uxIndex = 0u; uxIndex < uxIOVecCount; uxIndex++ )
 					{
-						/* We had reached the low-water mark, now see if the flag
-						can be cleared */
-						size_t uxFrontSpace = uxStreamBufferFrontSpace( pxSocket->u.xTCP.rxStream );
+					size_t uxCount;
 
-						if( uxFrontSpace >= pxSocket->u.xTCP.uxEnoughSpace )
+						if( pxIOVec[ uxIndex ].iov_len == 0u )
 						{
-							pxSocket->u.xTCP.bits.bLowWater = pdFALSE_UNSIGNED;
-							pxSocket->u.xTCP.bits.bWinChange = pdTRUE_UNSIGNED;
-							pxSocket->u.xTCP.usTimeout = 1u; /* because bLowWater is cleared. */
-							xSendEventToIPTask( eTCPTimerEvent );
+							continue;
+						}
+
+						uxCount = uxStreamBufferGet( pxSocket->u.xTCP.rxStream, ( xPeek != pdFALSE ) ? uxCopied : 0ul,
+							( uint8_t * ) pxIOVec[ uxIndex ].iov_base, pxIOVec[ uxIndex ].iov_len, xPeek );
+						uxCopied += uxCount;
+
+						if( uxCount < pxIOVec[ uxIndex ].iov_len )
+						{
+							/* The stream has been emptied. */
+							break;
+						}
+					}
+					xByteCount = ( BaseType_t ) uxCopied;
+
+					#if( ipconfigUSE_LATENCY_HISTOGRAMS == 1 )
+					{
+						if( ( xPeek == pdFALSE ) && ( uxCopied != 0u ) )
+						{
+							/* Measured for the oldest byte that was read, the
+							bytes that are left over are timed from now. */
+							vLatencyRecord( eLatencyRxSocket, pxSocket->u.xTCP.ulRxLatencyStamp );
+							pxSocket->u.xTCP.ulRxLatencyStamp = ipLATENCY_TIME();
 						}
 					}
+					#endif /* ipconfigUSE_LATENCY_HISTOGRAMS */
+
+					xWinUpdate = prvTCPRxLowWaterCheck( pxSocket );
 				}
 				else
 				{
-					/* Zero-copy reception of data: pvBuffer is a pointer to a pointer. */
-					xByteCount = ( BaseType_t ) uxStreamBufferGetPtr( pxSocket->u.xTCP.rxStream, (uint8_t **)pvBuffer );
+					/* Zero-copy reception of data: iov_base is a pointer to a pointer. */
+					xByteCount = ( BaseType_t ) uxStreamBufferGetPtr( pxSocket->u.xTCP.rxStream, (uint8_t **)pxIOVec[ 0 ].iov_base );
+
+					#if( ipconfigTCP_RX_AUTOTUNE == 1 )
+					{
+						/* The application holds a pointer into rxStream, which
+						may not be moved any more. */
+						pxSocket->u.xTCP.bits.bRxAutoTune = pdFALSE_UNSIGNED;
+					}
+					#endif
+				}
+				socketRX_STREAM_EXIT();
+
+				/* Not sent while rxStream was locked, sending may block. */
+				if( xWinUpdate != pdFALSE )
+				{
+					xSendEventToIPTask( eTCPTimerEvent );
 				}
 			}
 		} /* prvValidSocket() */
@@ -2369,6 +3132,33 @@ void vSocketWakeUpUser( FreeRTOS_Socket_t *pxSocket )
 #endif /* ipconfigUSE_TCP */
 /*-----------------------------------------------------------*/
 
+#if( ipconfigUSE_TCP == 1 )
+
+	static BaseType_t prvTCPRxLowWaterCheck( FreeRTOS_Socket_t *pxSocket )
+	{
+	BaseType_t xWinUpdate = pdFALSE;
+
+		if( pxSocket->u.xTCP.bits.bLowWater != pdFALSE_UNSIGNED )
+		{
+			/* We had reached the low-water mark, now see if the flag
+			can be cleared */
+			size_t uxFrontSpace = uxStreamBufferFrontSpace( pxSocket->u.xTCP.rxStream );
+
+			if( uxFrontSpace >= pxSocket->u.xTCP.uxEnoughSpace )
+			{
+				pxSocket->u.xTCP.bits.bLowWater = pdFALSE_UNSIGNED;
+				pxSocket->u.xTCP.bits.bWinChange = pdTRUE_UNSIGNED;
+				pxSocket->u.xTCP.usTimeout = 1u; /* because bLowWater is cleared. */
+				xWinUpdate = pdTRUE;
+			}
+		}
+
+		return xWinUpdate;
+	}
+
+#endif /* ipconfigUSE_TCP */
+/*-----------------------------------------------------------*/
+
 #if( ipconfigUSE_TCP == 1 )
 
 	static int32_t prvTCPSendCheck( FreeRTOS_Socket_t *pxSocket, size_t xDataLength )
@@ -2426,14 +3216,14 @@ void vSocketWakeUpUser( FreeRTOS_Socket_t *pxSocket )
 	uint8_t *pucReturn;
 	FreeRTOS_Socket_t *pxSocket = ( FreeRTOS_Socket_t * ) xSocket;
 	StreamBuffer_t *pxBuffer = pxSocket->u.xTCP.txStream;
+	StreamBufferSpan_t xSpans[ 2 ];
 
 		if( pxBuffer != NULL )
 		{
-		BaseType_t xSpace = ( BaseType_t ) uxStreamBufferGetSpace( pxBuffer );
-		BaseType_t xRemain = ( BaseType_t ) ( pxBuffer->LENGTH - pxBuffer->uxHead );
-
-			*pxLength = FreeRTOS_min_BaseType( xSpace, xRemain );
-			pucReturn = pxBuffer->ucArray + pxBuffer->uxHead;
+			/* Only the part up to the end of the circular buffer. */
+			( void ) uxStreamBufferGetWriteSpans( pxBuffer, 0u, xSpans );
+			*pxLength = ( BaseType_t ) xSpans[ 0 ].uxLength;
+			pucReturn = xSpans[ 0 ].pucData;
 		}
 		else
 		{
@@ -2447,33 +3237,180 @@ void vSocketWakeUpUser( FreeRTOS_Socket_t *pxSocket )
 /*-----------------------------------------------------------*/
 
 #if( ipconfigUSE_TCP == 1 )
-	/*
-	 * Send data using a TCP socket.  It is not necessary to have the socket
-	 * connected already.  Outgoing data will be stored and delivered as soon as
-	 * the socket gets connected.
-	 */
-	BaseType_t FreeRTOS_send( Socket_t xSocket, const void *pvBuffer, size_t uxDataLength, BaseType_t xFlags )
+
+	BaseType_t FreeRTOS_get_tx_spans( Socket_t xSocket, StreamBufferSpan_t *pxSpans )
 	{
-	BaseType_t xByteCount;
-	BaseType_t xBytesLeft;
 	FreeRTOS_Socket_t *pxSocket = ( FreeRTOS_Socket_t * ) xSocket;
-	TickType_t xRemainingTime;
-	BaseType_t xTimed = pdFALSE;
-	TimeOut_t xTimeOut;
-	BaseType_t xCloseAfterSend;
-
-		/* Prevent compiler warnings about unused parameters.  The parameter
-		may be used in future versions. */
-		( void ) xFlags;
+	BaseType_t xResult;
 
-		xByteCount = ( BaseType_t ) prvTCPSendCheck( pxSocket, uxDataLength );
+		/* Checks the socket and creates txStream when necessary. */
+		xResult = ( BaseType_t ) prvTCPSendCheck( pxSocket, 1u );
 
-		if( xByteCount > 0 )
+		if( xResult > 0 )
 		{
-			/* xBytesLeft is number of bytes to send, will count to zero. */
-			xBytesLeft = ( BaseType_t ) uxDataLength;
-
-			/* xByteCount is number of bytes that can be sent now. */
+			/* Only this task adds data to txStream, the space can only grow
+			until FreeRTOS_tx_commit() is called. */
+			xResult = ( BaseType_t ) uxStreamBufferGetWriteSpans( pxSocket->u.xTCP.txStream, 0u, pxSpans );
+		}
+		else
+		{
+			pxSpans[ 0 ].pucData = NULL;
+			pxSpans[ 0 ].uxLength = 0u;
+			pxSpans[ 1 ].pucData = NULL;
+			pxSpans[ 1 ].uxLength = 0u;
+		}
+
+		return xResult;
+	}
+
+#endif /* ipconfigUSE_TCP */
+/*-----------------------------------------------------------*/
+
+#if( ipconfigUSE_TCP == 1 )
+
+	BaseType_t FreeRTOS_tx_commit( Socket_t xSocket, size_t uxCount )
+	{
+	FreeRTOS_Socket_t *pxSocket = ( FreeRTOS_Socket_t * ) xSocket;
+	BaseType_t xResult;
+
+		xResult = ( BaseType_t ) prvTCPSendCheck( pxSocket, uxCount );
+
+		if( xResult > 0 )
+		{
+			/* The data has been written in place, only advance uxHead. */
+			xResult = ( BaseType_t ) uxStreamBufferCommit( pxSocket->u.xTCP.txStream, uxCount );
+
+			/* Let the IP-task work on this socket. */
+			pxSocket->u.xTCP.usTimeout = 1u;
+
+			if( xIsCallingFromIPTask() == pdFALSE )
+			{
+				xSendEventToIPTask( eTCPTimerEvent );
+			}
+		}
+
+		return xResult;
+	}
+
+#endif /* ipconfigUSE_TCP */
+/*-----------------------------------------------------------*/
+
+#if( ipconfigUSE_TCP == 1 )
+
+	BaseType_t FreeRTOS_get_rx_spans( Socket_t xSocket, StreamBufferSpan_t *pxSpans )
+	{
+	FreeRTOS_Socket_t *pxSocket = ( FreeRTOS_Socket_t * ) xSocket;
+	BaseType_t xResult = 0;
+
+		pxSpans[ 0 ].pucData = NULL;
+		pxSpans[ 0 ].uxLength = 0u;
+		pxSpans[ 1 ].pucData = NULL;
+		pxSpans[ 1 ].uxLength = 0u;
+
+		if( prvValidSocket( pxSocket, FREERTOS_IPPROTO_TCP, pdTRUE ) == pdFALSE )
+		{
+			xResult = -pdFREERTOS_ERRNO_EINVAL;
+		}
+		else
+		{
+			socketRX_STREAM_ENTER();
+			if( pxSocket->u.xTCP.rxStream != NULL )
+			{
+				xResult = ( BaseType_t ) uxStreamBufferGetReadSpans( pxSocket->u.xTCP.rxStream, 0u, pxSpans );
+
+				#if( ipconfigTCP_RX_AUTOTUNE == 1 )
+				{
+					/* The application holds pointers into rxStream, which may
+					not be moved any more. */
+					pxSocket->u.xTCP.bits.bRxAutoTune = pdFALSE_UNSIGNED;
+				}
+				#endif
+			}
+			socketRX_STREAM_EXIT();
+		}
+
+		return xResult;
+	}
+
+#endif /* ipconfigUSE_TCP */
+/*-----------------------------------------------------------*/
+
+#if( ipconfigUSE_TCP == 1 )
+
+	BaseType_t FreeRTOS_rx_consume( Socket_t xSocket, size_t uxCount )
+	{
+	FreeRTOS_Socket_t *pxSocket = ( FreeRTOS_Socket_t * ) xSocket;
+	BaseType_t xResult = 0;
+	BaseType_t xWinUpdate = pdFALSE;
+
+		if( prvValidSocket( pxSocket, FREERTOS_IPPROTO_TCP, pdTRUE ) == pdFALSE )
+		{
+			xResult = -pdFREERTOS_ERRNO_EINVAL;
+		}
+		else
+		{
+			socketRX_STREAM_ENTER();
+			if( pxSocket->u.xTCP.rxStream != NULL )
+			{
+				xResult = ( BaseType_t ) uxStreamBufferConsume( pxSocket->u.xTCP.rxStream, uxCount );
+				xWinUpdate = prvTCPRxLowWaterCheck( pxSocket );
+			}
+			socketRX_STREAM_EXIT();
+
+			/* Not sent while rxStream was locked, sending may block. */
+			if( xWinUpdate != pdFALSE )
+			{
+				xSendEventToIPTask( eTCPTimerEvent );
+			}
+		}
+
+		return xResult;
+	}
+
+#endif /* ipconfigUSE_TCP */
+/*-----------------------------------------------------------*/
+
+#if( ipconfigUSE_TCP == 1 )
+	/*
+	 * Send data using a TCP socket.  It is not necessary to have the socket
+	 * connected already.  Outgoing data will be stored and delivered as soon as
+	 * the socket gets connected.
+	 */
+	BaseType_t FreeRTOS_send( Socket_t xSocket, const void *pvBuffer, size_t uxDataLength, BaseType_t xFlags )
+	{
+	struct freertos_iovec xIOVec;
+
+		xIOVec.iov_base = ( void * ) pvBuffer;
+		xIOVec.iov_len = uxDataLength;
+
+		return prvTCPSendIOVec( ( FreeRTOS_Socket_t * ) xSocket, &xIOVec, 1u, xFlags );
+	}
+
+#endif /* ipconfigUSE_TCP */
+/*-----------------------------------------------------------*/
+
+#if( ipconfigUSE_TCP == 1 )
+
+	static BaseType_t prvTCPSendIOVec( FreeRTOS_Socket_t *pxSocket, const struct freertos_iovec *pxIOVec, size_t uxIOVecCount, BaseType_t xFlags )
+	{
+	BaseType_t xByteCount;
+	BaseType_t xBytesLeft;
+	TickType_t xRemainingTime;
+	BaseType_t xTimed = pdFALSE;
+	TimeOut_t xTimeOut;
+	BaseType_t xCloseAfterSend;
+	size_t uxDataLength = prvIOVecLength( pxIOVec, uxIOVecCount );
+	size_t uxIOVecIndex = 0u;
+	size_t uxIOVecOffset = 0u;
+
+		xByteCount = ( BaseType_t ) prvTCPSendCheck( pxSocket, uxDataLength );
+
+		if( xByteCount > 0 )
+		{
+			/* xBytesLeft is number of bytes to send, will count to zero. */
+			xBytesLeft = ( BaseType_t ) uxDataLength;
+
+			/* xByteCount is number of bytes that can be sent now. */
 			xByteCount = ( BaseType_t ) uxStreamBufferGetSpace( pxSocket->u.xTCP.txStream );
 
 			/* While there are still bytes to be sent. */
@@ -2482,6 +3419,8 @@ void vSocketWakeUpUser( FreeRTOS_Socket_t *pxSocket )
 				/* If txStream has space. */
 				if( xByteCount > 0 )
 				{
+				BaseType_t xCopied = 0;
+
 					/* Don't send more than necessary. */
 					if( xByteCount > xBytesLeft )
 					{
@@ -2515,7 +3454,24 @@ void vSocketWakeUpUser( FreeRTOS_Socket_t *pxSocket )
 						pxSocket->u.xTCP.bits.bCloseRequested = pdTRUE_UNSIGNED;
 					}
 
-					xByteCount = ( BaseType_t ) uxStreamBufferAdd( pxSocket->u.xTCP.txStream, 0ul, ( const uint8_t * ) pvBuffer, ( size_t ) xByteCount );
+					/* Copy xByteCount bytes from the fragments, continuing
+					where the previous round stopped.  Only this task adds data
+					to txStream, so the space can not shrink in the mean time. */
+					while( xCopied < xByteCount )
+					{
+					size_t uxChunk = FreeRTOS_min_uint32( ( uint32_t ) ( pxIOVec[ uxIOVecIndex ].iov_len - uxIOVecOffset ), ( uint32_t ) ( xByteCount - xCopied ) );
+
+						xCopied += ( BaseType_t ) uxStreamBufferAdd( pxSocket->u.xTCP.txStream, 0ul,
+							( ( const uint8_t * ) pxIOVec[ uxIOVecIndex ].iov_base ) + uxIOVecOffset, uxChunk );
+						uxIOVecOffset += uxChunk;
+
+						if( uxIOVecOffset == pxIOVec[ uxIOVecIndex ].iov_len )
+						{
+							uxIOVecIndex++;
+							uxIOVecOffset = 0u;
+						}
+					}
+					xByteCount = xCopied;
 
 					if( xCloseAfterSend != pdFALSE )
 					{
@@ -2542,10 +3498,6 @@ void vSocketWakeUpUser( FreeRTOS_Socket_t *pxSocket )
 					{
 						break;
 					}
-
-					/* As there are still bytes left to be sent, increase the
-					data pointer. */
-					pvBuffer = ( void * ) ( ( ( const uint8_t * ) pvBuffer) + xByteCount );
 				}
 
 				/* Not all bytes have been sent. In case the socket is marked as
@@ -2715,6 +3667,10 @@ void vSocketWakeUpUser( FreeRTOS_Socket_t *pxSocket )
 		{
 			pxSocket->u.xTCP.bits.bUserShutdown = pdTRUE_UNSIGNED;
 
+			/* No more data will follow: a corked socket sends what is left. */
+			pxSocket->u.xTCP.bits.bCork = pdFALSE_UNSIGNED;
+			pxSocket->u.xTCP.xTCPWindow.u.bits.bSendFullSize = pdFALSE_UNSIGNED;
+
 			/* Let the IP-task perform the shutdown of the connection. */
 			pxSocket->u.xTCP.usTimeout = 1u;
 			xSendEventToIPTask( eTCPTimerEvent );
@@ -2760,6 +3716,18 @@ void vSocketWakeUpUser( FreeRTOS_Socket_t *pxSocket )
 			pxSocket = ( FreeRTOS_Socket_t * )listGET_LIST_ITEM_OWNER( pxIterator );
 			pxIterator = ( ListItem_t * ) listGET_NEXT( pxIterator );
 
+			#if( ipconfigTCP_RX_AUTOTUNE == 1 )
+			{
+				/* A socket that has been idle gives back its reception stream. */
+				if( ( pxSocket->u.xTCP.rxStream != NULL ) &&
+					( pxSocket->u.xTCP.bits.bRxAutoTune != pdFALSE_UNSIGNED ) &&
+					( ( xNow - pxSocket->u.xTCP.xRxLastTime ) >= pdMS_TO_TICKS( ipconfigTCP_RX_AUTOTUNE_IDLE_MS ) ) )
+				{
+					( void ) prvTCPRxRelease( pxSocket );
+				}
+			}
+			#endif /* ipconfigTCP_RX_AUTOTUNE */
+
 			/* Sockets with 'tmout == 0' do not need any regular attention. */
 			if( pxSocket->u.xTCP.usTimeout == 0u )
 			{
@@ -2814,6 +3782,49 @@ void vSocketWakeUpUser( FreeRTOS_Socket_t *pxSocket )
 #endif /* ipconfigUSE_TCP */
 /*-----------------------------------------------------------*/
 
+#if( ipconfigUSE_TCP == 1 ) && ( ipconfigARP_PENDING_QUEUE_LENGTH > 0 )
+
+	void vTCPARPResolved( uint32_t ulIPAddress )
+	{
+	FreeRTOS_Socket_t *pxSocket;
+	uint32_t ulNextHop;
+	const ListItem_t *pxEnd = ( const ListItem_t * ) listGET_END_MARKER( &xBoundTCPSocketsList );
+	const ListItem_t *pxIterator;
+
+		for( pxIterator = ( const ListItem_t * ) listGET_NEXT( pxEnd );
+			 pxIterator != pxEnd;
+			 pxIterator = ( const ListItem_t * ) listGET_NEXT( pxIterator ) )
+		{
+			pxSocket = ( FreeRTOS_Socket_t * ) listGET_LIST_ITEM_OWNER( pxIterator );
+
+			/* Only a socket that could not send its SYN yet is interested. */
+			if( ( pxSocket->u.xTCP.ucTCPState != eCONNECT_SYN ) || ( pxSocket->u.xTCP.bits.bConnPrepared != pdFALSE_UNSIGNED ) )
+			{
+				continue;
+			}
+
+			/* Determine the next hop, the same way as eARPGetCacheEntry()
+			does. */
+			ulNextHop = FreeRTOS_htonl( pxSocket->u.xTCP.ulRemoteIP );
+
+			if( ( ulNextHop & xNetworkAddressing.ulNetMask ) != ( ( *ipLOCAL_IP_ADDRESS_POINTER ) & xNetworkAddressing.ulNetMask ) )
+			{
+				ulNextHop = xNetworkAddressing.ulGatewayAddress;
+			}
+
+			if( ulNextHop == ulIPAddress )
+			{
+				/* Let xTCPTimerCheck() call xTCPSocketCheck() for this socket
+				as soon as possible, instead of waiting for the retry delay. */
+				pxSocket->u.xTCP.usTimeout = 1u;
+				xSendEventToIPTask( eTCPTimerEvent );
+			}
+		}
+	}
+
+#endif /* ipconfigUSE_TCP && ipconfigARP_PENDING_QUEUE_LENGTH */
+/*-----------------------------------------------------------*/
+
 #if( ipconfigUSE_TCP == 1 )
 
 	/*
@@ -2873,12 +3884,155 @@ void vSocketWakeUpUser( FreeRTOS_Socket_t *pxSocket )
 	{
 	FreeRTOS_Socket_t *pxSocket = (FreeRTOS_Socket_t *)xSocket;
 
+		#if( ipconfigTCP_RX_AUTOTUNE == 1 )
+		{
+			/* The caller will access rxStream directly, it may not be moved or
+			released any more. */
+			socketRX_STREAM_ENTER();
+			pxSocket->u.xTCP.bits.bRxAutoTune = pdFALSE_UNSIGNED;
+			socketRX_STREAM_EXIT();
+		}
+		#endif
+
 		return pxSocket->u.xTCP.rxStream;
 	}
 
 #endif /* ipconfigUSE_TCP */
 /*-----------------------------------------------------------*/
 
+#if( ( ipconfigUSE_TCP == 1 ) && ( ipconfigUSE_TCP_METRICS == 1 ) )
+
+	static void prvTCPFillMetrics( const FreeRTOS_Socket_t *pxSocket, TCPMetrics_t *pxMetrics )
+	{
+	const TCPWindow_t *pxWindow = &( pxSocket->u.xTCP.xTCPWindow );
+	const StreamBuffer_t *pxStream;
+
+		pxMetrics->ulRemoteIP = pxSocket->u.xTCP.ulRemoteIP;
+		pxMetrics->usLocalPort = ( uint16_t ) pxSocket->usLocalPort;
+		pxMetrics->usRemotePort = pxSocket->u.xTCP.usRemotePort;
+		pxMetrics->ucTCPState = pxSocket->u.xTCP.ucTCPState;
+
+		#if( ipconfigTCP_HIGH_RESOLUTION_RTT == 1 )
+		{
+			pxMetrics->ulSRTTus = pxWindow->ulSRTTus;
+			pxMetrics->ulRTOus = pxWindow->ulRTOus;
+		}
+		#else
+		{
+			/* 'lSRTT' is in ms, the RTO is taken as 2 * SRTT. */
+			pxMetrics->ulSRTTus = ( uint32_t ) pxWindow->lSRTT * 1000UL;
+			pxMetrics->ulRTOus = 2UL * pxMetrics->ulSRTTus;
+		}
+		#endif
+
+		pxMetrics->ulRetransmits = pxWindow->xStats.ulRetransmits;
+		pxMetrics->ulFastRetransmits = pxWindow->xStats.ulFastRetransmits;
+		pxMetrics->ulSackReceived = pxWindow->xStats.ulSackReceived;
+		pxMetrics->ulSackSent = pxWindow->xStats.ulSackSent;
+		pxMetrics->ulDuplicateSegments = pxWindow->xStats.ulDuplicateSegments;
+		pxMetrics->ulZeroWindowStalls = pxWindow->xStats.ulZeroWindowStalls;
+
+		if( pxWindow->u.bits.bHasInit != pdFALSE_UNSIGNED )
+		{
+			pxMetrics->ulBytesInFlight = pxWindow->tx.ulHighestSequenceNumber - pxWindow->tx.ulCurrentSequenceNumber;
+		}
+		else
+		{
+			pxMetrics->ulBytesInFlight = 0UL;
+		}
+
+		pxMetrics->ulPeerWindow = pxSocket->u.xTCP.ulWindowSize;
+
+		#if( ipconfigUSE_TCP_CONGESTION_CONTROL == 1 )
+		{
+			pxMetrics->ulCongestionWindow = pxWindow->xCongestion.ulCwnd;
+		}
+		#else
+		{
+			pxMetrics->ulCongestionWindow = 0UL;
+		}
+		#endif
+
+		pxStream = pxSocket->u.xTCP.rxStream;
+		if( pxStream != NULL )
+		{
+			pxMetrics->uxRxStreamCount = uxStreamBufferGetSize( pxStream );
+			pxMetrics->uxRxStreamSize = pxStream->LENGTH - 1u;
+		}
+		else
+		{
+			pxMetrics->uxRxStreamCount = 0u;
+			pxMetrics->uxRxStreamSize = 0u;
+		}
+
+		pxStream = pxSocket->u.xTCP.txStream;
+		if( pxStream != NULL )
+		{
+			pxMetrics->uxTxStreamCount = uxStreamBufferGetSize( pxStream );
+			pxMetrics->uxTxStreamSize = pxStream->LENGTH - 1u;
+		}
+		else
+		{
+			pxMetrics->uxTxStreamCount = 0u;
+			pxMetrics->uxTxStreamSize = 0u;
+		}
+	}
+	/*-----------------------------------------------------------*/
+
+	BaseType_t FreeRTOS_GetTCPMetrics( Socket_t xSocket, TCPMetrics_t *pxMetrics )
+	{
+	FreeRTOS_Socket_t *pxSocket = ( FreeRTOS_Socket_t * ) xSocket;
+	BaseType_t xReturn;
+
+		if( ( pxSocket == NULL ) || ( pxSocket == FREERTOS_INVALID_SOCKET ) ||
+			( pxSocket->ucProtocol != ( uint8_t ) FREERTOS_IPPROTO_TCP ) )
+		{
+			xReturn = -pdFREERTOS_ERRNO_EINVAL;
+		}
+		else
+		{
+			/* The IP-task may not change the socket while it is being read. */
+			vTaskSuspendAll();
+			{
+				prvTCPFillMetrics( pxSocket, pxMetrics );
+			}
+			( void ) xTaskResumeAll();
+			xReturn = 0;
+		}
+
+		return xReturn;
+	}
+	/*-----------------------------------------------------------*/
+
+	BaseType_t FreeRTOS_GetAllTCPMetrics( TCPMetrics_t *pxMetrics, BaseType_t xMaxCount )
+	{
+	const ListItem_t *pxIterator;
+	const MiniListItem_t *pxEnd = ( const MiniListItem_t * ) listGET_END_MARKER( &xBoundTCPSocketsList );
+	BaseType_t xCount = 0;
+
+		/* Sockets can not be created, bound or closed while the scheduler is
+		suspended, so the list can be walked safely. */
+		vTaskSuspendAll();
+		{
+			for( pxIterator  = ( const ListItem_t * ) listGET_NEXT( pxEnd );
+				 pxIterator != ( const ListItem_t * ) pxEnd;
+				 pxIterator  = ( const ListItem_t * ) listGET_NEXT( pxIterator ) )
+			{
+				if( xCount < xMaxCount )
+				{
+					prvTCPFillMetrics( ( const FreeRTOS_Socket_t * ) listGET_LIST_ITEM_OWNER( pxIterator ), &( pxMetrics[ xCount ] ) );
+				}
+				xCount++;
+			}
+		}
+		( void ) xTaskResumeAll();
+
+		return xCount;
+	}
+	/*-----------------------------------------------------------*/
+
+#endif /* ( ipconfigUSE_TCP == 1 ) && ( ipconfigUSE_TCP_METRICS == 1 ) */
+
 #if( ipconfigUSE_TCP == 1 )
 
 	static StreamBuffer_t *prvTCPCreateStream ( FreeRTOS_Socket_t *pxSocket, BaseType_t xIsInputStream )
@@ -2916,7 +4070,19 @@ void vSocketWakeUpUser( FreeRTOS_Socket_t *pxSocket )
 
 		uxSize = sizeof( *pxBuffer ) - sizeof( pxBuffer->ucArray ) + uxLength;
 
-		pxBuffer = ( StreamBuffer_t * )pvPortMallocLarge( uxSize );
+		pxBuffer = ( StreamBuffer_t * )socketSTREAM_MALLOC( uxSize );
+
+		#if( ipconfigTCP_RX_AUTOTUNE == 1 )
+		{
+			/* Short of memory: let quiet sockets give back their reception
+			streams, and try once more.  Only the IP-task may do so. */
+			if( ( pxBuffer == NULL ) && ( xIsCallingFromIPTask() != pdFALSE ) &&
+				( prvTCPRxReclaim( pxSocket, socketRX_PRESSURE_IDLE_TICKS ) != 0 ) )
+			{
+				pxBuffer = ( StreamBuffer_t * )socketSTREAM_MALLOC( uxSize );
+			}
+		}
+		#endif /* ipconfigTCP_RX_AUTOTUNE */
 
 		if( pxBuffer == NULL )
 		{
@@ -2994,6 +4160,16 @@ void vSocketWakeUpUser( FreeRTOS_Socket_t *pxSocket )
 		}
 		#endif /* ipconfigUSE_CALLBACKS */
 
+		#if( ipconfigUSE_LATENCY_HISTOGRAMS == 1 )
+		{
+			if( ( uxOffset == 0u ) && ( uxStreamBufferGetSize( pxStream ) == 0u ) )
+			{
+				/* The stream was empty, the first unread byte arrives now. */
+				pxSocket->u.xTCP.ulRxLatencyStamp = ipLATENCY_TIME();
+			}
+		}
+		#endif /* ipconfigUSE_LATENCY_HISTOGRAMS */
+
 		xResult = ( int32_t ) uxStreamBufferAdd( pxStream, uxOffset, pcData, ( size_t ) ulByteCount );
 
 		#if( ipconfigHAS_DEBUG_PRINTF != 0 )
@@ -3072,6 +4248,15 @@ void vSocketWakeUpUser( FreeRTOS_Socket_t *pxSocket )
 				}
 				#endif
 			}
+
+			#if( ipconfigTCP_RX_AUTOTUNE == 1 )
+			{
+				if( pxSocket->u.xTCP.bits.bRxAutoTune != pdFALSE_UNSIGNED )
+				{
+					prvTCPRxAutoTune( pxSocket, ulByteCount );
+				}
+			}
+			#endif
 		}
 
 		return xResult;
@@ -3080,22 +4265,281 @@ void vSocketWakeUpUser( FreeRTOS_Socket_t *pxSocket )
 #endif /* ipconfigUSE_TCP */
 /*-----------------------------------------------------------*/
 
-#if( ipconfigUSE_TCP == 1 )
+#if( ipconfigTCP_RX_AUTOTUNE == 1 )
 
-	/* Function to get the remote address and IP port */
-	BaseType_t FreeRTOS_GetRemoteAddress( Socket_t xSocket, struct freertos_sockaddr *pxAddress )
+	static void prvTCPRxAutoTune( FreeRTOS_Socket_t *pxSocket, uint32_t ulByteCount )
 	{
-	FreeRTOS_Socket_t *pxSocket = ( FreeRTOS_Socket_t * ) xSocket;
-	BaseType_t xResult;
+	uint32_t ulNow = socketRX_STAMP();
+	uint32_t ulWindow = pxSocket->u.xTCP.xTCPWindow.xSize.ulRxWindowLength;
+	uint32_t ulElapsed;
 
-		if( pxSocket->ucProtocol != ( uint8_t ) FREERTOS_IPPROTO_TCP )
+		pxSocket->u.xTCP.xRxLastTime = xTaskGetTickCount();
+
+		/* The peer can not send more than one window per round-trip, so the
+		time needed to receive a full window is never shorter than the RTT.
+		The shortest sample is the best estimate. */
+		if( pxSocket->u.xTCP.bits.bRxRttSample == pdFALSE_UNSIGNED )
 		{
-			xResult = -pdFREERTOS_ERRNO_EINVAL;
+			pxSocket->u.xTCP.bits.bRxRttSample = pdTRUE_UNSIGNED;
+			pxSocket->u.xTCP.ulRxRttBytes = ulWindow;
+			pxSocket->u.xTCP.ulRxRttStamp = ulNow;
+		}
+		else if( ulByteCount < pxSocket->u.xTCP.ulRxRttBytes )
+		{
+			pxSocket->u.xTCP.ulRxRttBytes -= ulByteCount;
 		}
 		else
 		{
-			/* BSD style sockets communicate IP and port addresses in network
-			byte order.
+			ulElapsed = FreeRTOS_max_uint32( 1ul, ulNow - pxSocket->u.xTCP.ulRxRttStamp );
+			if( ( pxSocket->u.xTCP.ulRxRtt == 0ul ) || ( ulElapsed < pxSocket->u.xTCP.ulRxRtt ) )
+			{
+				pxSocket->u.xTCP.ulRxRtt = ulElapsed;
+			}
+			pxSocket->u.xTCP.bits.bRxRttSample = pdFALSE_UNSIGNED;
+		}
+
+		/* Count the bytes received during one RTT, which is the bandwidth-delay
+		product as far as the current window allows.  Like Linux's dynamic
+		right-sizing, the window becomes twice that number, so that the peer's
+		congestion window can continue to grow. */
+		pxSocket->u.xTCP.ulRxTuneBytes += ulByteCount;
+		ulElapsed = ulNow - pxSocket->u.xTCP.ulRxTuneStamp;
+
+		if( ( pxSocket->u.xTCP.ulRxRtt != 0ul ) && ( ulElapsed >= pxSocket->u.xTCP.ulRxRtt ) )
+		{
+			/* A measurement that lasted more than two RTT's is not used: the
+			peer has been quiet in between.  When the application does not
+			read, the low-water mark is reached: a larger window won't help. */
+			if( ( ulElapsed < ( 2ul * pxSocket->u.xTCP.ulRxRtt ) ) &&
+				( ( 2ul * pxSocket->u.xTCP.ulRxTuneBytes ) > ulWindow ) &&
+				( pxSocket->u.xTCP.bits.bLowWater == pdFALSE_UNSIGNED ) )
+			{
+				prvTCPRxGrow( pxSocket, 2ul * pxSocket->u.xTCP.ulRxTuneBytes );
+			}
+
+			pxSocket->u.xTCP.ulRxTuneBytes = 0ul;
+			pxSocket->u.xTCP.ulRxTuneStamp = ulNow;
+		}
+	}
+	/*-----------------------------------------------------------*/
+
+	static void prvTCPRxGrow( FreeRTOS_Socket_t *pxSocket, uint32_t ulTarget )
+	{
+	TCPWindow_t *pxWindow = &( pxSocket->u.xTCP.xTCPWindow );
+	uint32_t ulMSS = ( uint32_t ) pxSocket->u.xTCP.usCurMSS;
+	uint32_t ulWindow;
+	size_t uxNewSize;
+	size_t uxAvailable;
+
+		/* Whole segments, and not more than the scale factor can express. */
+		ulWindow = FreeRTOS_round_up( ulTarget, ulMSS );
+		ulWindow = FreeRTOS_min_uint32( ulWindow, ( uint32_t ) ipconfigTCP_RX_AUTOTUNE_MAX_LENGTH / 2ul );
+		ulWindow = FreeRTOS_min_uint32( ulWindow, 0xfffcul << pxSocket->u.xTCP.ucMyWinScaleFactor );
+
+		/* As with the default settings, the stream is twice the window. */
+		uxNewSize = ( size_t ) ( 2ul * ulWindow );
+
+		if( uxNewSize > pxSocket->u.xTCP.uxRxStreamSize )
+		{
+			uxAvailable = ( uxRxAutoTuneTotal < ( size_t ) ipconfigTCP_RX_AUTOTUNE_BUDGET ) ?
+				( ( size_t ) ipconfigTCP_RX_AUTOTUNE_BUDGET - uxRxAutoTuneTotal ) : 0u;
+
+			if( ( uxNewSize - pxSocket->u.xTCP.uxRxStreamSize ) > uxAvailable )
+			{
+				/* The budget is used up: take back the streams of sockets
+				that have been quiet for a while. */
+				if( prvTCPRxReclaim( pxSocket, socketRX_PRESSURE_IDLE_TICKS ) != 0 )
+				{
+					uxAvailable = ( uxRxAutoTuneTotal < ( size_t ) ipconfigTCP_RX_AUTOTUNE_BUDGET ) ?
+						( ( size_t ) ipconfigTCP_RX_AUTOTUNE_BUDGET - uxRxAutoTuneTotal ) : 0u;
+				}
+				uxNewSize = FreeRTOS_min_uint32( uxNewSize, pxSocket->u.xTCP.uxRxStreamSize + uxAvailable );
+			}
+
+			if( uxNewSize > pxSocket->u.xTCP.uxRxStreamSize )
+			{
+				( void ) prvTCPRxResize( pxSocket, uxNewSize );
+			}
+		}
+
+		/* The window can not be larger than half of the stream. */
+		ulWindow = FreeRTOS_min_uint32( ulWindow, ( ( ( uint32_t ) pxSocket->u.xTCP.uxRxStreamSize / 2ul ) / ulMSS ) * ulMSS );
+
+		if( ulWindow > pxWindow->xSize.ulRxWindowLength )
+		{
+			if( xTCPWindowLoggingLevel != 0 )
+			{
+				FreeRTOS_debug_printf( ( "prvTCPRxGrow: port %u window %lu -> %lu stream %lu (total %lu)\n",
+					pxSocket->usLocalPort,
+					pxWindow->xSize.ulRxWindowLength,
+					ulWindow,
+					pxSocket->u.xTCP.uxRxStreamSize,
+					uxRxAutoTuneTotal ) );
+			}
+			pxWindow->xSize.ulRxWindowLength = ulWindow;
+		}
+	}
+	/*-----------------------------------------------------------*/
+
+	static BaseType_t prvTCPRxResize( FreeRTOS_Socket_t *pxSocket, size_t uxNewSize )
+	{
+	StreamBuffer_t *pxOld = pxSocket->u.xTCP.rxStream;
+	StreamBuffer_t *pxNew = NULL;
+	size_t uxLength;
+	size_t uxCount;
+	size_t uxFirst;
+
+		if( pxOld != NULL )
+		{
+			/* Same size calculation as in prvTCPCreateStream(). */
+			uxLength = ( uxNewSize + sizeof( size_t ) ) & ~( sizeof( size_t ) - 1u );
+			pxNew = ( StreamBuffer_t * ) socketSTREAM_MALLOC( sizeof( *pxNew ) - sizeof( pxNew->ucArray ) + uxLength );
+
+			if( pxNew == NULL )
+			{
+				return pdFAIL;
+			}
+
+			memset( pxNew, '\0', sizeof( *pxNew ) - sizeof( pxNew->ucArray ) );
+			pxNew->LENGTH = uxLength;
+		}
+
+		/* Other tasks might be reading from the old stream. */
+		vTaskSuspendAll();
+		{
+			if( pxOld != NULL )
+			{
+				/* Copy everything from uxTail up to uxFront, including data
+				received out-of-order.  The positions relative to uxTail stay
+				the same. */
+				uxCount = uxStreamBufferDistance( pxOld, pxOld->uxTail, pxOld->uxFront );
+				uxFirst = FreeRTOS_min_uint32( pxOld->LENGTH - pxOld->uxTail, uxCount );
+				memcpy( pxNew->ucArray, pxOld->ucArray + pxOld->uxTail, uxFirst );
+				memcpy( pxNew->ucArray + uxFirst, pxOld->ucArray, uxCount - uxFirst );
+
+				pxNew->uxHead = uxStreamBufferDistance( pxOld, pxOld->uxTail, pxOld->uxHead );
+				pxNew->uxMid = uxStreamBufferDistance( pxOld, pxOld->uxTail, pxOld->uxMid );
+				pxNew->uxFront = uxCount;
+
+				pxSocket->u.xTCP.rxStream = pxNew;
+			}
+
+			uxRxAutoTuneTotal = ( uxRxAutoTuneTotal + uxNewSize ) - pxSocket->u.xTCP.uxRxStreamSize;
+			pxSocket->u.xTCP.uxRxStreamSize = uxNewSize;
+			pxSocket->u.xTCP.uxLittleSpace = ( 1u * uxNewSize ) / 5u;
+			pxSocket->u.xTCP.uxEnoughSpace = ( 4u * uxNewSize ) / 5u;
+		}
+		( void ) xTaskResumeAll();
+
+		if( pxOld != NULL )
+		{
+			socketSTREAM_FREE( pxOld );
+		}
+
+		return pdPASS;
+	}
+	/*-----------------------------------------------------------*/
+
+	static BaseType_t prvTCPRxRelease( FreeRTOS_Socket_t *pxSocket )
+	{
+	StreamBuffer_t *pxStream = pxSocket->u.xTCP.rxStream;
+	BaseType_t xReleased = pdFALSE;
+
+		/* Only a stream without data, also without out-of-order data, can be
+		released.  It will be created again with the initial size. */
+		if( ( pxStream != NULL ) && ( pxStream->uxTail == pxStream->uxHead ) && ( pxStream->uxHead == pxStream->uxFront ) )
+		{
+			vTaskSuspendAll();
+			{
+				pxSocket->u.xTCP.rxStream = NULL;
+				uxRxAutoTuneTotal -= pxSocket->u.xTCP.uxRxStreamSize - pxSocket->u.xTCP.uxRxBaseSize;
+				pxSocket->u.xTCP.uxRxStreamSize = pxSocket->u.xTCP.uxRxBaseSize;
+				pxSocket->u.xTCP.uxLittleSpace = ( 1u * pxSocket->u.xTCP.uxRxBaseSize ) / 5u;
+				pxSocket->u.xTCP.uxEnoughSpace = ( 4u * pxSocket->u.xTCP.uxRxBaseSize ) / 5u;
+			}
+			( void ) xTaskResumeAll();
+
+			socketSTREAM_FREE( pxStream );
+
+			if( pxSocket->u.xTCP.xTCPWindow.u.bits.bHasInit != pdFALSE_UNSIGNED )
+			{
+				pxSocket->u.xTCP.xTCPWindow.xSize.ulRxWindowLength = pxSocket->u.xTCP.uxRxWinSize * pxSocket->u.xTCP.usCurMSS;
+			}
+			pxSocket->u.xTCP.ulRxTuneBytes = 0ul;
+			pxSocket->u.xTCP.bits.bRxRttSample = pdFALSE_UNSIGNED;
+			xReleased = pdTRUE;
+
+			if( xTCPWindowLoggingLevel != 0 )
+			{
+				FreeRTOS_debug_printf( ( "prvTCPRxRelease: port %u released its rxStream (total %lu)\n",
+					pxSocket->usLocalPort,
+					uxRxAutoTuneTotal ) );
+			}
+		}
+
+		return xReleased;
+	}
+	/*-----------------------------------------------------------*/
+
+	static BaseType_t prvTCPRxReclaim( const FreeRTOS_Socket_t *pxExclude, TickType_t xMinIdle )
+	{
+	const ListItem_t *pxEnd = ( const ListItem_t * ) listGET_END_MARKER( &xBoundTCPSocketsList );
+	const ListItem_t *pxIterator;
+	FreeRTOS_Socket_t *pxSocket;
+	TickType_t xNow = xTaskGetTickCount();
+	BaseType_t xCount = 0;
+
+		for( pxIterator  = ( const ListItem_t * ) listGET_NEXT( pxEnd );
+			 pxIterator != pxEnd;
+			 pxIterator  = ( const ListItem_t * ) listGET_NEXT( pxIterator ) )
+		{
+			pxSocket = ( FreeRTOS_Socket_t * ) listGET_LIST_ITEM_OWNER( pxIterator );
+
+			if( ( pxSocket != pxExclude ) &&
+				( pxSocket->u.xTCP.bits.bRxAutoTune != pdFALSE_UNSIGNED ) &&
+				( ( xNow - pxSocket->u.xTCP.xRxLastTime ) >= xMinIdle ) )
+			{
+				xCount += prvTCPRxRelease( pxSocket );
+			}
+		}
+
+		return xCount;
+	}
+	/*-----------------------------------------------------------*/
+
+	static void prvTCPRxAutoTuneStop( FreeRTOS_Socket_t *pxSocket )
+	{
+		vTaskSuspendAll();
+		{
+			if( pxSocket->u.xTCP.bits.bRxAutoTune != pdFALSE_UNSIGNED )
+			{
+				uxRxAutoTuneTotal -= pxSocket->u.xTCP.uxRxStreamSize - pxSocket->u.xTCP.uxRxBaseSize;
+				pxSocket->u.xTCP.uxRxStreamSize = pxSocket->u.xTCP.uxRxBaseSize;
+				pxSocket->u.xTCP.bits.bRxAutoTune = pdFALSE_UNSIGNED;
+			}
+		}
+		( void ) xTaskResumeAll();
+	}
+
+#endif /* ipconfigTCP_RX_AUTOTUNE */
+/*-----------------------------------------------------------*/
+
+#if( ipconfigUSE_TCP == 1 )
+
+	/* Function to get the remote address and IP port */
+	BaseType_t FreeRTOS_GetRemoteAddress( Socket_t xSocket, struct freertos_sockaddr *pxAddress )
+	{
+	FreeRTOS_Socket_t *pxSocket = ( FreeRTOS_Socket_t * ) xSocket;
+	BaseType_t xResult;
+
+		if( pxSocket->ucProtocol != ( uint8_t ) FREERTOS_IPPROTO_TCP )
+		{
+			xResult = -pdFREERTOS_ERRNO_EINVAL;
+		}
+		else
+		{
+			/* BSD style sockets communicate IP and port addresses in network
+			byte order.
 
 			IP address of remote machine. */
 			pxAddress->sin_addr = FreeRTOS_htonl ( pxSocket->u.xTCP.ulRemoteIP );
@@ -3302,13 +4746,18 @@ void vSocketWakeUpUser( FreeRTOS_Socket_t *pxSocket )
 		{
 			xReturn = -pdFREERTOS_ERRNO_EINVAL;
 		}
-		else if( pxSocket->u.xTCP.rxStream != NULL )
-		{
-			xReturn = ( BaseType_t ) uxStreamBufferGetSize( pxSocket->u.xTCP.rxStream );
-		}
 		else
 		{
-			xReturn = 0;
+			socketRX_STREAM_ENTER();
+			if( pxSocket->u.xTCP.rxStream != NULL )
+			{
+				xReturn = ( BaseType_t ) uxStreamBufferGetSize( pxSocket->u.xTCP.rxStream );
+			}
+			else
+			{
+				xReturn = 0;
+			}
+			socketRX_STREAM_EXIT();
 		}
 
 		return xReturn;
@@ -3403,6 +4852,27 @@ void vSocketWakeUpUser( FreeRTOS_Socket_t *pxSocket )
 				uxGetMinimumFreeNetworkBuffers( ),
 				uxGetNumberOfFreeNetworkBuffers( ),
 				ipconfigNUM_NETWORK_BUFFER_DESCRIPTORS ) );
+
+			#if( ipconfigUSE_SOCKET_POOL == 1 )
+			{
+			static const char * const pcPoolNames[ FREERTOS_POOL_COUNT ] = { "sockets", "small streams", "large streams" };
+			SocketPoolStats_t xStats[ FREERTOS_POOL_COUNT ];
+			BaseType_t xIndex;
+
+				FreeRTOS_GetSocketPoolStats( xStats );
+
+				for( xIndex = 0; xIndex < FREERTOS_POOL_COUNT; xIndex++ )
+				{
+					FreeRTOS_printf( ( "Pool %-13s %lu/%lu used (max %lu) %lu bytes each, %lu from heap\n",
+						pcPoolNames[ xIndex ],
+						( uint32_t ) xStats[ xIndex ].uxInUse,
+						( uint32_t ) xStats[ xIndex ].uxCount,
+						( uint32_t ) xStats[ xIndex ].uxMaxInUse,
+						( uint32_t ) xStats[ xIndex ].uxBlockSize,
+						( uint32_t ) xStats[ xIndex ].uxHeapCount ) );
+				}
+			}
+			#endif /* ipconfigUSE_SOCKET_POOL */
 		}
 	}
 
@@ -3632,3 +5102,515 @@ void vSocketWakeUpUser( FreeRTOS_Socket_t *pxSocket )
 
 #endif /* ipconfigSUPPORT_SIGNALS */
 /*-----------------------------------------------------------*/
+
+#if( ipconfigUSE_TCP == 1 ) || ( ipconfigSUPPORT_MSG_FUNCTIONS == 1 )
+
+	static size_t prvIOVecLength( const struct freertos_iovec *pxIOVec, size_t uxIOVecCount )
+	{
+	size_t uxIndex;
+	size_t uxTotal = 0u;
+
+		for( uxIndex = 0u; uxIndex < uxIOVecCount; uxIndex++ )
+		{
+			uxTotal += pxIOVec[ uxIndex ].iov_len;
+		}
+
+		return uxTotal;
+	}
+
+#endif
+/*-----------------------------------------------------------*/
+
+#if( ipconfigSUPPORT_MSG_FUNCTIONS == 1 )
+
+	static TickType_t prvUDPSendBlockTime( FreeRTOS_Socket_t *pxSocket, BaseType_t xFlags )
+	{
+	TickType_t xTicksToWait = pxSocket->xSendBlockTime;
+
+		#if( ipconfigUSE_CALLBACKS != 0 )
+		{
+			if( xIsCallingFromIPTask() != pdFALSE )
+			{
+				/* Never block the IP-task. */
+				xTicksToWait = ( TickType_t ) 0;
+			}
+		}
+		#endif /* ipconfigUSE_CALLBACKS */
+
+		if( ( xFlags & FREERTOS_MSG_DONTWAIT ) != 0 )
+		{
+			xTicksToWait = ( TickType_t ) 0;
+		}
+
+		return xTicksToWait;
+	}
+
+#endif /* ipconfigSUPPORT_MSG_FUNCTIONS */
+/*-----------------------------------------------------------*/
+
+#if( ipconfigSUPPORT_MSG_FUNCTIONS == 1 )
+
+	static NetworkBufferDescriptor_t *prvUDPGatherMessage( const struct freertos_msghdr *pxMessage, TickType_t xTicksToWait )
+	{
+	NetworkBufferDescriptor_t *pxNetworkBuffer;
+	size_t uxTotalLength = prvIOVecLength( pxMessage->msg_iov, pxMessage->msg_iovlen );
+	uint8_t *pucPayload;
+	size_t uxIndex;
+
+		pxNetworkBuffer = pxGetNetworkBufferWithDescriptor( uxTotalLength + sizeof( UDPPacket_t ), xTicksToWait );
+
+		if( pxNetworkBuffer != NULL )
+		{
+			/* Copy the fragments directly into the network buffer. */
+			pucPayload = &( pxNetworkBuffer->pucEthernetBuffer[ ipUDP_PAYLOAD_OFFSET_IPv4 ] );
+
+			for( uxIndex = 0u; uxIndex < pxMessage->msg_iovlen; uxIndex++ )
+			{
+				memcpy( pucPayload, pxMessage->msg_iov[ uxIndex ].iov_base, pxMessage->msg_iov[ uxIndex ].iov_len );
+				pucPayload += pxMessage->msg_iov[ uxIndex ].iov_len;
+			}
+
+			pxNetworkBuffer->xDataLength = uxTotalLength;
+		}
+		else
+		{
+			iptraceNO_BUFFER_FOR_SENDTO();
+		}
+
+		return pxNetworkBuffer;
+	}
+
+#endif /* ipconfigSUPPORT_MSG_FUNCTIONS */
+/*-----------------------------------------------------------*/
+
+#if( ipconfigSUPPORT_MSG_FUNCTIONS == 1 )
+
+	static size_t prvUDPScatterMessage( struct freertos_msghdr *pxMessage, const uint8_t *pucPayload, size_t uxLength )
+	{
+	size_t uxIndex;
+	size_t uxCount;
+	size_t uxCopied = 0u;
+
+		for( uxIndex = 0u; ( uxIndex < pxMessage->msg_iovlen ) && ( uxCopied < uxLength ); uxIndex++ )
+		{
+			uxCount = FreeRTOS_min_uint32( ( uint32_t ) pxMessage->msg_iov[ uxIndex ].iov_len, ( uint32_t ) ( uxLength - uxCopied ) );
+			memcpy( pxMessage->msg_iov[ uxIndex ].iov_base, pucPayload + uxCopied, uxCount );
+			uxCopied += uxCount;
+		}
+
+		if( uxCopied < uxLength )
+		{
+			/* Like recvfrom(), the rest of the datagram is discarded. */
+			iptraceRECVFROM_DISCARDING_BYTES( uxLength - uxCopied );
+			pxMessage->msg_flags |= FREERTOS_MSG_TRUNC;
+		}
+
+		return uxCopied;
+	}
+
+#endif /* ipconfigSUPPORT_MSG_FUNCTIONS */
+/*-----------------------------------------------------------*/
+
+#if( ipconfigSUPPORT_MSG_FUNCTIONS == 1 )
+
+	static BaseType_t prvUDPMessageIsValid( const struct freertos_msghdr *pxMessage )
+	{
+	BaseType_t xReturn = pdTRUE;
+
+		if( ( pxMessage->msg_iov == NULL ) && ( pxMessage->msg_iovlen != 0u ) )
+		{
+			xReturn = pdFALSE;
+		}
+		else if( prvIOVecLength( pxMessage->msg_iov, pxMessage->msg_iovlen ) > ( size_t ) ipMAX_UDP_PAYLOAD_LENGTH )
+		{
+			xReturn = pdFALSE;
+		}
+		else if( pxMessage->msg_name == NULL )
+		{
+			/* A UDP message needs a destination. */
+			xReturn = pdFALSE;
+		}
+
+		return xReturn;
+	}
+
+#endif /* ipconfigSUPPORT_MSG_FUNCTIONS */
+/*-----------------------------------------------------------*/
+
+#if( ipconfigSUPPORT_MSG_FUNCTIONS == 1 )
+
+	static int32_t prvUDPSendMsg( FreeRTOS_Socket_t *pxSocket, const struct freertos_msghdr *pxMessage, BaseType_t xFlags )
+	{
+	NetworkBufferDescriptor_t *pxNetworkBuffer;
+	TickType_t xTicksToWait;
+	TimeOut_t xTimeOut;
+	size_t uxLength;
+	int32_t lReturn = 0;
+
+		if( prvUDPMessageIsValid( pxMessage ) == pdFALSE )
+		{
+			lReturn = -pdFREERTOS_ERRNO_EINVAL;
+		}
+		else
+		{
+			xTicksToWait = prvUDPSendBlockTime( pxSocket, xFlags );
+			vTaskSetTimeOutState( &xTimeOut );
+
+			pxNetworkBuffer = prvUDPGatherMessage( pxMessage, xTicksToWait );
+
+			if( pxNetworkBuffer != NULL )
+			{
+				if( xTaskCheckForTimeOut( &xTimeOut, &xTicksToWait ) != pdFALSE )
+				{
+					/* The entire block time has been used up. */
+					xTicksToWait = ( TickType_t ) 0;
+				}
+
+				/* The length is read now, the buffer may be gone once the
+				IP-task has it. */
+				uxLength = pxNetworkBuffer->xDataLength;
+
+				/* The buffer is not handed to FreeRTOS_sendto(): it returns 0
+				both on failure and for a valid zero-length datagram, so it
+				can not tell whether the IP-task has taken the buffer. */
+				if( ( prvUDPPrepareBuffer( pxSocket, pxNetworkBuffer, pxMessage->msg_name ) != pdFAIL ) &&
+					( prvUDPSendToIPTask( eStackTxEvent, pxNetworkBuffer, xTicksToWait ) != pdFAIL ) )
+				{
+					lReturn = ( int32_t ) uxLength;
+					prvUDPHandleSent( pxSocket, uxLength );
+				}
+				else
+				{
+					/* The buffer was not passed to the IP-task. */
+					vReleaseNetworkBufferAndDescriptor( pxNetworkBuffer );
+				}
+			}
+			else
+			{
+				iptraceNO_BUFFER_FOR_SENDTO();
+			}
+		}
+
+		return lReturn;
+	}
+
+#endif /* ipconfigSUPPORT_MSG_FUNCTIONS */
+/*-----------------------------------------------------------*/
+
+#if( ipconfigSUPPORT_MSG_FUNCTIONS == 1 )
+
+	static int32_t prvUDPRecvMsg( FreeRTOS_Socket_t *pxSocket, struct freertos_msghdr *pxMessage, BaseType_t xFlags )
+	{
+	uint8_t *pucPayload = NULL;
+	int32_t lReturn;
+
+		lReturn = FreeRTOS_recvfrom( ( Socket_t ) pxSocket, &pucPayload, 0u, xFlags | FREERTOS_ZERO_COPY,
+			pxMessage->msg_name, &( pxMessage->msg_namelen ) );
+
+		if( lReturn >= 0 )
+		{
+			lReturn = ( int32_t ) prvUDPScatterMessage( pxMessage, pucPayload, ( size_t ) lReturn );
+
+			if( ( xFlags & FREERTOS_MSG_PEEK ) == 0 )
+			{
+				FreeRTOS_ReleaseUDPPayloadBuffer( ( void * ) pucPayload );
+			}
+		}
+
+		return lReturn;
+	}
+
+#endif /* ipconfigSUPPORT_MSG_FUNCTIONS */
+/*-----------------------------------------------------------*/
+
+#if( ipconfigSUPPORT_MSG_FUNCTIONS == 1 )
+
+	/*
+	 * Send a message that is made up of 'msg_iovlen' fragments.  A UDP socket
+	 * sends it as a single datagram to 'msg_name', a TCP socket adds the
+	 * fragments to its transmission stream, as if FreeRTOS_send() was called
+	 * for each fragment.  FREERTOS_ZERO_COPY is not supported.
+	 */
+	int32_t FreeRTOS_sendmsg( Socket_t xSocket, const struct freertos_msghdr *pxMessage, BaseType_t xFlags )
+	{
+	FreeRTOS_Socket_t *pxSocket = ( FreeRTOS_Socket_t * ) xSocket;
+	int32_t lReturn;
+
+		configASSERT( pxMessage != NULL );
+
+		if( ( pxSocket == NULL ) || ( pxSocket == FREERTOS_INVALID_SOCKET ) ||
+			( ( xFlags & FREERTOS_ZERO_COPY ) != 0 ) ||
+			( ( pxMessage->msg_iov == NULL ) && ( pxMessage->msg_iovlen != 0u ) ) )
+		{
+			lReturn = -pdFREERTOS_ERRNO_EINVAL;
+		}
+		else if( pxSocket->ucProtocol == ( uint8_t ) FREERTOS_IPPROTO_UDP )
+		{
+			lReturn = prvUDPSendMsg( pxSocket, pxMessage, xFlags );
+		}
+		#if( ipconfigUSE_TCP == 1 )
+		else if( pxSocket->ucProtocol == ( uint8_t ) FREERTOS_IPPROTO_TCP )
+		{
+			lReturn = ( int32_t ) prvTCPSendIOVec( pxSocket, pxMessage->msg_iov, pxMessage->msg_iovlen, xFlags );
+		}
+		#endif /* ipconfigUSE_TCP */
+		else
+		{
+			lReturn = -pdFREERTOS_ERRNO_EINVAL;
+		}
+
+		return lReturn;
+	}
+
+#endif /* ipconfigSUPPORT_MSG_FUNCTIONS */
+/*-----------------------------------------------------------*/
+
+#if( ipconfigSUPPORT_MSG_FUNCTIONS == 1 )
+
+	/*
+	 * Receive data into 'msg_iovlen' fragments.  A UDP socket reads a single
+	 * datagram; if it does not fit, FREERTOS_MSG_TRUNC is set in 'msg_flags'.
+	 * A TCP socket reads as much as is available from its reception stream.
+	 * FREERTOS_ZERO_COPY is not supported.
+	 */
+	int32_t FreeRTOS_recvmsg( Socket_t xSocket, struct freertos_msghdr *pxMessage, BaseType_t xFlags )
+	{
+	FreeRTOS_Socket_t *pxSocket = ( FreeRTOS_Socket_t * ) xSocket;
+	int32_t lReturn;
+
+		configASSERT( pxMessage != NULL );
+
+		pxMessage->msg_flags = 0;
+
+		if( ( pxSocket == NULL ) || ( pxSocket == FREERTOS_INVALID_SOCKET ) ||
+			( ( xFlags & FREERTOS_ZERO_COPY ) != 0 ) ||
+			( ( pxMessage->msg_iov == NULL ) && ( pxMessage->msg_iovlen != 0u ) ) )
+		{
+			lReturn = -pdFREERTOS_ERRNO_EINVAL;
+		}
+		else if( pxSocket->ucProtocol == ( uint8_t ) FREERTOS_IPPROTO_UDP )
+		{
+			lReturn = prvUDPRecvMsg( pxSocket, pxMessage, xFlags );
+		}
+		#if( ipconfigUSE_TCP == 1 )
+		else if( pxSocket->ucProtocol == ( uint8_t ) FREERTOS_IPPROTO_TCP )
+		{
+			lReturn = ( int32_t ) prvTCPRecvIOVec( pxSocket, pxMessage->msg_iov, pxMessage->msg_iovlen, xFlags );
+		}
+		#endif /* ipconfigUSE_TCP */
+		else
+		{
+			lReturn = -pdFREERTOS_ERRNO_EINVAL;
+		}
+
+		return lReturn;
+	}
+
+#endif /* ipconfigSUPPORT_MSG_FUNCTIONS */
+/*-----------------------------------------------------------*/
+
+#if( ipconfigSUPPORT_MSG_FUNCTIONS == 1 )
+
+	/*
+	 * Send up to 'uxMessageCount' datagrams from a UDP socket.  All packets
+	 * are chained through pxNextBuffer and passed to the IP-task with a single
+	 * eStackTxChainEvent.  Returns the number of messages sent; 'msg_len' of
+	 * each sent message holds its length.  A message that is invalid or for
+	 * which no network buffer can be obtained stops the batch.
+	 */
+	int32_t FreeRTOS_sendmmsg( Socket_t xSocket, struct freertos_mmsghdr *pxMessages, size_t uxMessageCount, BaseType_t xFlags )
+	{
+	FreeRTOS_Socket_t *pxSocket = ( FreeRTOS_Socket_t * ) xSocket;
+	NetworkBufferDescriptor_t *pxNetworkBuffer;
+	NetworkBufferDescriptor_t *pxFirstBuffer = NULL;
+	NetworkBufferDescriptor_t *pxLastBuffer = NULL;
+	const struct freertos_msghdr *pxMessage;
+	TickType_t xTicksToWait;
+	TimeOut_t xTimeOut;
+	size_t uxIndex;
+	int32_t lReturn = 0;
+
+		if( ( prvValidSocket( pxSocket, FREERTOS_IPPROTO_UDP, pdFALSE ) == pdFALSE ) ||
+			( ( xFlags & FREERTOS_ZERO_COPY ) != 0 ) ||
+			( ( pxMessages == NULL ) && ( uxMessageCount != 0u ) ) )
+		{
+			lReturn = -pdFREERTOS_ERRNO_EINVAL;
+		}
+		else
+		{
+			xTicksToWait = prvUDPSendBlockTime( pxSocket, xFlags );
+			vTaskSetTimeOutState( &xTimeOut );
+
+			for( uxIndex = 0u; uxIndex < uxMessageCount; uxIndex++ )
+			{
+				pxMessage = &( pxMessages[ uxIndex ].msg_hdr );
+
+				if( prvUDPMessageIsValid( pxMessage ) == pdFALSE )
+				{
+					if( uxIndex == 0u )
+					{
+						lReturn = -pdFREERTOS_ERRNO_EINVAL;
+					}
+					break;
+				}
+
+				pxNetworkBuffer = prvUDPGatherMessage( pxMessage, xTicksToWait );
+
+				if( pxNetworkBuffer == NULL )
+				{
+					break;
+				}
+
+				if( prvUDPPrepareBuffer( pxSocket, pxNetworkBuffer, pxMessage->msg_name ) == pdFAIL )
+				{
+					vReleaseNetworkBufferAndDescriptor( pxNetworkBuffer );
+					break;
+				}
+
+				if( pxLastBuffer == NULL )
+				{
+					pxFirstBuffer = pxNetworkBuffer;
+				}
+				else
+				{
+					pxLastBuffer->pxNextBuffer = pxNetworkBuffer;
+				}
+				pxLastBuffer = pxNetworkBuffer;
+
+				pxMessages[ uxIndex ].msg_len = ( uint32_t ) pxNetworkBuffer->xDataLength;
+
+				if( xTaskCheckForTimeOut( &xTimeOut, &xTicksToWait ) != pdFALSE )
+				{
+					/* The entire block time has been used up. */
+					xTicksToWait = ( TickType_t ) 0;
+				}
+			}
+
+			if( pxFirstBuffer != NULL )
+			{
+				/* Ask the IP-task to send all packets. */
+				if( prvUDPSendToIPTask( eStackTxChainEvent, pxFirstBuffer, xTicksToWait ) != pdFAIL )
+				{
+					lReturn = ( int32_t ) uxIndex;
+
+					for( uxIndex = 0u; uxIndex < ( size_t ) lReturn; uxIndex++ )
+					{
+						prvUDPHandleSent( pxSocket, pxMessages[ uxIndex ].msg_len );
+					}
+				}
+				else
+				{
+					/* None of the packets were sent, release the chain. */
+					while( pxFirstBuffer != NULL )
+					{
+						pxNetworkBuffer = pxFirstBuffer;
+						pxFirstBuffer = pxFirstBuffer->pxNextBuffer;
+						vReleaseNetworkBufferAndDescriptor( pxNetworkBuffer );
+					}
+				}
+			}
+		}
+
+		return lReturn;
+	}
+
+#endif /* ipconfigSUPPORT_MSG_FUNCTIONS */
+/*-----------------------------------------------------------*/
+
+#if( ipconfigSUPPORT_MSG_FUNCTIONS == 1 )
+
+	/*
+	 * Receive up to 'uxMessageCount' datagrams from a UDP socket.  The call
+	 * blocks until at least one packet is available, and then takes all
+	 * waiting packets that fit in the array at once.  Returns the number of
+	 * messages received.  FREERTOS_MSG_PEEK is not supported.
+	 */
+	int32_t FreeRTOS_recvmmsg( Socket_t xSocket, struct freertos_mmsghdr *pxMessages, size_t uxMessageCount, BaseType_t xFlags )
+	{
+	FreeRTOS_Socket_t *pxSocket = ( FreeRTOS_Socket_t * ) xSocket;
+	NetworkBufferDescriptor_t *pxNetworkBuffer;
+	NetworkBufferDescriptor_t *pxFirstBuffer = NULL;
+	NetworkBufferDescriptor_t *pxLastBuffer = NULL;
+	struct freertos_msghdr *pxMessage;
+	EventBits_t xEventBits;
+	size_t uxCount = 0u;
+	size_t uxIndex;
+	int32_t lReturn;
+
+		if( ( prvValidSocket( pxSocket, FREERTOS_IPPROTO_UDP, pdTRUE ) == pdFALSE ) ||
+			( ( xFlags & ( FREERTOS_ZERO_COPY | FREERTOS_MSG_PEEK ) ) != 0 ) ||
+			( pxMessages == NULL ) || ( uxMessageCount == 0u ) )
+		{
+			return -pdFREERTOS_ERRNO_EINVAL;
+		}
+
+		if( prvUDPWaitForPacket( pxSocket, xFlags, &xEventBits ) != 0 )
+		{
+			/* Unlink as many packets as fit in one critical section, chaining
+			them through pxNextBuffer. */
+			taskENTER_CRITICAL();
+			{
+				while( ( uxCount < uxMessageCount ) &&
+					   ( listCURRENT_LIST_LENGTH( &( pxSocket->u.xUDP.xWaitingPacketsList ) ) != 0u ) )
+				{
+					pxNetworkBuffer = ( NetworkBufferDescriptor_t * ) listGET_OWNER_OF_HEAD_ENTRY( &( pxSocket->u.xUDP.xWaitingPacketsList ) );
+					uxListRemove( &( pxNetworkBuffer->xBufferListItem ) );
+					pxNetworkBuffer->pxNextBuffer = NULL;
+
+					if( pxLastBuffer == NULL )
+					{
+						pxFirstBuffer = pxNetworkBuffer;
+					}
+					else
+					{
+						pxLastBuffer->pxNextBuffer = pxNetworkBuffer;
+					}
+					pxLastBuffer = pxNetworkBuffer;
+					uxCount++;
+				}
+			}
+			taskEXIT_CRITICAL();
+
+			/* Copy the packets to the caller's fragments. */
+			for( uxIndex = 0u; uxIndex < uxCount; uxIndex++ )
+			{
+				pxNetworkBuffer = pxFirstBuffer;
+				pxFirstBuffer = pxFirstBuffer->pxNextBuffer;
+				pxNetworkBuffer->pxNextBuffer = NULL;
+				pxMessage = &( pxMessages[ uxIndex ].msg_hdr );
+				ipLATENCY_STAGE( pxNetworkBuffer, eLatencyRxSocket );
+
+				pxMessage->msg_flags = 0;
+
+				if( pxMessage->msg_name != NULL )
+				{
+					pxMessage->msg_name->sin_port = pxNetworkBuffer->usPort;
+					pxMessage->msg_name->sin_addr = pxNetworkBuffer->ulIPAddress;
+				}
+
+				pxMessages[ uxIndex ].msg_len = ( uint32_t ) prvUDPScatterMessage( pxMessage,
+					&( pxNetworkBuffer->pucEthernetBuffer[ ipUDP_PAYLOAD_OFFSET_IPv4 ] ), pxNetworkBuffer->xDataLength );
+
+				vReleaseNetworkBufferAndDescriptor( pxNetworkBuffer );
+			}
+
+			lReturn = ( int32_t ) uxCount;
+		}
+	#if( ipconfigSUPPORT_SIGNALS != 0 )
+		else if( ( xEventBits & eSOCKET_INTR ) != 0 )
+		{
+			lReturn = -pdFREERTOS_ERRNO_EINTR;
+			iptraceRECVFROM_INTERRUPTED();
+		}
+	#endif /* ipconfigSUPPORT_SIGNALS */
+		else
+		{
+			lReturn = -pdFREERTOS_ERRNO_EWOULDBLOCK;
+			iptraceRECVFROM_TIMEOUT();
+		}
+
+		return lReturn;
+	}
+
+#endif /* ipconfigSUPPORT_MSG_FUNCTIONS */
+/*-----------------------------------------------------------*/
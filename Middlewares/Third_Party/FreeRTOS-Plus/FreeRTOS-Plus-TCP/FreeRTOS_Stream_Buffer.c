@@ -152,6 +152,73 @@ size_t uxSpace, uxNextHead, uxFirst;
 }
 /*-----------------------------------------------------------*/
 
+/*
+ * prvStreamBufferSpans( )
+ * Describe 'uxCount' bytes starting at 'uxFirst' as at most two contiguous
+ * spans.
+ */
+static size_t prvStreamBufferSpans( StreamBuffer_t *pxBuffer, size_t uxFirst, size_t uxCount, StreamBufferSpan_t pxSpans[ 2 ] )
+{
+	if( uxFirst >= pxBuffer->LENGTH )
+	{
+		uxFirst -= pxBuffer->LENGTH;
+	}
+
+	pxSpans[ 0 ].pucData = pxBuffer->ucArray + uxFirst;
+	pxSpans[ 0 ].uxLength = FreeRTOS_min_uint32( pxBuffer->LENGTH - uxFirst, uxCount );
+
+	/* The remainder, if any, continues at the start of the buffer. */
+	pxSpans[ 1 ].pucData = pxBuffer->ucArray;
+	pxSpans[ 1 ].uxLength = uxCount - pxSpans[ 0 ].uxLength;
+
+	return uxCount;
+}
+/*-----------------------------------------------------------*/
+
+/*
+ * uxStreamBufferGetReadSpans( )
+ * The data between uxTail + uxOffset and uxHead, in place.
+ */
+size_t uxStreamBufferGetReadSpans( StreamBuffer_t *pxBuffer, size_t uxOffset, StreamBufferSpan_t pxSpans[ 2 ] )
+{
+size_t uxSize = uxStreamBufferGetSize( pxBuffer );
+
+	if( uxSize > uxOffset )
+	{
+		uxSize -= uxOffset;
+	}
+	else
+	{
+		uxOffset = uxSize;
+		uxSize = 0u;
+	}
+
+	return prvStreamBufferSpans( pxBuffer, pxBuffer->uxTail + uxOffset, uxSize, pxSpans );
+}
+/*-----------------------------------------------------------*/
+
+/*
+ * uxStreamBufferGetWriteSpans( )
+ * The free space between uxHead + uxOffset and uxTail, in place.
+ */
+size_t uxStreamBufferGetWriteSpans( StreamBuffer_t *pxBuffer, size_t uxOffset, StreamBufferSpan_t pxSpans[ 2 ] )
+{
+size_t uxSpace = uxStreamBufferGetSpace( pxBuffer );
+
+	if( uxSpace > uxOffset )
+	{
+		uxSpace -= uxOffset;
+	}
+	else
+	{
+		uxOffset = uxSpace;
+		uxSpace = 0u;
+	}
+
+	return prvStreamBufferSpans( pxBuffer, pxBuffer->uxHead + uxOffset, uxSpace, pxSpans );
+}
+/*-----------------------------------------------------------*/
+
 /*
  * uxStreamBufferGet( )
  * 'uxOffset' can be used to read data located at a certain offset from 'lTail'.
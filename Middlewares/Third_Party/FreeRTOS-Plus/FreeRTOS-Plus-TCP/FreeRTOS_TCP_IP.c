@@ -132,6 +132,9 @@ the defined MTU size can contain at ;east a complete TCP packet. */
 
 #define TCP_OPT_TIMESTAMP_LEN	10	/* fixed length of the time-stamp option */
 
+/* RFC 7323: a window scale factor larger than 14 must be treated as 14. */
+#define TCP_WSOPT_MAX_SHIFT		14u
+
 #ifndef ipconfigTCP_ACK_EARLIER_PACKET
 	#define ipconfigTCP_ACK_EARLIER_PACKET		1
 #endif
@@ -162,6 +165,12 @@ the defined MTU size can contain at ;east a complete TCP packet. */
 #define DELAYED_ACK_SHORT_DELAY_MS			( 2 )
 #define DELAYED_ACK_LONGER_DELAY_MS			( 20 )
 
+/*
+ * With FREERTOS_TCP_ACK_ADAPTIVE, a connection is considered to be in a bulk
+ * transfer after receiving this number of full-size segments in a row.
+ */
+#define DELAYED_ACK_BULK_SEGMENTS			( 2u )
+
 /*
  * The MSS (Maximum Segment Size) will be taken as large as possible. However, packets with
  * an MSS of 1460 bytes won't be transported through the internet.  The MSS will be reduced
@@ -328,6 +337,14 @@ static BaseType_t prvHandleSynReceived( FreeRTOS_Socket_t *pxSocket, NetworkBuff
 static BaseType_t prvHandleEstablished( FreeRTOS_Socket_t *pxSocket, NetworkBufferDescriptor_t **ppxNetworkBuffer,
 	uint32_t ulReceiveLength, UBaseType_t uxOptionsLength );
 
+/*
+ * Called from prvSendData() for every segment carrying data.  Applies the ACK
+ * policy of the socket and returns pdTRUE if the ACK may be delayed.
+ */
+#if( ipconfigUSE_TCP_WIN == 1 )
+	static BaseType_t prvTCPAckMayBeDelayed( FreeRTOS_Socket_t *pxSocket, uint32_t ulReceiveLength );
+#endif
+
 /*
  * Called from prvTCPHandleState().  There is data to be sent.
  * If ipconfigUSE_TCP_WIN is defined, and if only an ACK must be sent, it will
@@ -381,7 +398,31 @@ static NetworkBufferDescriptor_t *prvTCPBufferResize( FreeRTOS_Socket_t *pxSocke
 #endif
 
 #if( ipconfigUSE_TCP_WIN != 0 )
-	static uint8_t prvWinScaleFactor( FreeRTOS_Socket_t *pxSocket );
+	static uint8_t prvWinScaleFactor( FreeRTOS_Socket_t *pxSocket, UBaseType_t uxMSS );
+#endif
+
+/*
+ * The MSS that will be used for a peer: smaller when it is not on the local
+ * network.
+ */
+static uint16_t prvTCPPeerMSS( uint32_t ulRemoteIP );
+
+#if( ipconfigUSE_TCP_SYN_CACHE == 1 )
+	/*
+	 * Handles a packet for a listening socket that doesn't have 'bReuseSocket'
+	 * set.  A SYN is answered from the SYN cache, the final ACK of the
+	 * handshake creates the child socket, which is returned.
+	 */
+	static FreeRTOS_Socket_t *prvSynCacheInput( FreeRTOS_Socket_t *pxSocket, NetworkBufferDescriptor_t *pxNetworkBuffer );
+#endif
+
+#if( ipconfigUSE_TCP_TIME_WAIT == 1 )
+	/*
+	 * See if a packet belongs to a connection in the TIME_WAIT table, and
+	 * answer it if so.  Returns pdTRUE when the packet has been handled.
+	 */
+	static BaseType_t prvTCPTimeWaitInput( NetworkBufferDescriptor_t *pxNetworkBuffer, uint32_t ulRemoteIP,
+		uint16_t usLocalPort, uint16_t usRemotePort );
 #endif
 
 /*-----------------------------------------------------------*/
@@ -501,6 +542,17 @@ BaseType_t xTCPSocketCheck( FreeRTOS_Socket_t *pxSocket )
 BaseType_t xResult = 0;
 BaseType_t xReady = pdFALSE;
 
+	#if( ipconfigUSE_TCP_CONGESTION_CONTROL == 1 )
+	{
+		/* FreeRTOS_setsockopt() may have selected another algorithm. */
+		if( ( pxSocket->u.xTCP.xTCPWindow.u.bits.bHasInit != pdFALSE_UNSIGNED ) &&
+			( pxSocket->u.xTCP.xTCPWindow.xCongestion.ucAlgorithm != pxSocket->u.xTCP.ucCongestionControl ) )
+		{
+			( void ) xTCPWindowSetCongestionControl( &( pxSocket->u.xTCP.xTCPWindow ), ( BaseType_t ) pxSocket->u.xTCP.ucCongestionControl );
+		}
+	}
+	#endif /* ipconfigUSE_TCP_CONGESTION_CONTROL */
+
 	if( ( pxSocket->u.xTCP.ucTCPState >= eESTABLISHED ) && ( pxSocket->u.xTCP.txStream != NULL ) )
 	{
 		/* The API FreeRTOS_send() might have added data to the TX stream.  Add
@@ -733,7 +785,7 @@ NetworkBufferDescriptor_t xTempBuffer;
 	{
 		pxNetworkBuffer = &xTempBuffer;
 
-		#if( ipconfigUSE_LINKED_RX_MESSAGES != 0 )
+		#if( ipconfigUSE_LINKED_RX_MESSAGES != 0 ) || ( ipconfigSUPPORT_MSG_FUNCTIONS == 1 )
 		{
 			xTempBuffer.pxNextBuffer = NULL;
 		}
@@ -766,6 +818,12 @@ NetworkBufferDescriptor_t xTempBuffer;
 		/* Fill the packet, using hton translations. */
 		if( pxSocket != NULL )
 		{
+			#if( ipconfigUSE_TCP_WIN == 1 )
+			{
+				/* Every outgoing packet acknowledges all data received so far. */
+				pxSocket->u.xTCP.ucUnackedSegments = 0u;
+			}
+			#endif
 			/* Calculate the space in the RX buffer in order to advertise the
 			size of this socket's reception window. */
 			pxTCPWindow = &( pxSocket->u.xTCP.xTCPWindow );
@@ -803,8 +861,16 @@ NetworkBufferDescriptor_t xTempBuffer;
 				ulSpace = pxSocket->u.xTCP.usCurMSS;
 			}
 
-			/* Avoid overflow of the 16-bit win field. */
-			ulWinSize = ( ulSpace >> pxSocket->u.xTCP.ucMyWinScaleFactor );
+			/* Avoid overflow of the 16-bit win field.  The window of a SYN
+			segment is never scaled (RFC 7323). */
+			if( ( pxTCPPacket->xTCPHeader.ucTCPFlags & ipTCP_FLAG_SYN ) != 0u )
+			{
+				ulWinSize = ulSpace;
+			}
+			else
+			{
+				ulWinSize = ( ulSpace >> pxSocket->u.xTCP.ucMyWinScaleFactor );
+			}
 			if( ulWinSize > 0xfffcUL )
 			{
 				ulWinSize = 0xfffcUL;
@@ -933,7 +999,7 @@ NetworkBufferDescriptor_t xTempBuffer;
 		}
 		#endif
 
-	#if( ipconfigUSE_LINKED_RX_MESSAGES != 0 )
+	#if( ipconfigUSE_LINKED_RX_MESSAGES != 0 ) || ( ipconfigSUPPORT_MSG_FUNCTIONS == 1 )
 		pxNetworkBuffer->pxNextBuffer = NULL;
 	#endif
 
@@ -1003,6 +1069,16 @@ static void prvTCPCreateWindow( FreeRTOS_Socket_t *pxSocket )
 		pxSocket->u.xTCP.xTCPWindow.rx.ulCurrentSequenceNumber,
 		pxSocket->u.xTCP.xTCPWindow.ulOurSequenceNumber,
 		( uint32_t ) pxSocket->u.xTCP.usInitMSS );
+
+	/* The socket options which were set before the window existed. */
+	pxSocket->u.xTCP.xTCPWindow.u.bits.bSendFullSize = pxSocket->u.xTCP.bits.bCork;
+	pxSocket->u.xTCP.xTCPWindow.u.bits.bNagle = pxSocket->u.xTCP.bits.bNagle;
+
+	#if( ipconfigUSE_TCP_CONGESTION_CONTROL == 1 )
+	{
+		( void ) xTCPWindowSetCongestionControl( &pxSocket->u.xTCP.xTCPWindow, ( BaseType_t ) pxSocket->u.xTCP.ucCongestionControl );
+	}
+	#endif
 }
 /*-----------------------------------------------------------*/
 
@@ -1195,8 +1271,12 @@ UBaseType_t uxNewMSS;
 #if( ipconfigUSE_TCP_WIN != 0 )
 		else if( ( pucPtr[ 0 ] == TCP_OPT_WSOPT ) && ( pucPtr[ 1 ] == TCP_OPT_WSOPT_LEN ) )
 		{
-			pxSocket->u.xTCP.ucPeerWinScaleFactor = pucPtr[ 2 ];
-			pxSocket->u.xTCP.bits.bWinScaling = pdTRUE_UNSIGNED;
+			/* RFC 7323: the option is only valid in a SYN segment. */
+			if( ( pxTCPHeader->ucTCPFlags & ipTCP_FLAG_SYN ) != 0u )
+			{
+				pxSocket->u.xTCP.ucPeerWinScaleFactor = ( uint8_t ) FreeRTOS_min_uint32( pucPtr[ 2 ], TCP_WSOPT_MAX_SHIFT );
+				pxSocket->u.xTCP.bits.bWinScaling = pdTRUE_UNSIGNED;
+			}
 			pucPtr += TCP_OPT_WSOPT_LEN;
 		}
 #endif	/* ipconfigUSE_TCP_WIN */
@@ -1322,15 +1402,28 @@ UBaseType_t uxNewMSS;
 
 #if( ipconfigUSE_TCP_WIN != 0 )
 
-	static uint8_t prvWinScaleFactor( FreeRTOS_Socket_t *pxSocket )
+	static uint8_t prvWinScaleFactor( FreeRTOS_Socket_t *pxSocket, UBaseType_t uxMSS )
 	{
 	size_t uxWinSize;
 	uint8_t ucFactor;
 
 		/* 'xTCP.uxRxWinSize' is the size of the reception window in units of MSS. */
-		uxWinSize = pxSocket->u.xTCP.uxRxWinSize * ( size_t ) pxSocket->u.xTCP.usInitMSS;
+		uxWinSize = pxSocket->u.xTCP.uxRxWinSize * ( size_t ) uxMSS;
+
+		#if( ipconfigTCP_RX_AUTOTUNE == 1 )
+		{
+			/* The factor can only be exchanged in the SYN phase, so it must
+			already allow for the largest window that auto-tuning may give. */
+			if( ( pxSocket->u.xTCP.bits.bRxAutoTune != pdFALSE_UNSIGNED ) &&
+				( uxWinSize < ( ( size_t ) ipconfigTCP_RX_AUTOTUNE_MAX_LENGTH / 2u ) ) )
+			{
+				uxWinSize = ( size_t ) ipconfigTCP_RX_AUTOTUNE_MAX_LENGTH / 2u;
+			}
+		}
+		#endif /* ipconfigTCP_RX_AUTOTUNE */
+
 		ucFactor = 0u;
-		while( uxWinSize > 0xfffful )
+		while( ( uxWinSize > 0xfffful ) && ( ucFactor < TCP_WSOPT_MAX_SHIFT ) )
 		{
 			/* Divide by two and increase the binary factor by 1. */
 			uxWinSize >>= 1;
@@ -1339,7 +1432,7 @@ UBaseType_t uxNewMSS;
 
 		FreeRTOS_debug_printf( ( "prvWinScaleFactor: uxRxWinSize %lu MSS %lu Factor %u\n",
 			pxSocket->u.xTCP.uxRxWinSize,
-			pxSocket->u.xTCP.usInitMSS,
+			uxMSS,
 			ucFactor ) );
 
 		return ucFactor;
@@ -1369,8 +1462,16 @@ uint16_t usMSS = pxSocket->u.xTCP.usInitMSS;
 	pxTCPHeader->ucOptdata[ 3 ] = ( uint8_t ) ( usMSS & 0xffu );
 
 	#if( ipconfigUSE_TCP_WIN != 0 )
+	if( ( pxSocket->u.xTCP.ucTCPState == eSYN_FIRST ) && ( pxSocket->u.xTCP.bits.bWinScaling == pdFALSE_UNSIGNED ) )
+	{
+		/* RFC 7323: a SYN+ACK may only carry a scale factor when the peer
+		has sent one in its SYN. */
+		pxSocket->u.xTCP.ucMyWinScaleFactor = 0u;
+		uxOptionsLength = 4u;
+	}
+	else
 	{
-		pxSocket->u.xTCP.ucMyWinScaleFactor = prvWinScaleFactor( pxSocket );
+		pxSocket->u.xTCP.ucMyWinScaleFactor = prvWinScaleFactor( pxSocket, pxSocket->u.xTCP.usInitMSS );
 
 		pxTCPHeader->ucOptdata[ 4 ] = TCP_OPT_NOOP;
 		pxTCPHeader->ucOptdata[ 5 ] = ( uint8_t ) ( TCP_OPT_WSOPT );
@@ -1478,10 +1579,14 @@ BaseType_t bAfter  = ( BaseType_t ) NOW_CONNECTED( eTCPState );						/* Is it co
 				}
 				if( xParent != NULL )
 				{
-					if( xParent->u.xTCP.pxPeerSocket == NULL )
+					#if( ipconfigUSE_TCP_SYN_CACHE == 0 )
 					{
-						xParent->u.xTCP.pxPeerSocket = pxSocket;
+						if( xParent->u.xTCP.pxPeerSocket == NULL )
+						{
+							xParent->u.xTCP.pxPeerSocket = pxSocket;
+						}
 					}
+					#endif
 
 					xParent->xEventBits |= eSOCKET_ACCEPT;
 
@@ -1517,6 +1622,31 @@ BaseType_t bAfter  = ( BaseType_t ) NOW_CONNECTED( eTCPState );						/* Is it co
 
 				/* When true, this socket may be returned in a call to accept(). */
 				pxSocket->u.xTCP.bits.bPassAccept = pdTRUE_UNSIGNED;
+
+				#if( ipconfigUSE_TCP_SYN_CACHE == 1 )
+				{
+					if( ( xParent != NULL ) && ( xParent != pxSocket ) )
+					{
+						/* Append the child to the accept queue of its parent.
+						FreeRTOS_accept() takes it from the head of the queue. */
+						vTaskSuspendAll();
+						{
+							pxSocket->u.xTCP.pxAcceptNext = NULL;
+
+							if( xParent->u.xTCP.pxAcceptTail != NULL )
+							{
+								xParent->u.xTCP.pxAcceptTail->u.xTCP.pxAcceptNext = pxSocket;
+							}
+							else
+							{
+								xParent->u.xTCP.pxAcceptHead = pxSocket;
+							}
+							xParent->u.xTCP.pxAcceptTail = pxSocket;
+						}
+						xTaskResumeAll();
+					}
+				}
+				#endif /* ipconfigUSE_TCP_SYN_CACHE */
 			}
 			else
 			{
@@ -2034,6 +2164,14 @@ uint32_t ulAckNr = FreeRTOS_ntohl( pxTCPHeader->ulAckNr );
 				/* This is the third of the three-way hand shake: the last
 				ACK. */
 				pxTCPHeader->ucTCPFlags = ipTCP_FLAG_ACK;
+
+				#if( ipconfigUSE_TCP_TIME_WAIT == 1 )
+				{
+					/* This side is in TIME_WAIT now.  The table will answer a
+					repeated FIN, also after the socket has been closed. */
+					vTCPTimeWaitAdd( pxSocket );
+				}
+				#endif /* ipconfigUSE_TCP_TIME_WAIT */
 			}
 			else
 			{
@@ -2349,6 +2487,8 @@ BaseType_t xSendLength = 0;
 			synchronisation. */
 			vTCPWindowInit( &pxSocket->u.xTCP.xTCPWindow,
 				ulSequenceNumber, pxSocket->u.xTCP.xTCPWindow.ulOurSequenceNumber, ( uint32_t ) pxSocket->u.xTCP.usCurMSS );
+			pxTCPWindow->u.bits.bSendFullSize = pxSocket->u.xTCP.bits.bCork;
+			pxTCPWindow->u.bits.bNagle = pxSocket->u.xTCP.bits.bNagle;
 			pxTCPWindow->rx.ulCurrentSequenceNumber = pxTCPWindow->rx.ulHighestSequenceNumber = ulSequenceNumber + 1u;
 			pxTCPWindow->tx.ulCurrentSequenceNumber++; /* because we send a TCP_SYN [ | TCP_ACK ]; */
 			pxTCPWindow->ulNextTxSequenceNumber++;
@@ -2414,14 +2554,44 @@ uint8_t ucTCPFlags = pxTCPHeader->ucTCPFlags;
 uint32_t ulSequenceNumber = FreeRTOS_ntohl( pxTCPHeader->ulSequenceNumber ), ulCount;
 BaseType_t xSendLength = 0, xMayClose = pdFALSE, bRxComplete, bTxDone;
 int32_t lDistance, lSendResult;
+#if( ( ipconfigUSE_TCP_CONGESTION_CONTROL == 1 ) || ( ipconfigUSE_TCP_METRICS == 1 ) )
+	uint32_t ulPreviousWindowSize = pxSocket->u.xTCP.ulWindowSize;
+#endif
 
 	/* Remember the window size the peer is advertising. */
 	pxSocket->u.xTCP.ulWindowSize = FreeRTOS_ntohs( pxTCPHeader->usWindow );
 	pxSocket->u.xTCP.ulWindowSize =
 		( pxSocket->u.xTCP.ulWindowSize << pxSocket->u.xTCP.ucPeerWinScaleFactor );
 
+	#if( ipconfigUSE_TCP_METRICS == 1 )
+	{
+		/* The peer closes its window while there is data to be delivered:
+		transmission stalls until it opens the window again. */
+		if( ( pxSocket->u.xTCP.ulWindowSize == 0u ) && ( ulPreviousWindowSize != 0u ) &&
+			( pxSocket->u.xTCP.txStream != NULL ) && ( uxStreamBufferGetSize( pxSocket->u.xTCP.txStream ) != 0u ) )
+		{
+			pxTCPWindow->xStats.ulZeroWindowStalls++;
+		}
+	}
+	#endif /* ipconfigUSE_TCP_METRICS */
+
 	if( ( ucTCPFlags & ( uint8_t ) ipTCP_FLAG_ACK ) != 0u )
 	{
+		#if( ipconfigUSE_TCP_CONGESTION_CONTROL == 1 )
+		{
+			/* A duplicate ACK as defined in RFC 5681: no data, no SYN/FIN, the
+			same acknowledgement number and the same window as before.  Peers
+			without SACK can only report a loss in this way. */
+			if( ( ulReceiveLength == 0u ) &&
+				( ( ucTCPFlags & ( uint8_t ) ( ipTCP_FLAG_SYN | ipTCP_FLAG_FIN ) ) == 0u ) &&
+				( FreeRTOS_ntohl( pxTCPHeader->ulAckNr ) == pxTCPWindow->tx.ulCurrentSequenceNumber ) &&
+				( pxSocket->u.xTCP.ulWindowSize == ulPreviousWindowSize ) )
+			{
+				vTCPWindowTxDuplicateAck( pxTCPWindow );
+			}
+		}
+		#endif /* ipconfigUSE_TCP_CONGESTION_CONTROL */
+
 		ulCount = ulTCPWindowTxAck( pxTCPWindow, FreeRTOS_ntohl( pxTCPPacket->xTCPHeader.ulAckNr ) );
 
 		/* ulTCPWindowTxAck() returns the number of bytes which have been acked,
@@ -2555,6 +2725,60 @@ int32_t lDistance, lSendResult;
 }
 /*-----------------------------------------------------------*/
 
+#if( ipconfigUSE_TCP_WIN == 1 )
+
+	static BaseType_t prvTCPAckMayBeDelayed( FreeRTOS_Socket_t *pxSocket, uint32_t ulReceiveLength )
+	{
+	BaseType_t xReturn;
+
+		/* A full-size segment is probably part of a bulk transfer, a smaller
+		one normally ends a message to which the peer expects an answer. */
+		if( ulReceiveLength >= ( uint32_t ) pxSocket->u.xTCP.usCurMSS )
+		{
+			if( pxSocket->u.xTCP.ucBulkSegments < 0xffu )
+			{
+				pxSocket->u.xTCP.ucBulkSegments++;
+			}
+		}
+		else
+		{
+			pxSocket->u.xTCP.ucBulkSegments = 0u;
+		}
+
+		if( pxSocket->u.xTCP.ucUnackedSegments < 0xffu )
+		{
+			pxSocket->u.xTCP.ucUnackedSegments++;
+		}
+
+		switch( pxSocket->u.xTCP.ucAckPolicy )
+		{
+			case FREERTOS_TCP_ACK_QUICK:
+				xReturn = pdFALSE;
+				break;
+
+			case FREERTOS_TCP_ACK_ADAPTIVE:
+				/* Interactive traffic gets an immediate ACK, so that the peer's
+				Nagle algorithm doesn't have to wait for a delayed ACK. */
+				xReturn = ( pxSocket->u.xTCP.ucBulkSegments >= DELAYED_ACK_BULK_SEGMENTS ) ? pdTRUE : pdFALSE;
+				break;
+
+			default:
+				xReturn = pdTRUE;
+				break;
+		}
+
+		/* Don't let too many segments go unacknowledged. */
+		if( ( pxSocket->u.xTCP.ucAckSegments != 0u ) && ( pxSocket->u.xTCP.ucUnackedSegments >= pxSocket->u.xTCP.ucAckSegments ) )
+		{
+			xReturn = pdFALSE;
+		}
+
+		return xReturn;
+	}
+
+#endif /* ipconfigUSE_TCP_WIN */
+/*-----------------------------------------------------------*/
+
 /*
  * Called from prvTCPHandleState().  There is data to be sent.  If
  * ipconfigUSE_TCP_WIN is defined, and if only an ACK must be sent, it will be
@@ -2606,6 +2830,7 @@ int32_t lRxSpace;
 		/* In case we're receiving data continuously, we might postpone sending
 		an ACK to gain performance. */
 		if( ( ulReceiveLength > 0 ) &&							/* Data was sent to this socket. */
+			( prvTCPAckMayBeDelayed( pxSocket, ulReceiveLength ) != pdFALSE ) &&	/* The ACK policy allows a delay. */
 			( lRxSpace >= lMinLength ) &&						/* There is Rx space for more data. */
 			( pxSocket->u.xTCP.bits.bFinSent == pdFALSE_UNSIGNED ) &&	/* Not in a closure phase. */
 			( xSendLength == ( ipSIZE_OF_IPv4_HEADER + ipSIZE_OF_TCP_HEADER ) ) && /* No Tx data or options to be sent. */
@@ -2908,17 +3133,25 @@ static BaseType_t prvTCPSendReset( NetworkBufferDescriptor_t *pxNetworkBuffer )
 }
 /*-----------------------------------------------------------*/
 
-static void prvSocketSetMSS( FreeRTOS_Socket_t *pxSocket )
+static uint16_t prvTCPPeerMSS( uint32_t ulRemoteIP )
 {
 uint32_t ulMSS = ipconfigTCP_MSS;
 
-	if( ( ( FreeRTOS_ntohl( pxSocket->u.xTCP.ulRemoteIP ) ^ *ipLOCAL_IP_ADDRESS_POINTER ) & xNetworkAddressing.ulNetMask ) != 0ul )
+	if( ( ( FreeRTOS_ntohl( ulRemoteIP ) ^ *ipLOCAL_IP_ADDRESS_POINTER ) & xNetworkAddressing.ulNetMask ) != 0ul )
 	{
 		/* Data for this peer will pass through a router, and maybe through
 		the internet.  Limit the MSS to 1400 bytes or less. */
 		ulMSS = FreeRTOS_min_uint32( ( uint32_t ) REDUCED_MSS_THROUGH_INTERNET, ulMSS );
 	}
 
+	return ( uint16_t ) ulMSS;
+}
+/*-----------------------------------------------------------*/
+
+static void prvSocketSetMSS( FreeRTOS_Socket_t *pxSocket )
+{
+uint32_t ulMSS = ( uint32_t ) prvTCPPeerMSS( pxSocket->u.xTCP.ulRemoteIP );
+
 	FreeRTOS_debug_printf( ( "prvSocketSetMSS: %lu bytes for %lxip:%u\n", ulMSS, pxSocket->u.xTCP.ulRemoteIP, pxSocket->u.xTCP.usRemotePort ) );
 
 	pxSocket->u.xTCP.usInitMSS = pxSocket->u.xTCP.usCurMSS = ( uint16_t ) ulMSS;
@@ -2951,6 +3184,18 @@ BaseType_t xResult = pdPASS;
 	the destination PORT. */
 	pxSocket = ( FreeRTOS_Socket_t * ) pxTCPSocketLookup( ulLocalIP, xLocalPort, ulRemoteIP, xRemotePort );
 
+	#if( ipconfigUSE_TCP_TIME_WAIT == 1 )
+	if( ( ( pxSocket == NULL ) ||
+		  ( pxSocket->u.xTCP.ucTCPState == eTCP_LISTEN ) ||
+		  ( prvTCPSocketIsActive( ( UBaseType_t ) pxSocket->u.xTCP.ucTCPState ) == pdFALSE ) ) &&
+		( prvTCPTimeWaitInput( pxNetworkBuffer, ulRemoteIP, xLocalPort, xRemotePort ) != pdFALSE ) )
+	{
+		/* The connection has been closed, the TIME_WAIT table has answered
+		the packet. */
+		xResult = pdFAIL;
+	}
+	else
+	#endif /* ipconfigUSE_TCP_TIME_WAIT */
 	if( ( pxSocket == NULL ) || ( prvTCPSocketIsActive( ( UBaseType_t ) pxSocket->u.xTCP.ucTCPState ) == pdFALSE ) )
 	{
 		/* A TCP messages is received but either there is no socket with the
@@ -2981,6 +3226,20 @@ BaseType_t xResult = pdPASS;
 
 		if( pxSocket->u.xTCP.ucTCPState == eTCP_LISTEN )
 		{
+			#if( ipconfigUSE_TCP_SYN_CACHE == 1 )
+			if( pxSocket->u.xTCP.bits.bReuseSocket == pdFALSE_UNSIGNED )
+			{
+				/* The handshake is done by the SYN cache.  A new socket is
+				returned when the final ACK has been received. */
+				pxSocket = prvSynCacheInput( pxSocket, pxNetworkBuffer );
+
+				if( pxSocket == NULL )
+				{
+					xResult = pdFAIL;
+				}
+			}
+			else
+			#endif /* ipconfigUSE_TCP_SYN_CACHE */
 			/* The matching socket is in a listening state.  Test if the peer
 			has set the SYN flag. */
 			if( ( ucTCPFlags & ipTCP_FLAG_CTRL ) != ipTCP_FLAG_SYN )
@@ -3068,8 +3327,12 @@ BaseType_t xResult = pdPASS;
 		#if( ipconfigUSE_TCP_WIN == 1 )
 		{
 			pxSocket->u.xTCP.ulWindowSize = FreeRTOS_ntohs( pxTCPPacket->xTCPHeader.usWindow );
-			pxSocket->u.xTCP.ulWindowSize =
-				( pxSocket->u.xTCP.ulWindowSize << pxSocket->u.xTCP.ucPeerWinScaleFactor );
+			if( ( ucTCPFlags & ipTCP_FLAG_SYN ) == 0u )
+			{
+				/* The window of a SYN segment is never scaled (RFC 7323). */
+				pxSocket->u.xTCP.ulWindowSize =
+					( pxSocket->u.xTCP.ulWindowSize << pxSocket->u.xTCP.ucPeerWinScaleFactor );
+			}
 		}
 		#endif
 
@@ -3182,6 +3445,609 @@ FreeRTOS_Socket_t *pxReturn;
 }
 /*-----------------------------------------------------------*/
 
+#if( ipconfigUSE_TCP_SYN_CACHE == 1 )
+
+	/* A connection request that has been answered with a SYN+ACK, but of which
+	the final ACK has not been received yet.  The child socket will only be
+	created when that ACK arrives. */
+	typedef struct xSYN_CACHE_ENTRY
+	{
+		uint32_t ulRemoteIP;		/* IP address of the peer, host-endian. */
+		uint32_t ulPeerSequence;	/* Initial sequence number of the peer. */
+		uint32_t ulOurSequence;		/* Initial sequence number sent in the SYN+ACK. */
+		TickType_t xCreationTime;	/* Time at which the SYN was received. */
+		uint16_t usRemotePort;		/* Port number of the peer, host-endian. */
+		uint16_t usLocalPort;		/* Port number of the listening socket, 0 for a free entry. */
+		uint16_t usMSS;				/* The MSS sent in the SYN+ACK. */
+		uint8_t ucPeerWinScale;		/* Scale factor sent by the peer, or SYN_CACHE_NO_WSOPT. */
+		uint8_t ucMyWinScale;		/* Scale factor sent in the SYN+ACK. */
+	} SynCacheEntry_t;
+
+	#define SYN_CACHE_NO_WSOPT			( 0xffu )
+
+	static SynCacheEntry_t xSynCache[ ipconfigTCP_SYN_CACHE_ENTRIES ];
+
+	/*
+	 * Find the entry of a half-open connection.  Entries that have expired are
+	 * freed on the way.
+	 */
+	static SynCacheEntry_t *prvSynCacheLookup( uint16_t usLocalPort, uint32_t ulRemoteIP, uint16_t usRemotePort )
+	{
+	SynCacheEntry_t *pxEntry;
+	SynCacheEntry_t *pxReturn = NULL;
+	TickType_t xNow = xTaskGetTickCount();
+
+		for( pxEntry = xSynCache; pxEntry < &( xSynCache[ ipconfigTCP_SYN_CACHE_ENTRIES ] ); pxEntry++ )
+		{
+			if( pxEntry->usLocalPort == 0u )
+			{
+				/* A free entry. */
+			}
+			else if( ( xNow - pxEntry->xCreationTime ) >= pdMS_TO_TICKS( ipconfigTCP_SYN_CACHE_TIMEOUT_MS ) )
+			{
+				/* The final ACK never came. */
+				pxEntry->usLocalPort = 0u;
+			}
+			else if( ( pxEntry->usLocalPort == usLocalPort ) &&
+					 ( pxEntry->ulRemoteIP == ulRemoteIP ) &&
+					 ( pxEntry->usRemotePort == usRemotePort ) )
+			{
+				pxReturn = pxEntry;
+			}
+		}
+
+		return pxReturn;
+	}
+	/*-----------------------------------------------------------*/
+
+	/*
+	 * Find a free entry.  When all entries are in use, the oldest one is
+	 * recycled: a burst of SYN's will never use more than the cache.
+	 */
+	static SynCacheEntry_t *prvSynCacheAllocate( void )
+	{
+	SynCacheEntry_t *pxEntry;
+	SynCacheEntry_t *pxReturn = xSynCache;
+	TickType_t xNow = xTaskGetTickCount();
+
+		for( pxEntry = xSynCache; pxEntry < &( xSynCache[ ipconfigTCP_SYN_CACHE_ENTRIES ] ); pxEntry++ )
+		{
+			if( pxEntry->usLocalPort == 0u )
+			{
+				pxReturn = pxEntry;
+				break;
+			}
+
+			if( ( xNow - pxEntry->xCreationTime ) > ( xNow - pxReturn->xCreationTime ) )
+			{
+				pxReturn = pxEntry;
+			}
+		}
+
+		if( pxReturn->usLocalPort != 0u )
+		{
+			FreeRTOS_debug_printf( ( "SYN cache: full, drop %lxip:%u\n", pxReturn->ulRemoteIP, pxReturn->usRemotePort ) );
+		}
+
+		return pxReturn;
+	}
+	/*-----------------------------------------------------------*/
+
+	/*
+	 * Read the MSS and the window scale option from a SYN.
+	 */
+	static void prvSynCacheOptions( const TCPHeader_t *pxTCPHeader, uint16_t *pusPeerMSS, uint8_t *pucPeerWinScale )
+	{
+	const uint8_t *pucPtr = pxTCPHeader->ucOptdata;
+	const uint8_t *pucLast = pucPtr;
+	UBaseType_t uxLength;
+
+		*pusPeerMSS = 0u;
+		*pucPeerWinScale = SYN_CACHE_NO_WSOPT;
+
+		if( ( pxTCPHeader->ucTCPOffset & TCP_OFFSET_LENGTH_BITS ) > TCP_OFFSET_STANDARD_LENGTH )
+		{
+			pucLast += ( ( ( pxTCPHeader->ucTCPOffset >> 4 ) - 5 ) << 2 );
+		}
+
+		while( pucPtr < pucLast )
+		{
+			if( pucPtr[ 0 ] == TCP_OPT_END )
+			{
+				break;
+			}
+
+			if( pucPtr[ 0 ] == TCP_OPT_NOOP )
+			{
+				pucPtr++;
+			}
+			else
+			{
+				/* All other options have a length field.  Stop at malformed
+				options. */
+				uxLength = ( ( pucPtr + 1 ) < pucLast ) ? ( UBaseType_t ) pucPtr[ 1 ] : 0u;
+				if( ( uxLength < 2u ) || ( ( pucPtr + uxLength ) > pucLast ) )
+				{
+					break;
+				}
+
+				if( ( pucPtr[ 0 ] == TCP_OPT_MSS ) && ( uxLength == TCP_OPT_MSS_LEN ) )
+				{
+					*pusPeerMSS = usChar2u16( pucPtr + 2 );
+				}
+				#if( ipconfigUSE_TCP_WIN != 0 )
+				else if( ( pucPtr[ 0 ] == TCP_OPT_WSOPT ) && ( uxLength == TCP_OPT_WSOPT_LEN ) )
+				{
+					*pucPeerWinScale = ( uint8_t ) FreeRTOS_min_uint32( pucPtr[ 2 ], TCP_WSOPT_MAX_SHIFT );
+				}
+				#endif /* ipconfigUSE_TCP_WIN */
+
+				pucPtr += uxLength;
+			}
+		}
+	}
+	/*-----------------------------------------------------------*/
+
+	/*
+	 * Answer a SYN with a SYN+ACK.  A repeated SYN gets the same answer as
+	 * the first one.
+	 */
+	static void prvSynCacheSendSynAck( FreeRTOS_Socket_t *pxSocket, NetworkBufferDescriptor_t *pxNetworkBuffer, SynCacheEntry_t *pxEntry )
+	{
+	TCPPacket_t *pxTCPPacket = ( TCPPacket_t * ) ( pxNetworkBuffer->pucEthernetBuffer );
+	uint32_t ulPeerSequence = FreeRTOS_ntohl( pxTCPPacket->xTCPHeader.ulSequenceNumber );
+	NetworkBufferDescriptor_t *pxReply;
+	TCPHeader_t *pxTCPHeader;
+	uint16_t usPeerMSS;
+	uint8_t ucPeerWinScale;
+	UBaseType_t uxOptionsLength;
+	size_t uxNeeded;
+	uint32_t ulSpace;
+
+		if( ( pxEntry == NULL ) || ( pxEntry->ulPeerSequence != ulPeerSequence ) )
+		{
+			/* Not a repetition: a new connection request. */
+			if( pxEntry == NULL )
+			{
+				pxEntry = prvSynCacheAllocate();
+			}
+
+			prvSynCacheOptions( &( pxTCPPacket->xTCPHeader ), &usPeerMSS, &ucPeerWinScale );
+
+			pxEntry->ulRemoteIP = FreeRTOS_ntohl( pxTCPPacket->xIPHeader.ulSourceIPAddress );
+			pxEntry->usRemotePort = FreeRTOS_ntohs( pxTCPPacket->xTCPHeader.usSourcePort );
+			pxEntry->usLocalPort = ( uint16_t ) pxSocket->usLocalPort;
+			pxEntry->ulPeerSequence = ulPeerSequence;
+			pxEntry->ulOurSequence = ulNextInitialSequenceNumber;
+			pxEntry->xCreationTime = xTaskGetTickCount();
+
+			/* It is recommended to increase the ISS for each new connection with a value of 0x102. */
+			ulNextInitialSequenceNumber += INITIAL_SEQUENCE_NUMBER_INCREMENT;
+
+			/* Advertise the smallest of the two MSS's, as prvCheckOptions()
+			would do for a socket. */
+			pxEntry->usMSS = prvTCPPeerMSS( FreeRTOS_htonl( pxEntry->ulRemoteIP ) );
+			if( ( usPeerMSS != 0u ) && ( usPeerMSS < pxEntry->usMSS ) )
+			{
+				pxEntry->usMSS = usPeerMSS;
+			}
+
+			pxEntry->ucPeerWinScale = ucPeerWinScale;
+			pxEntry->ucMyWinScale = 0u;
+
+			#if( ipconfigUSE_TCP_WIN != 0 )
+			{
+				/* The child socket inherits the window sizes of the listening
+				socket, so the factor can be calculated for it already. */
+				if( ucPeerWinScale != SYN_CACHE_NO_WSOPT )
+				{
+					pxEntry->ucMyWinScale = prvWinScaleFactor( pxSocket, pxEntry->usMSS );
+				}
+			}
+			#endif /* ipconfigUSE_TCP_WIN */
+		}
+
+		/* The options as written by prvSetSynAckOptions(): MSS, window scaling
+		if the peer sent it, and SACK permitted. */
+		uxOptionsLength = 4u;
+		#if( ipconfigUSE_TCP_WIN != 0 )
+		{
+			if( pxEntry->ucPeerWinScale != SYN_CACHE_NO_WSOPT )
+			{
+				uxOptionsLength += 4u;
+			}
+			uxOptionsLength += 4u;
+		}
+		#endif /* ipconfigUSE_TCP_WIN */
+
+		/* The reply is made in the SYN's network buffer, unless that is too
+		small to hold the options. */
+		uxNeeded = ( size_t ) ( ipSIZE_OF_ETH_HEADER + ipSIZE_OF_IPv4_HEADER + ipSIZE_OF_TCP_HEADER ) + uxOptionsLength;
+		if( pxNetworkBuffer->xDataLength >= uxNeeded )
+		{
+			pxReply = pxNetworkBuffer;
+		}
+		else
+		{
+			pxReply = pxDuplicateNetworkBufferWithDescriptor( pxNetworkBuffer, ( BaseType_t ) uxNeeded );
+		}
+
+		if( pxReply != NULL )
+		{
+			pxTCPHeader = &( ( ( TCPPacket_t * ) ( pxReply->pucEthernetBuffer ) )->xTCPHeader );
+
+			pxTCPHeader->ucOptdata[ 0 ] = ( uint8_t ) TCP_OPT_MSS;
+			pxTCPHeader->ucOptdata[ 1 ] = ( uint8_t ) TCP_OPT_MSS_LEN;
+			pxTCPHeader->ucOptdata[ 2 ] = ( uint8_t ) ( pxEntry->usMSS >> 8 );
+			pxTCPHeader->ucOptdata[ 3 ] = ( uint8_t ) ( pxEntry->usMSS & 0xffu );
+
+			#if( ipconfigUSE_TCP_WIN != 0 )
+			{
+			UBaseType_t uxIndex = 4u;
+
+				if( pxEntry->ucPeerWinScale != SYN_CACHE_NO_WSOPT )
+				{
+					pxTCPHeader->ucOptdata[ 4 ] = TCP_OPT_NOOP;
+					pxTCPHeader->ucOptdata[ 5 ] = ( uint8_t ) ( TCP_OPT_WSOPT );
+					pxTCPHeader->ucOptdata[ 6 ] = ( uint8_t ) ( TCP_OPT_WSOPT_LEN );
+					pxTCPHeader->ucOptdata[ 7 ] = pxEntry->ucMyWinScale;
+					uxIndex = 8u;
+				}
+				pxTCPHeader->ucOptdata[ uxIndex + 0 ] = TCP_OPT_NOOP;
+				pxTCPHeader->ucOptdata[ uxIndex + 1 ] = TCP_OPT_NOOP;
+				pxTCPHeader->ucOptdata[ uxIndex + 2 ] = TCP_OPT_SACK_P;	/* 4: Sack-Permitted Option. */
+				pxTCPHeader->ucOptdata[ uxIndex + 3 ] = 2u;	/* 2: length of this option. */
+			}
+			#endif /* ipconfigUSE_TCP_WIN */
+
+			/* The window that the child socket will have, never scaled in a
+			SYN segment. */
+			ulSpace = FreeRTOS_min_uint32( ( uint32_t ) ( pxSocket->u.xTCP.uxRxWinSize * pxEntry->usMSS ),
+				( uint32_t ) pxSocket->u.xTCP.uxRxStreamSize );
+			ulSpace = FreeRTOS_min_uint32( ulSpace, 0xfffcUL );
+			pxTCPHeader->usWindow = FreeRTOS_htons( ( uint16_t ) ulSpace );
+
+			pxTCPHeader->ucTCPFlags = ipTCP_FLAG_SYN | ipTCP_FLAG_ACK;
+			pxTCPHeader->ucTCPOffset = ( uint8_t ) ( ( ipSIZE_OF_TCP_HEADER + uxOptionsLength ) << 2 );
+
+			/* Without a socket, prvTCPReturnPacket() swaps the sequence and the
+			ACK number. */
+			pxTCPHeader->ulSequenceNumber = FreeRTOS_htonl( pxEntry->ulPeerSequence + 1u );
+			pxTCPHeader->ulAckNr = FreeRTOS_htonl( pxEntry->ulOurSequence );
+
+			prvTCPReturnPacket( NULL, pxReply, ( uint32_t ) ( ipSIZE_OF_IPv4_HEADER + ipSIZE_OF_TCP_HEADER + uxOptionsLength ),
+				( pxReply != pxNetworkBuffer ) ? pdTRUE : pdFALSE );
+		}
+	}
+	/*-----------------------------------------------------------*/
+
+	/*
+	 * The final ACK of a handshake has been received: create the child
+	 * socket, in the state that it would have after sending a SYN+ACK.
+	 */
+	static FreeRTOS_Socket_t *prvSynCacheComplete( FreeRTOS_Socket_t *pxSocket, NetworkBufferDescriptor_t *pxNetworkBuffer, SynCacheEntry_t *pxEntry )
+	{
+	TCPPacket_t *pxTCPPacket = ( TCPPacket_t * ) ( pxNetworkBuffer->pucEthernetBuffer );
+	FreeRTOS_Socket_t *pxReturn = NULL;
+	FreeRTOS_Socket_t *pxNewSocket;
+	TCPWindow_t *pxTCPWindow;
+
+		if( ( ( pxTCPPacket->xTCPHeader.ucTCPFlags & 0x17u ) != ipTCP_FLAG_ACK ) ||
+			( FreeRTOS_ntohl( pxTCPPacket->xTCPHeader.ulAckNr ) != ( pxEntry->ulOurSequence + 1u ) ) )
+		{
+			/* Not the ACK that was expected in eSYN_RECEIVED. */
+			FreeRTOS_debug_printf( ( "SYN cache: flags %02X from %lxip:%u, no ACK of SYN+ACK\n",
+				pxTCPPacket->xTCPHeader.ucTCPFlags, pxEntry->ulRemoteIP, pxEntry->usRemotePort ) );
+			prvTCPSendReset( pxNetworkBuffer );
+		}
+		else if( pxSocket->u.xTCP.usChildCount >= pxSocket->u.xTCP.usBacklog )
+		{
+			FreeRTOS_printf( ( "Check: Socket %u already has %u / %u child%s\n",
+				pxSocket->usLocalPort,
+				pxSocket->u.xTCP.usChildCount,
+				pxSocket->u.xTCP.usBacklog,
+				pxSocket->u.xTCP.usChildCount == 1 ? "" : "ren" ) );
+			prvTCPSendReset( pxNetworkBuffer );
+			pxEntry->usLocalPort = 0u;
+		}
+		else
+		{
+			pxNewSocket = ( FreeRTOS_Socket_t * ) FreeRTOS_socket( FREERTOS_AF_INET, FREERTOS_SOCK_STREAM, FREERTOS_IPPROTO_TCP );
+
+			if( ( pxNewSocket == NULL ) || ( pxNewSocket == FREERTOS_INVALID_SOCKET ) )
+			{
+				FreeRTOS_debug_printf( ( "TCP: Listen: new socket failed\n" ) );
+				prvTCPSendReset( pxNetworkBuffer );
+			}
+			else if( prvTCPSocketCopy( pxNewSocket, pxSocket ) != pdFALSE )
+			{
+				pxTCPWindow = &( pxNewSocket->u.xTCP.xTCPWindow );
+
+				pxNewSocket->u.xTCP.usRemotePort = pxEntry->usRemotePort;
+				pxNewSocket->u.xTCP.ulRemoteIP = pxEntry->ulRemoteIP;
+				pxTCPWindow->ulOurSequenceNumber = pxEntry->ulOurSequence;
+				pxTCPWindow->rx.ulCurrentSequenceNumber = pxEntry->ulPeerSequence;
+				prvSocketSetMSS( pxNewSocket );
+
+				if( pxEntry->usMSS < pxNewSocket->u.xTCP.usInitMSS )
+				{
+					/* The peer's MSS was smaller. */
+					pxNewSocket->u.xTCP.usInitMSS = pxNewSocket->u.xTCP.usCurMSS = pxEntry->usMSS;
+					pxNewSocket->u.xTCP.bits.bMssChange = pdTRUE_UNSIGNED;
+				}
+
+				#if( ipconfigUSE_TCP_WIN != 0 )
+				{
+					if( pxEntry->ucPeerWinScale != SYN_CACHE_NO_WSOPT )
+					{
+						pxNewSocket->u.xTCP.bits.bWinScaling = pdTRUE_UNSIGNED;
+						pxNewSocket->u.xTCP.ucPeerWinScaleFactor = pxEntry->ucPeerWinScale;
+						pxNewSocket->u.xTCP.ucMyWinScaleFactor = pxEntry->ucMyWinScale;
+					}
+				}
+				#endif /* ipconfigUSE_TCP_WIN */
+
+				prvTCPCreateWindow( pxNewSocket );
+
+				/* The SYN+ACK has been sent, as in prvTCPHandleState() for
+				eSYN_FIRST.  The ACK will be handled in eSYN_RECEIVED. */
+				vTCPStateChange( pxNewSocket, eSYN_RECEIVED );
+				pxTCPWindow->rx.ulCurrentSequenceNumber = pxTCPWindow->rx.ulHighestSequenceNumber = pxEntry->ulPeerSequence + 1u;
+				pxTCPWindow->tx.ulCurrentSequenceNumber = pxTCPWindow->ulNextTxSequenceNumber = pxTCPWindow->tx.ulFirstSequenceNumber + 1u;
+
+				/* Make a copy of the header up to the TCP header.  It is needed later
+				on, whenever data must be sent to the peer. */
+				memcpy( pxNewSocket->u.xTCP.xPacket.u.ucLastPacket, pxNetworkBuffer->pucEthernetBuffer, sizeof( pxNewSocket->u.xTCP.xPacket.u.ucLastPacket ) );
+
+				pxReturn = pxNewSocket;
+			}
+
+			/* The half-open connection has been completed, or it failed. */
+			pxEntry->usLocalPort = 0u;
+		}
+
+		return pxReturn;
+	}
+	/*-----------------------------------------------------------*/
+
+	static FreeRTOS_Socket_t *prvSynCacheInput( FreeRTOS_Socket_t *pxSocket, NetworkBufferDescriptor_t *pxNetworkBuffer )
+	{
+	TCPPacket_t *pxTCPPacket = ( TCPPacket_t * ) ( pxNetworkBuffer->pucEthernetBuffer );
+	uint8_t ucTCPFlags = pxTCPPacket->xTCPHeader.ucTCPFlags;
+	SynCacheEntry_t *pxEntry;
+	FreeRTOS_Socket_t *pxReturn = NULL;
+
+		pxEntry = prvSynCacheLookup( ( uint16_t ) pxSocket->usLocalPort,
+			FreeRTOS_ntohl( pxTCPPacket->xIPHeader.ulSourceIPAddress ),
+			FreeRTOS_ntohs( pxTCPPacket->xTCPHeader.usSourcePort ) );
+
+		if( ( ucTCPFlags & ipTCP_FLAG_RST ) != 0u )
+		{
+			/* The peer gave up. */
+			if( pxEntry != NULL )
+			{
+				pxEntry->usLocalPort = 0u;
+			}
+		}
+		else if( ( ucTCPFlags & ipTCP_FLAG_CTRL ) == ipTCP_FLAG_SYN )
+		{
+			if( pxSocket->u.xTCP.usChildCount >= pxSocket->u.xTCP.usBacklog )
+			{
+				FreeRTOS_printf( ( "Check: Socket %u already has %u / %u child%s\n",
+					pxSocket->usLocalPort,
+					pxSocket->u.xTCP.usChildCount,
+					pxSocket->u.xTCP.usBacklog,
+					pxSocket->u.xTCP.usChildCount == 1 ? "" : "ren" ) );
+				prvTCPSendReset( pxNetworkBuffer );
+			}
+			else
+			{
+				prvSynCacheSendSynAck( pxSocket, pxNetworkBuffer, pxEntry );
+			}
+		}
+		else if( pxEntry == NULL )
+		{
+			/* What happens: maybe after a reboot, a client doesn't know the
+			connection had gone.  Send a RST in order to get a new connect
+			request. */
+			FreeRTOS_debug_printf( ( "TCP: Server can't handle flags: %02X from %lxip:%u to port %u\n",
+				ucTCPFlags,
+				FreeRTOS_ntohl( pxTCPPacket->xIPHeader.ulSourceIPAddress ),
+				FreeRTOS_ntohs( pxTCPPacket->xTCPHeader.usSourcePort ),
+				pxSocket->usLocalPort ) );
+			prvTCPSendReset( pxNetworkBuffer );
+		}
+		else
+		{
+			pxReturn = prvSynCacheComplete( pxSocket, pxNetworkBuffer, pxEntry );
+		}
+
+		return pxReturn;
+	}
+	/*-----------------------------------------------------------*/
+
+#endif /* ipconfigUSE_TCP_SYN_CACHE */
+
+#if( ipconfigUSE_TCP_TIME_WAIT == 1 )
+
+	/* A connection that was closed by this side: the peer may repeat its FIN
+	if our last ACK got lost.  Only the addresses and the sequence numbers are
+	kept, the socket itself can be freed. */
+	typedef struct xTCP_TIME_WAIT_ENTRY
+	{
+		uint32_t ulRemoteIP;		/* IP address of the peer, host-endian. */
+		uint32_t ulOurSequence;		/* Sequence number following our FIN. */
+		uint32_t ulPeerSequence;	/* Next sequence number expected from the peer. */
+		TickType_t xStartTime;		/* Time at which the entry was made, or the peer's FIN was received. */
+		uint16_t usRemotePort;		/* Port number of the peer, host-endian. */
+		uint16_t usLocalPort;		/* Local port number, 0 for a free entry. */
+		uint8_t ucFinReceived;		/* pdTRUE when the FIN of the peer has been received. */
+	} TCPTimeWaitEntry_t;
+
+	static TCPTimeWaitEntry_t xTimeWaitTable[ ipconfigTCP_TIME_WAIT_ENTRIES ];
+
+	/*
+	 * Find the entry of a closed connection.  Entries that have expired are
+	 * freed on the way.
+	 */
+	static TCPTimeWaitEntry_t *prvTCPTimeWaitLookup( uint32_t ulRemoteIP, uint16_t usLocalPort, uint16_t usRemotePort )
+	{
+	TCPTimeWaitEntry_t *pxEntry;
+	TCPTimeWaitEntry_t *pxReturn = NULL;
+	TickType_t xNow = xTaskGetTickCount();
+
+		for( pxEntry = xTimeWaitTable; pxEntry < &( xTimeWaitTable[ ipconfigTCP_TIME_WAIT_ENTRIES ] ); pxEntry++ )
+		{
+			if( pxEntry->usLocalPort == 0u )
+			{
+				/* A free entry. */
+			}
+			else if( ( xNow - pxEntry->xStartTime ) >= pdMS_TO_TICKS( ipconfigTCP_TIME_WAIT_MS ) )
+			{
+				pxEntry->usLocalPort = 0u;
+			}
+			else if( ( pxEntry->usLocalPort == usLocalPort ) &&
+					 ( pxEntry->ulRemoteIP == ulRemoteIP ) &&
+					 ( pxEntry->usRemotePort == usRemotePort ) )
+			{
+				pxReturn = pxEntry;
+			}
+		}
+
+		return pxReturn;
+	}
+	/*-----------------------------------------------------------*/
+
+	void vTCPTimeWaitAdd( FreeRTOS_Socket_t *pxSocket )
+	{
+	TCPTimeWaitEntry_t *pxEntry, *pxIterator;
+	TickType_t xNow = xTaskGetTickCount();
+
+		/* Only the side that sent the first FIN goes into TIME_WAIT, and only
+		once that FIN has been acknowledged.  Otherwise the socket is still
+		needed to repeat the FIN. */
+		if( ( pxSocket->u.xTCP.bits.bFinSent != pdFALSE_UNSIGNED ) &&
+			( pxSocket->u.xTCP.bits.bFinAcked != pdFALSE_UNSIGNED ) &&
+			( pxSocket->u.xTCP.bits.bFinLast == pdFALSE_UNSIGNED ) &&
+			( pxSocket->u.xTCP.ulRemoteIP != 0ul ) )
+		{
+			pxEntry = prvTCPTimeWaitLookup( pxSocket->u.xTCP.ulRemoteIP, ( uint16_t ) pxSocket->usLocalPort, pxSocket->u.xTCP.usRemotePort );
+
+			if( pxEntry == NULL )
+			{
+				/* Take a free entry, or else the oldest one. */
+				pxEntry = xTimeWaitTable;
+				for( pxIterator = xTimeWaitTable; pxIterator < &( xTimeWaitTable[ ipconfigTCP_TIME_WAIT_ENTRIES ] ); pxIterator++ )
+				{
+					if( pxIterator->usLocalPort == 0u )
+					{
+						pxEntry = pxIterator;
+						break;
+					}
+
+					if( ( xNow - pxIterator->xStartTime ) > ( xNow - pxEntry->xStartTime ) )
+					{
+						pxEntry = pxIterator;
+					}
+				}
+
+				pxEntry->ulRemoteIP = pxSocket->u.xTCP.ulRemoteIP;
+				pxEntry->usRemotePort = pxSocket->u.xTCP.usRemotePort;
+				pxEntry->usLocalPort = ( uint16_t ) pxSocket->usLocalPort;
+				pxEntry->ucFinReceived = pdFALSE;
+				pxEntry->xStartTime = xNow;
+			}
+
+			if( ( pxSocket->u.xTCP.bits.bFinRecv != pdFALSE_UNSIGNED ) && ( pxEntry->ucFinReceived == pdFALSE ) )
+			{
+				/* TIME_WAIT starts when both FIN's have been exchanged. */
+				pxEntry->ucFinReceived = pdTRUE;
+				pxEntry->xStartTime = xNow;
+			}
+
+			pxEntry->ulOurSequence = pxSocket->u.xTCP.xTCPWindow.tx.ulFINSequenceNumber + 1u;
+			pxEntry->ulPeerSequence = pxSocket->u.xTCP.xTCPWindow.rx.ulCurrentSequenceNumber;
+		}
+	}
+	/*-----------------------------------------------------------*/
+
+	static BaseType_t prvTCPTimeWaitInput( NetworkBufferDescriptor_t *pxNetworkBuffer, uint32_t ulRemoteIP,
+		uint16_t usLocalPort, uint16_t usRemotePort )
+	{
+	TCPPacket_t *pxTCPPacket = ( TCPPacket_t * ) ( pxNetworkBuffer->pucEthernetBuffer );
+	TCPHeader_t *pxTCPHeader = &( pxTCPPacket->xTCPHeader );
+	uint8_t ucTCPFlags = pxTCPHeader->ucTCPFlags;
+	uint32_t ulSequenceNumber = FreeRTOS_ntohl( pxTCPHeader->ulSequenceNumber );
+	TCPTimeWaitEntry_t *pxEntry;
+	uint8_t *pucRecvData;
+	uint32_t ulReceiveLength;
+	BaseType_t xReturn = pdTRUE;
+
+		pxEntry = prvTCPTimeWaitLookup( ulRemoteIP, usLocalPort, usRemotePort );
+
+		if( pxEntry == NULL )
+		{
+			xReturn = pdFALSE;
+		}
+		else if( ( ucTCPFlags & ipTCP_FLAG_RST ) != 0u )
+		{
+			/* The peer has forgotten the connection as well. */
+			pxEntry->usLocalPort = 0u;
+		}
+		else if( ( ucTCPFlags & ipTCP_FLAG_SYN ) != 0u )
+		{
+			/* A new connection with the same addresses: the old one is
+			forgotten, a listening socket may handle the SYN. */
+			pxEntry->usLocalPort = 0u;
+			xReturn = pdFALSE;
+		}
+		else
+		{
+			ulReceiveLength = ( uint32_t ) prvCheckRxData( pxNetworkBuffer, &pucRecvData );
+
+			if( ( int32_t ) ( ( ulSequenceNumber + ulReceiveLength ) - pxEntry->ulPeerSequence ) > 0 )
+			{
+				/* New data, while the owner has closed the connection. */
+				FreeRTOS_debug_printf( ( "TIME_WAIT: data from %lxip:%u, send RST\n", ulRemoteIP, usRemotePort ) );
+				prvTCPSendReset( pxNetworkBuffer );
+				pxEntry->usLocalPort = 0u;
+			}
+			else if( ( ( ucTCPFlags & ipTCP_FLAG_FIN ) != 0u ) || ( ulReceiveLength != 0u ) )
+			{
+				if( ( ( ucTCPFlags & ipTCP_FLAG_FIN ) != 0u ) &&
+					( pxEntry->ucFinReceived == pdFALSE ) &&
+					( ( ulSequenceNumber + ulReceiveLength ) == pxEntry->ulPeerSequence ) )
+				{
+					/* The peer's FIN has arrived after the socket was closed:
+					TIME_WAIT starts now. */
+					pxEntry->ulPeerSequence++;
+					pxEntry->ucFinReceived = pdTRUE;
+					pxEntry->xStartTime = xTaskGetTickCount();
+				}
+
+				/* A FIN, or old data that is repeated: acknowledge it again.
+				Without a socket, prvTCPReturnPacket() swaps the sequence and
+				the ACK number.  The window is closed, no new data is expected. */
+				pxTCPHeader->ulSequenceNumber = FreeRTOS_htonl( pxEntry->ulPeerSequence );
+				pxTCPHeader->ulAckNr = FreeRTOS_htonl( pxEntry->ulOurSequence );
+				pxTCPHeader->ucTCPFlags = ipTCP_FLAG_ACK;
+				pxTCPHeader->ucTCPOffset = ( ipSIZE_OF_TCP_HEADER + 0u ) << 2;
+				pxTCPHeader->usWindow = 0u;
+
+				prvTCPReturnPacket( NULL, pxNetworkBuffer, ( uint32_t ) ( ipSIZE_OF_IPv4_HEADER + ipSIZE_OF_TCP_HEADER ), pdFALSE );
+			}
+			else
+			{
+				/* An ACK without data: nothing to answer. */
+			}
+		}
+
+		return xReturn;
+	}
+	/*-----------------------------------------------------------*/
+
+#endif /* ipconfigUSE_TCP_TIME_WAIT */
+
 /*
  * Duplicates a socket after a listening socket receives a connection.
  */
@@ -3198,6 +4064,25 @@ struct freertos_sockaddr xAddress;
 	pxNewSocket->u.xTCP.uxEnoughSpace = pxSocket->u.xTCP.uxEnoughSpace;
 	pxNewSocket->u.xTCP.uxRxWinSize  = pxSocket->u.xTCP.uxRxWinSize;
 	pxNewSocket->u.xTCP.uxTxWinSize  = pxSocket->u.xTCP.uxTxWinSize;
+	pxNewSocket->u.xTCP.bits.bCork = pxSocket->u.xTCP.bits.bCork;
+	pxNewSocket->u.xTCP.bits.bNagle = pxSocket->u.xTCP.bits.bNagle;
+	#if( ipconfigUSE_TCP_WIN == 1 )
+	{
+		pxNewSocket->u.xTCP.ucAckPolicy = pxSocket->u.xTCP.ucAckPolicy;
+		pxNewSocket->u.xTCP.ucAckSegments = pxSocket->u.xTCP.ucAckSegments;
+	}
+	#endif
+	#if( ipconfigUSE_TCP_CONGESTION_CONTROL == 1 )
+	{
+		pxNewSocket->u.xTCP.ucCongestionControl = pxSocket->u.xTCP.ucCongestionControl;
+	}
+	#endif
+	#if( ipconfigTCP_RX_AUTOTUNE == 1 )
+	{
+		pxNewSocket->u.xTCP.uxRxBaseSize = pxSocket->u.xTCP.uxRxBaseSize;
+		pxNewSocket->u.xTCP.bits.bRxAutoTune = pxSocket->u.xTCP.bits.bRxAutoTune;
+	}
+	#endif
 
 	#if( ipconfigSOCKET_HAS_USER_SEMAPHORE == 1 )
 	{
@@ -3230,11 +4115,12 @@ struct freertos_sockaddr xAddress;
 	xAddress.sin_addr = *ipLOCAL_IP_ADDRESS_POINTER;
 	xAddress.sin_port = FreeRTOS_htons( pxSocket->usLocalPort );
 
-	#if( ipconfigTCP_HANG_PROTECTION == 1 )
+	#if( ipconfigTCP_HANG_PROTECTION == 1 ) || ( ipconfigUSE_TCP_SYN_CACHE == 1 )
 	{
 		/* Only when there is anti-hanging protection, a socket may become an
 		orphan temporarily.  Once this socket is really connected, the owner of
-		the server socket will be notified. */
+		the server socket will be notified.  With a SYN cache, the child is
+		queued to its parent once it is connected. */
 
 		/* When bPassQueued is true, the socket is an orphan until it gets
 		connected. */
@@ -89,6 +89,29 @@
 #define winSRTT_DECREMENT_CURRENT 	7
 #define winSRTT_CAP_mS				50
 
+#if( ipconfigTCP_HIGH_RESOLUTION_RTT == 1 )
+	/* ipconfigTCP_HR_TIMER_VALUE() wraps after some tens of seconds, older
+	timers are measured with the tick count. */
+	#define winHR_MAX_AGE_MS			10000UL
+
+	/* The clock granularity 'G' of RFC 6298: time-outs are handled by the
+	IP-task, which wakes up at tick boundaries. */
+	#define winHR_GRANULARITY_US		( ( uint32_t ) portTICK_PERIOD_MS * 1000UL )
+
+	/* The initial RTO is one second (RFC 6298, 2.1). */
+	#define winHR_INITIAL_RTO_US		1000000UL
+
+	/* Time-outs are compared in microseconds. */
+	#define winTIMER_UNITS_TO_MS( x )	( ( ( x ) + 999UL ) / 1000UL )
+
+	/* Exponential back-off is limited to 2^6 times the RTO. */
+	#define winMAX_BACKOFF_SHIFT		6UL
+#else
+	/* Time-outs are compared in milliseconds. */
+	#define winTIMER_UNITS_TO_MS( x )	( x )
+#endif
+
+
 #if( ipconfigUSE_TCP_WIN == 1 )
 
 	#define xTCPWindowRxNew( pxWindow, ulSequenceNumber, lCount ) xTCPWindowNew( pxWindow, ulSequenceNumber, lCount, pdTRUE )
@@ -120,6 +143,21 @@
 	#define MAX_TRANSMIT_COUNT_USING_LARGE_WINDOW		( 4u )
 
 #endif /* configUSE_TCP_WIN */
+
+#if( ipconfigUSE_TCP_CONGESTION_CONTROL == 1 )
+	/* Slow start may open the window by at most 2 x MSS per ACK (RFC 3465). */
+	#define tcpCC_SLOW_START_LIMIT_SEGMENTS		( 2UL )
+
+	/* CUBIC constants (RFC 8312): C = 0.4 and beta = 0.7, as fractions. */
+	#define tcpCUBIC_C_NUMERATOR				( 4ULL )
+	#define tcpCUBIC_C_DENOMINATOR				( 10ULL )
+	#define tcpCUBIC_BETA_NUMERATOR				( 7UL )
+	#define tcpCUBIC_BETA_DENOMINATOR			( 10UL )
+
+	/* Largest time offset in ms used in the cubic function, (2^21)^3 still
+	fits in 64 bits. */
+	#define tcpCUBIC_MAX_TIME_MS				( 0x1FFFFFUL )
+#endif /* ipconfigUSE_TCP_CONGESTION_CONTROL */
 /*-----------------------------------------------------------*/
 
 extern void vListInsertGeneric( List_t * const pxList, ListItem_t * const pxNewListItem, MiniListItem_t * const pxWhere );
@@ -229,6 +267,20 @@ extern void vListInsertGeneric( List_t * const pxList, ListItem_t * const pxNewL
 	static uint32_t prvTCPWindowFastRetransmit( TCPWindow_t *pxWindow, uint32_t ulFirst );
 #endif /* ipconfigUSE_TCP_WIN == 1 */
 
+/*
+ * Congestion control: reset the congestion window when a window is
+ * (re)initialised, open it for newly acknowledged data, and close it when a
+ * loss is detected, either by duplicate ACKs / SACK or by a time-out.
+ */
+#if( ipconfigUSE_TCP_CONGESTION_CONTROL == 1 )
+	static void prvCongestionInit( TCPWindow_t *pxWindow );
+	static void prvCongestionAck( TCPWindow_t *pxWindow, uint32_t ulAcked );
+	static void prvCongestionEnterRecovery( TCPWindow_t *pxWindow );
+	static void prvCongestionTimeout( TCPWindow_t *pxWindow, const TCPSegment_t *pxSegment );
+	static void prvCongestionRetransmitHead( TCPWindow_t *pxWindow );
+	static uint32_t prvCongestionFlightSize( const TCPWindow_t *pxWindow );
+#endif /* ipconfigUSE_TCP_CONGESTION_CONTROL */
+
 /*-----------------------------------------------------------*/
 
 /* TCP segement pool. */
@@ -298,6 +350,11 @@ static portINLINE void vTCPTimerSet( TCPTimer_t *pxTimer );
 static portINLINE void vTCPTimerSet( TCPTimer_t *pxTimer )
 {
 	pxTimer->ulBorn = xTaskGetTickCount ( );
+	#if( ipconfigTCP_HIGH_RESOLUTION_RTT == 1 )
+	{
+		pxTimer->ulBornHR = ipconfigTCP_HR_TIMER_VALUE();
+	}
+	#endif
 }
 /*-----------------------------------------------------------*/
 
@@ -308,6 +365,128 @@ static portINLINE uint32_t ulTimerGetAge( TCPTimer_t *pxTimer )
 }
 /*-----------------------------------------------------------*/
 
+#if( ipconfigTCP_HIGH_RESOLUTION_RTT == 1 )
+	static uint32_t ulTimerGetAgeUs( TCPTimer_t *pxTimer );
+	static uint32_t ulTimerGetAgeUs( TCPTimer_t *pxTimer )
+	{
+	uint32_t ulAge = ulTimerGetAge( pxTimer );
+
+		if( ulAge < winHR_MAX_AGE_MS )
+		{
+			ulAge = ( ipconfigTCP_HR_TIMER_VALUE() - pxTimer->ulBornHR ) / ( uint32_t ) ipconfigTCP_HR_TIMER_COUNTS_PER_US;
+		}
+		else
+		{
+			ulAge = FreeRTOS_min_uint32( ulAge, 0xFFFFFFFFUL / 1000UL ) * 1000UL;
+		}
+
+		return ulAge;
+	}
+#endif /* ipconfigTCP_HIGH_RESOLUTION_RTT */
+/*-----------------------------------------------------------*/
+
+/* The time elapsed since a segment was sent, in ms, or in us when
+ipconfigTCP_HIGH_RESOLUTION_RTT is defined. */
+static uint32_t prvSegmentAge( TCPSegment_t *pxSegment );
+static uint32_t prvSegmentAge( TCPSegment_t *pxSegment )
+{
+	#if( ipconfigTCP_HIGH_RESOLUTION_RTT == 1 )
+	{
+		return ulTimerGetAgeUs( &( pxSegment->xTransmitTimer ) );
+	}
+	#else
+	{
+		return ulTimerGetAge( &( pxSegment->xTransmitTimer ) );
+	}
+	#endif
+}
+/*-----------------------------------------------------------*/
+
+/* The time after which a segment will be retransmitted, in the same units as
+prvSegmentAge().  After a packet has been sent for the first time, it will
+wait one RTO for an ACK, and each retransmission doubles the time-out. */
+static uint32_t prvSegmentMaxAge( TCPWindow_t *pxWindow, TCPSegment_t *pxSegment );
+static uint32_t prvSegmentMaxAge( TCPWindow_t *pxWindow, TCPSegment_t *pxSegment )
+{
+uint32_t ulShift = pxSegment->u.bits.ucTransmitCount;
+uint32_t ulMaxAge;
+
+	#if( ipconfigTCP_HIGH_RESOLUTION_RTT == 1 )
+	{
+		/* ucTransmitCount is at least 1 for an outstanding segment. */
+		if( ulShift > 0UL )
+		{
+			ulShift--;
+		}
+
+		ulShift = FreeRTOS_min_uint32( ulShift, winMAX_BACKOFF_SHIFT );
+
+		if( pxWindow->ulRTOus > ( ( uint32_t ) ipconfigTCP_RTO_MAX_US >> ulShift ) )
+		{
+			ulMaxAge = ( uint32_t ) ipconfigTCP_RTO_MAX_US;
+		}
+		else
+		{
+			ulMaxAge = pxWindow->ulRTOus << ulShift;
+		}
+	}
+	#else
+	{
+		/* The RTO is taken as 2 * SRTT. */
+		ulMaxAge = ( 1UL << ulShift ) * ( ( uint32_t ) pxWindow->lSRTT );
+	}
+	#endif
+
+	return ulMaxAge;
+}
+/*-----------------------------------------------------------*/
+
+#if( ipconfigTCP_HIGH_RESOLUTION_RTT == 1 )
+	/* Process a round-trip time sample as described in RFC 6298. */
+	static void prvTCPWindowRTTSample( TCPWindow_t *pxWindow, uint32_t ulRTT );
+	static void prvTCPWindowRTTSample( TCPWindow_t *pxWindow, uint32_t ulRTT )
+	{
+	uint32_t ulDelta;
+
+		if( ulRTT == 0UL )
+		{
+			ulRTT = 1UL;
+		}
+
+		if( pxWindow->ulSRTTus == 0UL )
+		{
+			/* The first measurement. */
+			pxWindow->ulSRTTus = ulRTT;
+			pxWindow->ulRTTVARus = ulRTT / 2UL;
+		}
+		else
+		{
+			/* RTTVAR = 3/4 * RTTVAR + 1/4 * | SRTT - R |
+			SRTT = 7/8 * SRTT + 1/8 * R */
+			if( pxWindow->ulSRTTus > ulRTT )
+			{
+				ulDelta = pxWindow->ulSRTTus - ulRTT;
+			}
+			else
+			{
+				ulDelta = ulRTT - pxWindow->ulSRTTus;
+			}
+
+			pxWindow->ulRTTVARus = pxWindow->ulRTTVARus - ( pxWindow->ulRTTVARus / 4UL ) + ( ulDelta / 4UL );
+			pxWindow->ulSRTTus = pxWindow->ulSRTTus - ( pxWindow->ulSRTTus / 8UL ) + ( ulRTT / 8UL );
+		}
+
+		/* RTO = SRTT + max( G, 4 * RTTVAR ), within the configured limits. */
+		pxWindow->ulRTOus = pxWindow->ulSRTTus + FreeRTOS_max_uint32( winHR_GRANULARITY_US, 4UL * pxWindow->ulRTTVARus );
+		pxWindow->ulRTOus = FreeRTOS_max_uint32( pxWindow->ulRTOus, ( uint32_t ) ipconfigTCP_RTO_MIN_US );
+		pxWindow->ulRTOus = FreeRTOS_min_uint32( pxWindow->ulRTOus, ( uint32_t ) ipconfigTCP_RTO_MAX_US );
+
+		/* lSRTT remains available in ms, rounded up. */
+		pxWindow->lSRTT = ( int32_t ) winTIMER_UNITS_TO_MS( pxWindow->ulSRTTus );
+	}
+#endif /* ipconfigTCP_HIGH_RESOLUTION_RTT */
+/*-----------------------------------------------------------*/
+
 /* _HT_ GCC (using the settings that I'm using) checks for every public function if it is
 preceded by a prototype. Later this prototype will be located in list.h? */
 
@@ -681,6 +860,23 @@ const int32_t l500ms = 500;
 	/*Start with a timeout of 2 * 500 ms (1 sec). */
 	pxWindow->lSRTT = l500ms;
 
+	#if( ipconfigTCP_HIGH_RESOLUTION_RTT == 1 )
+	{
+		/* No RTT has been measured yet. */
+		pxWindow->ulSRTTus = 0UL;
+		pxWindow->ulRTTVARus = 0UL;
+		pxWindow->ulRTOus = winHR_INITIAL_RTO_US;
+	}
+	#endif
+
+	#if( ipconfigUSE_TCP_METRICS == 1 )
+	{
+		static const TCPWinStats_t xNoStats = { 0u };
+
+		pxWindow->xStats = xNoStats;
+	}
+	#endif
+
 	/* Just for logging, to print relative sequence numbers. */
 	pxWindow->rx.ulFirstSequenceNumber = ulAckNumber;
 
@@ -702,6 +898,12 @@ const int32_t l500ms = 500;
 	/* The right-hand side of the transmit window. */
 	pxWindow->tx.ulHighestSequenceNumber = ulSequenceNumber;
 	pxWindow->ulOurSequenceNumber = ulSequenceNumber;
+
+	#if( ipconfigUSE_TCP_CONGESTION_CONTROL == 1 )
+	{
+		prvCongestionInit( pxWindow );
+	}
+	#endif
 }
 /*-----------------------------------------------------------*/
 
@@ -888,6 +1090,11 @@ const int32_t l500ms = 500;
 				/* An earlier has been received, must be a retransmission of a
 				packet that has been accepted already.  No need to send out a
 				Selective ACK (SACK). */
+				#if( ipconfigUSE_TCP_METRICS == 1 )
+				{
+					pxWindow->xStats.ulDuplicateSegments++;
+				}
+				#endif
 				lReturn = -1;
 			}
 			else if( lDistance > ( int32_t ) ulSpace )
@@ -941,6 +1148,12 @@ const int32_t l500ms = 500;
 					/* This out-of-sequence packet has been received for a
 					second time.  It is already stored but do send a SACK
 					again. */
+					#if( ipconfigUSE_TCP_METRICS == 1 )
+					{
+						pxWindow->xStats.ulDuplicateSegments++;
+						pxWindow->xStats.ulSackSent++;
+					}
+					#endif
 					lReturn = -1;
 				}
 				else
@@ -967,6 +1180,12 @@ const int32_t l500ms = 500;
 							FreeRTOS_flush_logging( );
 						}
 
+						#if( ipconfigUSE_TCP_METRICS == 1 )
+						{
+							pxWindow->xStats.ulSackSent++;
+						}
+						#endif
+
 						/* Return a positive value.  The packet may be accepted
 						and stored but an earlier packet is still missing. */
 						lReturn = ( int32_t ) ( ulSequenceNumber - ulCurrentSequenceNumber );
@@ -1198,6 +1417,16 @@ const int32_t l500ms = 500;
 			{
 				xHasSpace = pdFALSE;
 			}
+
+			#if( ipconfigUSE_TCP_CONGESTION_CONTROL == 1 )
+			{
+				/* And the network must have room for it: the congestion window. */
+				if( ( ulTxOutstanding != 0UL ) && ( pxWindow->xCongestion.ulCwnd < ulTxOutstanding + ( ( uint32_t ) pxSegment->lDataLength ) ) )
+				{
+					xHasSpace = pdFALSE;
+				}
+			}
+			#endif
 		}
 
 		return xHasSpace;
@@ -1212,7 +1441,7 @@ const int32_t l500ms = 500;
 	{
 	TCPSegment_t *pxSegment;
 	BaseType_t xReturn;
-	TickType_t ulAge, ulMaxAge;
+	uint32_t ulAge, ulMaxAge;
 
 		*pulDelay = 0u;
 
@@ -1231,17 +1460,17 @@ const int32_t l500ms = 500;
 			{
 				/* There is an outstanding segment, see if it is time to resend
 				it. */
-				ulAge = ulTimerGetAge( &pxSegment->xTransmitTimer );
+				ulAge = prvSegmentAge( pxSegment );
 
 				/* After a packet has been sent for the first time, it will wait
-				'1 * lSRTT' ms for an ACK. A second time it will wait '2 * lSRTT' ms,
+				'1 * RTO' for an ACK. A second time it will wait '2 * RTO',
 				each time doubling the time-out */
-				ulMaxAge = ( 1u << pxSegment->u.bits.ucTransmitCount ) * ( ( uint32_t ) pxWindow->lSRTT );
+				ulMaxAge = prvSegmentMaxAge( pxWindow, pxSegment );
 
 				if( ulMaxAge > ulAge )
 				{
 					/* A segment must be sent after this amount of msecs */
-					*pulDelay = ulMaxAge - ulAge;
+					*pulDelay = winTIMER_UNITS_TO_MS( ulMaxAge - ulAge );
 				}
 
 				xReturn = pdTRUE;
@@ -1308,15 +1537,27 @@ const int32_t l500ms = 500;
 			if( pxSegment != NULL )
 			{
 				/* Do check the timing. */
-				ulMaxTime = ( 1u << pxSegment->u.bits.ucTransmitCount ) * ( ( uint32_t ) pxWindow->lSRTT );
+				ulMaxTime = prvSegmentMaxAge( pxWindow, pxSegment );
 
-				if( ulTimerGetAge( &pxSegment->xTransmitTimer ) > ulMaxTime )
+				if( prvSegmentAge( pxSegment ) > ulMaxTime )
 				{
 					/* A normal (non-fast) retransmission.  Move it from the
 					head of the waiting queue. */
 					pxSegment = xTCPWindowGetHead( &( pxWindow->xWaitQueue ) );
 					pxSegment->u.bits.ucDupAckCount = pdFALSE_UNSIGNED;
 
+					#if( ipconfigUSE_TCP_METRICS == 1 )
+					{
+						pxWindow->xStats.ulRetransmits++;
+					}
+					#endif
+
+					#if( ipconfigUSE_TCP_CONGESTION_CONTROL == 1 )
+					{
+						prvCongestionTimeout( pxWindow, pxSegment );
+					}
+					#endif
+
 					/* Some detailed logging. */
 					if( ( xTCPWindowLoggingLevel != 0 ) && ( ipconfigTCP_MAY_LOG_PORT( pxWindow->usOurPortNumber ) != 0 ) )
 					{
@@ -1352,6 +1593,13 @@ const int32_t l500ms = 500;
 					has a full size of MSS. */
 					ulReturn = 0;
 				}
+				else if( ( pxWindow->u.bits.bNagle != pdFALSE_UNSIGNED ) && ( pxSegment->lDataLength < pxSegment->lMaxLength ) &&
+						 ( pxWindow->tx.ulHighestSequenceNumber != pxWindow->tx.ulCurrentSequenceNumber ) )
+				{
+					/* Nagle: a small segment waits until all outstanding data
+					has been acknowledged, and meanwhile it may grow. */
+					ulReturn = 0;
+				}
 				else if( prvTCPWindowTxHasSpace( pxWindow, ulWindowSize ) == pdFALSE )
 				{
 					/* Peer has no more space at this moment. */
@@ -1420,7 +1668,9 @@ const int32_t l500ms = 500;
 			( pxSegment->u.bits.ucTransmitCount )++;
 
 			/* If there have been several retransmissions (4), decrease the
-			size of the transmission window to at most 2 times MSS. */
+			size of the transmission window to at most 2 times MSS.  With
+			congestion control, the congestion window takes care of this. */
+			#if( ipconfigUSE_TCP_CONGESTION_CONTROL == 0 )
 			if( pxSegment->u.bits.ucTransmitCount == MAX_TRANSMIT_COUNT_USING_LARGE_WINDOW )
 			{
 				if( pxWindow->xSize.ulTxWindowLength > ( 2U * pxWindow->usMSS ) )
@@ -1431,6 +1681,7 @@ const int32_t l500ms = 500;
 					pxWindow->xSize.ulTxWindowLength = ( 2UL * pxWindow->usMSS );
 				}
 			}
+			#endif /* ipconfigUSE_TCP_CONGESTION_CONTROL == 0 */
 
 			/* Clear the transmit timer. */
 			vTCPTimerSet( &( pxSegment->xTransmitTimer ) );
@@ -1536,6 +1787,11 @@ const int32_t l500ms = 500;
 				/* Calculate the RTT only if the segment was sent-out for the
 				first time and if this is the last ACK'd segment in a range. */
 				if( ( pxSegment->u.bits.ucTransmitCount == 1 ) && ( ( pxSegment->ulSequenceNumber + ulDataLength ) == ulLast ) )
+				#if( ipconfigTCP_HIGH_RESOLUTION_RTT == 1 )
+				{
+					prvTCPWindowRTTSample( pxWindow, ulTimerGetAgeUs( &( pxSegment->xTransmitTimer ) ) );
+				}
+				#else
 				{
 					int32_t mS = ( int32_t ) ulTimerGetAge( &( pxSegment->xTransmitTimer ) );
 
@@ -1556,6 +1812,7 @@ const int32_t l500ms = 500;
 						pxWindow->lSRTT = winSRTT_CAP_mS;
 					}
 				}
+				#endif /* ipconfigTCP_HIGH_RESOLUTION_RTT */
 
 				/* Unlink it from the 3 queues, but do not destroy it (yet). */
 				xDoUnlink = pdTRUE;
@@ -1654,6 +1911,12 @@ const int32_t l500ms = 500;
 			}
 		}
 
+		#if( ipconfigUSE_TCP_METRICS == 1 )
+		{
+			pxWindow->xStats.ulFastRetransmits += ulCount;
+		}
+		#endif
+
 		return ulCount;
 	}
 #endif /* ipconfigUSE_TCP_WIN == 1 */
@@ -1676,6 +1939,15 @@ const int32_t l500ms = 500;
 		else
 		{
 			ulReturn = prvTCPWindowTxCheckAck( pxWindow, ulFirstSequence, ulSequenceNumber );
+
+			#if( ipconfigUSE_TCP_CONGESTION_CONTROL == 1 )
+			{
+				if( ulReturn != 0UL )
+				{
+					prvCongestionAck( pxWindow, ulReturn );
+				}
+			}
+			#endif
 		}
 
 		return ulReturn;
@@ -1693,7 +1965,28 @@ const int32_t l500ms = 500;
 
 		/* Receive a SACK option. */
 		ulAckCount = prvTCPWindowTxCheckAck( pxWindow, ulFirst, ulLast );
-		prvTCPWindowFastRetransmit( pxWindow, ulFirst );
+
+		#if( ipconfigUSE_TCP_METRICS == 1 )
+		{
+			pxWindow->xStats.ulSackReceived++;
+		}
+		#endif
+
+		#if( ipconfigUSE_TCP_CONGESTION_CONTROL == 1 )
+		{
+			/* The SACK'd segments show that a lower one got lost. */
+			if( ( prvTCPWindowFastRetransmit( pxWindow, ulFirst ) != 0UL ) &&
+				( pxWindow->xCongestion.bInRecovery == pdFALSE_UNSIGNED ) &&
+				( xSequenceGreaterThanOrEqual( pxWindow->tx.ulCurrentSequenceNumber, pxWindow->xCongestion.ulRecover ) != pdFALSE ) )
+			{
+				prvCongestionEnterRecovery( pxWindow );
+			}
+		}
+		#else
+		{
+			prvTCPWindowFastRetransmit( pxWindow, ulFirst );
+		}
+		#endif
 
 		if( ( xTCPWindowLoggingLevel >= 1 ) && ( xSequenceGreaterThan( ulFirst, ulCurrentSequenceNumber ) != pdFALSE ) )
 		{
@@ -1712,6 +2005,529 @@ const int32_t l500ms = 500;
 #endif /* ipconfigUSE_TCP_WIN == 1 */
 /*-----------------------------------------------------------*/
 
+#if( ipconfigUSE_TCP_CONGESTION_CONTROL == 1 )
+
+	static uint32_t prvCongestionFlightSize( const TCPWindow_t *pxWindow )
+	{
+	uint32_t ulFlight;
+
+		/* The number of bytes sent but not yet acknowledged. */
+		if( xSequenceGreaterThan( pxWindow->tx.ulHighestSequenceNumber, pxWindow->tx.ulCurrentSequenceNumber ) != pdFALSE )
+		{
+			ulFlight = pxWindow->tx.ulHighestSequenceNumber - pxWindow->tx.ulCurrentSequenceNumber;
+		}
+		else
+		{
+			ulFlight = 0UL;
+		}
+
+		return ulFlight;
+	}
+
+#endif /* ipconfigUSE_TCP_CONGESTION_CONTROL */
+/*-----------------------------------------------------------*/
+
+#if( ipconfigUSE_TCP_CONGESTION_CONTROL == 1 )
+
+	static uint32_t prvCongestionLimit( const TCPWindow_t *pxWindow );
+	static uint32_t prvCongestionLimit( const TCPWindow_t *pxWindow )
+	{
+		/* There is no use in a congestion window which is larger than the
+		self-imposed transmission window. */
+		return FreeRTOS_max_uint32( pxWindow->xSize.ulTxWindowLength, 2UL * pxWindow->usMSS );
+	}
+
+#endif /* ipconfigUSE_TCP_CONGESTION_CONTROL */
+/*-----------------------------------------------------------*/
+
+#if( ipconfigUSE_TCP_CONGESTION_CONTROL == 1 )
+
+	static uint32_t prvCongestionSlowStart( TCPWindow_t *pxWindow, uint32_t ulAcked );
+	static uint32_t prvCongestionSlowStart( TCPWindow_t *pxWindow, uint32_t ulAcked )
+	{
+	TCPCongestion_t *pxCongestion = &( pxWindow->xCongestion );
+	uint32_t ulIncrease;
+
+		/* Slow start with appropriate byte counting (RFC 3465).  Returns the
+		number of acknowledged bytes left for congestion avoidance, which is
+		only non-zero when ssthresh has been reached. */
+		ulIncrease = FreeRTOS_min_uint32( ulAcked, tcpCC_SLOW_START_LIMIT_SEGMENTS * pxWindow->usMSS );
+		ulIncrease = FreeRTOS_min_uint32( ulIncrease, pxCongestion->ulSsthresh - pxCongestion->ulCwnd );
+		pxCongestion->ulCwnd += ulIncrease;
+
+		if( pxCongestion->ulCwnd < pxCongestion->ulSsthresh )
+		{
+			ulAcked = 0UL;
+		}
+		else
+		{
+			ulAcked -= ulIncrease;
+		}
+
+		return ulAcked;
+	}
+
+#endif /* ipconfigUSE_TCP_CONGESTION_CONTROL */
+/*-----------------------------------------------------------*/
+
+#if( ipconfigUSE_TCP_CONGESTION_CONTROL == 1 )
+
+	static void prvNewRenoInit( TCPWindow_t *pxWindow );
+	static void prvNewRenoInit( TCPWindow_t *pxWindow )
+	{
+		/* NewReno has no state other than the generic one. */
+		( void ) pxWindow;
+	}
+	/*-----------------------------------------------------------*/
+
+	static void prvNewRenoOnAck( TCPWindow_t *pxWindow, uint32_t ulAcked );
+	static void prvNewRenoOnAck( TCPWindow_t *pxWindow, uint32_t ulAcked )
+	{
+	TCPCongestion_t *pxCongestion = &( pxWindow->xCongestion );
+
+		if( pxCongestion->ulCwnd < pxCongestion->ulSsthresh )
+		{
+			ulAcked = prvCongestionSlowStart( pxWindow, ulAcked );
+		}
+
+		if( ulAcked != 0UL )
+		{
+			/* Congestion avoidance: one MSS per window of acknowledged data
+			(RFC 5681). */
+			pxCongestion->ulBytesAcked += ulAcked;
+
+			if( pxCongestion->ulBytesAcked >= pxCongestion->ulCwnd )
+			{
+				pxCongestion->ulBytesAcked -= pxCongestion->ulCwnd;
+				pxCongestion->ulCwnd += pxWindow->usMSS;
+			}
+		}
+	}
+	/*-----------------------------------------------------------*/
+
+	static uint32_t prvNewRenoSsthresh( TCPWindow_t *pxWindow );
+	static uint32_t prvNewRenoSsthresh( TCPWindow_t *pxWindow )
+	{
+		/* ssthresh = max( FlightSize / 2, 2 * MSS ) (RFC 5681). */
+		return FreeRTOS_max_uint32( prvCongestionFlightSize( pxWindow ) / 2UL, 2UL * pxWindow->usMSS );
+	}
+	/*-----------------------------------------------------------*/
+
+	static const TCPCongestionOps_t xNewRenoOps =
+	{
+		"newreno",
+		prvNewRenoInit,
+		prvNewRenoOnAck,
+		prvNewRenoSsthresh
+	};
+
+#endif /* ipconfigUSE_TCP_CONGESTION_CONTROL */
+/*-----------------------------------------------------------*/
+
+#if( ipconfigUSE_TCP_CONGESTION_CONTROL == 1 )
+
+	static uint32_t prvCubeRoot( uint64_t ullValue );
+	static uint32_t prvCubeRoot( uint64_t ullValue )
+	{
+	uint32_t ulLow = 0UL, ulHigh = tcpCUBIC_MAX_TIME_MS + 1UL, ulMid;
+
+		/* The largest x for which x^3 <= ullValue, found by a binary search.
+		The result is limited to tcpCUBIC_MAX_TIME_MS. */
+		while( ( ulHigh - ulLow ) > 1UL )
+		{
+			ulMid = ( ulLow + ulHigh ) / 2UL;
+
+			if( ( ( uint64_t ) ulMid * ulMid * ulMid ) <= ullValue )
+			{
+				ulLow = ulMid;
+			}
+			else
+			{
+				ulHigh = ulMid;
+			}
+		}
+
+		return ulLow;
+	}
+	/*-----------------------------------------------------------*/
+
+	static uint32_t prvCubicTime( void );
+	static uint32_t prvCubicTime( void )
+	{
+	uint32_t ulTime = ( uint32_t ) ( xTaskGetTickCount() * portTICK_PERIOD_MS );
+
+		/* Zero is used to indicate that there is no epoch. */
+		if( ulTime == 0UL )
+		{
+			ulTime = 1UL;
+		}
+
+		return ulTime;
+	}
+	/*-----------------------------------------------------------*/
+
+	static void prvCubicInit( TCPWindow_t *pxWindow );
+	static void prvCubicInit( TCPWindow_t *pxWindow )
+	{
+	TCPCongestion_t *pxCongestion = &( pxWindow->xCongestion );
+
+		pxCongestion->ulWMax = 0UL;
+		pxCongestion->ulEpochStart = 0UL;
+		pxCongestion->ulK = 0UL;
+		pxCongestion->ulOriginPoint = 0UL;
+		pxCongestion->ulTcpCwnd = 0UL;
+	}
+	/*-----------------------------------------------------------*/
+
+	static void prvCubicOnAck( TCPWindow_t *pxWindow, uint32_t ulAcked );
+	static void prvCubicOnAck( TCPWindow_t *pxWindow, uint32_t ulAcked )
+	{
+	TCPCongestion_t *pxCongestion = &( pxWindow->xCongestion );
+	uint32_t ulNow, ulTime, ulOffset, ulTarget;
+	uint64_t ullDelta;
+
+		if( pxCongestion->ulCwnd < pxCongestion->ulSsthresh )
+		{
+			ulAcked = prvCongestionSlowStart( pxWindow, ulAcked );
+		}
+
+		if( ulAcked != 0UL )
+		{
+			ulNow = prvCubicTime();
+
+			if( pxCongestion->ulEpochStart == 0UL )
+			{
+				/* The first ACK in congestion avoidance: start a new epoch.
+				K is the time needed to grow back to the plateau W_max:
+				K = cubic_root( ( W_max - cwnd ) / C ), here in ms and bytes. */
+				pxCongestion->ulEpochStart = ulNow;
+				pxCongestion->ulTcpCwnd = pxCongestion->ulCwnd;
+				pxCongestion->ulBytesAcked = 0UL;
+
+				if( pxCongestion->ulCwnd < pxCongestion->ulWMax )
+				{
+					ullDelta = ( uint64_t ) ( pxCongestion->ulWMax - pxCongestion->ulCwnd );
+					ullDelta = ( ullDelta * 1000000000ULL * tcpCUBIC_C_DENOMINATOR ) / ( tcpCUBIC_C_NUMERATOR * pxWindow->usMSS );
+					pxCongestion->ulK = prvCubeRoot( ullDelta );
+					pxCongestion->ulOriginPoint = pxCongestion->ulWMax;
+				}
+				else
+				{
+					pxCongestion->ulK = 0UL;
+					pxCongestion->ulOriginPoint = pxCongestion->ulCwnd;
+				}
+			}
+
+			/* W_cubic( t + RTT ) = C * ( t + RTT - K )^3 + W_max */
+			ulTime = ( ulNow - pxCongestion->ulEpochStart ) + ( uint32_t ) pxWindow->lSRTT;
+
+			if( ulTime > pxCongestion->ulK )
+			{
+				ulOffset = ulTime - pxCongestion->ulK;
+			}
+			else
+			{
+				ulOffset = pxCongestion->ulK - ulTime;
+			}
+
+			ulOffset = FreeRTOS_min_uint32( ulOffset, tcpCUBIC_MAX_TIME_MS );
+			ullDelta = ( ( uint64_t ) ulOffset * ulOffset * ulOffset ) / 1000000ULL;
+			ullDelta = ( ullDelta * tcpCUBIC_C_NUMERATOR * pxWindow->usMSS ) / ( tcpCUBIC_C_DENOMINATOR * 1000ULL );
+
+			if( ulTime > pxCongestion->ulK )
+			{
+				ullDelta += pxCongestion->ulOriginPoint;
+				ulTarget = ( ullDelta > 0x7FFFFFFFULL ) ? 0x7FFFFFFFUL : ( uint32_t ) ullDelta;
+			}
+			else if( ullDelta < pxCongestion->ulOriginPoint )
+			{
+				ulTarget = pxCongestion->ulOriginPoint - ( uint32_t ) ullDelta;
+			}
+			else
+			{
+				ulTarget = 0UL;
+			}
+
+			/* The TCP-friendly region: grow at least as fast as Reno would,
+			by 3 * ( 1 - beta ) / ( 1 + beta ) ~= 9/17 MSS per RTT. */
+			pxCongestion->ulTcpCwnd += ( uint32_t ) ( ( ( uint64_t ) ulAcked * pxWindow->usMSS * 9ULL ) /
+				( 17ULL * FreeRTOS_max_uint32( pxCongestion->ulTcpCwnd, 1UL ) ) );
+			ulTarget = FreeRTOS_max_uint32( ulTarget, pxCongestion->ulTcpCwnd );
+
+			if( ulTarget > pxCongestion->ulCwnd )
+			{
+				/* Do not grow by more than 50% per RTT. */
+				ulTarget = FreeRTOS_min_uint32( ulTarget, pxCongestion->ulCwnd + ( pxCongestion->ulCwnd / 2UL ) );
+				pxCongestion->ulCwnd += ( uint32_t ) ( ( ( uint64_t ) ( ulTarget - pxCongestion->ulCwnd ) * ulAcked ) / pxCongestion->ulCwnd );
+			}
+			else
+			{
+				/* Near the plateau: grow very slowly, one MSS per 100 windows. */
+				pxCongestion->ulBytesAcked += ulAcked;
+
+				if( pxCongestion->ulBytesAcked >= 100UL * pxCongestion->ulCwnd )
+				{
+					pxCongestion->ulBytesAcked = 0UL;
+					pxCongestion->ulCwnd += pxWindow->usMSS;
+				}
+			}
+		}
+	}
+	/*-----------------------------------------------------------*/
+
+	static uint32_t prvCubicSsthresh( TCPWindow_t *pxWindow );
+	static uint32_t prvCubicSsthresh( TCPWindow_t *pxWindow )
+	{
+	TCPCongestion_t *pxCongestion = &( pxWindow->xCongestion );
+	uint32_t ulCwnd = pxCongestion->ulCwnd;
+
+		/* A new epoch will start in congestion avoidance. */
+		pxCongestion->ulEpochStart = 0UL;
+
+		/* Fast convergence: when the plateau is lower than the previous one,
+		release some bandwidth for new flows. */
+		if( ulCwnd < pxCongestion->ulWMax )
+		{
+			pxCongestion->ulWMax = ( ulCwnd / 20UL ) * 17UL;
+		}
+		else
+		{
+			pxCongestion->ulWMax = ulCwnd;
+		}
+
+		return FreeRTOS_max_uint32( ( ulCwnd / tcpCUBIC_BETA_DENOMINATOR ) * tcpCUBIC_BETA_NUMERATOR, 2UL * pxWindow->usMSS );
+	}
+	/*-----------------------------------------------------------*/
+
+	static const TCPCongestionOps_t xCubicOps =
+	{
+		"cubic",
+		prvCubicInit,
+		prvCubicOnAck,
+		prvCubicSsthresh
+	};
+
+#endif /* ipconfigUSE_TCP_CONGESTION_CONTROL */
+/*-----------------------------------------------------------*/
+
+#if( ipconfigUSE_TCP_CONGESTION_CONTROL == 1 )
+
+	BaseType_t xTCPWindowSetCongestionControl( TCPWindow_t *pxWindow, BaseType_t xAlgorithm )
+	{
+	const TCPCongestionOps_t *pxOps;
+	BaseType_t xReturn = pdPASS;
+
+		switch( xAlgorithm )
+		{
+			case FREERTOS_TCP_CC_NEWRENO:
+				pxOps = &xNewRenoOps;
+				break;
+			case FREERTOS_TCP_CC_CUBIC:
+				pxOps = &xCubicOps;
+				break;
+			default:
+				pxOps = NULL;
+				xReturn = pdFAIL;
+				break;
+		}
+
+		if( pxOps != NULL )
+		{
+			/* The new algorithm continues with the current congestion window. */
+			pxWindow->xCongestion.pxOps = pxOps;
+			pxWindow->xCongestion.ucAlgorithm = ( uint8_t ) xAlgorithm;
+			pxOps->vInit( pxWindow );
+		}
+
+		return xReturn;
+	}
+
+#endif /* ipconfigUSE_TCP_CONGESTION_CONTROL */
+/*-----------------------------------------------------------*/
+
+#if( ipconfigUSE_TCP_CONGESTION_CONTROL == 1 )
+
+	static void prvCongestionInit( TCPWindow_t *pxWindow )
+	{
+	TCPCongestion_t *pxCongestion = &( pxWindow->xCongestion );
+	uint32_t ulMSS = ( uint32_t ) pxWindow->usMSS;
+
+		if( pxCongestion->pxOps == NULL )
+		{
+			pxCongestion->pxOps = &xNewRenoOps;
+			pxCongestion->ucAlgorithm = ( uint8_t ) FREERTOS_TCP_CC_NEWRENO;
+		}
+
+		/* Initial window: min( 4 * MSS, max( 2 * MSS, 4380 ) ) (RFC 3390).
+		The slow-start threshold starts arbitrarily high. */
+		pxCongestion->ulCwnd = FreeRTOS_min_uint32( 4UL * ulMSS, FreeRTOS_max_uint32( 2UL * ulMSS, 4380UL ) );
+		pxCongestion->ulSsthresh = 0xFFFFFFFFUL;
+		pxCongestion->ulBytesAcked = 0UL;
+		pxCongestion->ulRecover = pxWindow->tx.ulCurrentSequenceNumber;
+		pxCongestion->ucDupAcks = 0u;
+		pxCongestion->bInRecovery = pdFALSE_UNSIGNED;
+		pxCongestion->pxOps->vInit( pxWindow );
+	}
+
+#endif /* ipconfigUSE_TCP_CONGESTION_CONTROL */
+/*-----------------------------------------------------------*/
+
+#if( ipconfigUSE_TCP_CONGESTION_CONTROL == 1 )
+
+	static void prvCongestionRetransmitHead( TCPWindow_t *pxWindow )
+	{
+	TCPSegment_t *pxSegment;
+
+		/* Retransmit the oldest unacknowledged segment, unless it is already
+		queued for (re)transmission. */
+		if( listLIST_IS_EMPTY( &( pxWindow->xTxSegments ) ) == pdFALSE )
+		{
+			pxSegment = ( TCPSegment_t * ) listGET_OWNER_OF_HEAD_ENTRY( &( pxWindow->xTxSegments ) );
+
+			if( ( pxSegment->u.bits.bAcked == pdFALSE_UNSIGNED ) &&
+				( listLIST_ITEM_CONTAINER( &( pxSegment->xQueueItem ) ) == &( pxWindow->xWaitQueue ) ) )
+			{
+				uxListRemove( &pxSegment->xQueueItem );
+				vListInsertFifo( &( pxWindow->xPriorityQueue ), &( pxSegment->xQueueItem ) );
+
+				#if( ipconfigUSE_TCP_METRICS == 1 )
+				{
+					pxWindow->xStats.ulFastRetransmits++;
+				}
+				#endif
+			}
+		}
+	}
+
+#endif /* ipconfigUSE_TCP_CONGESTION_CONTROL */
+/*-----------------------------------------------------------*/
+
+#if( ipconfigUSE_TCP_CONGESTION_CONTROL == 1 )
+
+	static void prvCongestionEnterRecovery( TCPWindow_t *pxWindow )
+	{
+	TCPCongestion_t *pxCongestion = &( pxWindow->xCongestion );
+
+		/* A loss was detected by 3 duplicate ACKs or by SACK: fast
+		retransmit and fast recovery (RFC 5681 / RFC 6582). */
+		pxCongestion->ulSsthresh = pxCongestion->pxOps->ulSsthresh( pxWindow );
+		pxCongestion->ulCwnd = pxCongestion->ulSsthresh + ( DUPLICATE_ACKS_BEFORE_FAST_RETRANSMIT * pxWindow->usMSS );
+		pxCongestion->ulRecover = pxWindow->tx.ulHighestSequenceNumber;
+		pxCongestion->ulBytesAcked = 0UL;
+		pxCongestion->bInRecovery = pdTRUE_UNSIGNED;
+
+		if( ( xTCPWindowLoggingLevel != 0 ) && ( ipconfigTCP_MAY_LOG_PORT( pxWindow->usOurPortNumber ) != pdFALSE ) )
+		{
+			FreeRTOS_debug_printf( ( "TCP CC[%u,%u] %s: fast recovery at %lu, cwnd %lu ssthresh %lu\n",
+				pxWindow->usPeerPortNumber,
+				pxWindow->usOurPortNumber,
+				pxCongestion->pxOps->pcName,
+				pxWindow->tx.ulCurrentSequenceNumber - pxWindow->tx.ulFirstSequenceNumber,
+				pxCongestion->ulCwnd,
+				pxCongestion->ulSsthresh ) );
+		}
+	}
+
+#endif /* ipconfigUSE_TCP_CONGESTION_CONTROL */
+/*-----------------------------------------------------------*/
+
+#if( ipconfigUSE_TCP_CONGESTION_CONTROL == 1 )
+
+	void vTCPWindowTxDuplicateAck( TCPWindow_t *pxWindow )
+	{
+	TCPCongestion_t *pxCongestion = &( pxWindow->xCongestion );
+
+		if( prvCongestionFlightSize( pxWindow ) != 0UL )
+		{
+			if( pxCongestion->ucDupAcks < 0xffu )
+			{
+				pxCongestion->ucDupAcks++;
+			}
+
+			if( pxCongestion->bInRecovery != pdFALSE_UNSIGNED )
+			{
+				/* Every duplicate ACK means that a segment has left the
+				network: inflate the window. */
+				pxCongestion->ulCwnd += pxWindow->usMSS;
+			}
+			else if( ( pxCongestion->ucDupAcks == DUPLICATE_ACKS_BEFORE_FAST_RETRANSMIT ) &&
+					 ( xSequenceGreaterThanOrEqual( pxWindow->tx.ulCurrentSequenceNumber, pxCongestion->ulRecover ) != pdFALSE ) )
+			{
+				prvCongestionEnterRecovery( pxWindow );
+				prvCongestionRetransmitHead( pxWindow );
+			}
+		}
+	}
+
+#endif /* ipconfigUSE_TCP_CONGESTION_CONTROL */
+/*-----------------------------------------------------------*/
+
+#if( ipconfigUSE_TCP_CONGESTION_CONTROL == 1 )
+
+	static void prvCongestionAck( TCPWindow_t *pxWindow, uint32_t ulAcked )
+	{
+	TCPCongestion_t *pxCongestion = &( pxWindow->xCongestion );
+
+		pxCongestion->ucDupAcks = 0u;
+
+		if( pxCongestion->bInRecovery != pdFALSE_UNSIGNED )
+		{
+			if( xSequenceGreaterThanOrEqual( pxWindow->tx.ulCurrentSequenceNumber, pxCongestion->ulRecover ) != pdFALSE )
+			{
+				/* Full acknowledgement: leave fast recovery and deflate the
+				window to ssthresh. */
+				pxCongestion->bInRecovery = pdFALSE_UNSIGNED;
+				pxCongestion->ulCwnd = pxCongestion->ulSsthresh;
+			}
+			else
+			{
+				/* Partial acknowledgement (NewReno): the next hole is lost as
+				well, retransmit it and deflate by the amount acknowledged. */
+				prvCongestionRetransmitHead( pxWindow );
+				pxCongestion->ulCwnd -= FreeRTOS_min_uint32( ulAcked, pxCongestion->ulCwnd - pxWindow->usMSS );
+
+				if( ulAcked >= pxWindow->usMSS )
+				{
+					pxCongestion->ulCwnd += pxWindow->usMSS;
+				}
+			}
+		}
+		else
+		{
+			pxCongestion->pxOps->vOnAck( pxWindow, ulAcked );
+		}
+
+		pxCongestion->ulCwnd = FreeRTOS_min_uint32( pxCongestion->ulCwnd, prvCongestionLimit( pxWindow ) );
+	}
+
+#endif /* ipconfigUSE_TCP_CONGESTION_CONTROL */
+/*-----------------------------------------------------------*/
+
+#if( ipconfigUSE_TCP_CONGESTION_CONTROL == 1 )
+
+	static void prvCongestionTimeout( TCPWindow_t *pxWindow, const TCPSegment_t *pxSegment )
+	{
+	TCPCongestion_t *pxCongestion = &( pxWindow->xCongestion );
+
+		/* A retransmission time-out.  Every segment has its own timer, so
+		the window is reduced only once for all data which was outstanding
+		at the moment of the first time-out. */
+		if( xSequenceGreaterThanOrEqual( pxSegment->ulSequenceNumber, pxCongestion->ulRecover ) != pdFALSE )
+		{
+			pxCongestion->ulSsthresh = pxCongestion->pxOps->ulSsthresh( pxWindow );
+			pxCongestion->ulRecover = pxWindow->tx.ulHighestSequenceNumber;
+		}
+
+		/* Continue with slow start from a single segment (RFC 5681). */
+		pxCongestion->ulCwnd = pxWindow->usMSS;
+		pxCongestion->ulBytesAcked = 0UL;
+		pxCongestion->ucDupAcks = 0u;
+		pxCongestion->bInRecovery = pdFALSE_UNSIGNED;
+	}
+
+#endif /* ipconfigUSE_TCP_CONGESTION_CONTROL */
+/*-----------------------------------------------------------*/
+
 /*
 #####   #                      #####   ####  ######
 # # #   #                      # # #  #    #  #    #
@@ -1821,9 +2637,9 @@ const int32_t l500ms = 500;
 			if( pxSegment->u.bits.bOutstanding != pdFALSE_UNSIGNED )
 			{
 				/* As 'ucTransmitCount' has a minimum of 1, take 2 * RTT */
-				ulMaxTime = ( ( uint32_t ) 1u << pxSegment->u.bits.ucTransmitCount ) * ( ( uint32_t ) pxWindow->lSRTT );
+				ulMaxTime = prvSegmentMaxAge( pxWindow, pxSegment );
 
-				if( ulTimerGetAge( &( pxSegment->xTransmitTimer ) ) < ulMaxTime )
+				if( prvSegmentAge( pxSegment ) < ulMaxTime )
 				{
 					ulLength = 0ul;
 				}
@@ -1831,6 +2647,15 @@ const int32_t l500ms = 500;
 
 			if( ulLength != 0ul )
 			{
+				#if( ipconfigUSE_TCP_METRICS == 1 )
+				{
+					if( pxSegment->u.bits.bOutstanding != pdFALSE_UNSIGNED )
+					{
+						pxWindow->xStats.ulRetransmits++;
+					}
+				}
+				#endif
+
 				pxSegment->u.bits.bOutstanding = pdTRUE_UNSIGNED;
 				pxSegment->u.bits.ucTransmitCount++;
 				vTCPTimerSet (&pxSegment->xTransmitTimer);
@@ -1895,7 +2720,7 @@ const int32_t l500ms = 500;
 	{
 	TCPSegment_t *pxSegment = &( pxWindow->xTxSegment );
 	BaseType_t xReturn;
-	TickType_t ulAge, ulMaxAge;
+	uint32_t ulAge, ulMaxAge;
 
 		/* Check data to be sent. */
 		*pulDelay = ( TickType_t ) 0;
@@ -1908,12 +2733,12 @@ const int32_t l500ms = 500;
 		{
 			if( pxSegment->u.bits.bOutstanding != pdFALSE_UNSIGNED )
 			{
-				ulAge = ulTimerGetAge ( &pxSegment->xTransmitTimer );
-				ulMaxAge = ( ( TickType_t ) 1u << pxSegment->u.bits.ucTransmitCount ) * ( ( uint32_t ) pxWindow->lSRTT );
+				ulAge = prvSegmentAge( pxSegment );
+				ulMaxAge = prvSegmentMaxAge( pxWindow, pxSegment );
 
 				if( ulMaxAge > ulAge )
 				{
-					*pulDelay = ulMaxAge - ulAge;
+					*pulDelay = winTIMER_UNITS_TO_MS( ulMaxAge - ulAge );
 				}
 
 				xReturn = pdTRUE;
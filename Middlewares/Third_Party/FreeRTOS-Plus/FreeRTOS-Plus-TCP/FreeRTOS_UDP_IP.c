@@ -110,6 +110,7 @@ UDPPacket_t *pxUDPPacket;
 IPHeader_t *pxIPHeader;
 eARPLookupResult_t eReturned;
 uint32_t ulIPAddress = pxNetworkBuffer->ulIPAddress;
+BaseType_t xPacketParked = pdFALSE;
 
 	/* Map the UDP packet onto the start of the frame. */
 	pxUDPPacket = ( UDPPacket_t * ) pxNetworkBuffer->pucEthernetBuffer;
@@ -219,10 +220,22 @@ uint32_t ulIPAddress = pxNetworkBuffer->ulIPAddress;
 			outstanding, and perform retransmissions if necessary. */
 			vARPRefreshCacheEntry( NULL, ulIPAddress );
 
-			/* Generate an ARP for the required IP address. */
-			iptracePACKET_DROPPED_TO_GENERATE_ARP( pxNetworkBuffer->ulIPAddress );
-			pxNetworkBuffer->ulIPAddress = ulIPAddress;
-			vARPGenerateRequestPacket( pxNetworkBuffer );
+			#if( ipconfigARP_PENDING_QUEUE_LENGTH > 0 )
+			if( xARPQueuePendingPacket( pxNetworkBuffer, ulIPAddress ) != pdFALSE )
+			{
+				/* The packet is parked until the ARP reply comes in, send the
+				ARP request in a buffer of its own. */
+				FreeRTOS_OutputARPRequest( ulIPAddress );
+				xPacketParked = pdTRUE;
+			}
+			else
+			#endif /* ipconfigARP_PENDING_QUEUE_LENGTH */
+			{
+				/* Generate an ARP for the required IP address. */
+				iptracePACKET_DROPPED_TO_GENERATE_ARP( pxNetworkBuffer->ulIPAddress );
+				pxNetworkBuffer->ulIPAddress = ulIPAddress;
+				vARPGenerateRequestPacket( pxNetworkBuffer );
+			}
 		}
 		else
 		{
@@ -231,8 +244,20 @@ uint32_t ulIPAddress = pxNetworkBuffer->ulIPAddress;
 			eReturned = eCantSendPacket;
 		}
 	}
+	#if( ipconfigARP_PENDING_QUEUE_LENGTH > 0 )
+	else if( ( ulIPAddress != 0UL ) && ( xARPQueuePendingPacket( pxNetworkBuffer, ulIPAddress ) != pdFALSE ) )
+	{
+		/* An ARP request for the next hop is already outstanding, the
+		packet will be sent together with the ones parked earlier. */
+		xPacketParked = pdTRUE;
+	}
+	#endif /* ipconfigARP_PENDING_QUEUE_LENGTH */
 
-	if( eReturned != eCantSendPacket )
+	if( xPacketParked != pdFALSE )
+	{
+		/* The ARP module owns the network buffer now. */
+	}
+	else if( eReturned != eCantSendPacket )
 	{
 		/* The network driver is responsible for freeing the network buffer
 		after the packet has been sent. */
@@ -303,6 +328,17 @@ UDPPacket_t *pxUDPPacket = (UDPPacket_t *) pxNetworkBuffer->pucEthernetBuffer;
 		}
 		#endif /* ipconfigUSE_CALLBACKS */
 
+		#if( ( ipconfigUSE_DNS == 1 ) && ( ipconfigDNS_MAX_PENDING_QUERIES > 0 ) )
+		{
+			if( ( xReturn == pdPASS ) && ( xIsDNSSocket( ( Socket_t ) pxSocket ) != pdFALSE ) )
+			{
+				/* Replies to the DNS resolver are handled by the IP-task
+				itself, they are not queued. */
+				xReturn = ( BaseType_t ) ulDNSHandlePacket( pxNetworkBuffer );
+			}
+		}
+		#endif /* ipconfigDNS_MAX_PENDING_QUERIES */
+
 		#if( ipconfigUDP_MAX_RX_PACKETS > 0 )
 		{
 			if( xReturn == pdPASS )
@@ -328,6 +364,7 @@ UDPPacket_t *pxUDPPacket = (UDPPacket_t *) pxNetworkBuffer->pucEthernetBuffer;
 					{
 						/* Add the network packet to the list of packets to be
 						processed by the socket. */
+						ipLATENCY_STAMP( pxNetworkBuffer );
 						vListInsertEnd( &( pxSocket->u.xUDP.xWaitingPacketsList ), &( pxNetworkBuffer->xBufferListItem ) );
 					}
 					taskEXIT_CRITICAL();
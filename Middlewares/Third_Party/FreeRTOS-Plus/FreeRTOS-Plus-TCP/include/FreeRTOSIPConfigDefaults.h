@@ -173,6 +173,138 @@ from the FreeRTOSIPConfig.h configuration header file. */
 		#define	ipconfigTCP_WIN_SEG_COUNT		( 256 )
 	#endif
 
+	#ifndef ipconfigUSE_TCP_CONGESTION_CONTROL
+		/* When 1, every TCP connection keeps a congestion window (slow start,
+		congestion avoidance and fast recovery) on top of the peer's receive
+		window.  The algorithm can be chosen per socket with the
+		FREERTOS_SO_TCP_CONGESTION option. */
+		#define ipconfigUSE_TCP_CONGESTION_CONTROL	( 0 )
+	#endif
+
+	#if( ( ipconfigUSE_TCP_CONGESTION_CONTROL == 1 ) && ( ipconfigUSE_TCP_WIN == 0 ) )
+		#error ipconfigUSE_TCP_CONGESTION_CONTROL requires ipconfigUSE_TCP_WIN
+	#endif
+
+	#ifndef ipconfigTCP_CONGESTION_CONTROL_DEFAULT
+		/* The algorithm used by new sockets: FREERTOS_TCP_CC_NEWRENO ( 0 ) or
+		FREERTOS_TCP_CC_CUBIC ( 1 ). */
+		#define ipconfigTCP_CONGESTION_CONTROL_DEFAULT	( 0 )
+	#endif
+
+	#ifndef ipconfigTCP_ACK_POLICY
+		/* The ACK policy of new TCP sockets, see FREERTOS_SO_TCP_ACK_POLICY:
+		0 = delayed, 1 = quick, 2 = adaptive. */
+		#define ipconfigTCP_ACK_POLICY			( 0 )
+	#endif
+
+	#ifndef ipconfigTCP_ACK_EVERY_N_SEGMENTS
+		/* A delayed ACK will be sent at the latest after this number of
+		received segments, 0 means: only limited by the delayed-ACK timer. */
+		#define ipconfigTCP_ACK_EVERY_N_SEGMENTS	( 0 )
+	#endif
+
+	#ifndef ipconfigTCP_HIGH_RESOLUTION_RTT
+		/* When 1, round-trip times are measured with a free-running counter
+		rather than with the tick count, and the retransmission time-out is
+		calculated as in RFC 6298 (SRTT, RTTVAR and RTO). */
+		#define ipconfigTCP_HIGH_RESOLUTION_RTT	( 0 )
+	#endif
+
+	#if( ipconfigTCP_HIGH_RESOLUTION_RTT == 1 )
+		#ifndef ipconfigTCP_HR_TIMER_VALUE
+			#error ipconfigTCP_HR_TIMER_VALUE() must return a free-running 32-bit counter, e.g. the DWT cycle counter
+		#endif
+		#ifndef ipconfigTCP_HR_TIMER_COUNTS_PER_US
+			#error ipconfigTCP_HR_TIMER_COUNTS_PER_US must give the number of counts of ipconfigTCP_HR_TIMER_VALUE() per microsecond
+		#endif
+	#endif
+
+	#ifndef ipconfigTCP_RTO_MIN_US
+		/* Lower limit of the retransmission time-out in high-resolution mode.
+		RFC 6298 recommends one second, which is far too long for a local link. */
+		#define ipconfigTCP_RTO_MIN_US			( 200000UL )
+	#endif
+
+	#ifndef ipconfigTCP_RTO_MAX_US
+		#define ipconfigTCP_RTO_MAX_US			( 60000000UL )
+	#endif
+
+	#ifndef ipconfigTCP_RX_AUTOTUNE
+		/* When 1, the reception stream of a TCP socket grows with the measured
+		bandwidth-delay product, and streams of idle sockets are released.  A
+		socket stops auto-tuning when FREERTOS_SO_RCVBUF or
+		FREERTOS_SO_WIN_PROPERTIES is used. */
+		#define ipconfigTCP_RX_AUTOTUNE			( 0 )
+	#endif
+
+	#if( ( ipconfigTCP_RX_AUTOTUNE == 1 ) && ( ipconfigUSE_TCP_WIN == 0 ) )
+		#error ipconfigTCP_RX_AUTOTUNE requires ipconfigUSE_TCP_WIN
+	#endif
+
+	#ifndef ipconfigTCP_RX_AUTOTUNE_MAX_LENGTH
+		/* The largest size of an auto-tuned reception stream.  The reception
+		window will be at most half of it. */
+		#define ipconfigTCP_RX_AUTOTUNE_MAX_LENGTH	( 16u * ipconfigTCP_MSS )
+	#endif
+
+	#ifndef ipconfigTCP_RX_AUTOTUNE_BUDGET
+		/* The number of bytes that all auto-tuned reception streams together
+		may use on top of their initial size. */
+		#define ipconfigTCP_RX_AUTOTUNE_BUDGET	( 2u * ipconfigTCP_RX_AUTOTUNE_MAX_LENGTH )
+	#endif
+
+	#ifndef ipconfigTCP_RX_AUTOTUNE_IDLE_MS
+		/* An empty reception stream is released after this time without
+		reception.  It will be created again with its initial size. */
+		#define ipconfigTCP_RX_AUTOTUNE_IDLE_MS	( 5000u )
+	#endif
+
+	#ifndef ipconfigUSE_TCP_SYN_CACHE
+		/* When 1, a listening socket answers a SYN from a small table of
+		half-open connections, and the child socket is only created when the
+		handshake is completed.  Connected children are queued to the listening
+		socket in order of arrival, and returned by FreeRTOS_accept(). */
+		#define ipconfigUSE_TCP_SYN_CACHE		( 0 )
+	#endif
+
+	#ifndef ipconfigTCP_SYN_CACHE_ENTRIES
+		/* The number of half-open connections that can be remembered.  When
+		the table is full, the oldest entry is dropped. */
+		#define ipconfigTCP_SYN_CACHE_ENTRIES	( 8 )
+	#endif
+
+	#ifndef ipconfigTCP_SYN_CACHE_TIMEOUT_MS
+		/* Time that a half-open connection waits for the final ACK. */
+		#define ipconfigTCP_SYN_CACHE_TIMEOUT_MS	( 10000u )
+	#endif
+
+	#ifndef ipconfigUSE_TCP_TIME_WAIT
+		/* When 1, a connection that was closed by this side is remembered in a
+		small table of addresses and sequence numbers, so its socket can be
+		freed immediately.  The table acknowledges a repeated FIN from the peer
+		and answers new data with a RST. */
+		#define ipconfigUSE_TCP_TIME_WAIT		( 0 )
+	#endif
+
+	#ifndef ipconfigTCP_TIME_WAIT_ENTRIES
+		/* The number of closed connections that can be remembered.  When the
+		table is full, the oldest entry is dropped. */
+		#define ipconfigTCP_TIME_WAIT_ENTRIES	( 8 )
+	#endif
+
+	#ifndef ipconfigTCP_TIME_WAIT_MS
+		/* How long a closed connection is remembered, normally 2 x MSL. */
+		#define ipconfigTCP_TIME_WAIT_MS		( 30000u )
+	#endif
+
+	#ifndef ipconfigUSE_TCP_METRICS
+		/* When 1, every TCP connection counts its retransmissions, SACK's,
+		duplicate segments and zero-window stalls.  They can be read together
+		with the RTT and the stream occupancy with FreeRTOS_GetTCPMetrics() and
+		FreeRTOS_GetAllTCPMetrics(), also when printing is disabled. */
+		#define ipconfigUSE_TCP_METRICS			( 0 )
+	#endif
+
 	#ifndef ipconfigIGNORE_UNKNOWN_PACKETS
 		/* When non-zero, TCP will not send RST packets in reply to
 		TCP packets which are unknown, or out-of-order. */
@@ -180,6 +312,63 @@ from the FreeRTOSIPConfig.h configuration header file. */
 	#endif
 #endif
 
+#ifndef ipconfigUSE_BENCHMARKS
+	/* When 1, tools/tcp_utilities/tcp_benchmark.c is compiled: a set of
+	micro-benchmarks of the checksum, stream buffers, socket lookup, TCP
+	windows, network buffers, frame filtering and the heap. */
+	#define ipconfigUSE_BENCHMARKS				( 0 )
+#endif
+
+#ifndef ipconfigUSE_PCAP_REPLAY
+	/* When 1, tools/tcp_utilities/tcp_pcap_replay.c is compiled: it feeds a
+	pcap or pcapng capture into the IP-task, and the IP-task measures the
+	cost of every received packet. */
+	#define ipconfigUSE_PCAP_REPLAY				( 0 )
+#endif
+
+#ifndef ipconfigPCAP_REPLAY_USE_FILES
+	/* When 1, xPcapReplayFile() is available to read a capture from a file,
+	for hosts that have a file system. */
+	#define ipconfigPCAP_REPLAY_USE_FILES		( 0 )
+#endif
+
+#ifndef ipconfigUSE_LATENCY_HISTOGRAMS
+	/* When 1, network buffers carry a timestamp, and the time that a packet
+	spends in each stage between the driver, the IP-task and the sockets is
+	collected in histograms, see FreeRTOS_GetLatencyHistogram(). */
+	#define ipconfigUSE_LATENCY_HISTOGRAMS		( 0 )
+#endif
+
+#ifndef ipconfigLATENCY_HISTOGRAM_BUCKETS
+	/* Bucket 0 counts latencies of 0 or 1 timer counts, bucket 'n' counts
+	latencies from 2^n up to 2^(n+1) counts.  The last bucket also counts
+	anything longer.  With a 100 MHz cycle counter, 24 buckets reach up to
+	168 ms. */
+	#define ipconfigLATENCY_HISTOGRAM_BUCKETS	( 24 )
+#endif
+
+#if( ( ipconfigUSE_BENCHMARKS == 1 ) || ( ipconfigUSE_PCAP_REPLAY == 1 ) || ( ipconfigUSE_LATENCY_HISTOGRAMS == 1 ) )
+	/* The benchmarks, the pcap replay and the latency histograms need a
+	free-running 32-bit counter, by default the one that is used for
+	high-resolution RTT measurements.  On a host, it can be based on
+	clock_gettime(). */
+	#ifndef ipconfigBENCHMARK_TIMER_VALUE
+		#ifdef ipconfigTCP_HR_TIMER_VALUE
+			#define ipconfigBENCHMARK_TIMER_VALUE()		ipconfigTCP_HR_TIMER_VALUE()
+		#else
+			#error ipconfigBENCHMARK_TIMER_VALUE() must return a free-running 32-bit counter
+		#endif
+	#endif
+
+	#ifndef ipconfigBENCHMARK_COUNTS_PER_US
+		#ifdef ipconfigTCP_HR_TIMER_COUNTS_PER_US
+			#define ipconfigBENCHMARK_COUNTS_PER_US		ipconfigTCP_HR_TIMER_COUNTS_PER_US
+		#else
+			#error ipconfigBENCHMARK_COUNTS_PER_US must be the number of timer counts per microsecond
+		#endif
+	#endif
+#endif /* ipconfigUSE_BENCHMARKS || ipconfigUSE_PCAP_REPLAY || ipconfigUSE_LATENCY_HISTOGRAMS */
+
 /*
  * For debuging/logging: check if the port number is used for telnet
  * Some events will not be logged for telnet connections
@@ -275,6 +464,42 @@ from the FreeRTOSIPConfig.h configuration header file. */
 	#define vPortFreeSocket(ptr)				vPortFree(ptr)
 #endif
 
+/*
+ * When ipconfigUSE_SOCKET_POOL is 1, sockets and TCP streams are taken from
+ * statically allocated pools, and given back to them when a socket is closed.
+ * A pooled socket also keeps its event group.  There are two size classes of
+ * streams, by default for the Tx and the Rx stream of a TCP socket.  The heap
+ * is only used when a pool is empty, or when a stream is larger than both
+ * classes.
+ */
+#ifndef ipconfigUSE_SOCKET_POOL
+	#define ipconfigUSE_SOCKET_POOL				0
+#endif
+
+#ifndef ipconfigSOCKET_POOL_SOCKETS
+	#define ipconfigSOCKET_POOL_SOCKETS			( 4 )
+#endif
+
+#ifndef ipconfigSOCKET_POOL_SMALL_STREAM_LENGTH
+	#define ipconfigSOCKET_POOL_SMALL_STREAM_LENGTH	( ( ( ipconfigTCP_TX_BUFFER_LENGTH + ipconfigTCP_MSS - 1u ) / ipconfigTCP_MSS ) * ipconfigTCP_MSS )
+#endif
+
+#ifndef ipconfigSOCKET_POOL_SMALL_STREAMS
+	#define ipconfigSOCKET_POOL_SMALL_STREAMS	( 4 )
+#endif
+
+#ifndef ipconfigSOCKET_POOL_LARGE_STREAM_LENGTH
+	#define ipconfigSOCKET_POOL_LARGE_STREAM_LENGTH	( ipconfigTCP_RX_BUFFER_LENGTH )
+#endif
+
+#ifndef ipconfigSOCKET_POOL_LARGE_STREAMS
+	#define ipconfigSOCKET_POOL_LARGE_STREAMS	( 4 )
+#endif
+
+#if( ipconfigUSE_SOCKET_POOL == 1 ) && ( ( ipconfigSOCKET_POOL_SOCKETS < 1 ) || ( ipconfigSOCKET_POOL_SMALL_STREAMS < 1 ) || ( ipconfigSOCKET_POOL_LARGE_STREAMS < 1 ) )
+	#error Each of the socket pools must have at least one object
+#endif
+
 /*
  * At several places within the library, random numbers are needed:
  * - DHCP:    For creating a DHCP transaction number
@@ -319,6 +544,25 @@ from the FreeRTOSIPConfig.h configuration header file. */
 	#define	ipconfigUSE_ARP_REMOVE_ENTRY		0
 #endif
 
+#ifndef ipconfigARP_PENDING_QUEUE_LENGTH
+	/* When non-zero, an outgoing UDP packet for which the MAC address is not
+	yet known will be parked in a queue of this length while an ARP request is
+	sent.  The packet is sent as soon as the ARP reply arrives.  When zero, the
+	packet is turned into an ARP request and its payload is lost. */
+	#define ipconfigARP_PENDING_QUEUE_LENGTH	0
+#endif
+
+#ifndef ipconfigARP_PENDING_PER_DESTINATION
+	/* The maximum number of parked packets per next-hop address. */
+	#define ipconfigARP_PENDING_PER_DESTINATION	2
+#endif
+
+#ifndef ipconfigARP_PENDING_TIMEOUT_MS
+	/* Parked packets older than this will be dropped.  The queue is checked
+	when a packet is added and when the ARP cache is aged. */
+	#define ipconfigARP_PENDING_TIMEOUT_MS		3000
+#endif
+
 #ifndef ipconfigINCLUDE_FULL_INET_ADDR
 	#define ipconfigINCLUDE_FULL_INET_ADDR	1
 #endif
@@ -543,10 +787,63 @@ from the FreeRTOSIPConfig.h configuration header file. */
 	#define ipconfigDNS_USE_CALLBACKS 0
 #endif
 
+#ifndef ipconfigDNS_MAX_PENDING_QUERIES
+	/* When non-zero, DNS look-ups are handled by a resolver that keeps a
+	single UDP socket open and can have this many queries outstanding at the
+	same time.  Replies are matched to their query by the transaction ID, and
+	look-ups of a name that is already being resolved share the same query.
+	Retransmissions are driven by the DNS timer, so the resolver requires
+	ipconfigDNS_USE_CALLBACKS. */
+	#define ipconfigDNS_MAX_PENDING_QUERIES		0
+#endif
+
+#if( ipconfigDNS_MAX_PENDING_QUERIES > 0 )
+	#if( ipconfigDNS_USE_CALLBACKS == 0 )
+		#error ipconfigDNS_MAX_PENDING_QUERIES requires ipconfigDNS_USE_CALLBACKS
+	#endif
+
+	#if( ipconfigDNS_MAX_PENDING_QUERIES > 8 )
+		/* Every query uses one bit of an event group. */
+		#error ipconfigDNS_MAX_PENDING_QUERIES can not be larger than 8
+	#endif
+
+	#ifndef ipconfigDNS_QUERY_NAME_LENGTH
+		/* The longest host name (plus terminating zero) that can be resolved. */
+		#define ipconfigDNS_QUERY_NAME_LENGTH		( 64 )
+	#endif
+
+	#ifndef ipconfigDNS_REQUEST_TIMEOUT_MS
+		/* Time to wait for a reply before a query is sent again. */
+		#define ipconfigDNS_REQUEST_TIMEOUT_MS		( 1200 )
+	#endif
+
+	#ifndef ipconfigDNS_NEGATIVE_CACHE_TTL_SEC
+		/* Time for which the cache remembers that a name does not exist. */
+		#define ipconfigDNS_NEGATIVE_CACHE_TTL_SEC	( 30 )
+	#endif
+#endif /* ipconfigDNS_MAX_PENDING_QUERIES > 0 */
+
 #ifndef ipconfigSUPPORT_SIGNALS
 	#define ipconfigSUPPORT_SIGNALS				0
 #endif
 
+#ifndef ipconfigSUPPORT_MSG_FUNCTIONS
+	/* When non-zero, FreeRTOS_sendmsg() and FreeRTOS_recvmsg() are available.
+	They take an array of 'struct freertos_iovec' and copy the data directly
+	between the user's fragments and the network buffer (UDP) or the stream
+	buffers (TCP), so there is no need for an intermediate staging buffer.
+	FreeRTOS_sendmmsg() and FreeRTOS_recvmmsg() transfer a batch of UDP
+	datagrams with a single IP-task event or a single wake-up. */
+	#define ipconfigSUPPORT_MSG_FUNCTIONS		0
+#endif
+
+#ifndef ipconfigUSE_LINK_EMULATOR
+	/* When 1, portable/NetworkInterface/LinkEmulator provides the network
+	interface instead of the target's own driver.  It must then be the only
+	NetworkInterface that is linked. */
+	#define ipconfigUSE_LINK_EMULATOR			0
+#endif
+
 #ifndef ipconfigUSE_NBNS
 	#define ipconfigUSE_NBNS 0
 #endif
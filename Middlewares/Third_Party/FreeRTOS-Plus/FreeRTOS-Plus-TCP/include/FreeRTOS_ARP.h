@@ -77,6 +77,7 @@ typedef struct xARP_CACHE_TABLE_ROW
 	MACAddress_t xMACAddress;  /* The MAC address of an ARP cache entry. */
 	uint8_t ucAge;				/* A value that is periodically decremented but can also be refreshed by active communication.  The ARP cache entry is removed if the value reaches zero. */
     uint8_t ucValid;			/* pdTRUE: xMACAddress is valid, pdFALSE: waiting for ARP reply */
+	uint32_t ulLastUsed;		/* Value of a usage counter when the entry was last refreshed or looked up, the entry with the oldest value gets replaced first. */
 } ARPCacheRow_t;
 
 typedef enum
@@ -153,6 +154,18 @@ void vARPGenerateRequestPacket( NetworkBufferDescriptor_t * const pxNetworkBuffe
  */
 void vARPSendGratuitous( void );
 
+#if( ipconfigARP_PENDING_QUEUE_LENGTH > 0 )
+
+	/*
+	 * Park an outgoing packet until the MAC address of ulNextHopAddress is
+	 * known.  Returns pdTRUE if the queue has taken ownership of the buffer.
+	 * Returns pdFALSE when the queue or the quota for this address is full, or
+	 * when no ARP resolution is outstanding for ulNextHopAddress.
+	 */
+	BaseType_t xARPQueuePendingPacket( NetworkBufferDescriptor_t * const pxNetworkBuffer, uint32_t ulNextHopAddress );
+
+#endif /* ipconfigARP_PENDING_QUEUE_LENGTH */
+
 #ifdef __cplusplus
 } // extern "C"
 #endif
@@ -137,6 +137,16 @@ uint32_t ulDNSHandlePacket( NetworkBufferDescriptor_t *pxNetworkBuffer );
 
 #endif
 
+#if( ipconfigDNS_MAX_PENDING_QUERIES > 0 )
+
+	/*
+	 * Returns pdTRUE if xSocket is the socket of the DNS resolver.  Packets for
+	 * this socket are passed to ulDNSHandlePacket() by the IP-task.
+	 */
+	BaseType_t xIsDNSSocket( Socket_t xSocket );
+
+#endif
+
 /*
  * FULL, UP-TO-DATE AND MAINTAINED REFERENCE DOCUMENTATION FOR ALL THESE
  * FUNCTIONS IS AVAILABLE ON THE FOLLOWING URL:
@@ -126,8 +126,11 @@ typedef struct xNETWORK_BUFFER
 	size_t xDataLength; 			/* Starts by holding the total Ethernet frame length, then the UDP/TCP payload length. */
 	uint16_t usPort;				/* Source or destination port, depending on usage scenario. */
 	uint16_t usBoundPort;			/* The port to which a transmitting socket is bound. */
-	#if( ipconfigUSE_LINKED_RX_MESSAGES != 0 )
-		struct xNETWORK_BUFFER *pxNextBuffer; /* Possible optimisation for expert users - requires network driver support. */
+	#if( ipconfigUSE_LINKED_RX_MESSAGES != 0 ) || ( ipconfigSUPPORT_MSG_FUNCTIONS == 1 )
+		struct xNETWORK_BUFFER *pxNextBuffer; /* Possible optimisation for expert users - requires network driver support.  Also chains the packets of FreeRTOS_sendmmsg(). */
+	#endif
+	#if( ipconfigUSE_LATENCY_HISTOGRAMS == 1 )
+		uint32_t ulLatencyStamp;	/* The time at which the packet entered its current stage, see eLatencyStage_t. */
 	#endif
 } NetworkBufferDescriptor_t;
 
@@ -270,6 +273,40 @@ BaseType_t FreeRTOS_IsNetworkUp( void );
 	UBaseType_t uxGetMinimumIPQueueSpace( void );
 #endif
 
+#if( ipconfigUSE_LATENCY_HISTOGRAMS == 1 )
+	/* The stages of a packet for which the latency is measured. */
+	typedef enum eLATENCY_STAGE
+	{
+		eLatencyRxDriver = 0,	/* Reception interrupt until the network interface task has the frame in a network buffer. */
+		eLatencyRxQueue,		/* Network buffer sent to the IP-task until the IP-task starts processing it. */
+		eLatencyRxProcess,		/* The IP-task processing a received packet. */
+		eLatencyRxSocket,		/* Data delivered to a socket until FreeRTOS_recv() or FreeRTOS_recvfrom() returns it. */
+		eLatencyTxQueue,		/* FreeRTOS_sendto() until the IP-task starts processing the packet. */
+		eLatencyTxProcess,		/* The IP-task starts processing, or creates, a packet until it is passed to the network interface. */
+		eLatencyTxDriver,		/* The network interface accepting the packet for transmission. */
+		eLatencyStageCount
+	} eLatencyStage_t;
+
+	/* Latencies are expressed in counts of ipconfigBENCHMARK_TIMER_VALUE(). */
+	typedef struct xLATENCY_HISTOGRAM
+	{
+		uint32_t ulCount;
+		uint32_t ulMin;
+		uint32_t ulMax;
+		uint64_t ullTotal;
+		uint32_t ulBuckets[ ipconfigLATENCY_HISTOGRAM_BUCKETS ];
+	} LatencyHistogram_t;
+
+	/* Copy the histogram of one stage.  Returns pdFAIL for an invalid stage. */
+	BaseType_t FreeRTOS_GetLatencyHistogram( eLatencyStage_t eStage, LatencyHistogram_t *pxHistogram );
+
+	/* Clear all histograms, e.g. after changing a task priority. */
+	void FreeRTOS_ResetLatencyHistograms( void );
+
+	/* Print all histograms with FreeRTOS_printf(). */
+	void FreeRTOS_PrintLatencyHistograms( void );
+#endif /* ipconfigUSE_LATENCY_HISTOGRAMS */
+
 /*
  * Defined in FreeRTOS_Sockets.c
  * //_RB_ Don't think this comment is correct.  If this is for internal use only it should appear after all the public API functions and not start with FreeRTOS_.
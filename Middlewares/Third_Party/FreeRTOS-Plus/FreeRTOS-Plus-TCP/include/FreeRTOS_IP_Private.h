@@ -286,6 +286,7 @@ typedef enum
 	eSocketCloseEvent,		/* 9: Send a message to the IP-task to close a socket. */
 	eSocketSelectEvent,		/*10: Send a message to the IP-task for select(). */
 	eSocketSignalEvent,		/*11: A socket must be signalled. */
+	eStackTxChainEvent,		/*12: The software stack has queued a chain of UDP packets to transmit. */
 } eIPEvent_t;
 
 typedef struct IP_TASK_COMMANDS
@@ -490,6 +491,14 @@ BaseType_t xIPIsNetworkTaskReady( void );
 	 */
 	TickType_t xTCPTimerCheck( BaseType_t xWillSleep );
 
+	#if( ipconfigARP_PENDING_QUEUE_LENGTH > 0 )
+		/*
+		 * The MAC address of ulIPAddress has just been learned.  Sockets that
+		 * are waiting for it in order to send a SYN will be checked at once.
+		 */
+		void vTCPARPResolved( uint32_t ulIPAddress );
+	#endif
+
 	/* Every TCP socket has a buffer space just big enough to store
 	the last TCP header received.
 	As a reference of this field may be passed to DMA, force the
@@ -548,7 +557,11 @@ BaseType_t xIPIsNetworkTaskReady( void );
 				bFinLast : 1,		/* The last ACK (after FIN and FIN+ACK) has been sent or will be sent by the peer */
 				bRxStopped : 1,		/* Application asked to temporarily stop reception */
 				bMallocError : 1,	/* There was an error allocating a stream */
-				bWinScaling : 1;	/* A TCP-Window Scaling option was offered and accepted in the SYN phase. */
+				bWinScaling : 1,	/* A TCP-Window Scaling option was offered and accepted in the SYN phase. */
+				bCork : 1,			/* FREERTOS_SO_TCP_CORK: only send full-size segments */
+				bNagle : 1,			/* FREERTOS_SO_TCP_NODELAY cleared: hold small segments while data is outstanding */
+				bRxAutoTune : 1,	/* The size of rxStream follows the measured bandwidth-delay product */
+				bRxRttSample : 1;	/* A round-trip time sample of the reception is being taken */
 		} bits;
 		uint32_t ulHighestRxAllowed;
 								/* The highest sequence number that we can receive at any moment */
@@ -562,6 +575,11 @@ BaseType_t xIPIsNetworkTaskReady( void );
 								 * TCP win segments */
 		uint8_t ucTCPState;		/* TCP state: see eTCP_STATE */
 		struct XSOCKET *pxPeerSocket;	/* for server socket: child, for child socket: parent */
+		#if( ipconfigUSE_TCP_SYN_CACHE == 1 )
+			struct XSOCKET *pxAcceptHead;	/* for server socket: first connected child waiting for accept() */
+			struct XSOCKET *pxAcceptTail;	/* for server socket: last connected child waiting for accept() */
+			struct XSOCKET *pxAcceptNext;	/* for child socket: next child in the accept queue of the parent */
+		#endif /* ipconfigUSE_TCP_SYN_CACHE */
 		#if( ipconfigTCP_KEEP_ALIVE == 1 )
 			uint8_t ucKeepRepCount;
 			TickType_t xLastAliveTime;
@@ -575,8 +593,24 @@ BaseType_t xIPIsNetworkTaskReady( void );
 		size_t uxTxStreamSize;
 		StreamBuffer_t *rxStream;
 		StreamBuffer_t *txStream;
+		#if( ipconfigTCP_RX_AUTOTUNE == 1 )
+			size_t uxRxBaseSize;		/* Initial value of uxRxStreamSize, auto-tuning never goes below it */
+			uint32_t ulRxTuneBytes;		/* Bytes received in-order since ulRxTuneStamp */
+			uint32_t ulRxTuneStamp;		/* Start of the current rate measurement */
+			uint32_t ulRxRttBytes;		/* Bytes still to be received before the RTT sample is complete */
+			uint32_t ulRxRttStamp;		/* Start of the current RTT sample */
+			uint32_t ulRxRtt;			/* Shortest time needed to receive a full window, 0 when unknown */
+			TickType_t xRxLastTime;		/* Time of the last in-order reception */
+		#endif /* ipconfigTCP_RX_AUTOTUNE */
+		#if( ipconfigUSE_LATENCY_HISTOGRAMS == 1 )
+			uint32_t ulRxLatencyStamp;	/* Time at which the oldest unread byte in rxStream arrived */
+		#endif
 		#if( ipconfigUSE_TCP_WIN == 1 )
 			NetworkBufferDescriptor_t *pxAckMessage;
+			uint8_t ucAckPolicy;		/* FREERTOS_TCP_ACK_xxx: when may an ACK be delayed */
+			uint8_t ucAckSegments;		/* Send an ACK at least every N received segments, 0 for no limit */
+			uint8_t ucUnackedSegments;	/* Segments received since the last packet which carried an ACK */
+			uint8_t ucBulkSegments;		/* Consecutive full-size segments received, used by FREERTOS_TCP_ACK_ADAPTIVE */
 		#endif /* ipconfigUSE_TCP_WIN */
 		/* Buffer space to store the last TCP header received. */
 		LastTCPPacket_t xPacket;
@@ -585,6 +619,9 @@ BaseType_t xIPIsNetworkTaskReady( void );
 			uint8_t ucMyWinScaleFactor;
 			uint8_t ucPeerWinScaleFactor;
 		#endif
+		#if( ipconfigUSE_TCP_CONGESTION_CONTROL == 1 )
+			uint8_t ucCongestionControl;	/* FREERTOS_TCP_CC_xxx, applied to xTCPWindow when it is created */
+		#endif
 		#if( ipconfigUSE_CALLBACKS == 1 )
 			FOnTCPReceive_t pxHandleReceive;	/*
 										 		 * In case of a TCP socket:
@@ -677,6 +714,38 @@ typedef struct XSOCKET
 
 #endif /* ipconfigUSE_TCP */
 
+#if( ipconfigUSE_PCAP_REPLAY == 1 )
+	/*
+	 * Called by the IP-task before and after processing a received packet, so
+	 * that tools/tcp_utilities/tcp_pcap_replay.c can measure the cost of each
+	 * protocol.  The first returns the class of the packet, which must be
+	 * determined before the buffer is processed and possibly re-used.
+	 */
+	BaseType_t xPcapReplayClassify( const uint8_t *pucEthernetBuffer );
+	void vPcapReplayPacketProcessed( BaseType_t xClass, uint32_t ulStartTime );
+#endif /* ipconfigUSE_PCAP_REPLAY */
+
+#if( ipconfigUSE_LATENCY_HISTOGRAMS == 1 )
+	/*
+	 * Add the time since pxNetworkBuffer->ulLatencyStamp to the histogram of
+	 * eStage, and stamp the buffer again for the next stage.
+	 */
+	void vLatencyStage( NetworkBufferDescriptor_t *pxNetworkBuffer, eLatencyStage_t eStage );
+
+	/*
+	 * Add the time since ulStartTime to the histogram of eStage, for stages that
+	 * end when the buffer may already have been passed on or released.
+	 */
+	void vLatencyRecord( eLatencyStage_t eStage, uint32_t ulStartTime );
+
+	#define ipLATENCY_TIME()						( ( uint32_t ) ipconfigBENCHMARK_TIMER_VALUE() )
+	#define ipLATENCY_STAMP( pxNetworkBuffer )		( ( pxNetworkBuffer )->ulLatencyStamp = ipLATENCY_TIME() )
+	#define ipLATENCY_STAGE( pxNetworkBuffer, eStage )	vLatencyStage( ( pxNetworkBuffer ), ( eStage ) )
+#else
+	#define ipLATENCY_STAMP( pxNetworkBuffer )
+	#define ipLATENCY_STAGE( pxNetworkBuffer, eStage )
+#endif /* ipconfigUSE_LATENCY_HISTOGRAMS */
+
 /*
  * Look up a local socket by finding a match with the local port.
  */
@@ -749,6 +818,13 @@ BaseType_t xTCPSocketCheck( FreeRTOS_Socket_t *pxSocket );
 
 BaseType_t xTCPCheckNewClient( FreeRTOS_Socket_t *pxSocket );
 
+#if( ipconfigUSE_TCP_TIME_WAIT == 1 )
+	/* Remember a connection of which this side has sent the first FIN, and
+	which FIN has been acknowledged.  Called when the closure is complete, and
+	when the socket is closed. */
+	void vTCPTimeWaitAdd( FreeRTOS_Socket_t *pxSocket );
+#endif /* ipconfigUSE_TCP_TIME_WAIT */
+
 /* Defined in FreeRTOS_Sockets.c
  * Close a socket
  */
@@ -158,6 +158,27 @@ FreeRTOS_setsockopt(). */
 	#define FREERTOS_SO_UDP_MAX_RX_PACKETS	( 16 )		/* This option helps to limit the maximum number of packets a UDP socket will buffer */
 #endif
 
+#if( ipconfigUSE_TCP_CONGESTION_CONTROL == 1 )
+	#define FREERTOS_SO_TCP_CONGESTION	( 17 )		/* Select the congestion-control algorithm, parameter is pointer to BaseType_t holding FREERTOS_TCP_CC_xxx */
+
+	/* Values for FREERTOS_SO_TCP_CONGESTION. */
+	#define FREERTOS_TCP_CC_NEWRENO		( 0 )
+	#define FREERTOS_TCP_CC_CUBIC		( 1 )
+#endif
+
+#if( ipconfigUSE_TCP_WIN == 1 )
+	#define FREERTOS_SO_TCP_ACK_POLICY	( 18 )		/* When to delay ACK's, parameter is pointer to BaseType_t holding FREERTOS_TCP_ACK_xxx */
+	#define FREERTOS_SO_TCP_ACK_SEGMENTS ( 19 )		/* Send an ACK at least every N segments, parameter is pointer to BaseType_t, 0 means no limit */
+
+	/* Values for FREERTOS_SO_TCP_ACK_POLICY. */
+	#define FREERTOS_TCP_ACK_DELAYED	( 0 )		/* Delay ACK's as long as more data is expected */
+	#define FREERTOS_TCP_ACK_QUICK		( 1 )		/* Acknowledge every segment immediately */
+	#define FREERTOS_TCP_ACK_ADAPTIVE	( 2 )		/* Immediate ACK's for request/response traffic, delayed ACK's during bulk transfers */
+#endif
+
+#define FREERTOS_SO_TCP_CORK			( 20 )		/* Non-zero: hold data until a full MSS can be sent, zero: send what is left.  Same as FREERTOS_SO_SET_FULL_SIZE */
+#define FREERTOS_SO_TCP_NODELAY			( 21 )		/* Non-zero (default): send data immediately, zero: use the Nagle algorithm */
+
 #define FREERTOS_NOT_LAST_IN_FRAGMENTED_PACKET 	( 0x80 )  /* For internal use only, but also part of an 8-bit bitwise value. */
 #define FREERTOS_FRAGMENTED_PACKET				( 0x40 )  /* For internal use only, but also part of an 8-bit bitwise value. */
 
@@ -171,6 +192,7 @@ FreeRTOS_setsockopt(). */
 #define FREERTOS_MSG_PEEK				( 4 )		/* peek at incoming message */
 #define FREERTOS_MSG_DONTROUTE			( 8 )		/* send without using routing tables */
 #define FREERTOS_MSG_DONTWAIT			( 16 )		/* Can be used with recvfrom(), sendto(), recv(), and send(). */
+#define FREERTOS_MSG_TRUNC				( 32 )		/* Returned in msg_flags by recvmsg(): the datagram was larger than the buffers supplied. */
 
 typedef struct xWIN_PROPS {
 	/* Properties of the Tx buffer and Tx window */
@@ -200,6 +222,38 @@ struct freertos_sockaddr
 	uint32_t sin_addr;
 };
 
+/* A single fragment of a message, used by FreeRTOS_sendmsg() and
+FreeRTOS_recvmsg(). */
+struct freertos_iovec
+{
+	void *iov_base;		/* Start of the fragment. */
+	size_t iov_len;		/* Number of bytes in the fragment. */
+};
+
+#if( ipconfigSUPPORT_MSG_FUNCTIONS == 1 )
+
+	/* A message made up of 'msg_iovlen' fragments.  'msg_name' is only used by
+	UDP sockets: it holds the destination address for FreeRTOS_sendmsg() and
+	receives the source address in FreeRTOS_recvmsg().  It may be NULL. */
+	struct freertos_msghdr
+	{
+		struct freertos_sockaddr *msg_name;
+		socklen_t msg_namelen;
+		struct freertos_iovec *msg_iov;
+		size_t msg_iovlen;
+		BaseType_t msg_flags;	/* Set by FreeRTOS_recvmsg(), e.g. FREERTOS_MSG_TRUNC. */
+	};
+
+	/* An element of the array passed to FreeRTOS_sendmmsg() and
+	FreeRTOS_recvmmsg(). */
+	struct freertos_mmsghdr
+	{
+		struct freertos_msghdr msg_hdr;
+		uint32_t msg_len;		/* Number of bytes sent or received for this message. */
+	};
+
+#endif /* ipconfigSUPPORT_MSG_FUNCTIONS */
+
 #if ipconfigBYTE_ORDER == pdFREERTOS_LITTLE_ENDIAN
 
 	#define FreeRTOS_inet_addr_quick( ucOctet0, ucOctet1, ucOctet2, ucOctet3 )				\
@@ -249,6 +303,15 @@ int32_t FreeRTOS_recvfrom( Socket_t xSocket, void *pvBuffer, size_t xBufferLengt
 int32_t FreeRTOS_sendto( Socket_t xSocket, const void *pvBuffer, size_t xTotalDataLength, BaseType_t xFlags, const struct freertos_sockaddr *pxDestinationAddress, socklen_t xDestinationAddressLength );
 BaseType_t FreeRTOS_bind( Socket_t xSocket, struct freertos_sockaddr *pxAddress, socklen_t xAddressLength );
 
+#if( ipconfigSUPPORT_MSG_FUNCTIONS == 1 )
+	/* Scatter/gather versions of send/sendto() and recv/recvfrom().  Both UDP
+	and TCP sockets are supported.  FREERTOS_ZERO_COPY is not allowed. */
+	int32_t FreeRTOS_sendmsg( Socket_t xSocket, const struct freertos_msghdr *pxMessage, BaseType_t xFlags );
+	int32_t FreeRTOS_recvmsg( Socket_t xSocket, struct freertos_msghdr *pxMessage, BaseType_t xFlags );
+	int32_t FreeRTOS_sendmmsg( Socket_t xSocket, struct freertos_mmsghdr *pxMessages, size_t uxMessageCount, BaseType_t xFlags );
+	int32_t FreeRTOS_recvmmsg( Socket_t xSocket, struct freertos_mmsghdr *pxMessages, size_t uxMessageCount, BaseType_t xFlags );
+#endif /* ipconfigSUPPORT_MSG_FUNCTIONS */
+
 /* function to get the local address and IP port */
 size_t FreeRTOS_GetLocalAddress( Socket_t xSocket, struct freertos_sockaddr *pxAddress );
 
@@ -314,6 +377,28 @@ FreeRTOS_rx_size(). */
  */
 uint8_t *FreeRTOS_get_tx_head( Socket_t xSocket, BaseType_t *pxLength );
 
+/* See FreeRTOS_Stream_Buffer.h. */
+struct xSTREAM_BUFFER_SPAN;
+
+/*
+ * For advanced applications only:
+ * Describe the received data as at most two spans of the circular reception
+ * buffer, so it can be processed in place.  Returns the total number of bytes,
+ * or a negative errno.  The data is released with FreeRTOS_rx_consume().
+ */
+BaseType_t FreeRTOS_get_rx_spans( Socket_t xSocket, struct xSTREAM_BUFFER_SPAN *pxSpans );
+BaseType_t FreeRTOS_rx_consume( Socket_t xSocket, size_t uxCount );
+
+/*
+ * For advanced applications only:
+ * Describe the free space as at most two spans of the circular transmit
+ * buffer, so data can be produced in place.  Returns the total number of bytes
+ * that may be written, or a negative errno.  Written data is queued for
+ * transmission with FreeRTOS_tx_commit().
+ */
+BaseType_t FreeRTOS_get_tx_spans( Socket_t xSocket, struct xSTREAM_BUFFER_SPAN *pxSpans );
+BaseType_t FreeRTOS_tx_commit( Socket_t xSocket, size_t uxCount );
+
 #endif /* ipconfigUSE_TCP */
 
 /*
@@ -376,6 +461,71 @@ const struct xSTREAM_BUFFER *FreeRTOS_get_rx_buf( Socket_t xSocket );
 
 void FreeRTOS_netstat( void );
 
+#if( ipconfigUSE_SOCKET_POOL == 1 )
+
+	/* The pools of sockets and streams, see FreeRTOS_GetSocketPoolStats(). */
+	#define FREERTOS_POOL_SOCKETS			0
+	#define FREERTOS_POOL_SMALL_STREAMS		1
+	#define FREERTOS_POOL_LARGE_STREAMS		2
+	#define FREERTOS_POOL_COUNT				3
+
+	typedef struct xSOCKET_POOL_STATS
+	{
+		size_t uxBlockSize;			/* Size of one object in bytes. */
+		UBaseType_t uxCount;		/* Number of objects in the pool. */
+		UBaseType_t uxInUse;		/* Number of objects that are taken now. */
+		UBaseType_t uxMaxInUse;		/* Highest value of uxInUse so far. */
+		UBaseType_t uxHeapCount;	/* Allocations that were made from the heap because the pool was empty or too small. */
+	} SocketPoolStats_t;
+
+	/*
+	 * Fill in the occupancy of each pool, indexed by FREERTOS_POOL_xxx.
+	 */
+	void FreeRTOS_GetSocketPoolStats( SocketPoolStats_t pxStats[ FREERTOS_POOL_COUNT ] );
+
+#endif /* ipconfigUSE_SOCKET_POOL */
+
+#if( ( ipconfigUSE_TCP == 1 ) && ( ipconfigUSE_TCP_METRICS == 1 ) )
+
+	/* A snapshot of the state of one TCP socket, comparable to Linux' TCP_INFO. */
+	typedef struct xTCP_METRICS
+	{
+		uint32_t ulRemoteIP;			/* IP address of the peer, host-endian, 0 when not connected. */
+		uint16_t usLocalPort;			/* Local port number, host-endian. */
+		uint16_t usRemotePort;			/* Port number of the peer, host-endian. */
+		uint8_t ucTCPState;				/* eIPTCPState_t, see FreeRTOS_GetTCPStateName(). */
+		uint32_t ulSRTTus;				/* Smoothed round-trip time in us. */
+		uint32_t ulRTOus;				/* Current retransmission time-out in us. */
+		uint32_t ulRetransmits;			/* Segments sent again after a time-out. */
+		uint32_t ulFastRetransmits;		/* Segments sent again after duplicate ACKs or a SACK. */
+		uint32_t ulSackReceived;		/* SACK options received from the peer. */
+		uint32_t ulSackSent;			/* Out-of-order segments answered with a SACK. */
+		uint32_t ulDuplicateSegments;	/* Received segments that contained no new data. */
+		uint32_t ulZeroWindowStalls;	/* Number of times the peer closed its window while data was waiting. */
+		uint32_t ulBytesInFlight;		/* Bytes sent but not yet acknowledged. */
+		uint32_t ulPeerWindow;			/* Reception window advertised by the peer, in bytes. */
+		uint32_t ulCongestionWindow;	/* Congestion window in bytes, 0 when there is no congestion control. */
+		size_t uxRxStreamCount;			/* Bytes waiting in the reception stream. */
+		size_t uxRxStreamSize;			/* Size of the reception stream, 0 when not yet created. */
+		size_t uxTxStreamCount;			/* Bytes in the transmission stream, including those not yet acknowledged. */
+		size_t uxTxStreamSize;			/* Size of the transmission stream, 0 when not yet created. */
+	} TCPMetrics_t;
+
+	/*
+	 * Fill in the metrics of one TCP socket.  Returns 0, or -pdFREERTOS_ERRNO_EINVAL
+	 * when 'xSocket' is not a TCP socket.
+	 */
+	BaseType_t FreeRTOS_GetTCPMetrics( Socket_t xSocket, TCPMetrics_t *pxMetrics );
+
+	/*
+	 * Fill in the metrics of at most 'xMaxCount' bound TCP sockets in one call.
+	 * Returns the number of bound TCP sockets, which may be higher than
+	 * 'xMaxCount'.
+	 */
+	BaseType_t FreeRTOS_GetAllTCPMetrics( TCPMetrics_t *pxMetrics, BaseType_t xMaxCount );
+
+#endif /* ( ipconfigUSE_TCP == 1 ) && ( ipconfigUSE_TCP_METRICS == 1 ) */
+
 #if ipconfigSUPPORT_SELECT_FUNCTION == 1
 
 	/* For FD_SET and FD_CLR, a combination of the following bits can be used: */
@@ -80,6 +80,14 @@ typedef struct xSTREAM_BUFFER {
 	uint8_t ucArray[ sizeof( size_t ) ];
 } StreamBuffer_t;
 
+/* A contiguous part of a stream buffer.  Because the buffer is circular, data
+or space is described by at most two spans: one up to the end of ucArray[], and
+one starting at the beginning of ucArray[]. */
+typedef struct xSTREAM_BUFFER_SPAN {
+	uint8_t *pucData;			/* first byte of the span */
+	size_t uxLength;			/* number of bytes, zero for an empty span */
+} StreamBufferSpan_t;
+
 static portINLINE void vStreamBufferClear( StreamBuffer_t *pxBuffer );
 static portINLINE void vStreamBufferClear( StreamBuffer_t *pxBuffer )
 {
@@ -281,6 +289,48 @@ size_t uxStreamBufferAdd( StreamBuffer_t *pxBuffer, size_t uxOffset, const uint8
  */
 size_t uxStreamBufferGet( StreamBuffer_t *pxBuffer, size_t uxOffset, uint8_t *pucData, size_t uxMaxCount, BaseType_t xPeek );
 
+/*
+ * Describe the data that can be read, without copying it.
+ *
+ * pxBuffer -	The buffer from which the bytes will be read.
+ * uxOffset -	Skip this number of bytes from 'uxTail'.
+ * pxSpans -	Will be filled with at most two spans, an unused span gets a
+ *				length of zero.
+ *
+ * Returns the total number of bytes in both spans.  When done, the bytes can
+ * be removed with uxStreamBufferConsume().
+ */
+size_t uxStreamBufferGetReadSpans( StreamBuffer_t *pxBuffer, size_t uxOffset, StreamBufferSpan_t pxSpans[ 2 ] );
+
+/*
+ * Describe the free space that can be written, without copying into it.
+ *
+ * pxBuffer -	The buffer to which the bytes will be written.
+ * uxOffset -	Skip this number of bytes from 'uxHead'.
+ * pxSpans -	Will be filled with at most two spans, an unused span gets a
+ *				length of zero.
+ *
+ * Returns the total number of bytes in both spans.  Once written, the bytes
+ * are added to the stream with uxStreamBufferCommit().
+ */
+size_t uxStreamBufferGetWriteSpans( StreamBuffer_t *pxBuffer, size_t uxOffset, StreamBufferSpan_t pxSpans[ 2 ] );
+
+static portINLINE size_t uxStreamBufferCommit( StreamBuffer_t *pxBuffer, size_t uxCount );
+static portINLINE size_t uxStreamBufferCommit( StreamBuffer_t *pxBuffer, size_t uxCount )
+{
+	/* Advance uxHead over bytes that were written in place. */
+	return uxStreamBufferAdd( pxBuffer, 0u, NULL, uxCount );
+}
+/*-----------------------------------------------------------*/
+
+static portINLINE size_t uxStreamBufferConsume( StreamBuffer_t *pxBuffer, size_t uxCount );
+static portINLINE size_t uxStreamBufferConsume( StreamBuffer_t *pxBuffer, size_t uxCount )
+{
+	/* Advance uxTail over bytes that were read in place. */
+	return uxStreamBufferGet( pxBuffer, 0u, NULL, uxCount, pdFALSE );
+}
+/*-----------------------------------------------------------*/
+
 #ifdef __cplusplus
 } /* extern "C" */
 #endif
@@ -72,6 +72,9 @@ extern BaseType_t xTCPWindowLoggingLevel;
 typedef struct xTCPTimer
 {
 	uint32_t ulBorn;
+#if( ipconfigTCP_HIGH_RESOLUTION_RTT == 1 )
+	uint32_t ulBornHR;				/* The value of ipconfigTCP_HR_TIMER_VALUE() at the same moment */
+#endif
 } TCPTimer_t;
 
 typedef struct xTCP_SEGMENT
@@ -125,6 +128,58 @@ typedef struct xTCP_WINSIZE
 	#endif
 #endif
 
+#if( ipconfigUSE_TCP_CONGESTION_CONTROL == 1 )
+	struct xTCP_WINDOW;
+
+	/*
+	 * A congestion-control algorithm.  The generic code in FreeRTOS_TCP_WIN.c
+	 * takes care of duplicate ACKs, fast recovery and time-outs, the algorithm
+	 * only decides how the congestion window grows and how far it shrinks.
+	 */
+	typedef struct xTCP_CONGESTION_OPS
+	{
+		const char *pcName;
+		/* Called when the window is (re)initialised. */
+		void ( *vInit )( struct xTCP_WINDOW *pxWindow );
+		/* Called for every ACK that confirms 'ulAcked' new bytes outside fast recovery
+		(slow start and congestion avoidance). */
+		void ( *vOnAck )( struct xTCP_WINDOW *pxWindow, uint32_t ulAcked );
+		/* Called when a loss is detected, returns the new slow-start threshold. */
+		uint32_t ( *ulSsthresh )( struct xTCP_WINDOW *pxWindow );
+	} TCPCongestionOps_t;
+
+	typedef struct xTCP_CONGESTION
+	{
+		const TCPCongestionOps_t *pxOps;
+		uint32_t ulCwnd;					/* Congestion window in bytes */
+		uint32_t ulSsthresh;				/* Slow-start threshold in bytes */
+		uint32_t ulBytesAcked;				/* Bytes acknowledged during congestion avoidance (appropriate byte counting) */
+		uint32_t ulRecover;					/* Highest sequence number sent at the moment of the last loss (RFC 6582 'recover') */
+		uint8_t ucDupAcks;					/* Number of consecutive duplicate ACKs */
+		uint8_t ucAlgorithm;				/* FREERTOS_TCP_CC_xxx */
+		uint8_t bInRecovery;				/* Fast recovery is in progress */
+		/* CUBIC state (RFC 8312). */
+		uint32_t ulWMax;					/* Window size just before the last reduction */
+		uint32_t ulEpochStart;				/* Time in ms at which the current congestion-avoidance epoch started, 0 if none */
+		uint32_t ulK;						/* Time in ms needed to grow back to ulOriginPoint */
+		uint32_t ulOriginPoint;				/* Window size at the plateau of the cubic function */
+		uint32_t ulTcpCwnd;					/* Estimate of what a Reno connection would have as cwnd */
+	} TCPCongestion_t;
+#endif /* ipconfigUSE_TCP_CONGESTION_CONTROL */
+
+#if( ipconfigUSE_TCP_METRICS == 1 )
+	/* Event counters of a connection, see FreeRTOS_GetTCPMetrics(). */
+	typedef struct xTCP_WIN_STATS
+	{
+		uint32_t ulRetransmits;				/* Segments sent again after a time-out */
+		uint32_t ulFastRetransmits;			/* Segments sent again after duplicate ACKs or a SACK */
+		uint32_t ulSackReceived;			/* SACK options received from the peer */
+		uint32_t ulSackSent;				/* Out-of-order segments that were answered with a SACK */
+		uint32_t ulDuplicateSegments;		/* Received segments that contained no new data */
+		uint32_t ulZeroWindowStalls;		/* Number of times the peer closed its window while data was waiting */
+	} TCPWinStats_t;
+#endif /* ipconfigUSE_TCP_METRICS */
+
 /*
  *	Every TCP connection owns a TCP window for the administration of all packets
  *	It owns two sets of segment descriptors, incoming and outgoing
@@ -138,6 +193,7 @@ typedef struct xTCP_WINDOW
 			uint32_t
 				bHasInit : 1,		/* The window structure has been initialised */
 				bSendFullSize : 1,	/* May only send packets with a size equal to MSS (for optimisation) */
+				bNagle : 1,			/* Only send a segment smaller than MSS when no data is outstanding (RFC 896) */
 				bTimeStamps : 1;	/* Socket is supposed to use TCP time-stamps. This depends on the */
 		} bits;						/* party which opens the connection */
 		uint32_t ulFlags;
@@ -160,6 +216,11 @@ typedef struct xTCP_WINDOW
 	uint32_t ulUserDataLength;			/* Number of bytes in Rx buffer which may be passed to the user, after having received a 'missing packet' */
 	uint32_t ulNextTxSequenceNumber;	/* The sequence number given to the next byte to be added for transmission */
 	int32_t lSRTT;						/* Smoothed Round Trip Time, it may increment quickly and it decrements slower */
+#if( ipconfigTCP_HIGH_RESOLUTION_RTT == 1 )
+	uint32_t ulSRTTus;					/* RFC 6298 SRTT in us, zero as long as there is no measurement */
+	uint32_t ulRTTVARus;				/* RFC 6298 RTTVAR in us */
+	uint32_t ulRTOus;					/* Retransmission time-out in us */
+#endif
 	uint8_t ucOptionLength;				/* Number of valid bytes in ulOptionsData[] */
 #if( ipconfigUSE_TCP_WIN == 1 )
 	List_t xPriorityQueue;				/* Priority queue: segments which must be sent immediately */
@@ -177,6 +238,12 @@ typedef struct xTCP_WINDOW
 	uint16_t usPeerPortNumber;			/* debugging/logging: the peer's TCP port number */
 	uint16_t usMSS;						/* Current accepted MSS */
 	uint16_t usMSSInit;					/* MSS as configured by the socket owner */
+#if( ipconfigUSE_TCP_CONGESTION_CONTROL == 1 )
+	TCPCongestion_t xCongestion;		/* Congestion window and the state of the selected algorithm */
+#endif
+#if( ipconfigUSE_TCP_METRICS == 1 )
+	TCPWinStats_t xStats;				/* Event counters, see FreeRTOS_GetTCPMetrics() */
+#endif
 } TCPWindow_t;
 
 
@@ -245,6 +312,16 @@ uint32_t ulTCPWindowTxAck( TCPWindow_t *pxWindow, uint32_t ulSequenceNumber );
 /* Receive a SACK option */
 uint32_t ulTCPWindowTxSack( TCPWindow_t *pxWindow, uint32_t ulFirst, uint32_t ulLast );
 
+#if( ipconfigUSE_TCP_CONGESTION_CONTROL == 1 )
+	/* Select a congestion-control algorithm ( FREERTOS_TCP_CC_xxx ).
+	Returns pdFAIL if the algorithm is not known. */
+	BaseType_t xTCPWindowSetCongestionControl( TCPWindow_t *pxWindow, BaseType_t xAlgorithm );
+
+	/* An ACK was received which carries no data, does not advance SND.UNA and
+	does not change the window, while data is outstanding. */
+	void vTCPWindowTxDuplicateAck( TCPWindow_t *pxWindow );
+#endif /* ipconfigUSE_TCP_CONGESTION_CONTROL */
+
 
 #ifdef __cplusplus
 }	/* extern "C" */
@@ -299,12 +299,12 @@ size_t uxCount;
 				greater than the original requested size. */
 				pxReturn->xDataLength = xRequestedSizeBytes;
 
-				#if( ipconfigUSE_LINKED_RX_MESSAGES != 0 )
+				#if( ipconfigUSE_LINKED_RX_MESSAGES != 0 ) || ( ipconfigSUPPORT_MSG_FUNCTIONS == 1 )
 				{
 					/* make sure the buffer is not linked */
 					pxReturn->pxNextBuffer = NULL;
 				}
-				#endif /* ipconfigUSE_LINKED_RX_MESSAGES */
+				#endif /* ipconfigUSE_LINKED_RX_MESSAGES || ipconfigSUPPORT_MSG_FUNCTIONS */
 			}
 		}
 		else
@@ -320,6 +320,8 @@ size_t uxCount;
 	}
 	else
 	{
+		/* Until a stage stamps it again, the packet is timed from here. */
+		ipLATENCY_STAMP( pxReturn );
 		iptraceNETWORK_BUFFER_OBTAINED( pxReturn );
 	}
 
@@ -0,0 +1,99 @@
+/*
+ * LinkEmulator.h
+ *
+ * A NetworkInterface that connects FreeRTOS+TCP to a peer through an
+ * emulated link.  The link adds delay, jitter, loss, reordering, duplication
+ * and a bandwidth limit, driven by a seeded pseudo-random generator.  The same
+ * seed and the same sequence of frames give the same impairments.
+ *
+ * FreeRTOS+TCP keeps its state in global variables, so one process holds one
+ * stack.  The other end of the link is a peer that is given to
+ * vLinkEmulatorSetPeer(): a scripted TCP peer, or a bridge to a real network
+ * such as a TAP device.  The peer sends frames to the stack with
+ * xLinkEmulatorInject().
+ *
+ * Enabled with ipconfigUSE_LINK_EMULATOR in FreeRTOSIPConfig.h.  It replaces
+ * the RNDIS glue in usbd_rndis_if.c, so the firmware build excludes this
+ * directory (see .cproject).
+ */
+
+#ifndef LINK_EMULATOR_H
+#define LINK_EMULATOR_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* The two directions of the link. */
+#define linkemuTO_PEER			0	/* Frames sent by the stack */
+#define linkemuTO_STACK			1	/* Frames injected by the peer */
+#define linkemuDIRECTIONS		2
+
+/* Probabilities are expressed in parts per million. */
+#define linkemuPPM( percent )	( ( uint32_t ) ( ( percent ) * 10000UL ) )
+
+/* The impairments of one direction of the link.  All zero means a perfect
+link without any delay. */
+typedef struct xLINK_EMULATOR_CONFIG
+{
+	uint32_t ulDelayMs;				/* Fixed one-way delay */
+	uint32_t ulJitterMs;			/* A random delay between 0 and ulJitterMs is added */
+	uint32_t ulLossPPM;				/* Loss probability, in the good state of the Gilbert-Elliott model */
+	uint32_t ulBadLossPPM;			/* Loss probability in the bad state */
+	uint32_t ulGoodToBadPPM;		/* Probability to move from the good to the bad state, 0 for Bernoulli loss */
+	uint32_t ulBadToGoodPPM;		/* Probability to move from the bad to the good state */
+	uint32_t ulReorderPPM;			/* Probability that a frame skips the queue and is delivered without delay */
+	uint32_t ulDuplicatePPM;		/* Probability that a frame is delivered twice */
+	uint32_t ulRateBytesPerSecond;	/* Bandwidth of the token bucket, 0 for unlimited */
+	uint32_t ulBucketBytes;			/* Size of the token bucket, the largest burst at full speed */
+} LinkEmulatorConfig_t;
+
+/* Counters of one direction of the link. */
+typedef struct xLINK_EMULATOR_STATS
+{
+	uint32_t ulFrames;				/* Frames offered to the link */
+	uint32_t ulDelivered;			/* Frames delivered, duplicates included */
+	uint32_t ulLost;				/* Frames dropped by the loss model */
+	uint32_t ulReordered;			/* Frames that skipped the queue */
+	uint32_t ulDuplicated;			/* Frames delivered twice */
+	uint32_t ulQueueDrops;			/* Frames dropped because the link queue was full */
+} LinkEmulatorStats_t;
+
+/* The peer at the other end of the link.  pxReceive() is called from the
+link-emulator task for every frame sent by the stack; the frame is only valid
+during the call. */
+typedef struct xLINK_EMULATOR_PEER
+{
+	void ( *pxReceive )( void *pvContext, const uint8_t *pucFrame, size_t uxLength );
+	void *pvContext;
+} LinkEmulatorPeer_t;
+
+/*
+ * Set the impairments of both directions and restart the pseudo-random
+ * generators with 'ulSeed'.  Frames already on the link are not affected.
+ * May be called before or after the stack has been started.
+ */
+void vLinkEmulatorConfigure( const LinkEmulatorConfig_t pxConfig[ linkemuDIRECTIONS ], uint32_t ulSeed );
+
+/*
+ * Connect the peer.  Without a peer, frames sent by the stack are dropped
+ * after passing the link.
+ */
+void vLinkEmulatorSetPeer( const LinkEmulatorPeer_t *pxPeer );
+
+/*
+ * Send a frame from the peer to the stack.  The frame is copied.  Returns
+ * pdFAIL when no network buffer was available.
+ */
+BaseType_t xLinkEmulatorInject( const uint8_t *pucFrame, size_t uxLength );
+
+/*
+ * Read the counters of both directions, indexed by linkemuTO_xxx.
+ */
+void vLinkEmulatorGetStats( LinkEmulatorStats_t pxStats[ linkemuDIRECTIONS ] );
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /* LINK_EMULATOR_H */
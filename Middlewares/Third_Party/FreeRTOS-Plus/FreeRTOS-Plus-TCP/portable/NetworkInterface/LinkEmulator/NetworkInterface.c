@@ -0,0 +1,548 @@
+/*
+ * NetworkInterface.c for an emulated link, see LinkEmulator.h.
+ *
+ * Every frame passes a model with these steps, for each direction separately:
+ *
+ *	1. Loss: a Gilbert-Elliott channel.  It has a good and a bad state, each
+ *	   with its own loss probability.  Without state changes it is a normal
+ *	   Bernoulli loss.
+ *	2. Bandwidth: a token bucket that is filled at ulRateBytesPerSecond.  A
+ *	   frame leaves as soon as the bucket holds enough tokens.
+ *	3. Delay: a fixed delay plus a random jitter.  Frames keep their order,
+ *	   unless the reordering draw lets a frame skip the delay.
+ *	4. Duplication: the frame is delivered a second time at the same moment.
+ *
+ * Time is measured in clock ticks.  The random numbers come from a xorshift32
+ * generator per direction, so the decisions only depend on the seed and the
+ * sequence of frames.
+ */
+
+/* Standard includes. */
+#include <stdint.h>
+#include <string.h>
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
+#include "semphr.h"
+
+/* FreeRTOS+TCP includes. */
+#include "FreeRTOS_IP.h"
+#include "FreeRTOS_Sockets.h"
+#include "FreeRTOS_IP_Private.h"
+#include "NetworkBufferManagement.h"
+#include "NetworkInterface.h"
+
+#include "LinkEmulator.h"
+
+#if( ipconfigUSE_LINK_EMULATOR == 1 )
+
+#ifndef ipconfigLINK_EMULATOR_QUEUE_LENGTH
+	/* The number of frames that can be on the link at the same time, in both
+	directions together.  More frames are dropped. */
+	#define ipconfigLINK_EMULATOR_QUEUE_LENGTH	( 32 )
+#endif
+
+#ifndef configEMAC_TASK_STACK_SIZE
+	#define configEMAC_TASK_STACK_SIZE		( 2 * configMINIMAL_STACK_SIZE )
+#endif
+
+/* Used when the generator has not been seeded. */
+#define linkemuDEFAULT_SEED				( 0x2545F491UL )
+
+#define linkemuONE_MILLION				( 1000000UL )
+
+/*-----------------------------------------------------------*/
+
+/* The state of one direction of the link. */
+typedef struct xLINK_DIRECTION
+{
+	LinkEmulatorConfig_t xConfig;
+	LinkEmulatorStats_t xStats;
+	uint32_t ulRandom;				/* State of the xorshift32 generator */
+	TickType_t xLastDue;			/* Delivery time of the last frame that kept its order */
+	TickType_t xTokenTime;			/* Time at which ulTokens was valid */
+	uint32_t ulTokens;				/* Bytes in the token bucket */
+	uint8_t ucBadState;				/* pdTRUE while the loss model is in the bad state */
+} LinkDirection_t;
+
+/* A frame on the link. */
+typedef struct xLINK_FRAME
+{
+	NetworkBufferDescriptor_t *pxBuffer;	/* NULL for a free entry */
+	TickType_t xDue;				/* Time of delivery */
+	uint32_t ulOrder;				/* Frames with the same xDue are delivered in this order */
+	uint8_t ucDirection;			/* linkemuTO_xxx */
+} LinkFrame_t;
+
+/*-----------------------------------------------------------*/
+
+/*
+ * Delivers the frames of which the time has come.
+ */
+static void prvLinkEmulatorTask( void *pvParameters );
+
+/*
+ * Pass a frame through the model of one direction and put it on the link.
+ * The network buffer is owned by the link from now on.
+ */
+static void prvLinkOffer( BaseType_t xDirection, NetworkBufferDescriptor_t *pxBuffer );
+
+/*
+ * Put a frame on the link, or release it if the link is full.
+ */
+static void prvLinkEnqueue( BaseType_t xDirection, NetworkBufferDescriptor_t *pxBuffer, TickType_t xDue );
+
+/*
+ * The next pseudo-random number of a direction.
+ */
+static uint32_t prvLinkRandom( LinkDirection_t *pxDirection );
+
+/*
+ * Returns pdTRUE with a probability of 'ulPPM' parts per million.
+ */
+static BaseType_t prvLinkChance( LinkDirection_t *pxDirection, uint32_t ulPPM );
+
+/*
+ * Take 'uxLength' bytes from the token bucket.  Returns the time at which the
+ * frame may leave.
+ */
+static TickType_t prvLinkTokenBucket( LinkDirection_t *pxDirection, TickType_t xNow, size_t uxLength );
+
+/*-----------------------------------------------------------*/
+
+static LinkDirection_t xDirections[ linkemuDIRECTIONS ];
+
+static LinkFrame_t xFrames[ ipconfigLINK_EMULATOR_QUEUE_LENGTH ];
+
+/* Order of arrival on the link, see LinkFrame_t. */
+static uint32_t ulNextOrder = 0UL;
+
+static LinkEmulatorPeer_t xPeer = { NULL, NULL };
+
+static TaskHandle_t xLinkTaskHandle = NULL;
+
+/*-----------------------------------------------------------*/
+
+void vLinkEmulatorConfigure( const LinkEmulatorConfig_t pxConfig[ linkemuDIRECTIONS ], uint32_t ulSeed )
+{
+BaseType_t xIndex;
+TickType_t xNow = xTaskGetTickCount();
+
+	taskENTER_CRITICAL();
+	{
+		for( xIndex = 0; xIndex < linkemuDIRECTIONS; xIndex++ )
+		{
+			xDirections[ xIndex ].xConfig = pxConfig[ xIndex ];
+
+			/* Each direction gets its own sequence of numbers. */
+			xDirections[ xIndex ].ulRandom = ulSeed ^ ( 0x9E3779B9UL * ( uint32_t ) ( xIndex + 1 ) );
+			xDirections[ xIndex ].ucBadState = pdFALSE;
+			xDirections[ xIndex ].xLastDue = xNow;
+			xDirections[ xIndex ].xTokenTime = xNow;
+			xDirections[ xIndex ].ulTokens = pxConfig[ xIndex ].ulBucketBytes;
+		}
+	}
+	taskEXIT_CRITICAL();
+}
+/*-----------------------------------------------------------*/
+
+void vLinkEmulatorSetPeer( const LinkEmulatorPeer_t *pxPeer )
+{
+	taskENTER_CRITICAL();
+	{
+		xPeer = *pxPeer;
+	}
+	taskEXIT_CRITICAL();
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xLinkEmulatorInject( const uint8_t *pucFrame, size_t uxLength )
+{
+NetworkBufferDescriptor_t *pxBuffer;
+BaseType_t xReturn = pdFAIL;
+
+	pxBuffer = pxGetNetworkBufferWithDescriptor( uxLength, 0u );
+
+	if( pxBuffer != NULL )
+	{
+		memcpy( pxBuffer->pucEthernetBuffer, pucFrame, uxLength );
+		pxBuffer->xDataLength = uxLength;
+		prvLinkOffer( linkemuTO_STACK, pxBuffer );
+		xReturn = pdPASS;
+	}
+
+	return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+void vLinkEmulatorGetStats( LinkEmulatorStats_t pxStats[ linkemuDIRECTIONS ] )
+{
+BaseType_t xIndex;
+
+	taskENTER_CRITICAL();
+	{
+		for( xIndex = 0; xIndex < linkemuDIRECTIONS; xIndex++ )
+		{
+			pxStats[ xIndex ] = xDirections[ xIndex ].xStats;
+		}
+	}
+	taskEXIT_CRITICAL();
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xNetworkInterfaceInitialise( void )
+{
+	if( xLinkTaskHandle == NULL )
+	{
+		xTaskCreate( prvLinkEmulatorTask, "LinkEmu", configEMAC_TASK_STACK_SIZE, NULL, configMAX_PRIORITIES - 1, &xLinkTaskHandle );
+	}
+
+	return ( xLinkTaskHandle != NULL ) ? pdPASS : pdFAIL;
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xNetworkInterfaceOutput( NetworkBufferDescriptor_t * const pxDescriptor, BaseType_t xReleaseAfterSend )
+{
+NetworkBufferDescriptor_t *pxBuffer = pxDescriptor;
+
+	if( xReleaseAfterSend == pdFALSE )
+	{
+		/* The frame stays on the link for a while, it needs a buffer of its
+		own. */
+		pxBuffer = pxDuplicateNetworkBufferWithDescriptor( pxDescriptor, pxDescriptor->xDataLength );
+	}
+
+	if( pxBuffer != NULL )
+	{
+		prvLinkOffer( linkemuTO_PEER, pxBuffer );
+	}
+
+	/* Call the standard trace macro to log the send event. */
+	iptraceNETWORK_INTERFACE_TRANSMIT();
+
+	return pdTRUE;
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xGetPhyLinkStatus( void )
+{
+	/* The emulated link is always up. */
+	return pdPASS;
+}
+/*-----------------------------------------------------------*/
+
+static uint32_t prvLinkRandom( LinkDirection_t *pxDirection )
+{
+uint32_t ulValue = pxDirection->ulRandom;
+
+	if( ulValue == 0UL )
+	{
+		ulValue = linkemuDEFAULT_SEED;
+	}
+
+	/* xorshift32, Marsaglia 2003. */
+	ulValue ^= ulValue << 13;
+	ulValue ^= ulValue >> 17;
+	ulValue ^= ulValue << 5;
+	pxDirection->ulRandom = ulValue;
+
+	return ulValue;
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvLinkChance( LinkDirection_t *pxDirection, uint32_t ulPPM )
+{
+BaseType_t xReturn = pdFALSE;
+
+	/* No number is drawn for an impairment that is not used, so adding one
+	does not change the decisions of the others. */
+	if( ulPPM != 0UL )
+	{
+		if( ( prvLinkRandom( pxDirection ) % linkemuONE_MILLION ) < ulPPM )
+		{
+			xReturn = pdTRUE;
+		}
+	}
+
+	return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+static TickType_t prvLinkTokenBucket( LinkDirection_t *pxDirection, TickType_t xNow, size_t uxLength )
+{
+const LinkEmulatorConfig_t *pxConfig = &( pxDirection->xConfig );
+TickType_t xDepart;
+uint64_t ullTokens;
+uint32_t ulShortage;
+
+	if( pxConfig->ulRateBytesPerSecond == 0UL )
+	{
+		xDepart = xNow;
+	}
+	else
+	{
+		/* The bucket can not be filled before the last frame has left. */
+		if( ( int32_t ) ( xNow - pxDirection->xTokenTime ) > 0 )
+		{
+			ullTokens = ( uint64_t ) pxDirection->ulTokens +
+				( ( ( uint64_t ) pxConfig->ulRateBytesPerSecond * ( uint64_t ) ( xNow - pxDirection->xTokenTime ) ) / ( uint64_t ) configTICK_RATE_HZ );
+
+			if( ullTokens > ( uint64_t ) pxConfig->ulBucketBytes )
+			{
+				ullTokens = ( uint64_t ) pxConfig->ulBucketBytes;
+			}
+
+			pxDirection->ulTokens = ( uint32_t ) ullTokens;
+			pxDirection->xTokenTime = xNow;
+		}
+
+		xDepart = pxDirection->xTokenTime;
+
+		if( pxDirection->ulTokens >= ( uint32_t ) uxLength )
+		{
+			pxDirection->ulTokens -= ( uint32_t ) uxLength;
+		}
+		else
+		{
+			/* Wait until the missing tokens have come in, rounded up to a
+			whole tick. */
+			ulShortage = ( uint32_t ) uxLength - pxDirection->ulTokens;
+			xDepart += ( TickType_t ) ( ( ( ( uint64_t ) ulShortage * configTICK_RATE_HZ ) + pxConfig->ulRateBytesPerSecond - 1UL ) /
+				pxConfig->ulRateBytesPerSecond );
+			pxDirection->ulTokens = 0UL;
+			pxDirection->xTokenTime = xDepart;
+		}
+	}
+
+	return xDepart;
+}
+/*-----------------------------------------------------------*/
+
+static void prvLinkOffer( BaseType_t xDirection, NetworkBufferDescriptor_t *pxBuffer )
+{
+LinkDirection_t *pxDirection = &( xDirections[ xDirection ] );
+const LinkEmulatorConfig_t *pxConfig = &( pxDirection->xConfig );
+NetworkBufferDescriptor_t *pxCopy = NULL;
+TickType_t xNow = xTaskGetTickCount();
+TickType_t xDue = xNow;
+BaseType_t xLost, xDuplicate = pdFALSE;
+
+	taskENTER_CRITICAL();
+	{
+		pxDirection->xStats.ulFrames++;
+
+		/* Gilbert-Elliott: first the state transition, then the loss. */
+		if( pxDirection->ucBadState != pdFALSE )
+		{
+			if( prvLinkChance( pxDirection, pxConfig->ulBadToGoodPPM ) != pdFALSE )
+			{
+				pxDirection->ucBadState = pdFALSE;
+			}
+		}
+		else if( prvLinkChance( pxDirection, pxConfig->ulGoodToBadPPM ) != pdFALSE )
+		{
+			pxDirection->ucBadState = pdTRUE;
+		}
+
+		xLost = prvLinkChance( pxDirection,
+			( pxDirection->ucBadState != pdFALSE ) ? pxConfig->ulBadLossPPM : pxConfig->ulLossPPM );
+
+		if( xLost != pdFALSE )
+		{
+			pxDirection->xStats.ulLost++;
+		}
+		else
+		{
+			xDue = prvLinkTokenBucket( pxDirection, xNow, pxBuffer->xDataLength );
+
+			if( prvLinkChance( pxDirection, pxConfig->ulReorderPPM ) != pdFALSE )
+			{
+				/* This frame is delivered without delay, before the frames
+				that are still on their way. */
+				pxDirection->xStats.ulReordered++;
+			}
+			else
+			{
+				xDue += pdMS_TO_TICKS( pxConfig->ulDelayMs );
+
+				if( pxConfig->ulJitterMs != 0UL )
+				{
+					xDue += pdMS_TO_TICKS( prvLinkRandom( pxDirection ) % ( pxConfig->ulJitterMs + 1UL ) );
+				}
+
+				/* Jitter does not reorder frames. */
+				if( ( int32_t ) ( xDue - pxDirection->xLastDue ) < 0 )
+				{
+					xDue = pxDirection->xLastDue;
+				}
+				pxDirection->xLastDue = xDue;
+			}
+
+			xDuplicate = prvLinkChance( pxDirection, pxConfig->ulDuplicatePPM );
+		}
+	}
+	taskEXIT_CRITICAL();
+
+	if( xLost != pdFALSE )
+	{
+		vReleaseNetworkBufferAndDescriptor( pxBuffer );
+	}
+	else
+	{
+		if( xDuplicate != pdFALSE )
+		{
+			pxCopy = pxDuplicateNetworkBufferWithDescriptor( pxBuffer, pxBuffer->xDataLength );
+		}
+
+		prvLinkEnqueue( xDirection, pxBuffer, xDue );
+
+		if( pxCopy != NULL )
+		{
+			taskENTER_CRITICAL();
+			{
+				pxDirection->xStats.ulDuplicated++;
+			}
+			taskEXIT_CRITICAL();
+
+			prvLinkEnqueue( xDirection, pxCopy, xDue );
+		}
+
+		if( xLinkTaskHandle != NULL )
+		{
+			xTaskNotifyGive( xLinkTaskHandle );
+		}
+	}
+}
+/*-----------------------------------------------------------*/
+
+static void prvLinkEnqueue( BaseType_t xDirection, NetworkBufferDescriptor_t *pxBuffer, TickType_t xDue )
+{
+LinkFrame_t *pxFrame;
+BaseType_t xStored = pdFALSE;
+
+	taskENTER_CRITICAL();
+	{
+		for( pxFrame = xFrames; pxFrame < &( xFrames[ ipconfigLINK_EMULATOR_QUEUE_LENGTH ] ); pxFrame++ )
+		{
+			if( pxFrame->pxBuffer == NULL )
+			{
+				pxFrame->pxBuffer = pxBuffer;
+				pxFrame->xDue = xDue;
+				pxFrame->ulOrder = ulNextOrder++;
+				pxFrame->ucDirection = ( uint8_t ) xDirection;
+				xStored = pdTRUE;
+				break;
+			}
+		}
+
+		if( xStored == pdFALSE )
+		{
+			xDirections[ xDirection ].xStats.ulQueueDrops++;
+		}
+	}
+	taskEXIT_CRITICAL();
+
+	if( xStored == pdFALSE )
+	{
+		vReleaseNetworkBufferAndDescriptor( pxBuffer );
+	}
+}
+/*-----------------------------------------------------------*/
+
+static void prvLinkEmulatorTask( void *pvParameters )
+{
+LinkFrame_t *pxFrame, *pxFirst;
+NetworkBufferDescriptor_t *pxBuffer;
+IPStackEvent_t xRxEvent;
+TickType_t xNow, xWait;
+BaseType_t xDirection;
+
+	( void ) pvParameters;
+
+	for( ;; )
+	{
+		xNow = xTaskGetTickCount();
+		pxBuffer = NULL;
+		xWait = portMAX_DELAY;
+		xDirection = linkemuTO_PEER;
+
+		/* Find the frame that is due first, the oldest one in case of a tie. */
+		taskENTER_CRITICAL();
+		{
+			pxFirst = NULL;
+
+			for( pxFrame = xFrames; pxFrame < &( xFrames[ ipconfigLINK_EMULATOR_QUEUE_LENGTH ] ); pxFrame++ )
+			{
+				if( pxFrame->pxBuffer == NULL )
+				{
+					continue;
+				}
+
+				if( ( pxFirst == NULL ) ||
+					( ( int32_t ) ( pxFrame->xDue - pxFirst->xDue ) < 0 ) ||
+					( ( pxFrame->xDue == pxFirst->xDue ) && ( ( int32_t ) ( pxFrame->ulOrder - pxFirst->ulOrder ) < 0 ) ) )
+				{
+					pxFirst = pxFrame;
+				}
+			}
+
+			if( pxFirst != NULL )
+			{
+				if( ( int32_t ) ( pxFirst->xDue - xNow ) <= 0 )
+				{
+					pxBuffer = pxFirst->pxBuffer;
+					xDirection = ( BaseType_t ) pxFirst->ucDirection;
+					pxFirst->pxBuffer = NULL;
+					xDirections[ xDirection ].xStats.ulDelivered++;
+				}
+				else
+				{
+					xWait = pxFirst->xDue - xNow;
+				}
+			}
+		}
+		taskEXIT_CRITICAL();
+
+		if( pxBuffer == NULL )
+		{
+			/* Sleep until the next frame is due, or until a new frame is put
+			on the link. */
+			ulTaskNotifyTake( pdTRUE, xWait );
+		}
+		else if( xDirection == linkemuTO_PEER )
+		{
+			if( xPeer.pxReceive != NULL )
+			{
+				xPeer.pxReceive( xPeer.pvContext, pxBuffer->pucEthernetBuffer, pxBuffer->xDataLength );
+			}
+
+			vReleaseNetworkBufferAndDescriptor( pxBuffer );
+		}
+		else if( eConsiderFrameForProcessing( pxBuffer->pucEthernetBuffer ) != eProcessBuffer )
+		{
+			vReleaseNetworkBufferAndDescriptor( pxBuffer );
+		}
+		else
+		{
+			xRxEvent.eEventType = eNetworkRxEvent;
+			xRxEvent.pvData = ( void * ) pxBuffer;
+
+			if( xSendEventStructToIPTask( &xRxEvent, 0u ) == pdFALSE )
+			{
+				/* The buffer could not be sent to the IP task so the buffer
+				must be released. */
+				vReleaseNetworkBufferAndDescriptor( pxBuffer );
+				iptraceETHERNET_RX_EVENT_LOST();
+			}
+			else
+			{
+				iptraceNETWORK_INTERFACE_RECEIVE();
+			}
+		}
+	}
+}
+/*-----------------------------------------------------------*/
+
+#endif /* ipconfigUSE_LINK_EMULATOR == 1 */
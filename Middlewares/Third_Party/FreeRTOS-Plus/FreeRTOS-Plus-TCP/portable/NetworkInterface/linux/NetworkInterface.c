@@ -0,0 +1,240 @@
+/*
+ * NetworkInterface.c for a Linux host.
+ *
+ * A network driver for the FreeRTOS POSIX (Linux simulator) port, with a TAP
+ * device as the network.  It takes the place of the RNDIS glue in
+ * usbd_rndis_if.c.  Simulator/CMakeLists.txt builds it with the stack and
+ * the POSIX port of the kernel (portable/ThirdParty/GCC/Posix) into
+ * adhoc_sim.  The firmware build excludes this directory (see .cproject), and
+ * the file compiles to nothing when __linux__ is not defined.
+ *
+ * The TAP device must exist and be up before the stack is started, e.g.:
+ *
+ *		ip tuntap add dev tap0 mode tap user $USER
+ *		ip addr add 10.10.10.1/8 dev tap0
+ *		ip link set tap0 up
+ *
+ * The name of the device can be set with ipconfigLINUX_TAP_NAME.
+ *
+ * Under the POSIX port every task is a pthread, and only tasks may call the
+ * FreeRTOS API.  Therefore the device is not read by a separate thread: a
+ * normal task polls it without blocking, and sleeps a tick when it is empty.
+ */
+
+#if defined( __linux__ )
+
+/* Standard includes. */
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <net/if.h>
+#include <linux/if_tun.h>
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
+#include "semphr.h"
+
+/* FreeRTOS+TCP includes. */
+#include "FreeRTOS_IP.h"
+#include "FreeRTOS_Sockets.h"
+#include "FreeRTOS_IP_Private.h"
+#include "NetworkBufferManagement.h"
+#include "NetworkInterface.h"
+
+#ifndef ipconfigLINUX_TAP_NAME
+	/* The TAP device that will be opened. */
+	#define ipconfigLINUX_TAP_NAME			"tap0"
+#endif
+
+#ifndef configEMAC_TASK_STACK_SIZE
+	#define configEMAC_TASK_STACK_SIZE		( 2 * configMINIMAL_STACK_SIZE )
+#endif
+
+/* The largest frame that can be received: an MTU plus the Ethernet header. */
+#define linuxMAX_FRAME_SIZE					( ipconfigNETWORK_MTU + ipSIZE_OF_ETH_HEADER )
+
+/*-----------------------------------------------------------*/
+
+/*
+ * Reads frames from the TAP device and passes them to the IP-task.
+ */
+static void prvTapHandlerTask( void *pvParameters );
+
+/*
+ * Open the TAP device, returns a file descriptor or -1.
+ */
+static int prvTapOpen( const char *pcName );
+
+/*-----------------------------------------------------------*/
+
+/* File descriptor of the TAP device, -1 while not opened. */
+static int iTapFd = -1;
+
+/* The task that reads from the TAP device. */
+static TaskHandle_t xTapTaskHandle = NULL;
+
+/*-----------------------------------------------------------*/
+
+BaseType_t xNetworkInterfaceInitialise( void )
+{
+BaseType_t xReturn = pdFAIL;
+
+	if( iTapFd < 0 )
+	{
+		iTapFd = prvTapOpen( ipconfigLINUX_TAP_NAME );
+	}
+
+	if( iTapFd >= 0 )
+	{
+		if( xTapTaskHandle == NULL )
+		{
+			xTaskCreate( prvTapHandlerTask, "TAP", configEMAC_TASK_STACK_SIZE, NULL, configMAX_PRIORITIES - 1, &xTapTaskHandle );
+		}
+
+		if( xTapTaskHandle != NULL )
+		{
+			xReturn = pdPASS;
+		}
+	}
+
+	return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xNetworkInterfaceOutput( NetworkBufferDescriptor_t * const pxDescriptor, BaseType_t xReleaseAfterSend )
+{
+ssize_t xWritten;
+
+	xWritten = write( iTapFd, pxDescriptor->pucEthernetBuffer, pxDescriptor->xDataLength );
+
+	if( xWritten != ( ssize_t ) pxDescriptor->xDataLength )
+	{
+		FreeRTOS_debug_printf( ( "xNetworkInterfaceOutput: write %u bytes: errno %d\n",
+			( unsigned ) pxDescriptor->xDataLength, errno ) );
+	}
+
+	/* Call the standard trace macro to log the send event. */
+	iptraceNETWORK_INTERFACE_TRANSMIT();
+
+	if( xReleaseAfterSend != pdFALSE )
+	{
+		/* write() has copied the data, the buffer can be re-used. */
+		vReleaseNetworkBufferAndDescriptor( pxDescriptor );
+	}
+
+	return pdTRUE;
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xGetPhyLinkStatus( void )
+{
+BaseType_t xReturn;
+
+	if( iTapFd >= 0 )
+	{
+		xReturn = pdPASS;
+	}
+	else
+	{
+		xReturn = pdFAIL;
+	}
+
+	return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+static int prvTapOpen( const char *pcName )
+{
+struct ifreq xRequest;
+int iFd;
+
+	iFd = open( "/dev/net/tun", O_RDWR | O_NONBLOCK );
+
+	if( iFd < 0 )
+	{
+		FreeRTOS_printf( ( "prvTapOpen: can not open /dev/net/tun: errno %d\n", errno ) );
+	}
+	else
+	{
+		memset( &xRequest, '\0', sizeof( xRequest ) );
+
+		/* A TAP device carries Ethernet frames, without an extra header. */
+		xRequest.ifr_flags = IFF_TAP | IFF_NO_PI;
+		strncpy( xRequest.ifr_name, pcName, IFNAMSIZ - 1 );
+
+		if( ioctl( iFd, TUNSETIFF, ( void * ) &xRequest ) < 0 )
+		{
+			FreeRTOS_printf( ( "prvTapOpen: can not attach to %s: errno %d\n", pcName, errno ) );
+			close( iFd );
+			iFd = -1;
+		}
+	}
+
+	return iFd;
+}
+/*-----------------------------------------------------------*/
+
+static void prvTapHandlerTask( void *pvParameters )
+{
+static uint8_t ucFrame[ linuxMAX_FRAME_SIZE ];
+NetworkBufferDescriptor_t *pxBufferDescriptor;
+IPStackEvent_t xRxEvent;
+ssize_t xBytesReceived;
+
+	( void ) pvParameters;
+
+	for( ;; )
+	{
+		xBytesReceived = read( iTapFd, ucFrame, sizeof( ucFrame ) );
+
+		if( xBytesReceived <= 0 )
+		{
+			/* Nothing to read (EAGAIN), let the other tasks run. */
+			vTaskDelay( 1u );
+			continue;
+		}
+
+		/* Drop frames that are not for this node as early as possible. */
+		if( eConsiderFrameForProcessing( ucFrame ) != eProcessBuffer )
+		{
+			continue;
+		}
+
+		pxBufferDescriptor = pxGetNetworkBufferWithDescriptor( ( size_t ) xBytesReceived, 0u );
+
+		if( pxBufferDescriptor == NULL )
+		{
+			/* The event was lost because a network buffer was not
+			available. */
+			iptraceETHERNET_RX_EVENT_LOST();
+			continue;
+		}
+
+		memcpy( pxBufferDescriptor->pucEthernetBuffer, ucFrame, ( size_t ) xBytesReceived );
+		pxBufferDescriptor->xDataLength = ( size_t ) xBytesReceived;
+
+		xRxEvent.eEventType = eNetworkRxEvent;
+		xRxEvent.pvData = ( void * ) pxBufferDescriptor;
+
+		if( xSendEventStructToIPTask( &xRxEvent, 0u ) == pdFALSE )
+		{
+			/* The buffer could not be sent to the IP task so the buffer
+			must be released. */
+			vReleaseNetworkBufferAndDescriptor( pxBufferDescriptor );
+			iptraceETHERNET_RX_EVENT_LOST();
+		}
+		else
+		{
+			iptraceNETWORK_INTERFACE_RECEIVE();
+		}
+	}
+}
+/*-----------------------------------------------------------*/
+
+#endif /* __linux__ */
@@ -86,6 +86,8 @@
 #include "NTPDemo.h"
 #include "ntpClient.h"
 
+#include "hr_gettime.h"
+
 #include "date_and_time.h"
 
 enum EStatus {
@@ -116,7 +118,7 @@ static SemaphoreHandle_t xNTPWakeupSem = NULL;
 static uint32_t ulIPAddressFound;
 static Socket_t xUDPSocket = NULL;
 static TaskHandle_t xNTPTaskhandle = NULL;
-static TickType_t uxSendTime;
+static uint64_t ullSendTime;
 
 static void prvNTPTask( void *pvParameters );
 
@@ -272,15 +274,18 @@ static void prvReadTime( struct SNtpPacket * pxPacket )
 
 	const char *pcTimeUnit;
 	int32_t ilDiff;
-	TickType_t uxTravelTime;
+	uint32_t ulTravelTime;
 
-	uxTravelTime = xTaskGetTickCount() - uxSendTime;
+	/* The round-trip time in microseconds. */
+	ulTravelTime = ( uint32_t ) ( ullGetHighResolutionTime() - ullSendTime );
 
 	/* Transform the contents of the fields from big to native endian. */
 	prvSwapFields( pxPacket );
 
 	uxCurrentSeconds = pxPacket->receiveTimestamp.seconds - TIME1970;
 	uxCurrentMS = pxPacket->receiveTimestamp.fraction / 4294967;
+	/* The server received the request about half a round trip ago. */
+	uxCurrentMS += ( time_t ) ( ulTravelTime / 2000u );
 	uxCurrentSeconds += uxCurrentMS / 1000;
 	uxCurrentMS = uxCurrentMS % 1000;
 
@@ -318,11 +323,11 @@ static void prvReadTime( struct SNtpPacket * pxPacket )
 	FreeRTOS_gmtime_r( &uxCurrentSeconds, &xTimeStruct );
 
 	/*
-		378.067 [NTP client] NTP time: 9/11/2015 16:11:19.559 Diff -20 ms (289 ms)
-		379.441 [NTP client] NTP time: 9/11/2015 16:11:20.933 Diff 0 ms (263 ms)
+		378.067 [NTP client] NTP time: 9/11/2015 16:11:19.559 Diff -20 ms (289.113 ms)
+		379.441 [NTP client] NTP time: 9/11/2015 16:11:20.933 Diff 0 ms (263.407 ms)
 	*/
 
-	FreeRTOS_printf( ("NTP time: %d/%d/%02d %2d:%02d:%02d.%03u Diff %d %s (%lu ms)\n",
+	FreeRTOS_printf( ("NTP time: %d/%d/%02d %2d:%02d:%02d.%03u Diff %d %s (%lu.%03lu ms)\n",
 		xTimeStruct.tm_mday,
 		xTimeStruct.tm_mon + 1,
 		xTimeStruct.tm_year + 1900,
@@ -332,11 +337,12 @@ static void prvReadTime( struct SNtpPacket * pxPacket )
 		( unsigned )uxCurrentMS,
 		( unsigned )ilDiff,
 		pcTimeUnit,
-		uxTravelTime ) );
+		( unsigned long )( ulTravelTime / 1000u ),
+		( unsigned long )( ulTravelTime % 1000u ) ) );
 
 	/* Remove compiler warnings in case FreeRTOS_printf() is not used. */
 	( void ) pcTimeUnit;
-	( void ) uxTravelTime;
+	( void ) ulTravelTime;
 }
 /*-----------------------------------------------------------*/
 
@@ -421,7 +427,7 @@ struct freertos_sockaddr xAddress;
 					pcBuf,
 					FreeRTOS_ntohs( xAddress.sin_port ) ) );
 
-				uxSendTime = xTaskGetTickCount( );
+				ullSendTime = ullGetHighResolutionTime( );
 				FreeRTOS_sendto( xUDPSocket, ( void * )&xNTPPacket, sizeof( xNTPPacket ), 0, &xAddress, sizeof( xAddress ) );
 			}
 			break;
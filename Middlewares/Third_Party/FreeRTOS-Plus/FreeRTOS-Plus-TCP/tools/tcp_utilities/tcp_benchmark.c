@@ -0,0 +1,599 @@
+/*
+ * tcp_benchmark.c
+ *
+ * Micro-benchmarks of the hot primitives of FreeRTOS+TCP, see tcp_benchmark.h.
+ *
+ * Every benchmark repeats an operation ipconfigBENCHMARK_ITERATIONS times and
+ * reports the shortest, the average and the longest duration.  The shortest
+ * time is the most reproducible one; the longest time includes interrupts and
+ * task switches that happened during the measurement.
+ */
+
+/* Standard includes. */
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
+#include "semphr.h"
+
+/* FreeRTOS+TCP includes. */
+#include "FreeRTOS_IP.h"
+#include "FreeRTOS_Sockets.h"
+#include "FreeRTOS_IP_Private.h"
+#include "FreeRTOS_Stream_Buffer.h"
+#include "FreeRTOS_TCP_WIN.h"
+#include "NetworkBufferManagement.h"
+
+#include "tcp_benchmark.h"
+
+#if( ipconfigUSE_BENCHMARKS == 1 )
+
+#ifndef ipconfigBENCHMARK_ITERATIONS
+	/* The number of samples taken of every operation. */
+	#define ipconfigBENCHMARK_ITERATIONS		100u
+#endif
+
+#ifndef ipconfigBENCHMARK_STREAM_LENGTH
+	/* Size of the stream buffer that is used, allocated from the heap.  It is
+	not a multiple of the chunk sizes, so that some copies wrap around. */
+	#define ipconfigBENCHMARK_STREAM_LENGTH		2048u
+#endif
+
+#ifndef ipconfigBENCHMARK_MAX_SOCKETS
+	/* The socket lookup is measured with 1, 2, 4, ... up to this number of
+	listening sockets. */
+	#define ipconfigBENCHMARK_MAX_SOCKETS		8
+#endif
+
+#ifndef ipconfigBENCHMARK_FIRST_PORT
+	/* Port numbers of the listening sockets that are created. */
+	#define ipconfigBENCHMARK_FIRST_PORT		50000u
+#endif
+
+#define benchLINE_LENGTH			96
+#define benchMSS					1460u
+#define benchMAX_SEGMENTS			8u
+#define benchHEAP_BLOCKS			16u
+
+/* A window sequence number that does not start at zero, like a real ISN. */
+#define benchFIRST_SEQUENCE			0x10000000UL
+
+/*-----------------------------------------------------------*/
+
+/* The accumulated samples of one benchmark. */
+typedef struct xBENCH_RESULT
+{
+	uint32_t ulCount;
+	uint32_t ulMin;
+	uint32_t ulMax;
+	uint64_t ullSum;
+} BenchResult_t;
+
+/*-----------------------------------------------------------*/
+
+static void prvResultReset( BenchResult_t *pxResult );
+static void prvResultAdd( BenchResult_t *pxResult, uint32_t ulStart, uint32_t ulEnd );
+static void prvResultPrint( const BenchResult_t *pxResult, const char *pcName, uint32_t ulParameter );
+static void prvMeasureOverhead( void );
+
+static void prvBenchChecksum( void );
+static void prvBenchStreamBuffer( void );
+static void prvBenchSocketLookup( void );
+static void prvBenchRxWindow( void );
+static void prvBenchNetworkBuffers( void );
+static void prvBenchFrameFilter( void );
+static void prvBenchHeap( void );
+
+/*-----------------------------------------------------------*/
+
+/* Where the output lines go, set by vTCPBenchmarkRun(). */
+static BenchmarkOutput_t pxBenchOutput;
+
+/* The number of counts that it takes to read the timer twice. */
+static uint32_t ulTimerOverhead;
+
+/* Results are written here, so that the compiler can not remove the
+operations being measured. */
+static volatile uint32_t ulBenchSink;
+
+/* Data used by the checksum and stream buffer benchmarks.  One extra byte
+allows to test unaligned access. */
+static uint8_t ucBenchData[ ipconfigNETWORK_MTU + ipSIZE_OF_ETH_HEADER + 1u ];
+
+/*-----------------------------------------------------------*/
+
+static void prvResultReset( BenchResult_t *pxResult )
+{
+	pxResult->ulCount = 0u;
+	pxResult->ulMin = ~0UL;
+	pxResult->ulMax = 0u;
+	pxResult->ullSum = 0u;
+}
+/*-----------------------------------------------------------*/
+
+static void prvResultAdd( BenchResult_t *pxResult, uint32_t ulStart, uint32_t ulEnd )
+{
+uint32_t ulTime = ulEnd - ulStart;
+
+	/* The timer may wrap, the unsigned subtraction takes care of that. */
+	if( ulTime > ulTimerOverhead )
+	{
+		ulTime -= ulTimerOverhead;
+	}
+	else
+	{
+		ulTime = 0u;
+	}
+
+	pxResult->ulCount++;
+	pxResult->ullSum += ulTime;
+
+	if( pxResult->ulMin > ulTime )
+	{
+		pxResult->ulMin = ulTime;
+	}
+
+	if( pxResult->ulMax < ulTime )
+	{
+		pxResult->ulMax = ulTime;
+	}
+}
+/*-----------------------------------------------------------*/
+
+static void prvResultPrint( const BenchResult_t *pxResult, const char *pcName, uint32_t ulParameter )
+{
+char pcLine[ benchLINE_LENGTH ];
+uint32_t ulMean = 0u;
+
+	if( pxResult->ulCount != 0u )
+	{
+		ulMean = ( uint32_t ) ( pxResult->ullSum / pxResult->ulCount );
+
+		snprintf( pcLine, sizeof( pcLine ), "bench,%s,%lu,%lu,%lu,%lu,%lu",
+			pcName,
+			( unsigned long ) ulParameter,
+			( unsigned long ) pxResult->ulCount,
+			( unsigned long ) pxResult->ulMin,
+			( unsigned long ) ulMean,
+			( unsigned long ) pxResult->ulMax );
+		pxBenchOutput( pcLine );
+	}
+}
+/*-----------------------------------------------------------*/
+
+static void prvMeasureOverhead( void )
+{
+uint32_t ulStart, ulEnd, ulTime;
+UBaseType_t uxIndex;
+
+	ulTimerOverhead = ~0UL;
+
+	for( uxIndex = 0u; uxIndex < ipconfigBENCHMARK_ITERATIONS; uxIndex++ )
+	{
+		ulStart = ipconfigBENCHMARK_TIMER_VALUE();
+		ulEnd = ipconfigBENCHMARK_TIMER_VALUE();
+		ulTime = ulEnd - ulStart;
+
+		if( ulTimerOverhead > ulTime )
+		{
+			ulTimerOverhead = ulTime;
+		}
+	}
+}
+/*-----------------------------------------------------------*/
+
+static void prvBenchChecksum( void )
+{
+static const uint16_t usLengths[] = { 20u, 64u, 512u, 1460u };
+BenchResult_t xAligned, xUnaligned;
+uint32_t ulStart;
+UBaseType_t uxLength, uxIndex;
+
+	for( uxLength = 0u; uxLength < ( UBaseType_t ) ARRAY_SIZE( usLengths ); uxLength++ )
+	{
+		prvResultReset( &xAligned );
+		prvResultReset( &xUnaligned );
+
+		for( uxIndex = 0u; uxIndex < ipconfigBENCHMARK_ITERATIONS; uxIndex++ )
+		{
+			ulStart = ipconfigBENCHMARK_TIMER_VALUE();
+			ulBenchSink = usGenerateChecksum( 0u, ucBenchData, usLengths[ uxLength ] );
+			prvResultAdd( &xAligned, ulStart, ipconfigBENCHMARK_TIMER_VALUE() );
+
+			ulStart = ipconfigBENCHMARK_TIMER_VALUE();
+			ulBenchSink = usGenerateChecksum( 0u, ucBenchData + 1u, usLengths[ uxLength ] );
+			prvResultAdd( &xUnaligned, ulStart, ipconfigBENCHMARK_TIMER_VALUE() );
+		}
+
+		prvResultPrint( &xAligned, "checksum_aligned", usLengths[ uxLength ] );
+		prvResultPrint( &xUnaligned, "checksum_unaligned", usLengths[ uxLength ] );
+	}
+}
+/*-----------------------------------------------------------*/
+
+static void prvBenchStreamBuffer( void )
+{
+static const uint16_t usChunks[] = { 1u, 64u, 536u, 1460u };
+StreamBuffer_t *pxStream;
+StreamBufferSpan_t xSpans[ 2 ];
+BenchResult_t xAdd, xGet, xSpan;
+uint32_t ulStart;
+UBaseType_t uxChunk, uxIndex;
+size_t uxSize;
+
+	uxSize = sizeof( *pxStream ) - sizeof( pxStream->ucArray ) + ipconfigBENCHMARK_STREAM_LENGTH;
+	pxStream = ( StreamBuffer_t * ) pvPortMalloc( uxSize );
+
+	if( pxStream == NULL )
+	{
+		pxBenchOutput( "error,stream_buffer,no memory" );
+		return;
+	}
+
+	memset( pxStream, '\0', sizeof( *pxStream ) - sizeof( pxStream->ucArray ) );
+	pxStream->LENGTH = ipconfigBENCHMARK_STREAM_LENGTH;
+
+	for( uxChunk = 0u; uxChunk < ( UBaseType_t ) ARRAY_SIZE( usChunks ); uxChunk++ )
+	{
+		prvResultReset( &xAdd );
+		prvResultReset( &xGet );
+		prvResultReset( &xSpan );
+		vStreamBufferClear( pxStream );
+
+		for( uxIndex = 0u; uxIndex < ipconfigBENCHMARK_ITERATIONS; uxIndex++ )
+		{
+			/* The buffer is empty at the start of every round, but its head
+			moves on, so that a part of the copies wraps around. */
+			ulStart = ipconfigBENCHMARK_TIMER_VALUE();
+			uxStreamBufferAdd( pxStream, 0u, ucBenchData, usChunks[ uxChunk ] );
+			prvResultAdd( &xAdd, ulStart, ipconfigBENCHMARK_TIMER_VALUE() );
+
+			ulStart = ipconfigBENCHMARK_TIMER_VALUE();
+			ulBenchSink = uxStreamBufferGetReadSpans( pxStream, 0u, xSpans );
+			prvResultAdd( &xSpan, ulStart, ipconfigBENCHMARK_TIMER_VALUE() );
+
+			ulStart = ipconfigBENCHMARK_TIMER_VALUE();
+			uxStreamBufferGet( pxStream, 0u, ucBenchData, usChunks[ uxChunk ], pdFALSE );
+			prvResultAdd( &xGet, ulStart, ipconfigBENCHMARK_TIMER_VALUE() );
+		}
+
+		prvResultPrint( &xAdd, "stream_add", usChunks[ uxChunk ] );
+		prvResultPrint( &xGet, "stream_get", usChunks[ uxChunk ] );
+		prvResultPrint( &xSpan, "stream_read_spans", usChunks[ uxChunk ] );
+	}
+
+	vPortFree( pxStream );
+}
+/*-----------------------------------------------------------*/
+
+static void prvBenchSocketLookup( void )
+{
+Socket_t xSockets[ ipconfigBENCHMARK_MAX_SOCKETS ];
+struct freertos_sockaddr xAddress;
+BenchResult_t xHit, xMiss;
+uint32_t ulStart;
+BaseType_t xCount, xSocket;
+UBaseType_t uxIndex, uxPort;
+
+	for( xCount = 0; xCount < ipconfigBENCHMARK_MAX_SOCKETS; xCount++ )
+	{
+		xSockets[ xCount ] = FreeRTOS_socket( FREERTOS_AF_INET, FREERTOS_SOCK_STREAM, FREERTOS_IPPROTO_TCP );
+
+		if( xSockets[ xCount ] == FREERTOS_INVALID_SOCKET )
+		{
+			pxBenchOutput( "error,socket_lookup,no socket" );
+			break;
+		}
+
+		memset( &xAddress, '\0', sizeof( xAddress ) );
+		xAddress.sin_port = FreeRTOS_htons( ( uint16_t ) ( ipconfigBENCHMARK_FIRST_PORT + xCount ) );
+
+		if( ( FreeRTOS_bind( xSockets[ xCount ], &xAddress, sizeof( xAddress ) ) != 0 ) ||
+			( FreeRTOS_listen( xSockets[ xCount ], 1 ) != 0 ) )
+		{
+			FreeRTOS_closesocket( xSockets[ xCount ] );
+			pxBenchOutput( "error,socket_lookup,bind failed" );
+			break;
+		}
+
+		/* Measure with 1, 2, 4, ... sockets. */
+		if( ( ( xCount + 1 ) & xCount ) != 0 )
+		{
+			continue;
+		}
+
+		prvResultReset( &xHit );
+		prvResultReset( &xMiss );
+
+		/* The IP-task may change the list of bound sockets. */
+		vTaskSuspendAll();
+		{
+			for( uxIndex = 0u; uxIndex < ipconfigBENCHMARK_ITERATIONS; uxIndex++ )
+			{
+				/* Look up each of the sockets in turn. */
+				uxPort = ipconfigBENCHMARK_FIRST_PORT + ( uxIndex % ( UBaseType_t ) ( xCount + 1 ) );
+
+				ulStart = ipconfigBENCHMARK_TIMER_VALUE();
+				ulBenchSink = ( uint32_t ) ( pxTCPSocketLookup( *ipLOCAL_IP_ADDRESS_POINTER, uxPort, 0x0a0a0a02UL, 1024u ) != NULL );
+				prvResultAdd( &xHit, ulStart, ipconfigBENCHMARK_TIMER_VALUE() );
+
+				ulStart = ipconfigBENCHMARK_TIMER_VALUE();
+				ulBenchSink = ( uint32_t ) ( pxTCPSocketLookup( *ipLOCAL_IP_ADDRESS_POINTER, ipconfigBENCHMARK_FIRST_PORT - 1u, 0x0a0a0a02UL, 1024u ) != NULL );
+				prvResultAdd( &xMiss, ulStart, ipconfigBENCHMARK_TIMER_VALUE() );
+			}
+		}
+		xTaskResumeAll();
+
+		prvResultPrint( &xHit, "socket_lookup_hit", ( uint32_t ) ( xCount + 1 ) );
+		prvResultPrint( &xMiss, "socket_lookup_miss", ( uint32_t ) ( xCount + 1 ) );
+	}
+
+	for( xSocket = 0; xSocket < xCount; xSocket++ )
+	{
+		FreeRTOS_closesocket( xSockets[ xSocket ] );
+	}
+}
+/*-----------------------------------------------------------*/
+
+static void prvBenchRxWindow( void )
+{
+TCPWindow_t *pxWindow;
+BenchResult_t xInOrder, xOutOfOrder, xFillHole;
+uint32_t ulStart, ulSegment, ulSegments;
+UBaseType_t uxIndex;
+
+	pxWindow = ( TCPWindow_t * ) pvPortMalloc( sizeof( *pxWindow ) );
+
+	if( pxWindow == NULL )
+	{
+		pxBenchOutput( "error,rx_window,no memory" );
+		return;
+	}
+
+	for( ulSegments = benchMAX_SEGMENTS / 2u; ulSegments <= benchMAX_SEGMENTS; ulSegments *= 2u )
+	{
+		prvResultReset( &xInOrder );
+		prvResultReset( &xOutOfOrder );
+		prvResultReset( &xFillHole );
+
+		for( uxIndex = 0u; uxIndex < ipconfigBENCHMARK_ITERATIONS; uxIndex++ )
+		{
+			/* The segment descriptors are shared with the IP-task. */
+			vTaskSuspendAll();
+			{
+				memset( pxWindow, '\0', sizeof( *pxWindow ) );
+				vTCPWindowCreate( pxWindow, 2u * benchMAX_SEGMENTS * benchMSS, 2u * benchMAX_SEGMENTS * benchMSS,
+					benchFIRST_SEQUENCE, 0u, benchMSS );
+
+				/* All segments arrive in the expected order. */
+				for( ulSegment = 0u; ulSegment < ulSegments; ulSegment++ )
+				{
+					ulStart = ipconfigBENCHMARK_TIMER_VALUE();
+					lTCPWindowRxCheck( pxWindow, benchFIRST_SEQUENCE + ulSegment * benchMSS, benchMSS, ~0UL );
+					prvResultAdd( &xInOrder, ulStart, ipconfigBENCHMARK_TIMER_VALUE() );
+				}
+
+				vTCPWindowDestroy( pxWindow );
+				memset( pxWindow, '\0', sizeof( *pxWindow ) );
+				vTCPWindowCreate( pxWindow, 2u * benchMAX_SEGMENTS * benchMSS, 2u * benchMAX_SEGMENTS * benchMSS,
+					benchFIRST_SEQUENCE, 0u, benchMSS );
+
+				/* The first segment is lost, the others arrive in reverse
+				order and must be stored.  That is the worst case for the
+				search in the list of out-of-order segments. */
+				for( ulSegment = ulSegments - 1u; ulSegment > 0u; ulSegment-- )
+				{
+					ulStart = ipconfigBENCHMARK_TIMER_VALUE();
+					lTCPWindowRxCheck( pxWindow, benchFIRST_SEQUENCE + ulSegment * benchMSS, benchMSS, ~0UL );
+					prvResultAdd( &xOutOfOrder, ulStart, ipconfigBENCHMARK_TIMER_VALUE() );
+				}
+
+				/* The missing segment arrives, all stored segments become
+				available. */
+				ulStart = ipconfigBENCHMARK_TIMER_VALUE();
+				lTCPWindowRxCheck( pxWindow, benchFIRST_SEQUENCE, benchMSS, ~0UL );
+				prvResultAdd( &xFillHole, ulStart, ipconfigBENCHMARK_TIMER_VALUE() );
+
+				vTCPWindowDestroy( pxWindow );
+			}
+			xTaskResumeAll();
+		}
+
+		prvResultPrint( &xInOrder, "rx_window_in_order", ulSegments );
+		prvResultPrint( &xOutOfOrder, "rx_window_out_of_order", ulSegments );
+		prvResultPrint( &xFillHole, "rx_window_fill_hole", ulSegments );
+	}
+
+	vPortFree( pxWindow );
+}
+/*-----------------------------------------------------------*/
+
+static void prvBenchNetworkBuffers( void )
+{
+static const uint16_t usSizes[] = { 64u, ipconfigNETWORK_MTU + ipSIZE_OF_ETH_HEADER };
+NetworkBufferDescriptor_t *pxBuffer;
+BenchResult_t xGet, xRelease;
+uint32_t ulStart;
+UBaseType_t uxSize, uxIndex;
+
+	for( uxSize = 0u; uxSize < ( UBaseType_t ) ARRAY_SIZE( usSizes ); uxSize++ )
+	{
+		prvResultReset( &xGet );
+		prvResultReset( &xRelease );
+
+		for( uxIndex = 0u; uxIndex < ipconfigBENCHMARK_ITERATIONS; uxIndex++ )
+		{
+			ulStart = ipconfigBENCHMARK_TIMER_VALUE();
+			pxBuffer = pxGetNetworkBufferWithDescriptor( usSizes[ uxSize ], 0u );
+			prvResultAdd( &xGet, ulStart, ipconfigBENCHMARK_TIMER_VALUE() );
+
+			if( pxBuffer == NULL )
+			{
+				pxBenchOutput( "error,network_buffer,no buffer" );
+				break;
+			}
+
+			ulStart = ipconfigBENCHMARK_TIMER_VALUE();
+			vReleaseNetworkBufferAndDescriptor( pxBuffer );
+			prvResultAdd( &xRelease, ulStart, ipconfigBENCHMARK_TIMER_VALUE() );
+		}
+
+		prvResultPrint( &xGet, "network_buffer_get", usSizes[ uxSize ] );
+		prvResultPrint( &xRelease, "network_buffer_release", usSizes[ uxSize ] );
+	}
+}
+/*-----------------------------------------------------------*/
+
+static void prvBenchFrameFilter( void )
+{
+static const MACAddress_t xOtherMAC = { { 0x02, 0x00, 0x00, 0x12, 0x34, 0x56 } };
+static const char * const pcNames[] = { "frame_filter_unicast", "frame_filter_broadcast", "frame_filter_other" };
+const MACAddress_t *pxDestinations[ 3 ];
+EthernetHeader_t *pxHeader = ( EthernetHeader_t * ) ucBenchData;
+BenchResult_t xResult;
+uint32_t ulStart;
+UBaseType_t uxKind, uxIndex;
+
+	pxDestinations[ 0 ] = ( const MACAddress_t * ) ipLOCAL_MAC_ADDRESS;
+	pxDestinations[ 1 ] = &xBroadcastMACAddress;
+	pxDestinations[ 2 ] = &xOtherMAC;
+
+	memset( ucBenchData, '\0', sizeof( ucBenchData ) );
+	memcpy( &( pxHeader->xSourceAddress ), &xOtherMAC, sizeof( MACAddress_t ) );
+	pxHeader->usFrameType = ipIPv4_FRAME_TYPE;
+
+	for( uxKind = 0u; uxKind < ( UBaseType_t ) ARRAY_SIZE( pcNames ); uxKind++ )
+	{
+		prvResultReset( &xResult );
+		memcpy( &( pxHeader->xDestinationAddress ), pxDestinations[ uxKind ], sizeof( MACAddress_t ) );
+
+		for( uxIndex = 0u; uxIndex < ipconfigBENCHMARK_ITERATIONS; uxIndex++ )
+		{
+			ulStart = ipconfigBENCHMARK_TIMER_VALUE();
+			ulBenchSink = ( uint32_t ) eConsiderFrameForProcessing( ucBenchData );
+			prvResultAdd( &xResult, ulStart, ipconfigBENCHMARK_TIMER_VALUE() );
+		}
+
+		prvResultPrint( &xResult, pcNames[ uxKind ], ipSIZE_OF_ETH_HEADER );
+	}
+}
+/*-----------------------------------------------------------*/
+
+static void prvBenchHeap( void )
+{
+void *pvBlocks[ benchHEAP_BLOCKS ];
+void *pvBlock;
+BenchResult_t xMalloc, xFree, xSmall, xLarge;
+uint32_t ulStart;
+UBaseType_t uxIndex, uxBlock;
+size_t uxFreeBefore, uxFreeAfter;
+
+	prvResultReset( &xMalloc );
+	prvResultReset( &xFree );
+
+	/* The simplest pattern: one block is allocated and freed again. */
+	for( uxIndex = 0u; uxIndex < ipconfigBENCHMARK_ITERATIONS; uxIndex++ )
+	{
+		ulStart = ipconfigBENCHMARK_TIMER_VALUE();
+		pvBlock = pvPortMalloc( 64u );
+		prvResultAdd( &xMalloc, ulStart, ipconfigBENCHMARK_TIMER_VALUE() );
+
+		ulStart = ipconfigBENCHMARK_TIMER_VALUE();
+		vPortFree( pvBlock );
+		prvResultAdd( &xFree, ulStart, ipconfigBENCHMARK_TIMER_VALUE() );
+	}
+
+	prvResultPrint( &xMalloc, "heap_malloc", 64u );
+	prvResultPrint( &xFree, "heap_free", 64u );
+
+	/* A fragmented heap: small and large blocks are allocated in turn, and
+	every second block is freed.  New allocations must now search a list of
+	small free blocks. */
+	uxFreeBefore = xPortGetFreeHeapSize();
+
+	for( uxBlock = 0u; uxBlock < benchHEAP_BLOCKS; uxBlock++ )
+	{
+		pvBlocks[ uxBlock ] = pvPortMalloc( ( ( uxBlock & 1u ) != 0u ) ? 200u : 32u );
+	}
+
+	for( uxBlock = 0u; uxBlock < benchHEAP_BLOCKS; uxBlock += 2u )
+	{
+		vPortFree( pvBlocks[ uxBlock ] );
+		pvBlocks[ uxBlock ] = NULL;
+	}
+
+	prvResultReset( &xSmall );
+	prvResultReset( &xLarge );
+
+	for( uxIndex = 0u; uxIndex < ipconfigBENCHMARK_ITERATIONS; uxIndex++ )
+	{
+		ulStart = ipconfigBENCHMARK_TIMER_VALUE();
+		pvBlock = pvPortMalloc( 48u );
+		prvResultAdd( &xSmall, ulStart, ipconfigBENCHMARK_TIMER_VALUE() );
+		vPortFree( pvBlock );
+
+		ulStart = ipconfigBENCHMARK_TIMER_VALUE();
+		pvBlock = pvPortMalloc( 300u );
+		prvResultAdd( &xLarge, ulStart, ipconfigBENCHMARK_TIMER_VALUE() );
+		vPortFree( pvBlock );
+	}
+
+	uxFreeAfter = xPortGetFreeHeapSize();
+
+	for( uxBlock = 1u; uxBlock < benchHEAP_BLOCKS; uxBlock += 2u )
+	{
+		vPortFree( pvBlocks[ uxBlock ] );
+	}
+
+	prvResultPrint( &xSmall, "heap_fragmented_malloc", 48u );
+	prvResultPrint( &xLarge, "heap_fragmented_malloc", 300u );
+
+	{
+	char pcLine[ benchLINE_LENGTH ];
+
+		snprintf( pcLine, sizeof( pcLine ), "heap,fragmented,%lu,%lu,%lu",
+			( unsigned long ) uxFreeBefore,
+			( unsigned long ) uxFreeAfter,
+			( unsigned long ) xPortGetMinimumEverFreeHeapSize() );
+		pxBenchOutput( pcLine );
+	}
+}
+/*-----------------------------------------------------------*/
+
+void vTCPBenchmarkRun( BenchmarkOutput_t pxOutput )
+{
+char pcLine[ benchLINE_LENGTH ];
+UBaseType_t uxIndex;
+
+	pxBenchOutput = pxOutput;
+
+	for( uxIndex = 0u; uxIndex < sizeof( ucBenchData ); uxIndex++ )
+	{
+		ucBenchData[ uxIndex ] = ( uint8_t ) ( uxIndex * 7u );
+	}
+
+	prvMeasureOverhead();
+
+	pxBenchOutput( "bench,name,parameter,samples,min,mean,max" );
+	snprintf( pcLine, sizeof( pcLine ), "counts_per_us,%lu,overhead,%lu",
+		( unsigned long ) ipconfigBENCHMARK_COUNTS_PER_US,
+		( unsigned long ) ulTimerOverhead );
+	pxBenchOutput( pcLine );
+
+	prvBenchChecksum();
+	prvBenchStreamBuffer();
+	prvBenchSocketLookup();
+	prvBenchRxWindow();
+	prvBenchNetworkBuffers();
+	prvBenchFrameFilter();
+	prvBenchHeap();
+
+	pxBenchOutput( "done" );
+}
+/*-----------------------------------------------------------*/
+
+#endif /* ipconfigUSE_BENCHMARKS == 1 */
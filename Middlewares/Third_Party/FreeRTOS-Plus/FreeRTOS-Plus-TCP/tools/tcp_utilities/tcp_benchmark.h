@@ -0,0 +1,47 @@
+/*
+ * tcp_benchmark.h
+ *
+ * Micro-benchmarks of the primitives that are on the hot path of the stack:
+ * the internet checksum, the stream buffers, the TCP socket lookup, the TCP
+ * reception window, the network buffers, the Ethernet frame filter and the
+ * heap.  Compiled when ipconfigUSE_BENCHMARKS is 1.
+ *
+ * Times are taken with ipconfigBENCHMARK_TIMER_VALUE(), by default the same
+ * counter as ipconfigTCP_HR_TIMER_VALUE(): the DWT cycle counter on the target.
+ * On a host the application may define it as a counter derived from
+ * clock_gettime( CLOCK_MONOTONIC ), with ipconfigBENCHMARK_COUNTS_PER_US set
+ * accordingly.
+ *
+ * The results are written as lines of comma separated values:
+ *
+ *		bench,<name>,<parameter>,<samples>,<min>,<mean>,<max>
+ *
+ * All times are in timer counts, after subtracting the overhead of reading
+ * the timer.  The first lines are a header and the number of counts per
+ * microsecond, so that a script can convert the values.
+ */
+
+#ifndef TCP_BENCHMARK_H
+#define TCP_BENCHMARK_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Receives one line of output, without a line ending.  The line is only
+valid during the call. */
+typedef void ( * BenchmarkOutput_t )( const char *pcLine );
+
+/*
+ * Run all benchmarks and pass the results to 'pxOutput'.  Must be called from
+ * a normal task, not from the IP-task, after FreeRTOS_IPInit() has been
+ * called.  The socket lookup benchmark creates and closes a few listening TCP
+ * sockets, so some free sockets and heap are needed.
+ */
+void vTCPBenchmarkRun( BenchmarkOutput_t pxOutput );
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /* TCP_BENCHMARK_H */
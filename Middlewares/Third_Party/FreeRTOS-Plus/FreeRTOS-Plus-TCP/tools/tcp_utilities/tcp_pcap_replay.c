@@ -0,0 +1,731 @@
+/*
+ * tcp_pcap_replay.c
+ *
+ * Replays a pcap or pcapng capture through the reception path of the stack,
+ * see tcp_pcap_replay.h.
+ *
+ * Only the parts of the formats that describe Ethernet frames are used:
+ *		pcap:	the file header and the packet records, with micro- or
+ *				nanosecond timestamps, in either byte order.
+ *		pcapng:	Section Header, Interface Description (with if_tsresol),
+ *				Enhanced Packet and Simple Packet blocks.  Other blocks are
+ *				skipped.
+ */
+
+/* Standard includes. */
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
+#include "semphr.h"
+
+/* FreeRTOS+TCP includes. */
+#include "FreeRTOS_IP.h"
+#include "FreeRTOS_Sockets.h"
+#include "FreeRTOS_IP_Private.h"
+#include "NetworkBufferManagement.h"
+
+#include "tcp_pcap_replay.h"
+
+#if( ipconfigUSE_PCAP_REPLAY == 1 )
+
+#ifndef ipconfigPCAP_REPLAY_DRAIN_MS
+	/* After the last frame has been sent, the time that the IP-task gets to
+	process the frames still in its queue. */
+	#define ipconfigPCAP_REPLAY_DRAIN_MS		1000u
+#endif
+
+/* The pcap file header and record header. */
+#define replayPCAP_MAGIC_US				0xa1b2c3d4UL
+#define replayPCAP_MAGIC_NS				0xa1b23c4dUL
+#define replayPCAP_FILE_HEADER_SIZE		24u
+#define replayPCAP_RECORD_HEADER_SIZE	16u
+
+/* The pcapng block types and constants that are used. */
+#define replayPCAPNG_SHB				0x0a0d0d0aUL
+#define replayPCAPNG_IDB				0x00000001UL
+#define replayPCAPNG_SPB				0x00000003UL
+#define replayPCAPNG_EPB				0x00000006UL
+#define replayPCAPNG_BYTE_ORDER_MAGIC	0x1a2b3c4dUL
+#define replayPCAPNG_OPT_TSRESOL		9u
+#define replayPCAPNG_MIN_BLOCK			12u
+
+/* The link type of Ethernet frames. */
+#define replayLINKTYPE_ETHERNET			1u
+
+/* pcapng files may describe several interfaces, only the first ones are
+remembered.  Packets of other interfaces are skipped. */
+#define replayMAX_INTERFACES			4u
+
+#define replayMAX_FRAME_SIZE			( ipconfigNETWORK_MTU + ipSIZE_OF_ETH_HEADER )
+
+/*-----------------------------------------------------------*/
+
+typedef enum
+{
+	eReaderFrame,	/* A frame was found */
+	eReaderSkip,	/* A frame was found but it can not be used */
+	eReaderEnd		/* The end of the capture, or a damaged block */
+} eReaderResult_t;
+
+/* The state of the parser of a capture. */
+typedef struct xCAPTURE_READER
+{
+	const uint8_t *pucData;
+	size_t uxLength;
+	size_t uxOffset;
+	BaseType_t xBigEndian;
+	BaseType_t xIsPcapNG;
+	UBaseType_t uxInterfaceCount;
+	BaseType_t xIsEthernet[ replayMAX_INTERFACES ];
+	uint64_t ullUnitsPerSecond[ replayMAX_INTERFACES ];
+	uint64_t ullLastTimeUs;
+} CaptureReader_t;
+
+/*-----------------------------------------------------------*/
+
+static uint16_t prvGet16( const uint8_t *pucData, BaseType_t xBigEndian );
+static uint32_t prvGet32( const uint8_t *pucData, BaseType_t xBigEndian );
+static uint64_t prvToMicroseconds( uint64_t ullTime, uint64_t ullUnitsPerSecond );
+
+static BaseType_t prvReaderInit( CaptureReader_t *pxReader, const uint8_t *pucCapture, size_t uxLength );
+static eReaderResult_t prvReaderNext( CaptureReader_t *pxReader, const uint8_t **ppucFrame, size_t *puxFrameLength, uint64_t *pullTimeUs );
+static eReaderResult_t prvReaderNextPcap( CaptureReader_t *pxReader, const uint8_t **ppucFrame, size_t *puxFrameLength, uint64_t *pullTimeUs );
+static eReaderResult_t prvReaderNextPcapNG( CaptureReader_t *pxReader, const uint8_t **ppucFrame, size_t *puxFrameLength, uint64_t *pullTimeUs );
+static void prvReaderInterface( CaptureReader_t *pxReader, const uint8_t *pucBlock, uint32_t ulBlockLength );
+static eReaderResult_t prvCheckFrame( size_t uxCaptured, size_t uxOriginal );
+
+static void prvInjectFrame( const uint8_t *pucFrame, size_t uxLength, const PcapReplayConfig_t *pxConfig, PcapReplayReport_t *pxReport );
+
+/*-----------------------------------------------------------*/
+
+/* Set while a replay is running, the IP-task only measures packets then. */
+static volatile BaseType_t xReplayActive = pdFALSE;
+
+/* The number of packets processed by the IP-task during the replay. */
+static volatile uint32_t ulReplayProcessed;
+
+/* The processing costs, written by the IP-task. */
+static PcapReplayCost_t xReplayCost[ replayCLASS_COUNT ];
+
+/*-----------------------------------------------------------*/
+
+static uint16_t prvGet16( const uint8_t *pucData, BaseType_t xBigEndian )
+{
+uint16_t usValue;
+
+	if( xBigEndian != pdFALSE )
+	{
+		usValue = ( uint16_t ) ( ( ( ( uint16_t ) pucData[ 0 ] ) << 8 ) | pucData[ 1 ] );
+	}
+	else
+	{
+		usValue = ( uint16_t ) ( ( ( ( uint16_t ) pucData[ 1 ] ) << 8 ) | pucData[ 0 ] );
+	}
+
+	return usValue;
+}
+/*-----------------------------------------------------------*/
+
+static uint32_t prvGet32( const uint8_t *pucData, BaseType_t xBigEndian )
+{
+uint32_t ulValue;
+
+	if( xBigEndian != pdFALSE )
+	{
+		ulValue = ( ( ( uint32_t ) pucData[ 0 ] ) << 24 ) | ( ( ( uint32_t ) pucData[ 1 ] ) << 16 ) |
+				  ( ( ( uint32_t ) pucData[ 2 ] ) << 8 ) | ( ( uint32_t ) pucData[ 3 ] );
+	}
+	else
+	{
+		ulValue = ( ( ( uint32_t ) pucData[ 3 ] ) << 24 ) | ( ( ( uint32_t ) pucData[ 2 ] ) << 16 ) |
+				  ( ( ( uint32_t ) pucData[ 1 ] ) << 8 ) | ( ( uint32_t ) pucData[ 0 ] );
+	}
+
+	return ulValue;
+}
+/*-----------------------------------------------------------*/
+
+static uint64_t prvToMicroseconds( uint64_t ullTime, uint64_t ullUnitsPerSecond )
+{
+	/* Split the conversion so that the multiplication does not overflow for
+	normal resolutions. */
+	return ( ( ullTime / ullUnitsPerSecond ) * 1000000ULL ) +
+		( ( ( ullTime % ullUnitsPerSecond ) * 1000000ULL ) / ullUnitsPerSecond );
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvReaderInit( CaptureReader_t *pxReader, const uint8_t *pucCapture, size_t uxLength )
+{
+BaseType_t xReturn = pdFAIL;
+uint32_t ulMagic;
+
+	memset( pxReader, '\0', sizeof( *pxReader ) );
+	pxReader->pucData = pucCapture;
+	pxReader->uxLength = uxLength;
+
+	if( uxLength >= replayPCAP_FILE_HEADER_SIZE )
+	{
+		ulMagic = prvGet32( pucCapture, pdFALSE );
+
+		if( ulMagic == replayPCAPNG_SHB )
+		{
+			/* The Section Header Block is parsed as part of the blocks. */
+			pxReader->xIsPcapNG = pdTRUE;
+			xReturn = pdPASS;
+		}
+		else
+		{
+			if( ( ulMagic == replayPCAP_MAGIC_US ) || ( ulMagic == replayPCAP_MAGIC_NS ) )
+			{
+				pxReader->xBigEndian = pdFALSE;
+			}
+			else
+			{
+				pxReader->xBigEndian = pdTRUE;
+				ulMagic = prvGet32( pucCapture, pdTRUE );
+			}
+
+			if( ( ulMagic == replayPCAP_MAGIC_US ) || ( ulMagic == replayPCAP_MAGIC_NS ) )
+			{
+				pxReader->uxInterfaceCount = 1u;
+				pxReader->xIsEthernet[ 0 ] = ( prvGet32( pucCapture + 20u, pxReader->xBigEndian ) == replayLINKTYPE_ETHERNET );
+				pxReader->ullUnitsPerSecond[ 0 ] = ( ulMagic == replayPCAP_MAGIC_NS ) ? 1000000000ULL : 1000000ULL;
+				pxReader->uxOffset = replayPCAP_FILE_HEADER_SIZE;
+				xReturn = pxReader->xIsEthernet[ 0 ] ? pdPASS : pdFAIL;
+			}
+		}
+	}
+
+	return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+static eReaderResult_t prvCheckFrame( size_t uxCaptured, size_t uxOriginal )
+{
+eReaderResult_t eResult = eReaderFrame;
+
+	/* A frame that was cut off by the snap length would be seen by the stack
+	as a damaged packet. */
+	if( ( uxCaptured < uxOriginal ) || ( uxCaptured < ipSIZE_OF_ETH_HEADER ) || ( uxCaptured > replayMAX_FRAME_SIZE ) )
+	{
+		eResult = eReaderSkip;
+	}
+
+	return eResult;
+}
+/*-----------------------------------------------------------*/
+
+static eReaderResult_t prvReaderNextPcap( CaptureReader_t *pxReader, const uint8_t **ppucFrame, size_t *puxFrameLength, uint64_t *pullTimeUs )
+{
+const uint8_t *pucRecord = pxReader->pucData + pxReader->uxOffset;
+eReaderResult_t eResult = eReaderEnd;
+uint32_t ulCaptured, ulOriginal;
+uint64_t ullTime;
+
+	if( ( pxReader->uxLength - pxReader->uxOffset ) >= replayPCAP_RECORD_HEADER_SIZE )
+	{
+		ulCaptured = prvGet32( pucRecord + 8u, pxReader->xBigEndian );
+		ulOriginal = prvGet32( pucRecord + 12u, pxReader->xBigEndian );
+
+		if( ulCaptured <= ( pxReader->uxLength - pxReader->uxOffset - replayPCAP_RECORD_HEADER_SIZE ) )
+		{
+			ullTime = ( ( uint64_t ) prvGet32( pucRecord, pxReader->xBigEndian ) ) * pxReader->ullUnitsPerSecond[ 0 ];
+			ullTime += prvGet32( pucRecord + 4u, pxReader->xBigEndian );
+
+			*ppucFrame = pucRecord + replayPCAP_RECORD_HEADER_SIZE;
+			*puxFrameLength = ( size_t ) ulCaptured;
+			*pullTimeUs = prvToMicroseconds( ullTime, pxReader->ullUnitsPerSecond[ 0 ] );
+
+			pxReader->uxOffset += replayPCAP_RECORD_HEADER_SIZE + ulCaptured;
+			eResult = prvCheckFrame( ulCaptured, ulOriginal );
+		}
+	}
+
+	return eResult;
+}
+/*-----------------------------------------------------------*/
+
+static void prvReaderInterface( CaptureReader_t *pxReader, const uint8_t *pucBlock, uint32_t ulBlockLength )
+{
+UBaseType_t uxInterface = pxReader->uxInterfaceCount;
+uint32_t ulOffset = 16u;
+uint16_t usCode, usLength;
+uint8_t ucResolution;
+uint64_t ullUnits = 1000000ULL;
+
+	if( ( uxInterface < replayMAX_INTERFACES ) && ( ulBlockLength >= 20u ) )
+	{
+		/* Look for the if_tsresol option, the default is microseconds. */
+		while( ( ulOffset + 4u ) <= ( ulBlockLength - 4u ) )
+		{
+			usCode = prvGet16( pucBlock + ulOffset, pxReader->xBigEndian );
+			usLength = prvGet16( pucBlock + ulOffset + 2u, pxReader->xBigEndian );
+
+			if( ( usCode == 0u ) || ( ( ulOffset + 4u + usLength ) > ( ulBlockLength - 4u ) ) )
+			{
+				break;
+			}
+
+			if( ( usCode == replayPCAPNG_OPT_TSRESOL ) && ( usLength >= 1u ) )
+			{
+				ucResolution = pucBlock[ ulOffset + 4u ];
+
+				if( ( ucResolution & 0x80u ) != 0u )
+				{
+					/* A negative power of 2. */
+					ullUnits = 1ULL << ( ucResolution & 0x3fu );
+				}
+				else
+				{
+					/* A negative power of 10. */
+					ullUnits = 1u;
+
+					while( ( ucResolution > 0u ) && ( ullUnits < 1000000000000000000ULL ) )
+					{
+						ullUnits *= 10u;
+						ucResolution--;
+					}
+				}
+			}
+
+			/* Options are padded to 32 bits. */
+			ulOffset += 4u + ( ( usLength + 3u ) & ~3u );
+		}
+
+		pxReader->xIsEthernet[ uxInterface ] = ( prvGet16( pucBlock + 8u, pxReader->xBigEndian ) == replayLINKTYPE_ETHERNET );
+		pxReader->ullUnitsPerSecond[ uxInterface ] = ullUnits;
+	}
+
+	/* Interfaces are numbered in the order of their description. */
+	pxReader->uxInterfaceCount++;
+}
+/*-----------------------------------------------------------*/
+
+static eReaderResult_t prvReaderNextPcapNG( CaptureReader_t *pxReader, const uint8_t **ppucFrame, size_t *puxFrameLength, uint64_t *pullTimeUs )
+{
+const uint8_t *pucBlock;
+eReaderResult_t eResult = eReaderEnd;
+uint32_t ulType, ulBlockLength, ulInterface, ulCaptured, ulOriginal;
+uint64_t ullTime;
+BaseType_t xFound = pdFALSE;
+
+	while( ( xFound == pdFALSE ) && ( ( pxReader->uxLength - pxReader->uxOffset ) >= replayPCAPNG_MIN_BLOCK ) )
+	{
+		pucBlock = pxReader->pucData + pxReader->uxOffset;
+		ulType = prvGet32( pucBlock, pxReader->xBigEndian );
+
+		if( ulType == replayPCAPNG_SHB )
+		{
+			/* A new section, which may have a different byte order and new
+			interfaces. */
+			pxReader->xBigEndian = ( prvGet32( pucBlock + 8u, pdFALSE ) != replayPCAPNG_BYTE_ORDER_MAGIC );
+			pxReader->uxInterfaceCount = 0u;
+		}
+
+		ulBlockLength = prvGet32( pucBlock + 4u, pxReader->xBigEndian );
+
+		if( ( ulBlockLength < replayPCAPNG_MIN_BLOCK ) || ( ( ulBlockLength & 3u ) != 0u ) ||
+			( ulBlockLength > ( pxReader->uxLength - pxReader->uxOffset ) ) )
+		{
+			/* A damaged block, stop here. */
+			break;
+		}
+
+		pxReader->uxOffset += ulBlockLength;
+
+		if( ulType == replayPCAPNG_IDB )
+		{
+			prvReaderInterface( pxReader, pucBlock, ulBlockLength );
+		}
+		else if( ( ulType == replayPCAPNG_EPB ) && ( ulBlockLength >= 32u ) )
+		{
+			ulInterface = prvGet32( pucBlock + 8u, pxReader->xBigEndian );
+			ulCaptured = prvGet32( pucBlock + 20u, pxReader->xBigEndian );
+			ulOriginal = prvGet32( pucBlock + 24u, pxReader->xBigEndian );
+			xFound = pdTRUE;
+
+			if( ( ulInterface >= pxReader->uxInterfaceCount ) || ( ulInterface >= replayMAX_INTERFACES ) ||
+				( pxReader->xIsEthernet[ ulInterface ] == pdFALSE ) || ( ulCaptured > ( ulBlockLength - 32u ) ) )
+			{
+				eResult = eReaderSkip;
+			}
+			else
+			{
+				ullTime = ( ( ( uint64_t ) prvGet32( pucBlock + 12u, pxReader->xBigEndian ) ) << 32 ) |
+					prvGet32( pucBlock + 16u, pxReader->xBigEndian );
+				pxReader->ullLastTimeUs = prvToMicroseconds( ullTime, pxReader->ullUnitsPerSecond[ ulInterface ] );
+
+				*ppucFrame = pucBlock + 28u;
+				*puxFrameLength = ( size_t ) ulCaptured;
+				*pullTimeUs = pxReader->ullLastTimeUs;
+				eResult = prvCheckFrame( ulCaptured, ulOriginal );
+			}
+		}
+		else if( ( ulType == replayPCAPNG_SPB ) && ( ulBlockLength >= 16u ) )
+		{
+			/* A Simple Packet Block belongs to the first interface and has no
+			timestamp: use the time of the previous packet. */
+			ulOriginal = prvGet32( pucBlock + 8u, pxReader->xBigEndian );
+			ulCaptured = FreeRTOS_min_uint32( ulOriginal, ulBlockLength - 16u );
+			xFound = pdTRUE;
+
+			if( ( pxReader->uxInterfaceCount == 0u ) || ( pxReader->xIsEthernet[ 0 ] == pdFALSE ) )
+			{
+				eResult = eReaderSkip;
+			}
+			else
+			{
+				*ppucFrame = pucBlock + 12u;
+				*puxFrameLength = ( size_t ) ulCaptured;
+				*pullTimeUs = pxReader->ullLastTimeUs;
+				eResult = prvCheckFrame( ulCaptured, ulOriginal );
+			}
+		}
+		else
+		{
+			/* A block that is not used. */
+		}
+	}
+
+	return eResult;
+}
+/*-----------------------------------------------------------*/
+
+static eReaderResult_t prvReaderNext( CaptureReader_t *pxReader, const uint8_t **ppucFrame, size_t *puxFrameLength, uint64_t *pullTimeUs )
+{
+eReaderResult_t eResult;
+
+	if( pxReader->xIsPcapNG != pdFALSE )
+	{
+		eResult = prvReaderNextPcapNG( pxReader, ppucFrame, puxFrameLength, pullTimeUs );
+	}
+	else
+	{
+		eResult = prvReaderNextPcap( pxReader, ppucFrame, puxFrameLength, pullTimeUs );
+	}
+
+	return eResult;
+}
+/*-----------------------------------------------------------*/
+
+static void prvInjectFrame( const uint8_t *pucFrame, size_t uxLength, const PcapReplayConfig_t *pxConfig, PcapReplayReport_t *pxReport )
+{
+extern QueueHandle_t xNetworkEventQueue;
+NetworkBufferDescriptor_t *pxBufferDescriptor;
+IPStackEvent_t xRxEvent;
+UBaseType_t uxCount;
+
+	pxBufferDescriptor = pxGetNetworkBufferWithDescriptor( uxLength, pxConfig->xBlockTime );
+
+	if( pxBufferDescriptor == NULL )
+	{
+		pxReport->ulNoBuffer++;
+		iptraceETHERNET_RX_EVENT_LOST();
+	}
+	else
+	{
+		uxCount = uxGetNumberOfFreeNetworkBuffers();
+
+		if( pxReport->uxMinFreeBuffers > uxCount )
+		{
+			pxReport->uxMinFreeBuffers = uxCount;
+		}
+
+		/* Follow the steps of a network interface.  The frame is copied
+		first, because in the capture it may not be aligned. */
+		memcpy( pxBufferDescriptor->pucEthernetBuffer, pucFrame, uxLength );
+		pxBufferDescriptor->xDataLength = uxLength;
+
+		if( eConsiderFrameForProcessing( pxBufferDescriptor->pucEthernetBuffer ) != eProcessBuffer )
+		{
+			vReleaseNetworkBufferAndDescriptor( pxBufferDescriptor );
+			pxReport->ulFiltered++;
+		}
+		else
+		{
+			uxCount = uxQueueSpacesAvailable( xNetworkEventQueue );
+
+			if( pxReport->uxMinQueueSpace > uxCount )
+			{
+				pxReport->uxMinQueueSpace = uxCount;
+			}
+
+			xRxEvent.eEventType = eNetworkRxEvent;
+			xRxEvent.pvData = ( void * ) pxBufferDescriptor;
+
+			if( xSendEventStructToIPTask( &xRxEvent, pxConfig->xBlockTime ) == pdFALSE )
+			{
+				/* The buffer could not be sent to the IP task so the buffer
+				must be released. */
+				vReleaseNetworkBufferAndDescriptor( pxBufferDescriptor );
+				pxReport->ulQueueFull++;
+				iptraceETHERNET_RX_EVENT_LOST();
+			}
+			else
+			{
+				pxReport->ulInjected++;
+				iptraceNETWORK_INTERFACE_RECEIVE();
+			}
+		}
+	}
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xPcapReplayRun( const uint8_t *pucCapture, size_t uxLength, const PcapReplayConfig_t *pxConfig, PcapReplayReport_t *pxReport )
+{
+CaptureReader_t xReader;
+const uint8_t *pucFrame = NULL;
+size_t uxFrameLength = 0u;
+uint64_t ullTimeUs = 0u, ullFirstUs = 0u;
+eReaderResult_t eResult;
+TickType_t xStart, xLoopStart, xDue, xElapsed;
+BaseType_t xFirst, xReturn = pdFAIL;
+uint32_t ulLoop, ulLoops;
+UBaseType_t uxClass;
+
+	memset( pxReport, '\0', sizeof( *pxReport ) );
+	pxReport->uxMinFreeBuffers = ipconfigNUM_NETWORK_BUFFER_DESCRIPTORS;
+	pxReport->uxMinQueueSpace = ipconfigEVENT_QUEUE_LENGTH;
+
+	if( ( xReplayActive == pdFALSE ) && ( prvReaderInit( &xReader, pucCapture, uxLength ) == pdPASS ) )
+	{
+		for( uxClass = 0u; uxClass < replayCLASS_COUNT; uxClass++ )
+		{
+			memset( &( xReplayCost[ uxClass ] ), '\0', sizeof( xReplayCost[ uxClass ] ) );
+			xReplayCost[ uxClass ].ulMin = ~0UL;
+		}
+
+		ulReplayProcessed = 0u;
+		xReplayActive = pdTRUE;
+		ulLoops = ( pxConfig->ulLoops != 0u ) ? pxConfig->ulLoops : 1u;
+		xStart = xTaskGetTickCount();
+
+		for( ulLoop = 0u; ulLoop < ulLoops; ulLoop++ )
+		{
+			( void ) prvReaderInit( &xReader, pucCapture, uxLength );
+			xLoopStart = xTaskGetTickCount();
+			xFirst = pdTRUE;
+
+			for( ;; )
+			{
+				eResult = prvReaderNext( &xReader, &pucFrame, &uxFrameLength, &ullTimeUs );
+
+				if( eResult == eReaderEnd )
+				{
+					break;
+				}
+
+				pxReport->ulFrames++;
+
+				if( eResult == eReaderSkip )
+				{
+					pxReport->ulSkipped++;
+					continue;
+				}
+
+				if( pxConfig->xRecordedTiming != pdFALSE )
+				{
+					if( xFirst != pdFALSE )
+					{
+						ullFirstUs = ullTimeUs;
+						xFirst = pdFALSE;
+					}
+
+					/* Wait until the moment this frame was received, relative
+					to the first frame.  Frames that are out of order in the
+					capture are sent immediately. */
+					if( ullTimeUs > ullFirstUs )
+					{
+						xDue = pdMS_TO_TICKS( ( TickType_t ) ( ( ullTimeUs - ullFirstUs ) / 1000u ) );
+						xElapsed = xTaskGetTickCount() - xLoopStart;
+
+						if( xDue > xElapsed )
+						{
+							vTaskDelay( xDue - xElapsed );
+						}
+					}
+				}
+
+				prvInjectFrame( pucFrame, uxFrameLength, pxConfig, pxReport );
+			}
+		}
+
+		/* Give the IP-task time to process the frames in its queue. */
+		xDue = pdMS_TO_TICKS( ipconfigPCAP_REPLAY_DRAIN_MS );
+		xLoopStart = xTaskGetTickCount();
+
+		while( ( ulReplayProcessed < pxReport->ulInjected ) && ( ( xTaskGetTickCount() - xLoopStart ) < xDue ) )
+		{
+			vTaskDelay( 1u );
+		}
+
+		xElapsed = xTaskGetTickCount() - xStart;
+		xReplayActive = pdFALSE;
+
+		pxReport->ulElapsedMs = ( uint32_t ) ( xElapsed * portTICK_PERIOD_MS );
+		pxReport->ulFramesPerSecond = ( uint32_t ) ( ( ( uint64_t ) pxReport->ulInjected * 1000u ) /
+			FreeRTOS_max_uint32( pxReport->ulElapsedMs, 1u ) );
+		pxReport->uxMinEverFreeHeap = xPortGetMinimumEverFreeHeapSize();
+		memcpy( pxReport->xCost, xReplayCost, sizeof( pxReport->xCost ) );
+
+		xReturn = pdPASS;
+	}
+
+	return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xPcapReplayClassify( const uint8_t *pucEthernetBuffer )
+{
+const IPPacket_t *pxIPPacket = ( const IPPacket_t * ) pucEthernetBuffer;
+BaseType_t xClass = replayCLASS_OTHER;
+
+	if( pxIPPacket->xEthernetHeader.usFrameType == ipARP_FRAME_TYPE )
+	{
+		xClass = replayCLASS_ARP;
+	}
+	else if( pxIPPacket->xEthernetHeader.usFrameType == ipIPv4_FRAME_TYPE )
+	{
+		switch( pxIPPacket->xIPHeader.ucProtocol )
+		{
+			case ipPROTOCOL_ICMP:
+				xClass = replayCLASS_ICMP;
+				break;
+			case ipPROTOCOL_UDP:
+				xClass = replayCLASS_UDP;
+				break;
+			case ipPROTOCOL_TCP:
+				xClass = replayCLASS_TCP;
+				break;
+			default:
+				break;
+		}
+	}
+
+	return xClass;
+}
+/*-----------------------------------------------------------*/
+
+void vPcapReplayPacketProcessed( BaseType_t xClass, uint32_t ulStartTime )
+{
+PcapReplayCost_t *pxCost;
+uint32_t ulTime;
+
+	/* Called from the IP-task. */
+	if( xReplayActive != pdFALSE )
+	{
+		ulTime = ipconfigBENCHMARK_TIMER_VALUE() - ulStartTime;
+		pxCost = &( xReplayCost[ xClass ] );
+
+		pxCost->ulPackets++;
+		pxCost->ullTotal += ulTime;
+
+		if( pxCost->ulMin > ulTime )
+		{
+			pxCost->ulMin = ulTime;
+		}
+
+		if( pxCost->ulMax < ulTime )
+		{
+			pxCost->ulMax = ulTime;
+		}
+
+		ulReplayProcessed++;
+	}
+}
+/*-----------------------------------------------------------*/
+
+void vPcapReplayPrintReport( const PcapReplayReport_t *pxReport )
+{
+static const char * const pcClassNames[ replayCLASS_COUNT ] = { "ARP", "ICMP", "UDP", "TCP", "other" };
+const PcapReplayCost_t *pxCost;
+UBaseType_t uxClass;
+
+	/* The names are only used by FreeRTOS_printf(), which may be empty. */
+	( void ) pcClassNames;
+
+	FreeRTOS_printf( ( "Replay: %lu frames, %lu injected, %lu filtered, %lu skipped\n",
+		pxReport->ulFrames, pxReport->ulInjected, pxReport->ulFiltered, pxReport->ulSkipped ) );
+	FreeRTOS_printf( ( "Drops: %lu no buffer, %lu queue full\n",
+		pxReport->ulNoBuffer, pxReport->ulQueueFull ) );
+	FreeRTOS_printf( ( "Time: %lu ms, %lu frames/sec\n",
+		pxReport->ulElapsedMs, pxReport->ulFramesPerSecond ) );
+	FreeRTOS_printf( ( "Low water: %u buffers free, %u queue places free, %u bytes heap\n",
+		( unsigned ) pxReport->uxMinFreeBuffers, ( unsigned ) pxReport->uxMinQueueSpace, ( unsigned ) pxReport->uxMinEverFreeHeap ) );
+	FreeRTOS_printf( ( "Prot  Packets   Min  Mean   Max (counts, %lu per us)\n",
+		( uint32_t ) ipconfigBENCHMARK_COUNTS_PER_US ) );
+
+	for( uxClass = 0u; uxClass < replayCLASS_COUNT; uxClass++ )
+	{
+		pxCost = &( pxReport->xCost[ uxClass ] );
+
+		if( pxCost->ulPackets != 0u )
+		{
+			FreeRTOS_printf( ( "%-5s %7lu %5lu %5lu %5lu\n",
+				pcClassNames[ uxClass ],
+				pxCost->ulPackets,
+				pxCost->ulMin,
+				( uint32_t ) ( pxCost->ullTotal / pxCost->ulPackets ),
+				pxCost->ulMax ) );
+		}
+	}
+}
+/*-----------------------------------------------------------*/
+
+#if( ipconfigPCAP_REPLAY_USE_FILES == 1 )
+
+	BaseType_t xPcapReplayFile( const char *pcFileName, const PcapReplayConfig_t *pxConfig, PcapReplayReport_t *pxReport )
+	{
+	FILE *pxFile;
+	uint8_t *pucCapture = NULL;
+	long lLength = -1;
+	BaseType_t xReturn = pdFAIL;
+
+		pxFile = fopen( pcFileName, "rb" );
+
+		if( pxFile == NULL )
+		{
+			FreeRTOS_printf( ( "xPcapReplayFile: can not open %s\n", pcFileName ) );
+		}
+		else
+		{
+			if( fseek( pxFile, 0L, SEEK_END ) == 0 )
+			{
+				lLength = ftell( pxFile );
+				rewind( pxFile );
+			}
+
+			if( lLength > 0 )
+			{
+				pucCapture = ( uint8_t * ) pvPortMalloc( ( size_t ) lLength );
+			}
+
+			if( ( pucCapture != NULL ) && ( fread( pucCapture, 1u, ( size_t ) lLength, pxFile ) == ( size_t ) lLength ) )
+			{
+				xReturn = xPcapReplayRun( pucCapture, ( size_t ) lLength, pxConfig, pxReport );
+			}
+			else
+			{
+				FreeRTOS_printf( ( "xPcapReplayFile: can not read %s\n", pcFileName ) );
+			}
+
+			if( pucCapture != NULL )
+			{
+				vPortFree( pucCapture );
+			}
+
+			fclose( pxFile );
+		}
+
+		return xReturn;
+	}
+
+#endif /* ipconfigPCAP_REPLAY_USE_FILES */
+/*-----------------------------------------------------------*/
+
+#endif /* ipconfigUSE_PCAP_REPLAY == 1 */
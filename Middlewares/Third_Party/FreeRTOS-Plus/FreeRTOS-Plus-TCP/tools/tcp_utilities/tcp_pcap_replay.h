@@ -0,0 +1,91 @@
+/*
+ * tcp_pcap_replay.h
+ *
+ * Feeds a captured stream of Ethernet frames into the IP-task, along the same
+ * path as a network interface: eConsiderFrameForProcessing(), a network
+ * buffer, and xSendEventStructToIPTask().  The capture may be in the pcap or
+ * in the pcapng format, and must contain Ethernet frames.  Frames are sent as
+ * fast as possible, or at the moments that were recorded.
+ *
+ * The IP-task measures the time it spends on every received packet, sorted by
+ * protocol.  Together with the number of frames per second, the drops and the
+ * lowest number of free network buffers, this gives a repeatable workload to
+ * evaluate changes of the reception path.
+ *
+ * Compiled when ipconfigUSE_PCAP_REPLAY is 1.  The capture is read from
+ * memory: on the target it can be linked into flash, on a host it can be read
+ * from a file with xPcapReplayFile() when ipconfigPCAP_REPLAY_USE_FILES is 1.
+ */
+
+#ifndef TCP_PCAP_REPLAY_H
+#define TCP_PCAP_REPLAY_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* The classes of packets for which the processing time is measured. */
+#define replayCLASS_ARP				0
+#define replayCLASS_ICMP			1
+#define replayCLASS_UDP				2
+#define replayCLASS_TCP				3
+#define replayCLASS_OTHER			4
+#define replayCLASS_COUNT			5
+
+typedef struct xPCAP_REPLAY_CONFIG
+{
+	BaseType_t xRecordedTiming;		/* pdTRUE: wait for the recorded time of each frame, pdFALSE: as fast as possible */
+	TickType_t xBlockTime;			/* Maximum time to wait for a network buffer or for space in the event queue, 0 means drop like a driver */
+	uint32_t ulLoops;				/* Number of times the capture is replayed, 0 is treated as 1 */
+} PcapReplayConfig_t;
+
+/* The time spent by the IP-task on one class of packets, in counts of
+ipconfigBENCHMARK_TIMER_VALUE(). */
+typedef struct xPCAP_REPLAY_COST
+{
+	uint32_t ulPackets;
+	uint32_t ulMin;
+	uint32_t ulMax;
+	uint64_t ullTotal;
+} PcapReplayCost_t;
+
+typedef struct xPCAP_REPLAY_REPORT
+{
+	uint32_t ulFrames;				/* Frames found in the capture, including the skipped ones */
+	uint32_t ulInjected;			/* Frames passed to the IP-task */
+	uint32_t ulFiltered;			/* Frames rejected by eConsiderFrameForProcessing() */
+	uint32_t ulNoBuffer;			/* Frames dropped for lack of a network buffer */
+	uint32_t ulQueueFull;			/* Frames dropped because the event queue was full */
+	uint32_t ulSkipped;				/* Frames that were truncated, too long or not Ethernet */
+	uint32_t ulElapsedMs;			/* From the first frame until the IP-task has processed the last one */
+	uint32_t ulFramesPerSecond;		/* Injected frames per second */
+	UBaseType_t uxMinFreeBuffers;	/* Lowest number of free network buffers seen */
+	UBaseType_t uxMinQueueSpace;	/* Lowest number of free places in the event queue seen */
+	size_t uxMinEverFreeHeap;		/* xPortGetMinimumEverFreeHeapSize() after the replay */
+	PcapReplayCost_t xCost[ replayCLASS_COUNT ];
+} PcapReplayReport_t;
+
+/*
+ * Replay a capture that is stored in memory.  Must be called from a normal
+ * task after the network is up.  Returns pdFAIL when the capture is not
+ * recognised as pcap or pcapng, or when another replay is running.
+ */
+BaseType_t xPcapReplayRun( const uint8_t *pucCapture, size_t uxLength, const PcapReplayConfig_t *pxConfig, PcapReplayReport_t *pxReport );
+
+#if( ipconfigPCAP_REPLAY_USE_FILES == 1 )
+	/*
+	 * Read a capture file into the heap and replay it.
+	 */
+	BaseType_t xPcapReplayFile( const char *pcFileName, const PcapReplayConfig_t *pxConfig, PcapReplayReport_t *pxReport );
+#endif
+
+/*
+ * Print a report with FreeRTOS_printf(), in the same style as vTCPNetStat().
+ */
+void vPcapReplayPrintReport( const PcapReplayReport_t *pxReport );
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /* TCP_PCAP_REPLAY_H */
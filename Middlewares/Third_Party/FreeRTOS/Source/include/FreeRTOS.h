@@ -658,6 +658,18 @@ extern "C" {
 	#define traceTASK_NOTIFY_GIVE_FROM_ISR()
 #endif
 
+#ifndef traceCRITICAL_SECTION_ENTER
+	/* Called by the port layer after it has masked interrupts, at the start of
+	the outermost critical section and of the tick interrupt.  'pvSite' is the
+	code address that the masked region is charged to. */
+	#define traceCRITICAL_SECTION_ENTER( pvSite )
+#endif
+
+#ifndef traceCRITICAL_SECTION_EXIT
+	/* Called by the port layer just before it unmasks interrupts again. */
+	#define traceCRITICAL_SECTION_EXIT()
+#endif
+
 #ifndef configGENERATE_RUN_TIME_STATS
 	#define configGENERATE_RUN_TIME_STATS 0
 #endif
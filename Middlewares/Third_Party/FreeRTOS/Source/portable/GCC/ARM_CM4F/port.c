@@ -417,6 +417,7 @@ void vPortEnterCritical( void )
 	if( uxCriticalNesting == 1 )
 	{
 		configASSERT( ( portNVIC_INT_CTRL_REG & portVECTACTIVE_MASK ) == 0 );
+		traceCRITICAL_SECTION_ENTER( __builtin_return_address( 0 ) );
 	}
 }
 /*-----------------------------------------------------------*/
@@ -427,6 +428,7 @@ void vPortExitCritical( void )
 	uxCriticalNesting--;
 	if( uxCriticalNesting == 0 )
 	{
+		traceCRITICAL_SECTION_EXIT();
 		portENABLE_INTERRUPTS();
 	}
 }
@@ -497,6 +499,11 @@ void xPortSysTickHandler( void )
 	save and then restore the interrupt mask value as its value is already
 	known. */
 	portDISABLE_INTERRUPTS();
+
+	/* This function is the SysTick handler, or is tail-called from it, in
+	which case the return address is an EXC_RETURN value and not a call site.
+	The region is charged to the handler itself. */
+	traceCRITICAL_SECTION_ENTER( ( void * ) xPortSysTickHandler );
 	{
 		/* Increment the RTOS tick. */
 		if( xTaskIncrementTick() != pdFALSE )
@@ -506,6 +513,7 @@ void xPortSysTickHandler( void )
 			portNVIC_INT_CTRL_REG = portNVIC_PENDSVSET_BIT;
 		}
 	}
+	traceCRITICAL_SECTION_EXIT();
 	portENABLE_INTERRUPTS();
 }
 /*-----------------------------------------------------------*/
@@ -0,0 +1,411 @@
+/*-----------------------------------------------------------
+ * Implementation of functions defined in portable.h for the POSIX port.
+ *
+ * Each task has a pthread which holds the task's context.  Only one of these
+ * threads runs at a time: the others wait on their event.  A context switch
+ * wakes the thread of the new task and makes the old one wait.
+ *
+ * The tick is a SIGALRM from an interval timer.  Signals are only unblocked
+ * in the thread of the running task, and only when it is not in a critical
+ * section, so the tick handler never interrupts a critical section.  When the
+ * tick handler switches to another task, the interrupted thread waits inside
+ * the signal handler until it is switched back in.
+ *
+ * The FreeRTOS stack of a task only holds its Thread_t, the pthread has a
+ * stack of its own.  Stack overflow checking and the high water mark do not
+ * work with this port.
+ *----------------------------------------------------------*/
+
+/* Standard includes. */
+#include <errno.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+
+/* Scheduler includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include "utils/wait_for_event.h"
+
+/* The signal with which vPortEndScheduler() wakes the main thread. */
+#define portSIG_RESUME			SIGUSR1
+
+/* The signal of the tick. */
+#define portSIG_TICK			SIGALRM
+
+/* The context of a task, kept at the top of its FreeRTOS stack. */
+typedef struct THREAD
+{
+	pthread_t pthread;
+	pdTASK_CODE pxCode;
+	void *pvParams;
+	BaseType_t xDying;
+	struct event *ev;
+} Thread_t;
+
+/*
+ * Set up the signal masks and the tick handler, once.
+ */
+static void prvSetupSignals( void );
+
+/*
+ * The start routine of every thread: waits until the task is switched in for
+ * the first time.
+ */
+static void *prvWaitForStart( void *pvParams );
+
+/*
+ * Wake the thread of the new task and let the calling thread wait until its
+ * own task is switched in again.
+ */
+static void prvSwitchThread( Thread_t *pxThreadToResume, Thread_t *pxThreadToSuspend );
+
+/*
+ * The SIGALRM handler.
+ */
+static void prvSystemTickHandler( int iSignal );
+
+/*
+ * Start the interval timer that generates the tick.
+ */
+static void prvSetupTimerInterrupt( void );
+
+/*-----------------------------------------------------------*/
+
+/* The signals that are blocked in a critical section: all except SIGINT, so
+that the simulator can still be stopped with ^C. */
+static sigset_t xAllSignals;
+
+static pthread_once_t xSignalsOnce = PTHREAD_ONCE_INIT;
+
+/* The thread that started the scheduler, it waits until the end. */
+static pthread_t hMainThread;
+
+static volatile BaseType_t xSchedulerEnd = pdFALSE;
+
+/* Critical nesting of the running task.  Each thread keeps a copy while it is
+switched out, see prvSwitchThread(). */
+static volatile UBaseType_t uxCriticalNesting = 0;
+
+/*-----------------------------------------------------------*/
+
+static Thread_t *prvGetThreadFromTask( TaskHandle_t xTask )
+{
+StackType_t *pxTopOfStack = *( StackType_t ** ) xTask;
+
+	return ( Thread_t * ) ( pxTopOfStack + 1 );
+}
+/*-----------------------------------------------------------*/
+
+/*
+ * See header file for description.
+ */
+StackType_t *pxPortInitialiseStack( StackType_t *pxTopOfStack, TaskFunction_t pxCode, void *pvParameters )
+{
+Thread_t *pxThread;
+pthread_attr_t xThreadAttributes;
+sigset_t xSavedSignals;
+int iResult;
+
+	pthread_once( &xSignalsOnce, prvSetupSignals );
+
+	/* Store the context at the top of the stack, below the word that
+	pxTopOfStack points to. */
+	pxThread = ( Thread_t * ) ( pxTopOfStack + 1 ) - 1;
+	pxTopOfStack = ( StackType_t * ) pxThread - 1;
+
+	pxThread->pxCode = pxCode;
+	pxThread->pvParams = pvParameters;
+	pxThread->xDying = pdFALSE;
+	pxThread->ev = event_create();
+	configASSERT( pxThread->ev != NULL );
+
+	pthread_attr_init( &xThreadAttributes );
+
+	/* The new thread inherits the signal mask: it must start with all signals
+	blocked. */
+	pthread_sigmask( SIG_SETMASK, &xAllSignals, &xSavedSignals );
+	iResult = pthread_create( &pxThread->pthread, &xThreadAttributes, prvWaitForStart, pxThread );
+	pthread_sigmask( SIG_SETMASK, &xSavedSignals, NULL );
+
+	pthread_attr_destroy( &xThreadAttributes );
+
+	if( iResult != 0 )
+	{
+		fprintf( stderr, "pxPortInitialiseStack: pthread_create: %s\n", strerror( iResult ) );
+		abort();
+	}
+
+	return pxTopOfStack;
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xPortStartScheduler( void )
+{
+Thread_t *pxFirstThread;
+sigset_t xSignals;
+int iSignal;
+
+	hMainThread = pthread_self();
+
+	/* The main thread only waits for portSIG_RESUME, the tick must go to the
+	threads of the tasks. */
+	pthread_sigmask( SIG_BLOCK, &xAllSignals, NULL );
+
+	prvSetupTimerInterrupt();
+
+	/* Start the first task. */
+	pxFirstThread = prvGetThreadFromTask( xTaskGetCurrentTaskHandle() );
+	event_signal( pxFirstThread->ev );
+
+	/* Wait until vPortEndScheduler() is called. */
+	sigemptyset( &xSignals );
+	sigaddset( &xSignals, portSIG_RESUME );
+
+	while( xSchedulerEnd == pdFALSE )
+	{
+		sigwait( &xSignals, &iSignal );
+	}
+
+	return 0;
+}
+/*-----------------------------------------------------------*/
+
+void vPortEndScheduler( void )
+{
+struct itimerval xTimer;
+Thread_t *pxCurrentThread;
+
+	/* Stop the tick. */
+	memset( &xTimer, '\0', sizeof( xTimer ) );
+	setitimer( ITIMER_REAL, &xTimer, NULL );
+
+	xSchedulerEnd = pdTRUE;
+	pthread_kill( hMainThread, portSIG_RESUME );
+
+	/* vTaskStartScheduler() returns in the main thread, this task does not
+	run any more. */
+	pxCurrentThread = prvGetThreadFromTask( xTaskGetCurrentTaskHandle() );
+
+	for( ;; )
+	{
+		event_wait( pxCurrentThread->ev );
+	}
+}
+/*-----------------------------------------------------------*/
+
+void vPortEnterCritical( void )
+{
+	if( uxCriticalNesting == 0 )
+	{
+		vPortDisableInterrupts();
+	}
+
+	uxCriticalNesting++;
+}
+/*-----------------------------------------------------------*/
+
+void vPortExitCritical( void )
+{
+	configASSERT( uxCriticalNesting != 0 );
+
+	uxCriticalNesting--;
+
+	if( uxCriticalNesting == 0 )
+	{
+		vPortEnableInterrupts();
+	}
+}
+/*-----------------------------------------------------------*/
+
+void vPortDisableInterrupts( void )
+{
+	pthread_sigmask( SIG_BLOCK, &xAllSignals, NULL );
+}
+/*-----------------------------------------------------------*/
+
+void vPortEnableInterrupts( void )
+{
+	pthread_sigmask( SIG_UNBLOCK, &xAllSignals, NULL );
+}
+/*-----------------------------------------------------------*/
+
+UBaseType_t uxPortSetInterruptMask( void )
+{
+sigset_t xOldSignals;
+
+	pthread_sigmask( SIG_BLOCK, &xAllSignals, &xOldSignals );
+
+	/* Non-zero when the tick was already blocked. */
+	return ( UBaseType_t ) sigismember( &xOldSignals, portSIG_TICK );
+}
+/*-----------------------------------------------------------*/
+
+void vPortClearInterruptMask( UBaseType_t uxMask )
+{
+	if( uxMask == 0 )
+	{
+		vPortEnableInterrupts();
+	}
+}
+/*-----------------------------------------------------------*/
+
+void vPortYieldFromISR( void )
+{
+Thread_t *pxThreadToSuspend;
+Thread_t *pxThreadToResume;
+
+	pxThreadToSuspend = prvGetThreadFromTask( xTaskGetCurrentTaskHandle() );
+	vTaskSwitchContext();
+	pxThreadToResume = prvGetThreadFromTask( xTaskGetCurrentTaskHandle() );
+
+	prvSwitchThread( pxThreadToResume, pxThreadToSuspend );
+}
+/*-----------------------------------------------------------*/
+
+void vPortYield( void )
+{
+	vPortEnterCritical();
+	vPortYieldFromISR();
+	vPortExitCritical();
+}
+/*-----------------------------------------------------------*/
+
+void vPortThreadDying( void *pvTaskToDelete, volatile BaseType_t *pxPendYield )
+{
+Thread_t *pxThread = prvGetThreadFromTask( ( TaskHandle_t ) pvTaskToDelete );
+
+	( void ) pxPendYield;
+
+	/* The thread exits at its next context switch. */
+	pxThread->xDying = pdTRUE;
+}
+/*-----------------------------------------------------------*/
+
+void vPortCancelThread( void *pvTaskToDelete )
+{
+Thread_t *pxThread = prvGetThreadFromTask( ( TaskHandle_t ) pvTaskToDelete );
+
+	/* A thread that is switched out waits in event_wait(), where it can be
+	cancelled.  A thread that deleted itself has already exited. */
+	pthread_cancel( pxThread->pthread );
+	pthread_join( pxThread->pthread, NULL );
+	event_delete( pxThread->ev );
+}
+/*-----------------------------------------------------------*/
+
+static void prvSetupSignals( void )
+{
+struct sigaction xTickAction;
+
+	sigfillset( &xAllSignals );
+	sigdelset( &xAllSignals, SIGINT );
+
+	/* The threads of the tasks are created with these signals blocked. */
+	pthread_sigmask( SIG_BLOCK, &xAllSignals, NULL );
+
+	memset( &xTickAction, '\0', sizeof( xTickAction ) );
+	xTickAction.sa_handler = prvSystemTickHandler;
+	xTickAction.sa_flags = SA_RESTART;
+	sigfillset( &xTickAction.sa_mask );
+
+	if( sigaction( portSIG_TICK, &xTickAction, NULL ) != 0 )
+	{
+		fprintf( stderr, "prvSetupSignals: sigaction: %s\n", strerror( errno ) );
+		abort();
+	}
+}
+/*-----------------------------------------------------------*/
+
+static void *prvWaitForStart( void *pvParams )
+{
+Thread_t *pxThread = ( Thread_t * ) pvParams;
+
+	event_wait( pxThread->ev );
+
+	/* The task runs for the first time, outside any critical section. */
+	uxCriticalNesting = 0;
+	vPortEnableInterrupts();
+
+	pxThread->pxCode( pxThread->pvParams );
+
+	/* A task function must not return. */
+	configASSERT( pdFALSE );
+
+	return NULL;
+}
+/*-----------------------------------------------------------*/
+
+static void prvSwitchThread( Thread_t *pxThreadToResume, Thread_t *pxThreadToSuspend )
+{
+UBaseType_t uxSavedCriticalNesting;
+
+	if( pxThreadToSuspend != pxThreadToResume )
+	{
+		uxSavedCriticalNesting = uxCriticalNesting;
+
+		event_signal( pxThreadToResume->ev );
+
+		if( pxThreadToSuspend->xDying != pdFALSE )
+		{
+			/* The task deleted itself, vPortCancelThread() will join. */
+			pthread_exit( NULL );
+		}
+
+		event_wait( pxThreadToSuspend->ev );
+
+		uxCriticalNesting = uxSavedCriticalNesting;
+	}
+}
+/*-----------------------------------------------------------*/
+
+static void prvSystemTickHandler( int iSignal )
+{
+Thread_t *pxThreadToSuspend;
+Thread_t *pxThreadToResume;
+
+	( void ) iSignal;
+
+	/* All signals are blocked while the handler runs. */
+	uxCriticalNesting++;
+
+	pxThreadToSuspend = prvGetThreadFromTask( xTaskGetCurrentTaskHandle() );
+
+	if( xTaskIncrementTick() != pdFALSE )
+	{
+		#if( configUSE_PREEMPTION == 1 )
+		{
+			vTaskSwitchContext();
+		}
+		#endif
+	}
+
+	pxThreadToResume = prvGetThreadFromTask( xTaskGetCurrentTaskHandle() );
+
+	uxCriticalNesting--;
+
+	/* The interrupted task continues when the handler returns, either now or
+	after it has been switched in again. */
+	prvSwitchThread( pxThreadToResume, pxThreadToSuspend );
+}
+/*-----------------------------------------------------------*/
+
+static void prvSetupTimerInterrupt( void )
+{
+struct itimerval xTimer;
+
+	xTimer.it_interval.tv_sec = 0;
+	xTimer.it_interval.tv_usec = ( suseconds_t ) portTICK_PERIOD_US;
+	xTimer.it_value = xTimer.it_interval;
+
+	if( setitimer( ITIMER_REAL, &xTimer, NULL ) != 0 )
+	{
+		fprintf( stderr, "prvSetupTimerInterrupt: setitimer: %s\n", strerror( errno ) );
+		abort();
+	}
+}
+/*-----------------------------------------------------------*/
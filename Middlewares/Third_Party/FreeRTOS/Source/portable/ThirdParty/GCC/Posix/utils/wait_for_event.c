@@ -0,0 +1,75 @@
+/*
+ * A binary event for the POSIX port, see wait_for_event.h.
+ */
+
+#include <stdbool.h>
+#include <stdlib.h>
+#include <pthread.h>
+
+#include "wait_for_event.h"
+
+struct event
+{
+	pthread_mutex_t mutex;
+	pthread_cond_t cond;
+	bool event_triggered;
+};
+
+/*-----------------------------------------------------------*/
+
+struct event *event_create( void )
+{
+struct event *ev = malloc( sizeof( struct event ) );
+
+	if( ev != NULL )
+	{
+		ev->event_triggered = false;
+		pthread_mutex_init( &ev->mutex, NULL );
+		pthread_cond_init( &ev->cond, NULL );
+	}
+
+	return ev;
+}
+/*-----------------------------------------------------------*/
+
+void event_delete( struct event *ev )
+{
+	pthread_mutex_destroy( &ev->mutex );
+	pthread_cond_destroy( &ev->cond );
+	free( ev );
+}
+/*-----------------------------------------------------------*/
+
+static void prvUnlockMutex( void *pvMutex )
+{
+	pthread_mutex_unlock( ( pthread_mutex_t * ) pvMutex );
+}
+/*-----------------------------------------------------------*/
+
+void event_wait( struct event *ev )
+{
+	pthread_mutex_lock( &ev->mutex );
+
+	/* pthread_cond_wait() is where a thread of a deleted task is cancelled,
+	the mutex must not stay locked then. */
+	pthread_cleanup_push( prvUnlockMutex, &ev->mutex );
+
+	while( ev->event_triggered == false )
+	{
+		pthread_cond_wait( &ev->cond, &ev->mutex );
+	}
+
+	ev->event_triggered = false;
+
+	pthread_cleanup_pop( 1 );
+}
+/*-----------------------------------------------------------*/
+
+void event_signal( struct event *ev )
+{
+	pthread_mutex_lock( &ev->mutex );
+	ev->event_triggered = true;
+	pthread_cond_signal( &ev->cond );
+	pthread_mutex_unlock( &ev->mutex );
+}
+/*-----------------------------------------------------------*/
@@ -0,0 +1,16 @@
+/*
+ * A binary event for the POSIX port: a thread waits until another thread
+ * signals it.  A signal that is given while nobody waits is remembered.
+ */
+
+#ifndef WAIT_FOR_EVENT_H
+#define WAIT_FOR_EVENT_H
+
+struct event;
+
+struct event *event_create( void );
+void event_delete( struct event *ev );
+void event_wait( struct event *ev );
+void event_signal( struct event *ev );
+
+#endif /* WAIT_FOR_EVENT_H */
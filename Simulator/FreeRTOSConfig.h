@@ -0,0 +1,66 @@
+/*
+ * FreeRTOSConfig.h for the host simulation, with the POSIX port.
+ *
+ * The kernel settings follow Inc/FreeRTOSConfig.h where the host allows it.
+ * The differences: there are no interrupt priorities, the generic task
+ * selection is used, stack overflow checking is off (the tasks run on the
+ * stacks of their pthreads), and the heap is larger because the stack of a
+ * task is counted in 64-bit words.
+ *
+ *	1 tab == 4 spaces!
+ */
+
+#ifndef FREERTOS_CONFIG_H
+#define FREERTOS_CONFIG_H
+
+#include <stdint.h>
+
+/* The high-resolution clock of Src/hr_gettime.c counts nanoseconds on a
+host, so the TCP timers see a 1 GHz CPU. */
+#define configCPU_CLOCK_HZ                       ( 1000000000UL )
+
+#define configUSE_PREEMPTION                     1
+#define configSUPPORT_STATIC_ALLOCATION          0
+#define configSUPPORT_DYNAMIC_ALLOCATION         1
+#define configUSE_IDLE_HOOK                      1
+#define configUSE_TICK_HOOK                      0
+#define configTICK_RATE_HZ                       ((TickType_t)1000)
+#define configMAX_PRIORITIES                     ( 7 )
+#define configMINIMAL_STACK_SIZE                 ((uint16_t)128)
+#define configTOTAL_HEAP_SIZE                    ((size_t)( 4 * 1024 * 1024 ))
+#define configMAX_TASK_NAME_LEN                  ( 16 )
+#define configUSE_16_BIT_TICKS                   0
+#define configUSE_MUTEXES                        1
+#define configQUEUE_REGISTRY_SIZE                8
+#define configCHECK_FOR_STACK_OVERFLOW           0
+#define configUSE_MALLOC_FAILED_HOOK             1
+#define configUSE_COUNTING_SEMAPHORES            1
+#define configUSE_PORT_OPTIMISED_TASK_SELECTION  0
+#define configUSE_CO_ROUTINES                    0
+#define configMAX_CO_ROUTINE_PRIORITIES          ( 2 )
+
+/* Set the following definitions to 1 to include the API function, or zero
+to exclude the API function. */
+#define INCLUDE_vTaskPrioritySet            1
+#define INCLUDE_uxTaskPriorityGet           1
+#define INCLUDE_vTaskDelete                 1
+#define INCLUDE_vTaskCleanUpResources       0
+#define INCLUDE_vTaskSuspend                1
+#define INCLUDE_vTaskDelayUntil             0
+#define INCLUDE_vTaskDelay                  1
+#define INCLUDE_xTaskGetSchedulerState      1
+#define INCLUDE_xTaskGetCurrentTaskHandle   1
+
+/* Prints the location and stops the simulation, see Simulator/main.c. */
+extern void vAssertCalled( const char *pcFile, unsigned long ulLine );
+#define configASSERT( x ) if( ( x ) == 0 ) vAssertCalled( __FILE__, __LINE__ )
+
+/* The trace ring, the pcap ring, the run-time statistics and the critical
+profiler need the RNDIS link and the Cortex-M cycle counter, they are not part
+of the host build. */
+#define configUSE_TRACE_RING					0
+#define configUSE_PCAP_RING						0
+#define configUSE_RUN_TIME_STATS				0
+#define configUSE_CRITICAL_PROFILER				0
+
+#endif /* FREERTOS_CONFIG_H */
@@ -0,0 +1,27 @@
+/*
+ * FreeRTOSIPConfig.h for the host simulation.
+ *
+ * The host runs the stack with the settings of the firmware, from
+ * Inc/FreeRTOSIPConfig.h, except for the items below.
+ */
+
+#ifndef SIMULATOR_IP_CONFIG_H
+#define SIMULATOR_IP_CONFIG_H
+
+#include <stdio.h>
+
+#include "../Inc/FreeRTOSIPConfig.h"
+
+/* A TAP device does not check or calculate checksums, the stack must do
+it. */
+#undef ipconfigDRIVER_INCLUDED_TX_IP_CHECKSUM
+#undef ipconfigDRIVER_INCLUDED_RX_IP_CHECKSUM
+#define ipconfigDRIVER_INCLUDED_TX_IP_CHECKSUM		( 0 )
+#define ipconfigDRIVER_INCLUDED_RX_IP_CHECKSUM		( 0 )
+
+/* Messages go to stdout. */
+#undef ipconfigHAS_PRINTF
+#define ipconfigHAS_PRINTF			1
+#define FreeRTOS_printf( X )		printf X
+
+#endif /* SIMULATOR_IP_CONFIG_H */
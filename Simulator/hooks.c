@@ -0,0 +1,55 @@
+/*
+ * hooks.c for the host simulation.
+ *
+ * The hooks of the kernel and FreeRTOS+TCP that are the same for adhoc_sim
+ * and the tests.  The hooks of the application are in main.c and in the
+ * tests.
+ */
+
+/* Standard includes. */
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* FreeRTOS+TCP includes. */
+#include "FreeRTOS_IP.h"
+
+#include "hr_gettime.h"
+
+/*-----------------------------------------------------------*/
+
+UBaseType_t uxRand( void )
+{
+	return( ( int ) ( rand() >> 16UL ) & 0x7fffUL );
+}
+/*-----------------------------------------------------------*/
+
+uint32_t ulApplicationGetCycleCount( void )
+{
+	return ulGetHighResolutionCycles();
+}
+/*-----------------------------------------------------------*/
+
+void vApplicationIdleHook( void )
+{
+	/* Sleep until the next tick instead of spinning on a host CPU. */
+	pause();
+}
+/*-----------------------------------------------------------*/
+
+void vApplicationMallocFailedHook( void )
+{
+	vAssertCalled( __FILE__, __LINE__ );
+}
+/*-----------------------------------------------------------*/
+
+void vAssertCalled( const char *pcFile, unsigned long ulLine )
+{
+	fprintf( stderr, "Assertion failed: %s:%lu\n", pcFile, ulLine );
+	abort();
+}
+/*-----------------------------------------------------------*/
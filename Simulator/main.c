@@ -0,0 +1,140 @@
+/*
+ * main.c for the host simulation.
+ *
+ * Runs the task layout of Src/main.c with the POSIX port, and with a TAP
+ * device in the place of the RNDIS link: the IP-task, the default task and
+ * the hooks of FreeRTOS+TCP, with the same addresses.  The hooks that do not
+ * depend on the application are in hooks.c.  The TAP device must exist before
+ * the simulation starts, see portable/NetworkInterface/linux/NetworkInterface.c.
+ */
+
+/* Standard includes. */
+#include <string.h>
+#include <strings.h>
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* FreeRTOS+TCP includes. */
+#include "FreeRTOS_IP.h"
+#include "FreeRTOS_Sockets.h"
+
+#include "hr_gettime.h"
+
+#define mainHOST_NAME					"RTOSDemo"
+#define mainDEVICE_NICK_NAME			"stm32"
+
+/* osPriorityNormal of cmsis_os. */
+#define mainDEFAULT_TASK_PRIORITY		( tskIDLE_PRIORITY + 3 )
+#define mainDEFAULT_TASK_STACK_SIZE		( 128 )
+
+/* The MAC address array is not declared const as the MAC address will
+normally be read from an EEPROM and not hard coded (in real deployed
+applications).*/
+static uint8_t ucMACAddress[ 6 ] = { 0x00, 0x11, 0x22, 0x33, 0x44, 0x55 };
+
+static const uint8_t ucIPAddress[ 4 ] = { 10, 10, 10, 200 };
+static const uint8_t ucNetMask[ 4 ] = { 255, 0, 0, 0 };
+static const uint8_t ucGatewayAddress[ 4 ] = { 10, 10, 10, 1 };
+
+/* The following is the address of an OpenDNS server. */
+static const uint8_t ucDNSServerAddress[ 4 ] = { 208, 67, 222, 222 };
+
+/*-----------------------------------------------------------*/
+
+/*
+ * The default task of Src/main.c, without the LED.
+ */
+static void prvDefaultTask( void *pvParameters );
+
+/*-----------------------------------------------------------*/
+
+int main( void )
+{
+	/* Start the high-resolution clock, see hr_gettime.h. */
+	vStartHighResolutionTimer();
+
+	FreeRTOS_IPInit( ucIPAddress,
+				   ucNetMask,
+				   ucGatewayAddress,
+				   ucDNSServerAddress,
+				   ucMACAddress );
+
+	xTaskCreate( prvDefaultTask, "defaultTask", mainDEFAULT_TASK_STACK_SIZE, NULL, mainDEFAULT_TASK_PRIORITY, NULL );
+
+	/* Start scheduler */
+	vTaskStartScheduler();
+
+	/* Only reached when vTaskEndScheduler() is called. */
+	return 0;
+}
+/*-----------------------------------------------------------*/
+
+static void prvDefaultTask( void *pvParameters )
+{
+	( void ) pvParameters;
+
+	for( ;; )
+	{
+		vTaskDelay( pdMS_TO_TICKS( 1000 ) );
+	}
+}
+/*-----------------------------------------------------------*/
+
+void vApplicationPingReplyHook( ePingReplyStatus_t eStatus, uint16_t usIdentifier )
+{
+	( void ) eStatus;
+	( void ) usIdentifier;
+}
+/*-----------------------------------------------------------*/
+
+/* Called by FreeRTOS+TCP when the network connects or disconnects.  Disconnect
+events are only received if implemented in the MAC driver. */
+void vApplicationIPNetworkEventHook( eIPCallbackEvent_t eNetworkEvent )
+{
+uint32_t ulIPAddress, ulNetMask, ulGatewayAddress, ulDNSServerAddress;
+char cBuffer[ 16 ];
+
+	if( eNetworkEvent == eNetworkUp )
+	{
+		FreeRTOS_GetAddressConfiguration( &ulIPAddress, &ulNetMask, &ulGatewayAddress, &ulDNSServerAddress );
+		FreeRTOS_inet_ntoa( ulIPAddress, cBuffer );
+		FreeRTOS_printf( ( "Network up, IP address %s\n", cBuffer ) );
+	}
+}
+/*-----------------------------------------------------------*/
+
+const char *pcApplicationHostnameHook( void )
+{
+	/* Assign the name "rtosdemo" to this network node.  This function will be
+	called during the DHCP: the machine will be registered with an IP address
+	plus this name. */
+	return mainHOST_NAME;
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xApplicationDNSQueryHook( const char *pcName )
+{
+BaseType_t xReturn;
+
+	/* Determine if a name lookup is for this node.  Two names are given
+	to this node: that returned by pcApplicationHostnameHook() and that set
+	by mainDEVICE_NICK_NAME. */
+	if( strcasecmp( pcName, pcApplicationHostnameHook() ) == 0 )
+	{
+		xReturn = pdPASS;
+	}
+	else if( strcasecmp( pcName, mainDEVICE_NICK_NAME ) == 0 )
+	{
+		xReturn = pdPASS;
+	}
+	else
+	{
+		xReturn = pdFAIL;
+	}
+
+	return xReturn;
+}
+/*-----------------------------------------------------------*/
+
@@ -0,0 +1,19 @@
+/*
+ * FreeRTOSIPConfig.h for the tests of the host simulation.
+ *
+ * The settings of Simulator/FreeRTOSIPConfig.h, with the link emulator as the
+ * network interface and a fixed address: the scripted peer is not a DHCP
+ * server.
+ */
+
+#ifndef SIMULATOR_TESTS_IP_CONFIG_H
+#define SIMULATOR_TESTS_IP_CONFIG_H
+
+#include "../FreeRTOSIPConfig.h"
+
+#undef ipconfigUSE_DHCP
+#define ipconfigUSE_DHCP				0
+
+#define ipconfigUSE_LINK_EMULATOR		1
+
+#endif /* SIMULATOR_TESTS_IP_CONFIG_H */
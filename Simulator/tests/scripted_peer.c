@@ -0,0 +1,345 @@
+/*
+ * scripted_peer.c
+ *
+ * A scripted peer for the link emulator, see scripted_peer.h.
+ */
+
+/* Standard includes. */
+#include <stdint.h>
+#include <string.h>
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* FreeRTOS+TCP includes. */
+#include "FreeRTOS_IP.h"
+
+#include "LinkEmulator.h"
+#include "scripted_peer.h"
+
+/* Offsets in an Ethernet frame. */
+#define peerETH_DESTINATION			0
+#define peerETH_SOURCE				6
+#define peerETH_TYPE				12
+#define peerETH_HEADER				14
+
+#define peerIP_VERSION_LENGTH		( peerETH_HEADER + 0 )
+#define peerIP_TOTAL_LENGTH			( peerETH_HEADER + 2 )
+#define peerIP_TIME_TO_LIVE			( peerETH_HEADER + 8 )
+#define peerIP_PROTOCOL				( peerETH_HEADER + 9 )
+#define peerIP_CHECKSUM				( peerETH_HEADER + 10 )
+#define peerIP_SOURCE				( peerETH_HEADER + 12 )
+#define peerIP_DESTINATION			( peerETH_HEADER + 16 )
+#define peerIP_HEADER				20
+
+#define peerUDP_SOURCE_PORT			( peerETH_HEADER + peerIP_HEADER + 0 )
+#define peerUDP_DESTINATION_PORT	( peerETH_HEADER + peerIP_HEADER + 2 )
+#define peerUDP_LENGTH				( peerETH_HEADER + peerIP_HEADER + 4 )
+#define peerUDP_CHECKSUM			( peerETH_HEADER + peerIP_HEADER + 6 )
+#define peerUDP_HEADER				8
+#define peerUDP_PAYLOAD				( peerETH_HEADER + peerIP_HEADER + peerUDP_HEADER )
+
+#define peerARP_OPERATION			( peerETH_HEADER + 6 )
+#define peerARP_SENDER_MAC			( peerETH_HEADER + 8 )
+#define peerARP_SENDER_IP			( peerETH_HEADER + 14 )
+#define peerARP_TARGET_MAC			( peerETH_HEADER + 18 )
+#define peerARP_TARGET_IP			( peerETH_HEADER + 24 )
+#define peerARP_LENGTH				( peerETH_HEADER + 28 )
+
+#define peerETH_TYPE_IPv4			0x0800u
+#define peerETH_TYPE_ARP			0x0806u
+#define peerARP_REQUEST				1u
+#define peerARP_REPLY				2u
+#define peerPROTOCOL_UDP			17u
+
+/* Frames shorter than this are padded. */
+#define peerMINIMUM_FRAME			60u
+
+#define peerMAXIMUM_FRAME			( ipconfigNETWORK_MTU + peerETH_HEADER )
+
+/*-----------------------------------------------------------*/
+
+/*
+ * Called by the link emulator for every frame that the stack sent.
+ */
+static void prvPeerReceive( void *pvContext, const uint8_t *pucFrame, size_t uxLength );
+
+/*
+ * Answer an ARP request for the address of the peer.
+ */
+static void prvPeerARP( const uint8_t *pucFrame, size_t uxLength );
+
+/*
+ * Echo a UDP datagram that was sent to the echo port.
+ */
+static void prvPeerUDP( const uint8_t *pucFrame, size_t uxLength );
+
+/*
+ * Fill in the Ethernet, IP and UDP headers of 'pucFrame', of which the payload
+ * is already in place.  Returns the length of the frame.
+ */
+static size_t prvPeerBuildUDP( uint8_t *pucFrame, const uint8_t *pucDestinationMAC, uint32_t ulDestinationIP,
+	uint16_t usSourcePort, uint16_t usDestinationPort, size_t uxPayloadLength );
+
+/*
+ * The Internet checksum of RFC 1071, starting from a partial sum.
+ */
+static uint16_t prvPeerChecksum( uint32_t ulSum, const uint8_t *pucData, size_t uxLength );
+
+static uint16_t prvPeerGet16( const uint8_t *pucData );
+static void prvPeerSet16( uint8_t *pucData, uint16_t usValue );
+
+/*-----------------------------------------------------------*/
+
+static uint8_t ucPeerMAC[ 6 ];
+static uint32_t ulPeerIP;
+static uint16_t usPeerEchoPort;
+
+static ScriptedPeerStats_t xPeerStats;
+
+/* Only used by the link-emulator task, which calls prvPeerReceive(). */
+static uint8_t ucReplyFrame[ peerMAXIMUM_FRAME ];
+
+/*-----------------------------------------------------------*/
+
+void vScriptedPeerStart( const uint8_t ucMACAddress[ 6 ], uint32_t ulIPAddress, uint16_t usEchoPort )
+{
+LinkEmulatorPeer_t xPeer;
+
+	memcpy( ucPeerMAC, ucMACAddress, sizeof( ucPeerMAC ) );
+	ulPeerIP = ulIPAddress;
+	usPeerEchoPort = usEchoPort;
+
+	xPeer.pxReceive = prvPeerReceive;
+	xPeer.pvContext = NULL;
+	vLinkEmulatorSetPeer( &xPeer );
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xScriptedPeerSendUDP( uint16_t usSourcePort, uint16_t usDestinationPort, const void *pvData, size_t uxLength )
+{
+uint8_t ucFrame[ peerMAXIMUM_FRAME ];
+size_t uxFrameLength;
+BaseType_t xReturn;
+
+	configASSERT( uxLength <= sizeof( ucFrame ) - peerUDP_PAYLOAD );
+
+	memcpy( ucFrame + peerUDP_PAYLOAD, pvData, uxLength );
+	uxFrameLength = prvPeerBuildUDP( ucFrame, FreeRTOS_GetMACAddress(), FreeRTOS_GetIPAddress(),
+		usSourcePort, usDestinationPort, uxLength );
+
+	xReturn = xLinkEmulatorInject( ucFrame, uxFrameLength );
+
+	if( xReturn != pdFAIL )
+	{
+		taskENTER_CRITICAL();
+		{
+			xPeerStats.ulDatagramsSent++;
+		}
+		taskEXIT_CRITICAL();
+	}
+
+	return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+void vScriptedPeerGetStats( ScriptedPeerStats_t *pxStats )
+{
+	taskENTER_CRITICAL();
+	{
+		*pxStats = xPeerStats;
+	}
+	taskEXIT_CRITICAL();
+}
+/*-----------------------------------------------------------*/
+
+static void prvPeerReceive( void *pvContext, const uint8_t *pucFrame, size_t uxLength )
+{
+	( void ) pvContext;
+
+	taskENTER_CRITICAL();
+	{
+		xPeerStats.ulFramesReceived++;
+	}
+	taskEXIT_CRITICAL();
+
+	if( uxLength >= peerETH_HEADER )
+	{
+		switch( prvPeerGet16( pucFrame + peerETH_TYPE ) )
+		{
+			case peerETH_TYPE_ARP:
+				prvPeerARP( pucFrame, uxLength );
+				break;
+
+			case peerETH_TYPE_IPv4:
+				prvPeerUDP( pucFrame, uxLength );
+				break;
+
+			default:
+				/* Ignored. */
+				break;
+		}
+	}
+}
+/*-----------------------------------------------------------*/
+
+static void prvPeerARP( const uint8_t *pucFrame, size_t uxLength )
+{
+uint8_t *pucReply = ucReplyFrame;
+
+	if( ( uxLength >= peerARP_LENGTH ) &&
+		( prvPeerGet16( pucFrame + peerARP_OPERATION ) == peerARP_REQUEST ) &&
+		( memcmp( pucFrame + peerARP_TARGET_IP, &ulPeerIP, sizeof( ulPeerIP ) ) == 0 ) )
+	{
+		memset( pucReply, '\0', peerMINIMUM_FRAME );
+
+		/* Same hardware and protocol type as the request. */
+		memcpy( pucReply, pucFrame, peerARP_LENGTH );
+		memcpy( pucReply + peerETH_DESTINATION, pucFrame + peerETH_SOURCE, 6 );
+		memcpy( pucReply + peerETH_SOURCE, ucPeerMAC, 6 );
+		prvPeerSet16( pucReply + peerARP_OPERATION, peerARP_REPLY );
+		memcpy( pucReply + peerARP_SENDER_MAC, ucPeerMAC, 6 );
+		memcpy( pucReply + peerARP_SENDER_IP, &ulPeerIP, 4 );
+		memcpy( pucReply + peerARP_TARGET_MAC, pucFrame + peerARP_SENDER_MAC, 6 );
+		memcpy( pucReply + peerARP_TARGET_IP, pucFrame + peerARP_SENDER_IP, 4 );
+
+		if( xLinkEmulatorInject( pucReply, peerMINIMUM_FRAME ) != pdFAIL )
+		{
+			taskENTER_CRITICAL();
+			{
+				xPeerStats.ulARPReplies++;
+			}
+			taskEXIT_CRITICAL();
+		}
+	}
+}
+/*-----------------------------------------------------------*/
+
+static void prvPeerUDP( const uint8_t *pucFrame, size_t uxLength )
+{
+uint32_t ulSourceIP;
+size_t uxPayloadLength;
+uint16_t usUDPLength;
+
+	if( ( uxLength < peerUDP_PAYLOAD ) ||
+		( pucFrame[ peerIP_VERSION_LENGTH ] != 0x45u ) ||
+		( pucFrame[ peerIP_PROTOCOL ] != peerPROTOCOL_UDP ) ||
+		( memcmp( pucFrame + peerIP_DESTINATION, &ulPeerIP, sizeof( ulPeerIP ) ) != 0 ) ||
+		( prvPeerGet16( pucFrame + peerUDP_DESTINATION_PORT ) != usPeerEchoPort ) )
+	{
+		return;
+	}
+
+	usUDPLength = prvPeerGet16( pucFrame + peerUDP_LENGTH );
+
+	if( ( usUDPLength < peerUDP_HEADER ) || ( ( size_t ) usUDPLength > uxLength - ( peerETH_HEADER + peerIP_HEADER ) ) )
+	{
+		return;
+	}
+
+	uxPayloadLength = ( size_t ) usUDPLength - peerUDP_HEADER;
+	memcpy( &ulSourceIP, pucFrame + peerIP_SOURCE, sizeof( ulSourceIP ) );
+
+	memcpy( ucReplyFrame + peerUDP_PAYLOAD, pucFrame + peerUDP_PAYLOAD, uxPayloadLength );
+	uxLength = prvPeerBuildUDP( ucReplyFrame, pucFrame + peerETH_SOURCE, ulSourceIP,
+		usPeerEchoPort, prvPeerGet16( pucFrame + peerUDP_SOURCE_PORT ), uxPayloadLength );
+
+	if( xLinkEmulatorInject( ucReplyFrame, uxLength ) != pdFAIL )
+	{
+		taskENTER_CRITICAL();
+		{
+			xPeerStats.ulEchoes++;
+		}
+		taskEXIT_CRITICAL();
+	}
+}
+/*-----------------------------------------------------------*/
+
+static size_t prvPeerBuildUDP( uint8_t *pucFrame, const uint8_t *pucDestinationMAC, uint32_t ulDestinationIP,
+	uint16_t usSourcePort, uint16_t usDestinationPort, size_t uxPayloadLength )
+{
+uint8_t ucPseudoHeader[ 12 ];
+uint16_t usUDPLength = ( uint16_t ) ( peerUDP_HEADER + uxPayloadLength );
+uint16_t usChecksum;
+size_t uxLength;
+
+	memcpy( pucFrame + peerETH_DESTINATION, pucDestinationMAC, 6 );
+	memcpy( pucFrame + peerETH_SOURCE, ucPeerMAC, 6 );
+	prvPeerSet16( pucFrame + peerETH_TYPE, peerETH_TYPE_IPv4 );
+
+	memset( pucFrame + peerETH_HEADER, '\0', peerIP_HEADER + peerUDP_HEADER );
+	pucFrame[ peerIP_VERSION_LENGTH ] = 0x45u;
+	prvPeerSet16( pucFrame + peerIP_TOTAL_LENGTH, ( uint16_t ) ( peerIP_HEADER + usUDPLength ) );
+	pucFrame[ peerIP_TIME_TO_LIVE ] = 64u;
+	pucFrame[ peerIP_PROTOCOL ] = peerPROTOCOL_UDP;
+	memcpy( pucFrame + peerIP_SOURCE, &ulPeerIP, 4 );
+	memcpy( pucFrame + peerIP_DESTINATION, &ulDestinationIP, 4 );
+	prvPeerSet16( pucFrame + peerIP_CHECKSUM, prvPeerChecksum( 0UL, pucFrame + peerETH_HEADER, peerIP_HEADER ) );
+
+	prvPeerSet16( pucFrame + peerUDP_SOURCE_PORT, usSourcePort );
+	prvPeerSet16( pucFrame + peerUDP_DESTINATION_PORT, usDestinationPort );
+	prvPeerSet16( pucFrame + peerUDP_LENGTH, usUDPLength );
+
+	/* The UDP checksum covers a pseudo header with the addresses. */
+	memcpy( ucPseudoHeader, pucFrame + peerIP_SOURCE, 8 );
+	ucPseudoHeader[ 8 ] = 0u;
+	ucPseudoHeader[ 9 ] = peerPROTOCOL_UDP;
+	prvPeerSet16( ucPseudoHeader + 10, usUDPLength );
+	usChecksum = prvPeerChecksum( ( uint32_t ) ( uint16_t ) ~prvPeerChecksum( 0UL, ucPseudoHeader, sizeof( ucPseudoHeader ) ),
+		pucFrame + peerETH_HEADER + peerIP_HEADER, usUDPLength );
+
+	if( usChecksum == 0u )
+	{
+		/* Zero means "no checksum". */
+		usChecksum = 0xffffu;
+	}
+	prvPeerSet16( pucFrame + peerUDP_CHECKSUM, usChecksum );
+
+	uxLength = peerUDP_PAYLOAD + uxPayloadLength;
+
+	if( uxLength < peerMINIMUM_FRAME )
+	{
+		memset( pucFrame + uxLength, '\0', peerMINIMUM_FRAME - uxLength );
+		uxLength = peerMINIMUM_FRAME;
+	}
+
+	return uxLength;
+}
+/*-----------------------------------------------------------*/
+
+static uint16_t prvPeerChecksum( uint32_t ulSum, const uint8_t *pucData, size_t uxLength )
+{
+size_t uxIndex;
+
+	for( uxIndex = 0; uxIndex + 1 < uxLength; uxIndex += 2 )
+	{
+		ulSum += prvPeerGet16( pucData + uxIndex );
+	}
+
+	if( ( uxLength & 1u ) != 0u )
+	{
+		ulSum += ( uint32_t ) pucData[ uxLength - 1 ] << 8;
+	}
+
+	while( ( ulSum >> 16 ) != 0UL )
+	{
+		ulSum = ( ulSum & 0xffffUL ) + ( ulSum >> 16 );
+	}
+
+	return ( uint16_t ) ~ulSum;
+}
+/*-----------------------------------------------------------*/
+
+static uint16_t prvPeerGet16( const uint8_t *pucData )
+{
+	return ( uint16_t ) ( ( ( uint16_t ) pucData[ 0 ] << 8 ) | pucData[ 1 ] );
+}
+/*-----------------------------------------------------------*/
+
+static void prvPeerSet16( uint8_t *pucData, uint16_t usValue )
+{
+	pucData[ 0 ] = ( uint8_t ) ( usValue >> 8 );
+	pucData[ 1 ] = ( uint8_t ) usValue;
+}
+/*-----------------------------------------------------------*/
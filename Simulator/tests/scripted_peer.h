@@ -0,0 +1,49 @@
+/*
+ * scripted_peer.h
+ *
+ * A scripted peer for the link emulator, see LinkEmulator.h.  It has its own
+ * MAC and IP address at the other end of the link, answers ARP requests for
+ * that address, and echoes the UDP datagrams that are sent to its echo port.
+ * It can also send UDP datagrams to the stack on its own.
+ *
+ * The peer builds and parses the frames itself, it does not share code with
+ * FreeRTOS+TCP.  IP addresses are in network byte order, as in the stack.
+ */
+
+#ifndef SCRIPTED_PEER_H
+#define SCRIPTED_PEER_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Counters of the peer. */
+typedef struct xSCRIPTED_PEER_STATS
+{
+	uint32_t ulFramesReceived;		/* Frames that came from the stack */
+	uint32_t ulARPReplies;			/* ARP requests answered */
+	uint32_t ulEchoes;				/* UDP datagrams echoed */
+	uint32_t ulDatagramsSent;		/* Datagrams of xScriptedPeerSendUDP() */
+} ScriptedPeerStats_t;
+
+/*
+ * Give the peer its addresses and connect it to the link emulator.
+ */
+void vScriptedPeerStart( const uint8_t ucMACAddress[ 6 ], uint32_t ulIPAddress, uint16_t usEchoPort );
+
+/*
+ * Send a UDP datagram to the stack.  Returns pdFAIL when the link emulator had
+ * no network buffer.
+ */
+BaseType_t xScriptedPeerSendUDP( uint16_t usSourcePort, uint16_t usDestinationPort, const void *pvData, size_t uxLength );
+
+/*
+ * Read the counters of the peer.
+ */
+void vScriptedPeerGetStats( ScriptedPeerStats_t *pxStats );
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /* SCRIPTED_PEER_H */
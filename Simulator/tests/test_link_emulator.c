@@ -0,0 +1,368 @@
+/*
+ * test_link_emulator.c
+ *
+ * Runs the stack over the link emulator, with the scripted peer at the other
+ * end, and checks that a seed replays the same impairments:
+ *
+ *	1. Echo: over a perfect link, the stack resolves the peer with ARP and
+ *	   every datagram comes back from the echo port of the peer.
+ *	2. Replay: the peer sends a burst of datagrams over a link with delay,
+ *	   jitter, loss, reordering and duplication.  The burst is sent while the
+ *	   scheduler is suspended, so that all frames enter the link in the same
+ *	   tick, and the order in which they arrive only depends on the seed.  The
+ *	   same seed must give the same sequence twice, and the sequence that is
+ *	   recorded below; another seed must give another sequence.
+ *
+ * The exit code is 0 when all checks pass.
+ */
+
+/* Standard includes. */
+#include <stdio.h>
+#include <string.h>
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* FreeRTOS+TCP includes. */
+#include "FreeRTOS_IP.h"
+#include "FreeRTOS_Sockets.h"
+
+#include "hr_gettime.h"
+#include "LinkEmulator.h"
+#include "scripted_peer.h"
+
+#define testPEER_ECHO_PORT			7u
+#define testLOCAL_PORT				5000u
+
+/* The number of datagrams in a burst of the replay. */
+#define testBURST_LENGTH			12u
+
+/* A burst can arrive with duplicates. */
+#define testMAX_RECEIVED			( 2u * testBURST_LENGTH )
+
+/* The link is quiet when nothing arrived for this long. */
+#define testQUIET_MS				300u
+
+#define testECHO_COUNT				8u
+#define testARP_ATTEMPTS			5u
+
+#define testSEED					0x5EED0042UL
+#define testOTHER_SEED				0x0BADCAFEUL
+
+#define testTASK_PRIORITY			( tskIDLE_PRIORITY + 1 )
+#define testTASK_STACK_SIZE			( 4 * configMINIMAL_STACK_SIZE )
+
+/* The outcome of one replay. */
+typedef struct xREPLAY_RESULT
+{
+	uint8_t ucSequence[ testMAX_RECEIVED ];	/* Payloads in the order of arrival */
+	size_t uxCount;
+	LinkEmulatorStats_t xStats;			/* Counters of the direction to the stack, for this burst */
+} ReplayResult_t;
+
+/*-----------------------------------------------------------*/
+
+static void prvTestTask( void *pvParameters );
+
+/*
+ * Phase 1, returns pdPASS when every datagram was echoed.
+ */
+static BaseType_t prvTestEcho( Socket_t xSocket );
+
+/*
+ * Phase 2, one burst over the impaired link with 'ulSeed'.
+ */
+static void prvTestReplay( Socket_t xSocket, uint32_t ulSeed, ReplayResult_t *pxResult );
+
+static void prvPrintReplay( const char *pcName, const ReplayResult_t *pxResult );
+
+static BaseType_t prvSameReplay( const ReplayResult_t *pxLeft, const ReplayResult_t *pxRight );
+
+/*-----------------------------------------------------------*/
+
+static uint8_t ucMACAddress[ 6 ] = { 0x00, 0x11, 0x22, 0x33, 0x44, 0x55 };
+static const uint8_t ucIPAddress[ 4 ] = { 10, 10, 10, 200 };
+static const uint8_t ucNetMask[ 4 ] = { 255, 0, 0, 0 };
+static const uint8_t ucGatewayAddress[ 4 ] = { 10, 10, 10, 1 };
+static const uint8_t ucDNSServerAddress[ 4 ] = { 10, 10, 10, 1 };
+
+/* The peer is the gateway. */
+static const uint8_t ucPeerMACAddress[ 6 ] = { 0x02, 0x00, 0x00, 0x00, 0x00, 0x01 };
+
+/* The impairments of the replay, on the direction to the stack. */
+static const LinkEmulatorConfig_t xImpairedLink =
+{
+	5u,						/* ulDelayMs */
+	10u,					/* ulJitterMs */
+	linkemuPPM( 20 ),		/* ulLossPPM */
+	0u,						/* ulBadLossPPM */
+	0u,						/* ulGoodToBadPPM */
+	0u,						/* ulBadToGoodPPM */
+	linkemuPPM( 15 ),		/* ulReorderPPM */
+	linkemuPPM( 10 ),		/* ulDuplicatePPM */
+	0u,						/* ulRateBytesPerSecond */
+	0u						/* ulBucketBytes */
+};
+
+/* What testSEED gives with xImpairedLink.  A change of this sequence means
+that a seed no longer replays the impairments of earlier versions. */
+static const uint8_t ucExpectedSequence[] = { 8, 8, 11, 0, 0, 2, 6, 6, 7, 9 };
+
+static TaskHandle_t xTestTaskHandle = NULL;
+
+static volatile BaseType_t xTestResult = pdFAIL;
+
+/*-----------------------------------------------------------*/
+
+int main( void )
+{
+static const LinkEmulatorConfig_t xPerfectLink[ linkemuDIRECTIONS ];
+
+	vStartHighResolutionTimer();
+
+	vLinkEmulatorConfigure( xPerfectLink, testSEED );
+	vScriptedPeerStart( ucPeerMACAddress,
+		FreeRTOS_inet_addr_quick( ucGatewayAddress[ 0 ], ucGatewayAddress[ 1 ], ucGatewayAddress[ 2 ], ucGatewayAddress[ 3 ] ),
+		testPEER_ECHO_PORT );
+
+	FreeRTOS_IPInit( ucIPAddress, ucNetMask, ucGatewayAddress, ucDNSServerAddress, ucMACAddress );
+
+	xTaskCreate( prvTestTask, "Test", testTASK_STACK_SIZE, NULL, testTASK_PRIORITY, &xTestTaskHandle );
+
+	vTaskStartScheduler();
+
+	printf( "test_link_emulator: %s\n", ( xTestResult == pdPASS ) ? "PASS" : "FAIL" );
+
+	return ( xTestResult == pdPASS ) ? 0 : 1;
+}
+/*-----------------------------------------------------------*/
+
+static void prvTestTask( void *pvParameters )
+{
+static ReplayResult_t xFirst, xSecond, xOther;
+struct freertos_sockaddr xBindAddress;
+TickType_t xTimeout = pdMS_TO_TICKS( testQUIET_MS );
+Socket_t xSocket;
+BaseType_t xResult = pdPASS;
+
+	( void ) pvParameters;
+
+	/* Wait for vApplicationIPNetworkEventHook(). */
+	if( ulTaskNotifyTake( pdTRUE, pdMS_TO_TICKS( 5000 ) ) == 0u )
+	{
+		printf( "The network did not come up\n" );
+		vTaskEndScheduler();
+	}
+
+	xSocket = FreeRTOS_socket( FREERTOS_AF_INET, FREERTOS_SOCK_DGRAM, FREERTOS_IPPROTO_UDP );
+	configASSERT( xSocket != FREERTOS_INVALID_SOCKET );
+	FreeRTOS_setsockopt( xSocket, 0, FREERTOS_SO_RCVTIMEO, &xTimeout, sizeof( xTimeout ) );
+
+	xBindAddress.sin_port = FreeRTOS_htons( testLOCAL_PORT );
+	xBindAddress.sin_addr = 0UL;
+	FreeRTOS_bind( xSocket, &xBindAddress, sizeof( xBindAddress ) );
+
+	if( prvTestEcho( xSocket ) != pdPASS )
+	{
+		xResult = pdFAIL;
+	}
+
+	prvTestReplay( xSocket, testSEED, &xFirst );
+	prvTestReplay( xSocket, testSEED, &xSecond );
+	prvTestReplay( xSocket, testOTHER_SEED, &xOther );
+
+	prvPrintReplay( "seed", &xFirst );
+	prvPrintReplay( "same seed", &xSecond );
+	prvPrintReplay( "other seed", &xOther );
+
+	if( prvSameReplay( &xFirst, &xSecond ) == pdFALSE )
+	{
+		printf( "FAIL: the same seed gave another sequence\n" );
+		xResult = pdFAIL;
+	}
+
+	if( ( xFirst.uxCount != sizeof( ucExpectedSequence ) ) ||
+		( memcmp( xFirst.ucSequence, ucExpectedSequence, sizeof( ucExpectedSequence ) ) != 0 ) )
+	{
+		printf( "FAIL: the seed no longer gives the recorded sequence\n" );
+		xResult = pdFAIL;
+	}
+
+	if( xFirst.uxCount != ( size_t ) xFirst.xStats.ulDelivered )
+	{
+		printf( "FAIL: the stack did not receive every frame that the link delivered\n" );
+		xResult = pdFAIL;
+	}
+
+	if( prvSameReplay( &xFirst, &xOther ) != pdFALSE )
+	{
+		printf( "FAIL: another seed gave the same sequence\n" );
+		xResult = pdFAIL;
+	}
+
+	FreeRTOS_closesocket( xSocket );
+
+	xTestResult = xResult;
+	vTaskEndScheduler();
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvTestEcho( Socket_t xSocket )
+{
+struct freertos_sockaddr xPeerAddress, xFromAddress;
+uint32_t ulFromLength = sizeof( xFromAddress );
+char cMessage[ 16 ], cReply[ 16 ];
+ScriptedPeerStats_t xPeerStats;
+UBaseType_t uxIndex, uxEchoed = 0u;
+BaseType_t xReceived = 0;
+
+	xPeerAddress.sin_port = FreeRTOS_htons( testPEER_ECHO_PORT );
+	xPeerAddress.sin_addr = FreeRTOS_inet_addr_quick( ucGatewayAddress[ 0 ], ucGatewayAddress[ 1 ], ucGatewayAddress[ 2 ], ucGatewayAddress[ 3 ] );
+
+	/* The first datagram waits for the ARP resolution, or is dropped for it. */
+	for( uxIndex = 0u; ( uxIndex < testARP_ATTEMPTS ) && ( xReceived <= 0 ); uxIndex++ )
+	{
+		FreeRTOS_sendto( xSocket, "probe", 5u, 0, &xPeerAddress, sizeof( xPeerAddress ) );
+		xReceived = FreeRTOS_recvfrom( xSocket, cReply, sizeof( cReply ), 0, &xFromAddress, &ulFromLength );
+	}
+
+	for( uxIndex = 0u; uxIndex < testECHO_COUNT; uxIndex++ )
+	{
+		snprintf( cMessage, sizeof( cMessage ), "echo %u", ( unsigned ) uxIndex );
+		FreeRTOS_sendto( xSocket, cMessage, strlen( cMessage ), 0, &xPeerAddress, sizeof( xPeerAddress ) );
+		xReceived = FreeRTOS_recvfrom( xSocket, cReply, sizeof( cReply ), 0, &xFromAddress, &ulFromLength );
+
+		if( ( xReceived == ( BaseType_t ) strlen( cMessage ) ) &&
+			( memcmp( cReply, cMessage, ( size_t ) xReceived ) == 0 ) &&
+			( xFromAddress.sin_port == FreeRTOS_htons( testPEER_ECHO_PORT ) ) )
+		{
+			uxEchoed++;
+		}
+	}
+
+	vScriptedPeerGetStats( &xPeerStats );
+	printf( "echo: %u of %u echoed, %u ARP replies\n", ( unsigned ) uxEchoed, ( unsigned ) testECHO_COUNT,
+		( unsigned ) xPeerStats.ulARPReplies );
+
+	return ( ( uxEchoed == testECHO_COUNT ) && ( xPeerStats.ulARPReplies > 0u ) ) ? pdPASS : pdFAIL;
+}
+/*-----------------------------------------------------------*/
+
+static void prvTestReplay( Socket_t xSocket, uint32_t ulSeed, ReplayResult_t *pxResult )
+{
+LinkEmulatorConfig_t xConfig[ linkemuDIRECTIONS ];
+LinkEmulatorStats_t xBefore[ linkemuDIRECTIONS ], xAfter[ linkemuDIRECTIONS ];
+struct freertos_sockaddr xFromAddress;
+uint32_t ulFromLength = sizeof( xFromAddress );
+uint8_t ucPayload[ 4 ];
+uint8_t ucIndex;
+BaseType_t xReceived;
+
+	memset( xConfig, '\0', sizeof( xConfig ) );
+	xConfig[ linkemuTO_STACK ] = xImpairedLink;
+	vLinkEmulatorConfigure( xConfig, ulSeed );
+	vLinkEmulatorGetStats( xBefore );
+
+	/* All frames of the burst enter the link in the same tick. */
+	vTaskSuspendAll();
+	{
+		for( ucIndex = 0u; ucIndex < testBURST_LENGTH; ucIndex++ )
+		{
+			( void ) xScriptedPeerSendUDP( testPEER_ECHO_PORT, testLOCAL_PORT, &ucIndex, sizeof( ucIndex ) );
+		}
+	}
+	( void ) xTaskResumeAll();
+
+	pxResult->uxCount = 0u;
+
+	for( ;; )
+	{
+		xReceived = FreeRTOS_recvfrom( xSocket, ucPayload, sizeof( ucPayload ), 0, &xFromAddress, &ulFromLength );
+
+		if( xReceived <= 0 )
+		{
+			break;
+		}
+
+		if( pxResult->uxCount < testMAX_RECEIVED )
+		{
+			pxResult->ucSequence[ pxResult->uxCount++ ] = ucPayload[ 0 ];
+		}
+	}
+
+	vLinkEmulatorGetStats( xAfter );
+	pxResult->xStats.ulFrames = xAfter[ linkemuTO_STACK ].ulFrames - xBefore[ linkemuTO_STACK ].ulFrames;
+	pxResult->xStats.ulDelivered = xAfter[ linkemuTO_STACK ].ulDelivered - xBefore[ linkemuTO_STACK ].ulDelivered;
+	pxResult->xStats.ulLost = xAfter[ linkemuTO_STACK ].ulLost - xBefore[ linkemuTO_STACK ].ulLost;
+	pxResult->xStats.ulReordered = xAfter[ linkemuTO_STACK ].ulReordered - xBefore[ linkemuTO_STACK ].ulReordered;
+	pxResult->xStats.ulDuplicated = xAfter[ linkemuTO_STACK ].ulDuplicated - xBefore[ linkemuTO_STACK ].ulDuplicated;
+	pxResult->xStats.ulQueueDrops = xAfter[ linkemuTO_STACK ].ulQueueDrops - xBefore[ linkemuTO_STACK ].ulQueueDrops;
+}
+/*-----------------------------------------------------------*/
+
+static void prvPrintReplay( const char *pcName, const ReplayResult_t *pxResult )
+{
+size_t uxIndex;
+
+	printf( "%-10s: frames %u lost %u reordered %u duplicated %u delivered %u, sequence {",
+		pcName,
+		( unsigned ) pxResult->xStats.ulFrames,
+		( unsigned ) pxResult->xStats.ulLost,
+		( unsigned ) pxResult->xStats.ulReordered,
+		( unsigned ) pxResult->xStats.ulDuplicated,
+		( unsigned ) pxResult->xStats.ulDelivered );
+
+	for( uxIndex = 0u; uxIndex < pxResult->uxCount; uxIndex++ )
+	{
+		printf( "%s %u", ( uxIndex == 0u ) ? "" : ",", ( unsigned ) pxResult->ucSequence[ uxIndex ] );
+	}
+
+	printf( " }\n" );
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvSameReplay( const ReplayResult_t *pxLeft, const ReplayResult_t *pxRight )
+{
+BaseType_t xReturn = pdFALSE;
+
+	if( ( pxLeft->uxCount == pxRight->uxCount ) &&
+		( memcmp( pxLeft->ucSequence, pxRight->ucSequence, pxLeft->uxCount ) == 0 ) &&
+		( memcmp( &( pxLeft->xStats ), &( pxRight->xStats ), sizeof( pxLeft->xStats ) ) == 0 ) )
+	{
+		xReturn = pdTRUE;
+	}
+
+	return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+void vApplicationIPNetworkEventHook( eIPCallbackEvent_t eNetworkEvent )
+{
+	if( ( eNetworkEvent == eNetworkUp ) && ( xTestTaskHandle != NULL ) )
+	{
+		xTaskNotifyGive( xTestTaskHandle );
+	}
+}
+/*-----------------------------------------------------------*/
+
+void vApplicationPingReplyHook( ePingReplyStatus_t eStatus, uint16_t usIdentifier )
+{
+	( void ) eStatus;
+	( void ) usIdentifier;
+}
+/*-----------------------------------------------------------*/
+
+const char *pcApplicationHostnameHook( void )
+{
+	return "RTOSDemo";
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xApplicationDNSQueryHook( const char *pcName )
+{
+	( void ) pcName;
+
+	return pdFAIL;
+}
+/*-----------------------------------------------------------*/
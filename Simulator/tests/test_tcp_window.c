@@ -0,0 +1,541 @@
+/*
+ * test_tcp_window.c
+ *
+ * Drives the congestion control of FreeRTOS_TCP_WIN.c without a network: a
+ * sender and a receiver exchange segments in rounds of one RTT, and the test
+ * checks the congestion window and the slow-start threshold after every
+ * round.  The receiver acknowledges every segment, and reports a hole with
+ * duplicate ACKs that carry a SACK block, in the same order as
+ * FreeRTOS_TCP_IP.c passes them on: ulTCPWindowTxSack(), then
+ * vTCPWindowTxDuplicateAck() and ulTCPWindowTxAck().
+ *
+ *	1. NewReno: slow start, a loss, fast recovery and congestion avoidance.
+ *	   This does not depend on time, so the trajectory must be exactly the
+ *	   one that is recorded below.
+ *	2. CUBIC: the same start, after which the window must grow back to W_max
+ *	   along a concave curve, in about K ms.  A loss above W_max sets W_max to
+ *	   the window, a loss below W_max releases some bandwidth (fast
+ *	   convergence).  The growth depends on the tick count, so it is checked
+ *	   with a margin.
+ *
+ * The exit code is 0 when all checks pass.
+ */
+
+/* Standard includes. */
+#include <stdio.h>
+#include <string.h>
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* FreeRTOS+TCP includes. */
+#include "FreeRTOS_IP.h"
+#include "FreeRTOS_Sockets.h"
+#include "FreeRTOS_TCP_WIN.h"
+
+#include "hr_gettime.h"
+
+#define testMSS						1000UL
+
+/* The self-imposed transmission window, which also limits cwnd. */
+#define testTX_WINDOW				( 48UL * testMSS )
+#define testRX_WINDOW				( 8UL * testMSS )
+
+/* The receiver never limits the sender. */
+#define testPEER_WINDOW				0x100000UL
+
+#define testFIRST_SEQUENCE			0x10000UL
+
+/* The length of the (imaginary) circular TX buffer. */
+#define testSTREAM_LENGTH			( 256L * ( int32_t ) testMSS )
+
+#define testMAX_SEGMENTS			ipconfigTCP_WIN_SEG_COUNT
+#define testMAX_ROUNDS				64u
+
+#define testNO_DROP					( -1 )
+
+/* NewReno does not look at the clock, CUBIC does.  A long RTT keeps CUBIC
+out of its TCP-friendly region, so that the cubic curve can be seen. */
+#define testNEWRENO_RTT_MS			10u
+#define testCUBIC_RTT_MS			200u
+
+/* The rounds of slow start before the first loss. */
+#define testSLOW_START_ROUNDS		4u
+
+/* The segment of the last round of slow start that gets lost. */
+#define testFIRST_DROP				8
+
+#define testTASK_PRIORITY			( tskIDLE_PRIORITY + 1 )
+#define testTASK_STACK_SIZE			( 4 * configMINIMAL_STACK_SIZE )
+
+/* A segment on its way to the receiver. */
+typedef struct xTEST_SEGMENT
+{
+	uint32_t ulSequenceNumber;
+	uint32_t ulLength;
+} TestSegment_t;
+
+/* The congestion state after a round. */
+typedef struct xTEST_SAMPLE
+{
+	uint32_t ulCwnd;
+	uint32_t ulSsthresh;
+	uint32_t ulWMax;
+	TickType_t xTime;
+	BaseType_t xInRecovery;
+} TestSample_t;
+
+/* One connection: the window of the sender, and the receiver. */
+typedef struct xTEST_FLOW
+{
+	TCPWindow_t xWindow;
+	int32_t lPosition;							/* Stream position of the next byte that is added */
+	TestSegment_t xSent[ testMAX_SEGMENTS ];	/* Segments sent in the last round, without the dropped one */
+	size_t uxSent;
+	uint32_t ulReceiveNext;						/* The next byte that the receiver expects */
+	uint32_t ulSackFirst;						/* A block received above a hole, empty when ulSackFirst == ulSackLast */
+	uint32_t ulSackLast;
+	uint32_t ulCwndAfterRecovery;				/* cwnd at the full ACK that ended the last fast recovery */
+	TestSample_t xSamples[ testMAX_ROUNDS ];
+	size_t uxRounds;
+} TestFlow_t;
+
+/* A round of the NewReno trajectory, in MSS. */
+typedef struct xTEST_EXPECTED
+{
+	uint8_t ucCwnd;
+	uint8_t ucSsthresh;		/* 0 means not set yet */
+	uint8_t ucInRecovery;
+} TestExpected_t;
+
+/*-----------------------------------------------------------*/
+
+static void prvTestTask( void *pvParameters );
+
+static BaseType_t prvTestNewReno( void );
+static BaseType_t prvTestCubic( void );
+
+static void prvFlowInit( TestFlow_t *pxFlow, BaseType_t xAlgorithm );
+
+/*
+ * One RTT: the receiver gets the segments of the previous round and
+ * acknowledges them, after which the sender sends what its windows allow.
+ * The 'xDrop'th new segment of this round gets lost, unless it is testNO_DROP.
+ * The scheduler is suspended so that the tick count does not change within a
+ * round.
+ */
+static void prvRound( TestFlow_t *pxFlow, BaseType_t xDrop, TickType_t xRTT );
+static void prvReceive( TestFlow_t *pxFlow, const TestSegment_t *pxSegment );
+static void prvSend( TestFlow_t *pxFlow, BaseType_t xDrop );
+
+static void prvPrintFlow( const char *pcName, const TestFlow_t *pxFlow );
+
+/*-----------------------------------------------------------*/
+
+/* The NewReno trajectory, as RFC 5681 and RFC 6582 give it.  Slow start
+doubles the initial window of 4 MSS every round.  In round 3 the 9th of 32
+segments is lost.  Round 4 receives 8 segments (cwnd 40), after which 23 SACKs
+of the remaining segments detect the loss: ssthresh = FlightSize / 2 = 12, cwnd
+= ssthresh + 3 and one more for every later duplicate ACK, 36.  In round 5 the
+retransmission is a full ACK (cwnd = ssthresh), and the 12 segments which were
+sent during recovery add one MSS, as does every later round. */
+static const TestExpected_t xNewRenoExpected[] =
+{
+	{  4,  0, 0 },
+	{  8,  0, 0 },
+	{ 16,  0, 0 },
+	{ 32,  0, 0 },
+	{ 36, 12, 1 },
+	{ 13, 12, 0 },
+	{ 14, 12, 0 },
+	{ 15, 12, 0 },
+	{ 16, 12, 0 },
+	{ 17, 12, 0 }
+};
+
+static volatile BaseType_t xTestResult = pdFAIL;
+
+/*-----------------------------------------------------------*/
+
+int main( void )
+{
+	/* The RTT is measured with the high-resolution clock. */
+	vStartHighResolutionTimer();
+
+	xTaskCreate( prvTestTask, "Test", testTASK_STACK_SIZE, NULL, testTASK_PRIORITY, NULL );
+
+	vTaskStartScheduler();
+
+	printf( "test_tcp_window: %s\n", ( xTestResult == pdPASS ) ? "PASS" : "FAIL" );
+
+	return ( xTestResult == pdPASS ) ? 0 : 1;
+}
+/*-----------------------------------------------------------*/
+
+static void prvTestTask( void *pvParameters )
+{
+BaseType_t xResult = pdPASS;
+
+	( void ) pvParameters;
+
+	if( prvTestNewReno() != pdPASS )
+	{
+		xResult = pdFAIL;
+	}
+
+	if( prvTestCubic() != pdPASS )
+	{
+		xResult = pdFAIL;
+	}
+
+	xTestResult = xResult;
+	vTaskEndScheduler();
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvTestNewReno( void )
+{
+static TestFlow_t xFlow;
+const size_t uxRounds = sizeof( xNewRenoExpected ) / sizeof( xNewRenoExpected[ 0 ] );
+const TestExpected_t *pxExpected;
+const TestSample_t *pxSample;
+uint32_t ulSsthresh;
+BaseType_t xResult = pdPASS;
+size_t uxRound;
+
+	prvFlowInit( &xFlow, FREERTOS_TCP_CC_NEWRENO );
+
+	for( uxRound = 0u; uxRound < uxRounds; uxRound++ )
+	{
+		prvRound( &xFlow, ( uxRound == testSLOW_START_ROUNDS - 1u ) ? testFIRST_DROP : testNO_DROP, pdMS_TO_TICKS( testNEWRENO_RTT_MS ) );
+	}
+
+	prvPrintFlow( "newreno", &xFlow );
+
+	for( uxRound = 0u; uxRound < uxRounds; uxRound++ )
+	{
+		pxExpected = &( xNewRenoExpected[ uxRound ] );
+		pxSample = &( xFlow.xSamples[ uxRound ] );
+		ulSsthresh = ( pxExpected->ucSsthresh == 0u ) ? 0xFFFFFFFFUL : pxExpected->ucSsthresh * testMSS;
+
+		if( ( pxSample->ulCwnd != pxExpected->ucCwnd * testMSS ) ||
+			( pxSample->ulSsthresh != ulSsthresh ) ||
+			( pxSample->xInRecovery != ( BaseType_t ) pxExpected->ucInRecovery ) )
+		{
+			printf( "FAIL: newreno round %u: cwnd %lu ssthresh %lu recovery %ld, expected %u %u %u (MSS)\n",
+				( unsigned ) uxRound,
+				( unsigned long ) pxSample->ulCwnd,
+				( unsigned long ) pxSample->ulSsthresh,
+				( long ) pxSample->xInRecovery,
+				pxExpected->ucCwnd, pxExpected->ucSsthresh, pxExpected->ucInRecovery );
+			xResult = pdFAIL;
+		}
+	}
+
+	vTCPWindowDestroy( &( xFlow.xWindow ) );
+
+	return xResult;
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvTestCubic( void )
+{
+static TestFlow_t xFlow;
+TCPCongestion_t *pxCongestion = &( xFlow.xWindow.xCongestion );
+const TestSample_t *pxSample;
+uint32_t ulCwnd, ulWMax, ulEpochStart, ulK, ulHalf, ulFirstHalf, ulSecondHalf, ulNearK;
+size_t uxRound, uxStart;
+BaseType_t xResult = pdPASS;
+
+	prvFlowInit( &xFlow, FREERTOS_TCP_CC_CUBIC );
+
+	/* Slow start is the same as with NewReno, up to the first loss. */
+	for( uxRound = 0u; uxRound <= testSLOW_START_ROUNDS; uxRound++ )
+	{
+		prvRound( &xFlow, ( uxRound == testSLOW_START_ROUNDS - 1u ) ? testFIRST_DROP : testNO_DROP, pdMS_TO_TICKS( testCUBIC_RTT_MS ) );
+
+		if( ( uxRound < testSLOW_START_ROUNDS ) && ( xFlow.xSamples[ uxRound ].ulCwnd != ( ( 4UL * testMSS ) << uxRound ) ) )
+		{
+			printf( "FAIL: cubic round %u: cwnd %lu in slow start\n", ( unsigned ) uxRound, ( unsigned long ) xFlow.xSamples[ uxRound ].ulCwnd );
+			xResult = pdFAIL;
+		}
+	}
+
+	/* The loss was detected at a cwnd of 40 MSS: beta = 0.7 and W_max is the
+	window before the reduction. */
+	pxSample = &( xFlow.xSamples[ testSLOW_START_ROUNDS ] );
+
+	if( ( pxSample->xInRecovery == pdFALSE ) || ( pxSample->ulSsthresh != 28UL * testMSS ) || ( pxSample->ulWMax != 40UL * testMSS ) )
+	{
+		printf( "FAIL: cubic first loss: ssthresh %lu W_max %lu, expected %lu %lu\n",
+			( unsigned long ) pxSample->ulSsthresh, ( unsigned long ) pxSample->ulWMax,
+			28UL * testMSS, 40UL * testMSS );
+		xResult = pdFAIL;
+	}
+
+	/* The full ACK ends the recovery and starts an epoch. */
+	prvRound( &xFlow, testNO_DROP, pdMS_TO_TICKS( testCUBIC_RTT_MS ) );
+	uxStart = xFlow.uxRounds - 1u;
+	ulEpochStart = pxCongestion->ulEpochStart;
+	ulK = pxCongestion->ulK;
+
+	if( xFlow.ulCwndAfterRecovery != 28UL * testMSS )
+	{
+		printf( "FAIL: cubic full ACK: cwnd %lu, expected %lu\n", ( unsigned long ) xFlow.ulCwndAfterRecovery, 28UL * testMSS );
+		xResult = pdFAIL;
+	}
+
+	/* Grow until K has passed. */
+	do
+	{
+		prvRound( &xFlow, testNO_DROP, pdMS_TO_TICKS( testCUBIC_RTT_MS ) );
+	} while( ( ( uint32_t ) ( xFlow.xSamples[ xFlow.uxRounds - 1u ].xTime * portTICK_PERIOD_MS ) - ulEpochStart <= ulK ) &&
+			 ( xFlow.uxRounds < testMAX_ROUNDS - 8u ) );
+
+	/* The curve is concave below W_max: the first half of the way to K
+	gives more growth than the second half.  The window comes back close to
+	W_max in about K ms, and not above it before K. */
+	ulHalf = ulEpochStart + ( ulK / 2UL );
+	ulFirstHalf = 0UL;
+	ulSecondHalf = 0UL;
+	ulNearK = 0UL;
+
+	for( uxRound = uxStart + 1u; uxRound < xFlow.uxRounds; uxRound++ )
+	{
+		uint32_t ulTime = ( uint32_t ) ( xFlow.xSamples[ uxRound ].xTime * portTICK_PERIOD_MS );
+		uint32_t ulGrowth = xFlow.xSamples[ uxRound ].ulCwnd - xFlow.xSamples[ uxRound - 1u ].ulCwnd;
+
+		if( ulTime <= ulHalf )
+		{
+			ulFirstHalf += ulGrowth;
+		}
+		else if( ulTime - ulEpochStart <= ulK )
+		{
+			ulSecondHalf += ulGrowth;
+		}
+
+		if( ( ulTime - ulEpochStart + testCUBIC_RTT_MS < ulK ) && ( xFlow.xSamples[ uxRound ].ulCwnd > 41UL * testMSS ) )
+		{
+			printf( "FAIL: cubic round %u: cwnd %lu above W_max before K\n", ( unsigned ) uxRound, ( unsigned long ) xFlow.xSamples[ uxRound ].ulCwnd );
+			xResult = pdFAIL;
+		}
+
+		ulNearK = xFlow.xSamples[ uxRound ].ulCwnd;
+	}
+
+	if( ( ulFirstHalf <= ulSecondHalf ) || ( ulNearK < 38UL * testMSS ) || ( ulNearK > 42UL * testMSS ) )
+	{
+		printf( "FAIL: cubic epoch: growth %lu then %lu, cwnd %lu at K = %lu ms\n",
+			( unsigned long ) ulFirstHalf, ( unsigned long ) ulSecondHalf, ( unsigned long ) ulNearK, ( unsigned long ) ulK );
+		xResult = pdFAIL;
+	}
+
+	/* A loss at or above W_max: the new W_max is the window.  The first
+	segment of the round gets lost, so cwnd does not change between the end of
+	that round and the detection of the loss. */
+	prvRound( &xFlow, 0, pdMS_TO_TICKS( testCUBIC_RTT_MS ) );
+	ulCwnd = xFlow.xSamples[ xFlow.uxRounds - 1u ].ulCwnd;
+	prvRound( &xFlow, testNO_DROP, pdMS_TO_TICKS( testCUBIC_RTT_MS ) );
+	pxSample = &( xFlow.xSamples[ xFlow.uxRounds - 1u ] );
+
+	if( ( pxSample->xInRecovery == pdFALSE ) || ( pxSample->ulWMax != ulCwnd ) || ( pxSample->ulSsthresh != ( ulCwnd / 10UL ) * 7UL ) )
+	{
+		printf( "FAIL: cubic loss at cwnd %lu: ssthresh %lu W_max %lu\n",
+			( unsigned long ) ulCwnd, ( unsigned long ) pxSample->ulSsthresh, ( unsigned long ) pxSample->ulWMax );
+		xResult = pdFAIL;
+	}
+
+	/* Another loss before the window is back at W_max: fast convergence
+	sets W_max to 0.85 times the window. */
+	prvRound( &xFlow, testNO_DROP, pdMS_TO_TICKS( testCUBIC_RTT_MS ) );
+	prvRound( &xFlow, testNO_DROP, pdMS_TO_TICKS( testCUBIC_RTT_MS ) );
+	prvRound( &xFlow, 0, pdMS_TO_TICKS( testCUBIC_RTT_MS ) );
+	ulCwnd = xFlow.xSamples[ xFlow.uxRounds - 1u ].ulCwnd;
+	ulWMax = xFlow.xSamples[ xFlow.uxRounds - 1u ].ulWMax;
+	prvRound( &xFlow, testNO_DROP, pdMS_TO_TICKS( testCUBIC_RTT_MS ) );
+	pxSample = &( xFlow.xSamples[ xFlow.uxRounds - 1u ] );
+
+	if( ( ulCwnd >= ulWMax ) || ( pxSample->xInRecovery == pdFALSE ) ||
+		( pxSample->ulWMax != ( ulCwnd / 20UL ) * 17UL ) || ( pxSample->ulSsthresh != ( ulCwnd / 10UL ) * 7UL ) )
+	{
+		printf( "FAIL: cubic loss at cwnd %lu below W_max %lu: ssthresh %lu W_max %lu\n",
+			( unsigned long ) ulCwnd, ( unsigned long ) ulWMax,
+			( unsigned long ) pxSample->ulSsthresh, ( unsigned long ) pxSample->ulWMax );
+		xResult = pdFAIL;
+	}
+
+	prvPrintFlow( "cubic", &xFlow );
+
+	vTCPWindowDestroy( &( xFlow.xWindow ) );
+
+	return xResult;
+}
+/*-----------------------------------------------------------*/
+
+static void prvFlowInit( TestFlow_t *pxFlow, BaseType_t xAlgorithm )
+{
+BaseType_t xResult;
+
+	memset( pxFlow, 0, sizeof( *pxFlow ) );
+
+	vTCPWindowCreate( &( pxFlow->xWindow ), testRX_WINDOW, testTX_WINDOW, 0UL, testFIRST_SEQUENCE, testMSS );
+	xResult = xTCPWindowSetCongestionControl( &( pxFlow->xWindow ), xAlgorithm );
+	configASSERT( xResult == pdPASS );
+	( void ) xResult;
+
+	pxFlow->ulReceiveNext = testFIRST_SEQUENCE;
+}
+/*-----------------------------------------------------------*/
+
+static void prvRound( TestFlow_t *pxFlow, BaseType_t xDrop, TickType_t xRTT )
+{
+TestSegment_t xArrived[ testMAX_SEGMENTS ];
+const TCPCongestion_t *pxCongestion = &( pxFlow->xWindow.xCongestion );
+TestSample_t *pxSample;
+size_t uxCount, uxIndex;
+
+	configASSERT( pxFlow->uxRounds < testMAX_ROUNDS );
+
+	vTaskSuspendAll();
+	{
+		uxCount = pxFlow->uxSent;
+		memcpy( xArrived, pxFlow->xSent, uxCount * sizeof( xArrived[ 0 ] ) );
+		pxFlow->uxSent = 0u;
+
+		for( uxIndex = 0u; uxIndex < uxCount; uxIndex++ )
+		{
+			prvReceive( pxFlow, &( xArrived[ uxIndex ] ) );
+		}
+
+		prvSend( pxFlow, xDrop );
+
+		pxSample = &( pxFlow->xSamples[ pxFlow->uxRounds ] );
+		pxSample->ulCwnd = pxCongestion->ulCwnd;
+		pxSample->ulSsthresh = pxCongestion->ulSsthresh;
+		pxSample->ulWMax = pxCongestion->ulWMax;
+		pxSample->xTime = xTaskGetTickCount();
+		pxSample->xInRecovery = ( pxCongestion->bInRecovery != pdFALSE_UNSIGNED ) ? pdTRUE : pdFALSE;
+		pxFlow->uxRounds++;
+	}
+	xTaskResumeAll();
+
+	vTaskDelay( xRTT );
+}
+/*-----------------------------------------------------------*/
+
+static void prvReceive( TestFlow_t *pxFlow, const TestSegment_t *pxSegment )
+{
+TCPWindow_t *pxWindow = &( pxFlow->xWindow );
+const TCPCongestion_t *pxCongestion = &( pxWindow->xCongestion );
+BaseType_t xSack = pdFALSE;
+uint8_t ucInRecovery = pxCongestion->bInRecovery;
+
+	if( pxSegment->ulSequenceNumber == pxFlow->ulReceiveNext )
+	{
+		/* In order, possibly filling the hole below the SACK block. */
+		pxFlow->ulReceiveNext += pxSegment->ulLength;
+
+		if( ( pxFlow->ulSackFirst != pxFlow->ulSackLast ) && ( pxFlow->ulReceiveNext == pxFlow->ulSackFirst ) )
+		{
+			pxFlow->ulReceiveNext = pxFlow->ulSackLast;
+			pxFlow->ulSackFirst = 0UL;
+			pxFlow->ulSackLast = 0UL;
+		}
+	}
+	else if( ( int32_t ) ( pxSegment->ulSequenceNumber - pxFlow->ulReceiveNext ) > 0 )
+	{
+		/* Above a hole: the block grows, the segments arrive in order. */
+		if( pxFlow->ulSackFirst == pxFlow->ulSackLast )
+		{
+			pxFlow->ulSackFirst = pxSegment->ulSequenceNumber;
+		}
+
+		pxFlow->ulSackLast = pxSegment->ulSequenceNumber + pxSegment->ulLength;
+		xSack = pdTRUE;
+	}
+
+	/* The ACK, in the order of FreeRTOS_TCP_IP.c: first the SACK option,
+	then the duplicate ACK, then the acknowledgement number. */
+	if( xSack != pdFALSE )
+	{
+		ulTCPWindowTxSack( pxWindow, pxFlow->ulSackFirst, pxFlow->ulSackLast );
+	}
+
+	if( pxFlow->ulReceiveNext == pxWindow->tx.ulCurrentSequenceNumber )
+	{
+		vTCPWindowTxDuplicateAck( pxWindow );
+	}
+
+	ulTCPWindowTxAck( pxWindow, pxFlow->ulReceiveNext );
+
+	if( ( ucInRecovery != pdFALSE_UNSIGNED ) && ( pxCongestion->bInRecovery == pdFALSE_UNSIGNED ) )
+	{
+		pxFlow->ulCwndAfterRecovery = pxCongestion->ulCwnd;
+	}
+}
+/*-----------------------------------------------------------*/
+
+static void prvSend( TestFlow_t *pxFlow, BaseType_t xDrop )
+{
+TCPWindow_t *pxWindow = &( pxFlow->xWindow );
+BaseType_t xNewSegments = 0;
+uint32_t ulHighest, ulLength;
+int32_t lStreamPosition, lAdded;
+
+	for( ;; )
+	{
+		/* Keep one full segment queued, there is no use in adding more
+		segments than the window can send. */
+		if( pxWindow->ulNextTxSequenceNumber == pxWindow->tx.ulHighestSequenceNumber )
+		{
+			lAdded = lTCPWindowTxAdd( pxWindow, testMSS, pxFlow->lPosition, testSTREAM_LENGTH );
+			configASSERT( lAdded == ( int32_t ) testMSS );
+			pxFlow->lPosition = ( pxFlow->lPosition + ( int32_t ) testMSS ) % testSTREAM_LENGTH;
+		}
+
+		ulHighest = pxWindow->tx.ulHighestSequenceNumber;
+		ulLength = ulTCPWindowTxGet( pxWindow, testPEER_WINDOW, &lStreamPosition );
+
+		if( ulLength == 0UL )
+		{
+			break;
+		}
+
+		/* ulTCPWindowTxGet() leaves the sequence number of the segment in
+		ulOurSequenceNumber.  Only new segments can get lost. */
+		if( pxWindow->ulOurSequenceNumber == ulHighest )
+		{
+			if( xNewSegments++ == xDrop )
+			{
+				continue;
+			}
+		}
+
+		configASSERT( pxFlow->uxSent < testMAX_SEGMENTS );
+		pxFlow->xSent[ pxFlow->uxSent ].ulSequenceNumber = pxWindow->ulOurSequenceNumber;
+		pxFlow->xSent[ pxFlow->uxSent ].ulLength = ulLength;
+		pxFlow->uxSent++;
+	}
+}
+/*-----------------------------------------------------------*/
+
+static void prvPrintFlow( const char *pcName, const TestFlow_t *pxFlow )
+{
+size_t uxRound;
+const TestSample_t *pxSample;
+
+	for( uxRound = 0u; uxRound < pxFlow->uxRounds; uxRound++ )
+	{
+		pxSample = &( pxFlow->xSamples[ uxRound ] );
+		printf( "%-8s round %2u at %6lu ms: cwnd %6lu ssthresh %10lu W_max %6lu%s\n",
+			pcName,
+			( unsigned ) uxRound,
+			( unsigned long ) ( pxSample->xTime * portTICK_PERIOD_MS ),
+			( unsigned long ) pxSample->ulCwnd,
+			( unsigned long ) pxSample->ulSsthresh,
+			( unsigned long ) pxSample->ulWMax,
+			( pxSample->xInRecovery != pdFALSE ) ? " recovery" : "" );
+	}
+}
+/*-----------------------------------------------------------*/
@@ -0,0 +1,438 @@
+/*
+ * critical_profiler.c
+ *
+ * The masked-region profiler, see critical_profiler.h.
+ *
+ * All updates are made while interrupts up to
+ * configMAX_SYSCALL_INTERRUPT_PRIORITY are masked, either by the region that
+ * is being measured or explicitly.  Regions do not nest: only the outermost
+ * one is timed, so there is a single start time and site.  The sites are
+ * kept in a small open-addressed hash table, so the cost of a region is a
+ * few loads and stores plus a short probe.
+ */
+
+/* Standard includes. */
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* FreeRTOS+TCP includes. */
+#include "FreeRTOS_IP.h"
+#include "FreeRTOS_Sockets.h"
+
+#include "hr_gettime.h"
+#include "report_server.h"
+#include "critical_profiler.h"
+
+#if( configUSE_CRITICAL_PROFILER == 1 )
+
+#include "stm32f4xx.h"
+
+#ifndef configCRITICAL_PROFILER_SITES
+	/* The number of call sites that are told apart, must be a power of 2. */
+	#define configCRITICAL_PROFILER_SITES		64u
+#endif
+
+#ifndef configCRITICAL_PROFILER_IRQ
+	/* The interrupt of which the entry latency is measured. */
+	#define configCRITICAL_PROFILER_IRQ			OTG_FS_IRQn
+#endif
+
+#if( ( configCRITICAL_PROFILER_SITES & ( configCRITICAL_PROFILER_SITES - 1u ) ) != 0u ) || ( configCRITICAL_PROFILER_SITES > 256u )
+	#error configCRITICAL_PROFILER_SITES must be a power of 2, and at most 256
+#endif
+
+
+/*-----------------------------------------------------------*/
+
+static UBaseType_t prvBucket( uint32_t ulCounts );
+static CriticalProfilerSite_t *prvFindSite( uint32_t ulSite );
+static BaseType_t prvIrqHeldOff( void );
+static BaseType_t prvPrintf( ReportServerWrite_t pxWrite, void *pvContext, const char *pcFormat, ... );
+static BaseType_t prvWriteReport( ReportServerWrite_t pxWrite, void *pvContext );
+
+/*-----------------------------------------------------------*/
+
+static CriticalProfilerSite_t xCriticalSites[ configCRITICAL_PROFILER_SITES ];
+static CriticalProfilerIrq_t xCriticalIrq;
+
+/* Regions whose site did not fit in xCriticalSites. */
+static uint32_t ulCriticalLostRegions = 0u;
+
+/* The region that is being measured. */
+static UBaseType_t uxCriticalDepth = 0u;
+static uint32_t ulCriticalStart;
+static uint32_t ulCriticalSite;
+
+/* Set when the watched interrupt was pending at the end of a region. */
+static BaseType_t xCriticalIrqHeldOff = pdFALSE;
+static uint32_t ulCriticalIrqHeldSince;
+static uint32_t ulCriticalIrqHeldSite;
+
+static ReportServer_t xCriticalServer = { NULL, 0u, NULL };
+
+/*-----------------------------------------------------------*/
+
+static UBaseType_t prvBucket( uint32_t ulCounts )
+{
+UBaseType_t uxBucket = 0u;
+
+	if( ulCounts >= 32u )
+	{
+		/* 31 - clz is the position of the highest bit that is set, which is 5
+		for 32 up to 63 counts. */
+		uxBucket = ( UBaseType_t ) ( 27 - __builtin_clz( ulCounts ) );
+
+		if( uxBucket > ( criticalprofilerBUCKETS - 1u ) )
+		{
+			uxBucket = criticalprofilerBUCKETS - 1u;
+		}
+	}
+
+	return uxBucket;
+}
+/*-----------------------------------------------------------*/
+
+static CriticalProfilerSite_t *prvFindSite( uint32_t ulSite )
+{
+UBaseType_t uxIndex, uxProbe;
+CriticalProfilerSite_t *pxSite;
+
+	/* Bit 0 of a Thumb address is always set. */
+	uxIndex = ( UBaseType_t ) ( ulSite >> 1 );
+
+	for( uxProbe = 0u; uxProbe < configCRITICAL_PROFILER_SITES; uxProbe++ )
+	{
+		pxSite = &( xCriticalSites[ ( uxIndex + uxProbe ) & ( configCRITICAL_PROFILER_SITES - 1u ) ] );
+
+		if( pxSite->ulSite == ulSite )
+		{
+			return pxSite;
+		}
+
+		if( pxSite->ulSite == 0u )
+		{
+			pxSite->ulSite = ulSite;
+			return pxSite;
+		}
+	}
+
+	return NULL;
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvIrqHeldOff( void )
+{
+uint32_t ulActive;
+
+	if( NVIC_GetPendingIRQ( configCRITICAL_PROFILER_IRQ ) == 0u )
+	{
+		return pdFALSE;
+	}
+
+	ulActive = __get_IPSR();
+
+	if( ulActive == 0u )
+	{
+		/* Thread mode, only the mask holds the interrupt off. */
+		return pdTRUE;
+	}
+
+	/* In an interrupt of the same or a higher priority, the interrupt would
+	also be held off without the mask. */
+	return ( NVIC_GetPriority( ( IRQn_Type ) ( ( int32_t ) ulActive - 16 ) ) > NVIC_GetPriority( configCRITICAL_PROFILER_IRQ ) ) ? pdTRUE : pdFALSE;
+}
+/*-----------------------------------------------------------*/
+
+void vCriticalProfilerEnter( void *pvSite )
+{
+	if( uxCriticalDepth == 0u )
+	{
+		ulCriticalSite = ( uint32_t ) ( uintptr_t ) pvSite;
+		ulCriticalStart = ulGetHighResolutionCycles();
+	}
+
+	uxCriticalDepth++;
+}
+/*-----------------------------------------------------------*/
+
+void vCriticalProfilerExit( void )
+{
+uint32_t ulDuration = ulGetHighResolutionCycles() - ulCriticalStart;
+CriticalProfilerSite_t *pxSite;
+
+	if( uxCriticalDepth == 0u )
+	{
+		return;
+	}
+
+	uxCriticalDepth--;
+
+	if( uxCriticalDepth != 0u )
+	{
+		return;
+	}
+
+	pxSite = prvFindSite( ulCriticalSite );
+
+	if( pxSite != NULL )
+	{
+		if( ( pxSite->ulCount == 0u ) || ( ulDuration < pxSite->ulMin ) )
+		{
+			pxSite->ulMin = ulDuration;
+		}
+		if( ulDuration > pxSite->ulMax )
+		{
+			pxSite->ulMax = ulDuration;
+		}
+		pxSite->ulCount++;
+		pxSite->ullTotal += ulDuration;
+		pxSite->ulBuckets[ prvBucket( ulDuration ) ]++;
+	}
+	else
+	{
+		ulCriticalLostRegions++;
+	}
+
+	if( ( xCriticalIrqHeldOff == pdFALSE ) && ( prvIrqHeldOff() != pdFALSE ) )
+	{
+		/* The interrupt became pending during this region. */
+		xCriticalIrqHeldOff = pdTRUE;
+		ulCriticalIrqHeldSince = ulCriticalStart;
+		ulCriticalIrqHeldSite = ulCriticalSite;
+	}
+}
+/*-----------------------------------------------------------*/
+
+uint32_t ulCriticalProfilerMaskFromISR( void )
+{
+uint32_t ulOriginalMask = ulPortRaiseBASEPRI();
+
+	if( ulOriginalMask == 0u )
+	{
+		vCriticalProfilerEnter( __builtin_return_address( 0 ) );
+	}
+
+	return ulOriginalMask;
+}
+/*-----------------------------------------------------------*/
+
+void vCriticalProfilerUnmaskFromISR( uint32_t ulNewMaskValue )
+{
+	if( ulNewMaskValue == 0u )
+	{
+		vCriticalProfilerExit();
+	}
+
+	vPortSetBASEPRI( ulNewMaskValue );
+}
+/*-----------------------------------------------------------*/
+
+void vCriticalProfilerIrqEntry( void )
+{
+uint32_t ulNow = ulGetHighResolutionCycles();
+uint32_t ulMask, ulLatency;
+
+	/* Masked with the port functions, this is not a region to be measured. */
+	ulMask = ulPortRaiseBASEPRI();
+	{
+		xCriticalIrq.ulEntries++;
+
+		if( xCriticalIrqHeldOff != pdFALSE )
+		{
+			xCriticalIrqHeldOff = pdFALSE;
+			ulLatency = ulNow - ulCriticalIrqHeldSince;
+
+			xCriticalIrq.ulHeldOff++;
+			xCriticalIrq.ulBuckets[ prvBucket( ulLatency ) ]++;
+
+			if( ulLatency > xCriticalIrq.ulMaxLatency )
+			{
+				xCriticalIrq.ulMaxLatency = ulLatency;
+				xCriticalIrq.ulMaxLatencySite = ulCriticalIrqHeldSite;
+			}
+		}
+	}
+	vPortSetBASEPRI( ulMask );
+}
+/*-----------------------------------------------------------*/
+
+size_t uxCriticalProfilerGetSites( CriticalProfilerSite_t *pxSites, size_t uxMaxSites, uint32_t *pulLostRegions )
+{
+UBaseType_t uxIndex;
+size_t uxCount = 0u;
+
+	for( uxIndex = 0u; ( uxIndex < configCRITICAL_PROFILER_SITES ) && ( uxCount < uxMaxSites ); uxIndex++ )
+	{
+		taskENTER_CRITICAL();
+		{
+			if( xCriticalSites[ uxIndex ].ulCount != 0u )
+			{
+				pxSites[ uxCount++ ] = xCriticalSites[ uxIndex ];
+			}
+		}
+		taskEXIT_CRITICAL();
+	}
+
+	if( pulLostRegions != NULL )
+	{
+		*pulLostRegions = ulCriticalLostRegions;
+	}
+
+	return uxCount;
+}
+/*-----------------------------------------------------------*/
+
+void vCriticalProfilerGetIrq( CriticalProfilerIrq_t *pxIrq )
+{
+	taskENTER_CRITICAL();
+	{
+		*pxIrq = xCriticalIrq;
+	}
+	taskEXIT_CRITICAL();
+}
+/*-----------------------------------------------------------*/
+
+void vCriticalProfilerReset( void )
+{
+	/* The region of this critical section itself is still open, so the
+	depth, start and site are left alone. */
+	taskENTER_CRITICAL();
+	{
+		memset( xCriticalSites, '\0', sizeof( xCriticalSites ) );
+		memset( &xCriticalIrq, '\0', sizeof( xCriticalIrq ) );
+		ulCriticalLostRegions = 0u;
+		xCriticalIrqHeldOff = pdFALSE;
+	}
+	taskEXIT_CRITICAL();
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvPrintf( ReportServerWrite_t pxWrite, void *pvContext, const char *pcFormat, ... )
+{
+char pcLine[ 96 ];
+va_list xArgs;
+int iLength;
+
+	va_start( xArgs, pcFormat );
+	iLength = vsnprintf( pcLine, sizeof( pcLine ), pcFormat, xArgs );
+	va_end( xArgs );
+
+	if( iLength < 0 )
+	{
+		return pdFAIL;
+	}
+
+	if( iLength >= ( int ) sizeof( pcLine ) )
+	{
+		iLength = ( int ) sizeof( pcLine ) - 1;
+	}
+
+	return pxWrite( pvContext, pcLine, ( size_t ) iLength );
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvWriteReport( ReportServerWrite_t pxWrite, void *pvContext )
+{
+static uint8_t ucOrder[ configCRITICAL_PROFILER_SITES ];
+CriticalProfilerSite_t xSite;
+CriticalProfilerIrq_t xIrq;
+UBaseType_t uxIndex, uxCount = 0u, uxBucket, uxPosition;
+BaseType_t xResult;
+
+	/* Order the sites by their longest region.  The maxima may still grow
+	while sorting, which only affects the order. */
+	for( uxIndex = 0u; uxIndex < configCRITICAL_PROFILER_SITES; uxIndex++ )
+	{
+		if( xCriticalSites[ uxIndex ].ulCount == 0u )
+		{
+			continue;
+		}
+
+		for( uxPosition = uxCount; uxPosition > 0u; uxPosition-- )
+		{
+			if( xCriticalSites[ ucOrder[ uxPosition - 1u ] ].ulMax >= xCriticalSites[ uxIndex ].ulMax )
+			{
+				break;
+			}
+
+			ucOrder[ uxPosition ] = ucOrder[ uxPosition - 1u ];
+		}
+
+		ucOrder[ uxPosition ] = ( uint8_t ) uxIndex;
+		uxCount++;
+	}
+
+	xResult = prvPrintf( pxWrite, pvContext, "Masked regions in counts, %lu counts per us, %lu regions lost\n",
+		( unsigned long ) ulGetHighResolutionCountsPerUs(), ( unsigned long ) ulCriticalLostRegions );
+
+	if( xResult != pdFAIL )
+	{
+		xResult = prvPrintf( pxWrite, pvContext, "%-10s %10s %10s %10s %10s\n", "site", "count", "min", "mean", "max" );
+	}
+
+	for( uxIndex = 0u; ( uxIndex < uxCount ) && ( xResult != pdFAIL ); uxIndex++ )
+	{
+		taskENTER_CRITICAL();
+		{
+			xSite = xCriticalSites[ ucOrder[ uxIndex ] ];
+		}
+		taskEXIT_CRITICAL();
+
+		xResult = prvPrintf( pxWrite, pvContext, "0x%08lx %10lu %10lu %10lu %10lu\n",
+			( unsigned long ) xSite.ulSite,
+			( unsigned long ) xSite.ulCount,
+			( unsigned long ) xSite.ulMin,
+			( unsigned long ) ( xSite.ullTotal / xSite.ulCount ),
+			( unsigned long ) xSite.ulMax );
+
+		for( uxBucket = 0u; ( uxBucket < criticalprofilerBUCKETS ) && ( xResult != pdFAIL ); uxBucket++ )
+		{
+			if( xSite.ulBuckets[ uxBucket ] != 0u )
+			{
+				xResult = prvPrintf( pxWrite, pvContext, "    >= %10lu: %lu\n",
+					( uxBucket == 0u ) ? 0ul : ( 1ul << ( uxBucket + 4u ) ),
+					( unsigned long ) xSite.ulBuckets[ uxBucket ] );
+			}
+		}
+	}
+
+	vCriticalProfilerGetIrq( &xIrq );
+
+	if( xResult != pdFAIL )
+	{
+		xResult = prvPrintf( pxWrite, pvContext, "IRQ %d: %lu entries, %lu held off, entry latency at most %lu at 0x%08lx\n",
+			( int ) configCRITICAL_PROFILER_IRQ,
+			( unsigned long ) xIrq.ulEntries,
+			( unsigned long ) xIrq.ulHeldOff,
+			( unsigned long ) xIrq.ulMaxLatency,
+			( unsigned long ) xIrq.ulMaxLatencySite );
+	}
+
+	for( uxBucket = 0u; ( uxBucket < criticalprofilerBUCKETS ) && ( xResult != pdFAIL ); uxBucket++ )
+	{
+		if( xIrq.ulBuckets[ uxBucket ] != 0u )
+		{
+			xResult = prvPrintf( pxWrite, pvContext, "    >= %10lu: %lu\n",
+				( uxBucket == 0u ) ? 0ul : ( 1ul << ( uxBucket + 4u ) ),
+				( unsigned long ) xIrq.ulBuckets[ uxBucket ] );
+		}
+	}
+
+	return xResult;
+}
+/*-----------------------------------------------------------*/
+
+void vCriticalProfilerStartServer( uint16_t usPort )
+{
+	/* vsnprintf() needs some extra stack. */
+	vReportServerStart( &xCriticalServer, "CritSrv", 3u * configMINIMAL_STACK_SIZE, usPort, prvWriteReport );
+}
+/*-----------------------------------------------------------*/
+
+#endif /* configUSE_CRITICAL_PROFILER == 1 */
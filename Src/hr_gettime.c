@@ -0,0 +1,120 @@
+/*
+ * hr_gettime.c
+ *
+ * The high-resolution clock, see hr_gettime.h.
+ *
+ * On a Cortex-M, the 64-bit value is kept in ullHRCycles: every reading adds
+ * the cycles that passed since the previous reading.  The update is done with
+ * all interrupts disabled, for a few instructions, so that an interrupt of a
+ * priority above configMAX_SYSCALL_INTERRUPT_PRIORITY can read the clock too.
+ */
+
+/* Standard includes. */
+#include <stdint.h>
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+
+#include "hr_gettime.h"
+
+#if defined( __ARM_ARCH_7EM__ ) || defined( __ARM_ARCH_7M__ )
+
+#include "stm32f4xx.h"
+
+/* The cycle counter, extended to 64 bits. */
+static uint64_t ullHRCycles = 0u;
+
+/*-----------------------------------------------------------*/
+
+void vStartHighResolutionTimer( void )
+{
+	CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+	DWT->CYCCNT = 0u;
+	DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+	ullHRCycles = 0u;
+}
+/*-----------------------------------------------------------*/
+
+uint32_t ulGetHighResolutionCycles( void )
+{
+	return DWT->CYCCNT;
+}
+/*-----------------------------------------------------------*/
+
+uint64_t ullGetHighResolutionCycles( void )
+{
+uint32_t ulPriMask;
+uint64_t ullResult;
+
+	ulPriMask = __get_PRIMASK();
+	__disable_irq();
+	{
+		ullHRCycles += ( uint32_t ) ( DWT->CYCCNT - ( uint32_t ) ullHRCycles );
+		ullResult = ullHRCycles;
+	}
+	__set_PRIMASK( ulPriMask );
+
+	return ullResult;
+}
+/*-----------------------------------------------------------*/
+
+uint32_t ulGetHighResolutionCountsPerUs( void )
+{
+	return configCPU_CLOCK_HZ / 1000000UL;
+}
+/*-----------------------------------------------------------*/
+
+#elif defined( __unix__ ) || defined( __APPLE__ )
+
+/* The host simulation counts nanoseconds of the monotonic clock. */
+#include <time.h>
+
+static uint64_t ullHRStart = 0u;
+
+static uint64_t prvMonotonicNanoseconds( void );
+
+/*-----------------------------------------------------------*/
+
+static uint64_t prvMonotonicNanoseconds( void )
+{
+struct timespec xNow;
+
+	clock_gettime( CLOCK_MONOTONIC, &xNow );
+
+	return ( ( uint64_t ) xNow.tv_sec * 1000000000u ) + ( uint64_t ) xNow.tv_nsec;
+}
+/*-----------------------------------------------------------*/
+
+void vStartHighResolutionTimer( void )
+{
+	ullHRStart = prvMonotonicNanoseconds();
+}
+/*-----------------------------------------------------------*/
+
+uint32_t ulGetHighResolutionCycles( void )
+{
+	return ( uint32_t ) ullGetHighResolutionCycles();
+}
+/*-----------------------------------------------------------*/
+
+uint64_t ullGetHighResolutionCycles( void )
+{
+	return prvMonotonicNanoseconds() - ullHRStart;
+}
+/*-----------------------------------------------------------*/
+
+uint32_t ulGetHighResolutionCountsPerUs( void )
+{
+	return 1000u;
+}
+/*-----------------------------------------------------------*/
+
+#else
+	#error No high-resolution clock for this platform
+#endif
+
+uint64_t ullGetHighResolutionTime( void )
+{
+	return ullGetHighResolutionCycles() / ulGetHighResolutionCountsPerUs();
+}
+/*-----------------------------------------------------------*/
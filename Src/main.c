@@ -59,6 +59,16 @@
 //#include "FreeRTOS_tcp_server.h"
 //#include "FreeRTOS_DHCP.h"
 //#include "usbd_cdc.h"
+#include "hr_gettime.h"
+#if( configUSE_PCAP_RING == 1 )
+	#include "pcap_ring.h"
+#endif
+#if( configUSE_RUN_TIME_STATS == 1 )
+	#include "run_time_stats.h"
+#endif
+#if( configUSE_CRITICAL_PROFILER == 1 )
+	#include "critical_profiler.h"
+#endif
 /* USER CODE END Includes */
 
 /* Private variables ---------------------------------------------------------*/
@@ -123,6 +133,8 @@ int main(void)
   SystemClock_Config();
 
   /* USER CODE BEGIN SysInit */
+  /* Start the high-resolution clock, see hr_gettime.h. */
+  vStartHighResolutionTimer();
 
   /* USER CODE END SysInit */
 
@@ -296,7 +308,38 @@ void vApplicationPingReplyHook( ePingReplyStatus_t eStatus, uint16_t usIdentifie
 events are only received if implemented in the MAC driver. */
 void vApplicationIPNetworkEventHook( eIPCallbackEvent_t eNetworkEvent )
 {
-
+#if( configUSE_TRACE_RING == 1 )
+	/* Send the trace records to the host at the other end of the RNDIS
+	link. */
+	if( eNetworkEvent == eNetworkUp )
+	{
+		vTraceRingStartUDP( FreeRTOS_inet_addr_quick( ucGatewayAddress[ 0 ], ucGatewayAddress[ 1 ], ucGatewayAddress[ 2 ], ucGatewayAddress[ 3 ] ),
+			configTRACE_RING_UDP_PORT );
+	}
+#endif
+#if( configUSE_PCAP_RING == 1 )
+	/* Serve the captured frames to the host. */
+	if( eNetworkEvent == eNetworkUp )
+	{
+		vPcapRingStartServer( configPCAP_RING_TCP_PORT );
+	}
+#endif
+#if( configUSE_RUN_TIME_STATS == 1 )
+	/* Send the CPU and stack usage to the host. */
+	if( eNetworkEvent == eNetworkUp )
+	{
+		vRunTimeStatsStartUDP( FreeRTOS_inet_addr_quick( ucGatewayAddress[ 0 ], ucGatewayAddress[ 1 ], ucGatewayAddress[ 2 ], ucGatewayAddress[ 3 ] ),
+			configRUN_TIME_STATS_UDP_PORT );
+	}
+#endif
+#if( configUSE_CRITICAL_PROFILER == 1 )
+	/* Serve the masked-region report to the host. */
+	if( eNetworkEvent == eNetworkUp )
+	{
+		vCriticalProfilerStartServer( configCRITICAL_PROFILER_TCP_PORT );
+	}
+#endif
+	( void ) eNetworkEvent;
 }
 
 const char *pcApplicationHostnameHook( void )
@@ -312,6 +355,11 @@ UBaseType_t uxRand( void )
 	return( ( int ) ( rand() >> 16UL ) & 0x7fffUL );
 }
 
+uint32_t ulApplicationGetCycleCount( void )
+{
+	return ulGetHighResolutionCycles();
+}
+
 
 
 BaseType_t xApplicationDNSQueryHook( const char *pcName )
@@ -372,7 +420,11 @@ void HAL_TIM_PeriodElapsedCallback(TIM_HandleTypeDef *htim)
     HAL_IncTick();
   }
   /* USER CODE BEGIN Callback 1 */
-
+  if (htim->Instance == TIM1) {
+    /* Let the high-resolution clock see every wrap-around of the cycle
+    counter. */
+    ( void ) ullGetHighResolutionCycles();
+  }
   /* USER CODE END Callback 1 */
 }
 
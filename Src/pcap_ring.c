@@ -0,0 +1,386 @@
+/*
+ * pcap_ring.c
+ *
+ * The capture ring, see pcap_ring.h.
+ *
+ * Every captured frame takes one slot of a fixed size, so storing a frame
+ * never has to move or drop other frames than the oldest one.  The filters
+ * and the copy are done in a critical section of bounded length, which also
+ * guarantees that no frame is half written once capturing has been paused
+ * for an export.
+ *
+ * Frames are stamped with the 64-bit high-resolution clock of hr_gettime.h,
+ * so the timestamps stay exact over any length of capture.
+ */
+
+/* Standard includes. */
+#include <stdint.h>
+#include <string.h>
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
+#include "semphr.h"
+
+/* FreeRTOS+TCP includes. */
+#include "FreeRTOS_IP.h"
+#include "FreeRTOS_Sockets.h"
+
+#include "hr_gettime.h"
+#include "report_server.h"
+
+#include "pcap_ring.h"
+
+#if( configUSE_PCAP_RING == 1 )
+
+#ifndef configPCAP_RING_SLOTS
+	/* The number of frames that are kept. */
+	#define configPCAP_RING_SLOTS				32u
+#endif
+
+#ifndef configPCAP_RING_SNAPLEN
+	/* The maximum number of bytes stored of each frame. */
+	#define configPCAP_RING_SNAPLEN				128u
+#endif
+
+#ifndef configPCAP_RING_FILTERS
+	#define configPCAP_RING_FILTERS				4u
+#endif
+
+#if( configPCAP_RING_SNAPLEN > 0xFFFFu )
+	#error configPCAP_RING_SNAPLEN is too large
+#endif
+
+/* pcapng block types and constants. */
+#define pcapringBLOCK_SHB					0x0A0D0D0AUL
+#define pcapringBLOCK_IDB					0x00000001UL
+#define pcapringBLOCK_EPB					0x00000006UL
+#define pcapringBYTE_ORDER_MAGIC			0x1A2B3C4DUL
+#define pcapringLINKTYPE_ETHERNET			1u
+#define pcapringOPTION_EPB_FLAGS			2u		/* The low bits hold the direction, as pcapringDIR_XXX */
+
+/* Fields of the frames that the filters look at. */
+#define pcapringETHERTYPE_OFFSET			12u
+#define pcapringIP_OFFSET					14u
+#define pcapringETHERTYPE_IPv4				0x0800u
+#define pcapringPROTOCOL_TCP				6u
+#define pcapringPROTOCOL_UDP				17u
+
+/*-----------------------------------------------------------*/
+
+typedef struct xPCAP_RING_SLOT
+{
+	uint64_t ullTimestamp;		/* ullGetHighResolutionCycles() */
+	uint16_t usCaptured;		/* Bytes stored in ucFrame */
+	uint16_t usOriginal;		/* Length of the frame */
+	uint8_t ucDirection;		/* pcapringDIR_XXX */
+	uint8_t ucFrame[ configPCAP_RING_SNAPLEN ];
+} PcapRingSlot_t;
+
+typedef struct xPCAPNG_SECTION_HEADER
+{
+	uint32_t ulType;
+	uint32_t ulLength;
+	uint32_t ulByteOrderMagic;
+	uint16_t usMajor;
+	uint16_t usMinor;
+	uint32_t ulSectionLengthLow;
+	uint32_t ulSectionLengthHigh;
+	uint32_t ulTrailingLength;
+} PcapngSectionHeader_t;
+
+typedef struct xPCAPNG_INTERFACE
+{
+	uint32_t ulType;
+	uint32_t ulLength;
+	uint16_t usLinkType;
+	uint16_t usReserved;
+	uint32_t ulSnapLength;
+	uint32_t ulTrailingLength;
+} PcapngInterface_t;
+
+typedef struct xPCAPNG_PACKET
+{
+	uint32_t ulType;
+	uint32_t ulLength;
+	uint32_t ulInterface;
+	uint32_t ulTimeHigh;		/* Microseconds since boot */
+	uint32_t ulTimeLow;
+	uint32_t ulCaptured;
+	uint32_t ulOriginal;
+} PcapngPacket_t;
+
+typedef struct xPCAPNG_PACKET_OPTIONS
+{
+	uint16_t usFlagsCode;
+	uint16_t usFlagsLength;
+	uint32_t ulFlags;
+	uint32_t ulEndOfOptions;
+	uint32_t ulTrailingLength;
+} PcapngPacketOptions_t;
+
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvMatchesFilters( uint8_t ucDirection, const uint8_t *pucFrame, size_t uxLength );
+static BaseType_t prvExportFrame( const PcapRingSlot_t *pxSlot, uint64_t ullTimeUs, PcapRingWrite_t pxWrite, void *pvContext );
+
+/*-----------------------------------------------------------*/
+
+static PcapRingSlot_t xPcapSlots[ configPCAP_RING_SLOTS ];
+
+/* The number of frames captured since the last clear. */
+static uint32_t ulPcapHead = 0u;
+
+static BaseType_t xPcapCapturing = pdTRUE;
+static size_t uxPcapSnapLength = configPCAP_RING_SNAPLEN;
+static PcapRingFilter_t xPcapFilters[ configPCAP_RING_FILTERS ];
+static size_t uxPcapFilterCount = 0u;
+
+static ReportServer_t xPcapServer = { NULL, 0u, NULL };
+
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvMatchesFilters( uint8_t ucDirection, const uint8_t *pucFrame, size_t uxLength )
+{
+uint16_t usEtherType = 0u, usSourcePort = 0u, usDestinationPort = 0u;
+uint8_t ucProtocol = 0u;
+size_t uxHeaderLength, uxIndex;
+const PcapRingFilter_t *pxFilter;
+BaseType_t xResult = pdFALSE;
+
+	if( uxPcapFilterCount == 0u )
+	{
+		return pdTRUE;
+	}
+
+	if( uxLength >= pcapringIP_OFFSET )
+	{
+		usEtherType = ( uint16_t ) ( ( pucFrame[ pcapringETHERTYPE_OFFSET ] << 8 ) | pucFrame[ pcapringETHERTYPE_OFFSET + 1u ] );
+	}
+
+	if( ( usEtherType == pcapringETHERTYPE_IPv4 ) && ( uxLength >= pcapringIP_OFFSET + 20u ) )
+	{
+		uxHeaderLength = ( size_t ) ( pucFrame[ pcapringIP_OFFSET ] & 0x0Fu ) * 4u;
+		ucProtocol = pucFrame[ pcapringIP_OFFSET + 9u ];
+
+		/* Only the first fragment carries the ports. */
+		if( ( ( ucProtocol == pcapringPROTOCOL_TCP ) || ( ucProtocol == pcapringPROTOCOL_UDP ) ) &&
+			( ( pucFrame[ pcapringIP_OFFSET + 6u ] & 0x1Fu ) == 0u ) && ( pucFrame[ pcapringIP_OFFSET + 7u ] == 0u ) &&
+			( uxLength >= pcapringIP_OFFSET + uxHeaderLength + 4u ) )
+		{
+			const uint8_t *pucPorts = &( pucFrame[ pcapringIP_OFFSET + uxHeaderLength ] );
+
+			usSourcePort = ( uint16_t ) ( ( pucPorts[ 0 ] << 8 ) | pucPorts[ 1 ] );
+			usDestinationPort = ( uint16_t ) ( ( pucPorts[ 2 ] << 8 ) | pucPorts[ 3 ] );
+		}
+	}
+
+	for( uxIndex = 0u; uxIndex < uxPcapFilterCount; uxIndex++ )
+	{
+		pxFilter = &( xPcapFilters[ uxIndex ] );
+
+		if( ( ( pxFilter->ucDirections == 0u ) || ( ( pxFilter->ucDirections & ucDirection ) != 0u ) ) &&
+			( ( pxFilter->usEtherType == 0u ) || ( pxFilter->usEtherType == usEtherType ) ) &&
+			( ( pxFilter->ucProtocol == 0u ) || ( pxFilter->ucProtocol == ucProtocol ) ) &&
+			( ( pxFilter->usPort == 0u ) || ( pxFilter->usPort == usSourcePort ) || ( pxFilter->usPort == usDestinationPort ) ) )
+		{
+			xResult = pdTRUE;
+			break;
+		}
+	}
+
+	return xResult;
+}
+/*-----------------------------------------------------------*/
+
+void vPcapRingCapture( uint8_t ucDirection, const uint8_t *pucFrame, size_t uxLength )
+{
+PcapRingSlot_t *pxSlot;
+size_t uxCaptured;
+
+	taskENTER_CRITICAL();
+	{
+		if( ( xPcapCapturing != pdFALSE ) && ( prvMatchesFilters( ucDirection, pucFrame, uxLength ) != pdFALSE ) )
+		{
+			pxSlot = &( xPcapSlots[ ulPcapHead % configPCAP_RING_SLOTS ] );
+			uxCaptured = ( uxLength < uxPcapSnapLength ) ? uxLength : uxPcapSnapLength;
+
+			pxSlot->ullTimestamp = ullGetHighResolutionCycles();
+			pxSlot->usCaptured = ( uint16_t ) uxCaptured;
+			pxSlot->usOriginal = ( uint16_t ) uxLength;
+			pxSlot->ucDirection = ucDirection;
+			memcpy( pxSlot->ucFrame, pucFrame, uxCaptured );
+
+			ulPcapHead++;
+		}
+	}
+	taskEXIT_CRITICAL();
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xPcapRingSetFilters( const PcapRingFilter_t *pxFilters, size_t uxCount )
+{
+BaseType_t xResult = pdFAIL;
+
+	if( uxCount <= configPCAP_RING_FILTERS )
+	{
+		taskENTER_CRITICAL();
+		{
+			if( uxCount != 0u )
+			{
+				memcpy( xPcapFilters, pxFilters, uxCount * sizeof( xPcapFilters[ 0 ] ) );
+			}
+			uxPcapFilterCount = uxCount;
+		}
+		taskEXIT_CRITICAL();
+		xResult = pdPASS;
+	}
+
+	return xResult;
+}
+/*-----------------------------------------------------------*/
+
+void vPcapRingSetSnapLength( size_t uxSnapLength )
+{
+	if( uxSnapLength > configPCAP_RING_SNAPLEN )
+	{
+		uxSnapLength = configPCAP_RING_SNAPLEN;
+	}
+
+	uxPcapSnapLength = uxSnapLength;
+}
+/*-----------------------------------------------------------*/
+
+void vPcapRingStart( void )
+{
+	xPcapCapturing = pdTRUE;
+}
+/*-----------------------------------------------------------*/
+
+void vPcapRingStop( void )
+{
+	taskENTER_CRITICAL();
+	{
+		xPcapCapturing = pdFALSE;
+	}
+	taskEXIT_CRITICAL();
+}
+/*-----------------------------------------------------------*/
+
+void vPcapRingClear( void )
+{
+	taskENTER_CRITICAL();
+	{
+		ulPcapHead = 0u;
+	}
+	taskEXIT_CRITICAL();
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvExportFrame( const PcapRingSlot_t *pxSlot, uint64_t ullTimeUs, PcapRingWrite_t pxWrite, void *pvContext )
+{
+PcapngPacket_t xPacket;
+PcapngPacketOptions_t xOptions;
+static const uint8_t ucPadding[ 3 ] = { 0u, 0u, 0u };
+size_t uxPadding = ( 4u - ( pxSlot->usCaptured & 3u ) ) & 3u;
+uint32_t ulLength = ( uint32_t ) ( sizeof( xPacket ) + pxSlot->usCaptured + uxPadding + sizeof( xOptions ) );
+BaseType_t xResult;
+
+	xPacket.ulType = pcapringBLOCK_EPB;
+	xPacket.ulLength = ulLength;
+	xPacket.ulInterface = 0u;
+	xPacket.ulTimeHigh = ( uint32_t ) ( ullTimeUs >> 32 );
+	xPacket.ulTimeLow = ( uint32_t ) ullTimeUs;
+	xPacket.ulCaptured = pxSlot->usCaptured;
+	xPacket.ulOriginal = pxSlot->usOriginal;
+
+	xOptions.usFlagsCode = pcapringOPTION_EPB_FLAGS;
+	xOptions.usFlagsLength = sizeof( xOptions.ulFlags );
+	xOptions.ulFlags = pxSlot->ucDirection;
+	xOptions.ulEndOfOptions = 0u;
+	xOptions.ulTrailingLength = ulLength;
+
+	xResult = pxWrite( pvContext, &xPacket, sizeof( xPacket ) );
+
+	if( xResult != pdFAIL )
+	{
+		xResult = pxWrite( pvContext, pxSlot->ucFrame, pxSlot->usCaptured );
+	}
+
+	if( ( xResult != pdFAIL ) && ( uxPadding != 0u ) )
+	{
+		xResult = pxWrite( pvContext, ucPadding, uxPadding );
+	}
+
+	if( xResult != pdFAIL )
+	{
+		xResult = pxWrite( pvContext, &xOptions, sizeof( xOptions ) );
+	}
+
+	return xResult;
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xPcapRingExport( PcapRingWrite_t pxWrite, void *pvContext )
+{
+PcapngSectionHeader_t xSection;
+PcapngInterface_t xInterface;
+const PcapRingSlot_t *pxSlot;
+BaseType_t xWasCapturing, xResult;
+uint32_t ulCount, ulNumber, ulCountsPerUs;
+
+	/* After this, no frame is being written. */
+	taskENTER_CRITICAL();
+	{
+		xWasCapturing = xPcapCapturing;
+		xPcapCapturing = pdFALSE;
+	}
+	taskEXIT_CRITICAL();
+
+	xSection.ulType = pcapringBLOCK_SHB;
+	xSection.ulLength = sizeof( xSection );
+	xSection.ulByteOrderMagic = pcapringBYTE_ORDER_MAGIC;
+	xSection.usMajor = 1u;
+	xSection.usMinor = 0u;
+	xSection.ulSectionLengthLow = 0xFFFFFFFFUL;		/* Unknown */
+	xSection.ulSectionLengthHigh = 0xFFFFFFFFUL;
+	xSection.ulTrailingLength = sizeof( xSection );
+
+	/* Without an if_tsresol option, timestamps are in microseconds. */
+	xInterface.ulType = pcapringBLOCK_IDB;
+	xInterface.ulLength = sizeof( xInterface );
+	xInterface.usLinkType = pcapringLINKTYPE_ETHERNET;
+	xInterface.usReserved = 0u;
+	xInterface.ulSnapLength = configPCAP_RING_SNAPLEN;
+	xInterface.ulTrailingLength = sizeof( xInterface );
+
+	xResult = pxWrite( pvContext, &xSection, sizeof( xSection ) );
+
+	if( xResult != pdFAIL )
+	{
+		xResult = pxWrite( pvContext, &xInterface, sizeof( xInterface ) );
+	}
+
+	ulCountsPerUs = ulGetHighResolutionCountsPerUs();
+	ulCount = ( ulPcapHead < configPCAP_RING_SLOTS ) ? ulPcapHead : configPCAP_RING_SLOTS;
+
+	for( ulNumber = ulPcapHead - ulCount; ( ulNumber != ulPcapHead ) && ( xResult != pdFAIL ); ulNumber++ )
+	{
+		pxSlot = &( xPcapSlots[ ulNumber % configPCAP_RING_SLOTS ] );
+		xResult = prvExportFrame( pxSlot, pxSlot->ullTimestamp / ulCountsPerUs, pxWrite, pvContext );
+	}
+
+	xPcapCapturing = xWasCapturing;
+
+	return xResult;
+}
+/*-----------------------------------------------------------*/
+
+void vPcapRingStartServer( uint16_t usPort )
+{
+	vReportServerStart( &xPcapServer, "PcapSrv", 2u * configMINIMAL_STACK_SIZE, usPort, xPcapRingExport );
+}
+/*-----------------------------------------------------------*/
+
+#endif /* configUSE_PCAP_RING == 1 */
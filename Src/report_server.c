@@ -0,0 +1,126 @@
+/*
+ * report_server.c
+ *
+ * The report server, see report_server.h.
+ *
+ * After the report the socket is shut down, and the task waits a short time
+ * for the peer to close its side.  Closing at once could reset the
+ * connection and discard the end of the report.
+ */
+
+/* Standard includes. */
+#include <stdint.h>
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* FreeRTOS+TCP includes. */
+#include "FreeRTOS_IP.h"
+#include "FreeRTOS_Sockets.h"
+
+#include "report_server.h"
+
+#if( configUSE_PCAP_RING == 1 ) || ( configUSE_CRITICAL_PROFILER == 1 )
+
+#define reportserverSEND_TIMEOUT_MS			5000u
+#define reportserverSHUTDOWN_WAIT_MS		250u
+#define reportserverSHUTDOWN_LOOPS			20
+
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvSocketWrite( void *pvContext, const void *pvData, size_t uxLength );
+static void prvReportServerTask( void *pvParameters );
+
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvSocketWrite( void *pvContext, const void *pvData, size_t uxLength )
+{
+Socket_t xSocket = ( Socket_t ) pvContext;
+const uint8_t *pucData = ( const uint8_t * ) pvData;
+BaseType_t xSent;
+
+	while( uxLength != 0u )
+	{
+		xSent = FreeRTOS_send( xSocket, pucData, uxLength, 0 );
+
+		if( xSent <= 0 )
+		{
+			/* An error, or the send timeout expired. */
+			return pdFAIL;
+		}
+
+		pucData += xSent;
+		uxLength -= ( size_t ) xSent;
+	}
+
+	return pdPASS;
+}
+/*-----------------------------------------------------------*/
+
+void vReportServerStart( ReportServer_t *pxServer, const char *pcName, uint16_t usStackDepth,
+	uint16_t usPort, ReportServerReport_t pxReport )
+{
+	configASSERT( pxReport != NULL );
+
+	if( pxServer->xTaskHandle == NULL )
+	{
+		pxServer->pxReport = pxReport;
+		pxServer->usPort = usPort;
+		xTaskCreate( prvReportServerTask, pcName, usStackDepth, ( void * ) pxServer, tskIDLE_PRIORITY + 1u, &( pxServer->xTaskHandle ) );
+	}
+}
+/*-----------------------------------------------------------*/
+
+static void prvReportServerTask( void *pvParameters )
+{
+ReportServer_t *pxServer = ( ReportServer_t * ) pvParameters;
+Socket_t xListener, xClient;
+struct freertos_sockaddr xAddress;
+socklen_t xSize = sizeof( xAddress );
+TickType_t xTimeout = pdMS_TO_TICKS( reportserverSEND_TIMEOUT_MS );
+uint8_t ucDrain[ 16 ];
+BaseType_t xLoops;
+
+	xListener = FreeRTOS_socket( FREERTOS_AF_INET, FREERTOS_SOCK_STREAM, FREERTOS_IPPROTO_TCP );
+	configASSERT( xListener != FREERTOS_INVALID_SOCKET );
+
+	xAddress.sin_addr = 0u;
+	xAddress.sin_port = FreeRTOS_htons( pxServer->usPort );
+	FreeRTOS_bind( xListener, &xAddress, sizeof( xAddress ) );
+	FreeRTOS_listen( xListener, 1 );
+
+	for( ;; )
+	{
+		xClient = FreeRTOS_accept( xListener, &xAddress, &xSize );
+
+		if( ( xClient == NULL ) || ( xClient == FREERTOS_INVALID_SOCKET ) )
+		{
+			continue;
+		}
+
+		FreeRTOS_setsockopt( xClient, 0, FREERTOS_SO_SNDTIMEO, &xTimeout, sizeof( xTimeout ) );
+		FreeRTOS_setsockopt( xClient, 0, FREERTOS_SO_RCVTIMEO, &xTimeout, sizeof( xTimeout ) );
+
+		( void ) pxServer->pxReport( prvSocketWrite, ( void * ) xClient );
+
+		/* Let the peer receive everything before the socket is closed. */
+		FreeRTOS_shutdown( xClient, FREERTOS_SHUT_RDWR );
+		xTimeout = pdMS_TO_TICKS( reportserverSHUTDOWN_WAIT_MS );
+		FreeRTOS_setsockopt( xClient, 0, FREERTOS_SO_RCVTIMEO, &xTimeout, sizeof( xTimeout ) );
+		xTimeout = pdMS_TO_TICKS( reportserverSEND_TIMEOUT_MS );
+
+		for( xLoops = 0; xLoops < reportserverSHUTDOWN_LOOPS; xLoops++ )
+		{
+			if( FreeRTOS_recv( xClient, ucDrain, sizeof( ucDrain ), 0 ) < 0 )
+			{
+				break;
+			}
+		}
+
+		FreeRTOS_closesocket( xClient );
+	}
+}
+/*-----------------------------------------------------------*/
+
+#endif /* ( configUSE_PCAP_RING == 1 ) || ( configUSE_CRITICAL_PROFILER == 1 ) */
@@ -0,0 +1,201 @@
+/*
+ * run_time_stats.c
+ *
+ * The CPU accounting, see run_time_stats.h.
+ *
+ * The task run times are kept by the kernel, with
+ * configGENERATE_RUN_TIME_STATS and portGET_RUN_TIME_COUNTER_VALUE() set in
+ * FreeRTOSConfig.h.  The interrupt run times are kept here.  An interrupt
+ * only updates its own entry, and the snapshot reads the entries in a
+ * critical section, so the instrumented interrupts must have a priority at or
+ * below configMAX_SYSCALL_INTERRUPT_PRIORITY.
+ */
+
+/* Standard includes. */
+#include <stdint.h>
+#include <string.h>
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* FreeRTOS+TCP includes. */
+#include "FreeRTOS_IP.h"
+#include "FreeRTOS_Sockets.h"
+
+#include "hr_gettime.h"
+#include "run_time_stats.h"
+
+#if( configUSE_RUN_TIME_STATS == 1 )
+
+#ifndef configRUN_TIME_STATS_MAX_TASKS
+	/* The number of tasks that fit in a snapshot. */
+	#define configRUN_TIME_STATS_MAX_TASKS		16u
+#endif
+
+#ifndef configRUN_TIME_STATS_PERIOD_MS
+	/* How often the UDP task sends a snapshot. */
+	#define configRUN_TIME_STATS_PERIOD_MS		1000u
+#endif
+
+#if( configGENERATE_RUN_TIME_STATS != 1 ) || ( configUSE_TRACE_FACILITY != 1 )
+	#error configUSE_RUN_TIME_STATS needs configGENERATE_RUN_TIME_STATS and configUSE_TRACE_FACILITY
+#endif
+
+#define runtimestatsMAGIC					0x54535452UL	/* "RTST" */
+
+#define runtimestatsMAX_SNAPSHOT_LENGTH		( sizeof( RunTimeStatsHeader_t ) + \
+											  configRUN_TIME_STATS_MAX_TASKS * sizeof( RunTimeStatsTask_t ) + \
+											  runtimestatsISR_COUNT * sizeof( RunTimeStatsIsr_t ) )
+
+/*-----------------------------------------------------------*/
+
+static void prvRunTimeStatsUDPTask( void *pvParameters );
+
+/*-----------------------------------------------------------*/
+
+/* Must follow the order of the runtimestatsISR_XXX numbers. */
+static const char * const pcRunTimeIsrNames[ runtimestatsISR_COUNT ] =
+{
+	"OTG_FS"
+};
+
+static volatile uint32_t ulRunTimeIsrCounts[ runtimestatsISR_COUNT ];
+static volatile uint32_t ulRunTimeIsrTimes[ runtimestatsISR_COUNT ];
+
+/* Filled by uxTaskGetSystemState(), too large for the stack of the UDP
+task. */
+static TaskStatus_t xRunTimeTaskStatus[ configRUN_TIME_STATS_MAX_TASKS ];
+
+/* Used by the UDP task. */
+static uint32_t ulRunTimeHostIP;
+static uint16_t usRunTimeHostPort;
+static TaskHandle_t xRunTimeUDPTaskHandle = NULL;
+static uint8_t ucRunTimeDatagram[ runtimestatsMAX_SNAPSHOT_LENGTH ];
+
+/*-----------------------------------------------------------*/
+
+uint32_t ulRunTimeStatsIsrEnter( void )
+{
+	return ulGetHighResolutionCycles();
+}
+/*-----------------------------------------------------------*/
+
+void vRunTimeStatsIsrExit( size_t uxIsr, uint32_t ulStart )
+{
+	configASSERT( uxIsr < runtimestatsISR_COUNT );
+
+	ulRunTimeIsrCounts[ uxIsr ]++;
+	ulRunTimeIsrTimes[ uxIsr ] += ulGetHighResolutionCycles() - ulStart;
+}
+/*-----------------------------------------------------------*/
+
+size_t uxRunTimeStatsSnapshot( uint8_t *pucBuffer, size_t uxLength )
+{
+RunTimeStatsHeader_t xHeader;
+RunTimeStatsTask_t xTask;
+RunTimeStatsIsr_t xIsr;
+UBaseType_t uxTaskCount, uxIndex;
+size_t uxNeeded;
+
+	/* Suspends the scheduler while the task lists are read. */
+	uxTaskCount = uxTaskGetSystemState( xRunTimeTaskStatus, configRUN_TIME_STATS_MAX_TASKS, NULL );
+
+	uxNeeded = sizeof( xHeader ) + uxTaskCount * sizeof( xTask ) + runtimestatsISR_COUNT * sizeof( xIsr );
+
+	if( ( uxTaskCount == 0u ) || ( uxLength < uxNeeded ) )
+	{
+		/* There are more tasks than configRUN_TIME_STATS_MAX_TASKS, or the
+		buffer is too small. */
+		return 0u;
+	}
+
+	xHeader.ulMagic = runtimestatsMAGIC;
+	xHeader.ulCountsPerUs = ulGetHighResolutionCountsPerUs();
+	xHeader.ulTimestamp = portGET_RUN_TIME_COUNTER_VALUE();
+	xHeader.ulFreeHeap = ( uint32_t ) xPortGetFreeHeapSize();
+	xHeader.ulMinimumFreeHeap = ( uint32_t ) xPortGetMinimumEverFreeHeapSize();
+	xHeader.usTaskCount = ( uint16_t ) uxTaskCount;
+	xHeader.usIsrCount = ( uint16_t ) runtimestatsISR_COUNT;
+
+	memcpy( pucBuffer, &xHeader, sizeof( xHeader ) );
+	pucBuffer += sizeof( xHeader );
+
+	for( uxIndex = 0u; uxIndex < uxTaskCount; uxIndex++ )
+	{
+		memset( &xTask, 0, sizeof( xTask ) );
+		xTask.ulTask = ( uint32_t ) ( uintptr_t ) xRunTimeTaskStatus[ uxIndex ].xHandle;
+		strncpy( xTask.pcName, xRunTimeTaskStatus[ uxIndex ].pcTaskName, runtimestatsNAME_LENGTH );
+		xTask.ulRunTime = xRunTimeTaskStatus[ uxIndex ].ulRunTimeCounter;
+		xTask.usStackHighWaterMark = xRunTimeTaskStatus[ uxIndex ].usStackHighWaterMark;
+		xTask.ucPriority = ( uint8_t ) xRunTimeTaskStatus[ uxIndex ].uxCurrentPriority;
+		xTask.ucState = ( uint8_t ) xRunTimeTaskStatus[ uxIndex ].eCurrentState;
+
+		memcpy( pucBuffer, &xTask, sizeof( xTask ) );
+		pucBuffer += sizeof( xTask );
+	}
+
+	for( uxIndex = 0u; uxIndex < runtimestatsISR_COUNT; uxIndex++ )
+	{
+		memset( &xIsr, 0, sizeof( xIsr ) );
+		strncpy( xIsr.pcName, pcRunTimeIsrNames[ uxIndex ], runtimestatsNAME_LENGTH );
+
+		/* The count and the time of one interrupt belong together. */
+		taskENTER_CRITICAL();
+		{
+			xIsr.ulCount = ulRunTimeIsrCounts[ uxIndex ];
+			xIsr.ulRunTime = ulRunTimeIsrTimes[ uxIndex ];
+		}
+		taskEXIT_CRITICAL();
+
+		memcpy( pucBuffer, &xIsr, sizeof( xIsr ) );
+		pucBuffer += sizeof( xIsr );
+	}
+
+	return uxNeeded;
+}
+/*-----------------------------------------------------------*/
+
+void vRunTimeStatsStartUDP( uint32_t ulHostIP, uint16_t usPort )
+{
+	ulRunTimeHostIP = ulHostIP;
+	usRunTimeHostPort = usPort;
+
+	if( xRunTimeUDPTaskHandle == NULL )
+	{
+		xTaskCreate( prvRunTimeStatsUDPTask, "RunTimeUDP", 2u * configMINIMAL_STACK_SIZE, NULL, tskIDLE_PRIORITY + 1u, &xRunTimeUDPTaskHandle );
+	}
+}
+/*-----------------------------------------------------------*/
+
+static void prvRunTimeStatsUDPTask( void *pvParameters )
+{
+Socket_t xSocket;
+struct freertos_sockaddr xAddress;
+size_t uxLength;
+
+	( void ) pvParameters;
+
+	xSocket = FreeRTOS_socket( FREERTOS_AF_INET, FREERTOS_SOCK_DGRAM, FREERTOS_IPPROTO_UDP );
+	configASSERT( xSocket != FREERTOS_INVALID_SOCKET );
+
+	for( ;; )
+	{
+		xAddress.sin_addr = ulRunTimeHostIP;
+		xAddress.sin_port = FreeRTOS_htons( usRunTimeHostPort );
+
+		uxLength = uxRunTimeStatsSnapshot( ucRunTimeDatagram, sizeof( ucRunTimeDatagram ) );
+
+		if( uxLength != 0u )
+		{
+			FreeRTOS_sendto( xSocket, ucRunTimeDatagram, uxLength, 0, &xAddress, sizeof( xAddress ) );
+		}
+
+		/* The snapshots carry their own timestamp, so the period need not be
+		exact. */
+		vTaskDelay( pdMS_TO_TICKS( configRUN_TIME_STATS_PERIOD_MS ) );
+	}
+}
+/*-----------------------------------------------------------*/
+
+#endif /* configUSE_RUN_TIME_STATS == 1 */
@@ -0,0 +1,338 @@
+/*
+ * trace_ring.c
+ *
+ * The trace ring, see trace_ring.h.
+ *
+ * Every writer reserves a record number with an atomic increment of
+ * ulTraceHead, fills in the record, and writes the low bits of the record
+ * number to usSequence as the last field.  The reader only accepts a record
+ * when usSequence matches, so records that are still being written are left
+ * for the next read.  When the writers are more than a ring ahead of the
+ * reader, the oldest records are lost and counted.
+ */
+
+/* Standard includes. */
+#include <stdint.h>
+#include <string.h>
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
+#include "semphr.h"
+
+/* FreeRTOS+TCP includes. */
+#include "FreeRTOS_IP.h"
+#include "FreeRTOS_Sockets.h"
+
+#include "trace_ring.h"
+
+#if( configUSE_TRACE_RING == 1 )
+
+#ifndef configTRACE_RING_RECORDS
+	/* The number of records in the ring, must be a power of 2. */
+	#define configTRACE_RING_RECORDS			256u
+#endif
+
+#ifndef configTRACE_RING_TIMESTAMP
+	#define configTRACE_RING_TIMESTAMP()		ulApplicationGetCycleCount()
+	extern uint32_t ulApplicationGetCycleCount( void );
+#endif
+
+#ifndef configTRACE_RING_COUNTS_PER_US
+	#define configTRACE_RING_COUNTS_PER_US		( configCPU_CLOCK_HZ / 1000000UL )
+#endif
+
+#ifndef configTRACE_RING_MAX_TASKS
+	/* The number of task names that are remembered. */
+	#define configTRACE_RING_MAX_TASKS			16u
+#endif
+
+#ifndef configTRACE_RING_UDP_PERIOD_MS
+	/* How often the UDP drain task sends the new records. */
+	#define configTRACE_RING_UDP_PERIOD_MS		100u
+#endif
+
+#ifndef configTRACE_RING_IN_ISR
+	#if defined( __GNUC__ ) && defined( __ARM_ARCH_7EM__ )
+		/* On a Cortex-M, IPSR holds the number of the active exception. */
+		#define configTRACE_RING_IN_ISR()		( prvReadIPSR() != 0u )
+	#else
+		#define configTRACE_RING_IN_ISR()		( 0 )
+	#endif
+#endif
+
+#if( ( configTRACE_RING_RECORDS & ( configTRACE_RING_RECORDS - 1u ) ) != 0u )
+	#error configTRACE_RING_RECORDS must be a power of 2
+#endif
+
+/* The format of the datagrams sent by the UDP drain task. */
+#define traceringMAGIC						0x54524352UL	/* "TRCR" */
+#define traceringTYPE_RECORDS				1u
+#define traceringTYPE_TASK_NAMES			2u
+#define traceringRECORDS_PER_DATAGRAM		64u
+#define traceringNAME_LENGTH				16u
+
+/* Send the task names once every so many periods. */
+#define traceringNAMES_INTERVAL				10u
+
+/*-----------------------------------------------------------*/
+
+typedef struct xTRACE_DATAGRAM_HEADER
+{
+	uint32_t ulMagic;
+	uint32_t ulCountsPerUs;
+	uint32_t ulLost;				/* Total number of records lost */
+	uint32_t ulTimestamp;			/* The time at which the datagram was sent */
+	uint16_t usType;				/* traceringTYPE_XXX */
+	uint16_t usCount;				/* Number of records or task names */
+} TraceDatagramHeader_t;
+
+typedef struct xTRACE_TASK_NAME
+{
+	uint32_t ulTask;
+	char pcName[ traceringNAME_LENGTH ];
+} TraceTaskName_t;
+
+/*-----------------------------------------------------------*/
+
+#if defined( __GNUC__ ) && defined( __ARM_ARCH_7EM__ )
+	static portFORCE_INLINE uint32_t prvReadIPSR( void );
+#endif
+
+static void prvTraceUDPTask( void *pvParameters );
+static void prvSendTaskNames( Socket_t xSocket, struct freertos_sockaddr *pxAddress );
+static BaseType_t prvSendRecords( Socket_t xSocket, struct freertos_sockaddr *pxAddress );
+
+/*-----------------------------------------------------------*/
+
+static TraceRecord_t xTraceRecords[ configTRACE_RING_RECORDS ];
+
+/* The number of the next record to be written, and to be read. */
+static volatile uint32_t ulTraceHead = 0u;
+static uint32_t ulTraceTail = 0u;
+
+/* The total number of records lost. */
+static uint32_t ulTraceLost = 0u;
+
+/* Task names, written from within the critical section of xTaskCreate(). */
+static TraceTaskName_t xTraceTaskNames[ configTRACE_RING_MAX_TASKS ];
+
+/* Used by the UDP drain task. */
+static uint32_t ulTraceHostIP;
+static uint16_t usTraceHostPort;
+static TaskHandle_t xTraceUDPTaskHandle = NULL;
+static uint8_t ucTraceDatagram[ sizeof( TraceDatagramHeader_t ) + traceringRECORDS_PER_DATAGRAM * sizeof( TraceRecord_t ) ];
+
+/*-----------------------------------------------------------*/
+
+#if defined( __GNUC__ ) && defined( __ARM_ARCH_7EM__ )
+
+	static portFORCE_INLINE uint32_t prvReadIPSR( void )
+	{
+	uint32_t ulIPSR;
+
+		__asm volatile ( "mrs %0, ipsr" : "=r" ( ulIPSR ) );
+		return ulIPSR;
+	}
+
+#endif
+/*-----------------------------------------------------------*/
+
+void vTraceRingWrite( uint8_t ucEvent, uint32_t ulObject, uint32_t ulValue )
+{
+uint32_t ulNumber;
+TraceRecord_t *pxRecord;
+
+	ulNumber = __atomic_fetch_add( &ulTraceHead, 1u, __ATOMIC_RELAXED );
+	pxRecord = &( xTraceRecords[ ulNumber & ( configTRACE_RING_RECORDS - 1u ) ] );
+
+	pxRecord->ulTimestamp = configTRACE_RING_TIMESTAMP();
+	pxRecord->ucEvent = ucEvent;
+	pxRecord->ucFlags = ( configTRACE_RING_IN_ISR() ) ? traceringFLAG_ISR : 0u;
+	pxRecord->ulObject = ulObject;
+	pxRecord->ulValue = ulValue;
+
+	/* Publish the record. */
+	__atomic_store_n( &( pxRecord->usSequence ), ( uint16_t ) ulNumber, __ATOMIC_RELEASE );
+}
+/*-----------------------------------------------------------*/
+
+void vTraceRingTaskCreated( uint32_t ulTask, const char *pcName, uint32_t ulPriority )
+{
+UBaseType_t uxIndex, uxFree = configTRACE_RING_MAX_TASKS;
+
+	/* A new task may get the handle of a deleted one, re-use its entry. */
+	for( uxIndex = 0u; uxIndex < configTRACE_RING_MAX_TASKS; uxIndex++ )
+	{
+		if( xTraceTaskNames[ uxIndex ].ulTask == ulTask )
+		{
+			uxFree = uxIndex;
+			break;
+		}
+
+		if( ( xTraceTaskNames[ uxIndex ].ulTask == 0u ) && ( uxFree == configTRACE_RING_MAX_TASKS ) )
+		{
+			uxFree = uxIndex;
+		}
+	}
+
+	if( uxFree < configTRACE_RING_MAX_TASKS )
+	{
+		xTraceTaskNames[ uxFree ].ulTask = ulTask;
+		strncpy( xTraceTaskNames[ uxFree ].pcName, pcName, traceringNAME_LENGTH );
+	}
+
+	vTraceRingWrite( traceringTASK_CREATE, ulTask, ulPriority );
+}
+/*-----------------------------------------------------------*/
+
+size_t uxTraceRingRead( TraceRecord_t *pxRecords, size_t uxMaxCount, uint32_t *pulLost )
+{
+uint32_t ulHead;
+size_t uxCount = 0u;
+TraceRecord_t *pxRecord;
+
+	while( uxCount < uxMaxCount )
+	{
+		ulHead = __atomic_load_n( &ulTraceHead, __ATOMIC_ACQUIRE );
+
+		if( ( ulHead - ulTraceTail ) > configTRACE_RING_RECORDS )
+		{
+			/* The writers have overtaken the reader. */
+			*pulLost += ( ulHead - ulTraceTail ) - configTRACE_RING_RECORDS;
+			ulTraceTail = ulHead - configTRACE_RING_RECORDS;
+		}
+
+		if( ulTraceTail == ulHead )
+		{
+			break;
+		}
+
+		pxRecord = &( xTraceRecords[ ulTraceTail & ( configTRACE_RING_RECORDS - 1u ) ] );
+
+		if( __atomic_load_n( &( pxRecord->usSequence ), __ATOMIC_ACQUIRE ) != ( uint16_t ) ulTraceTail )
+		{
+			/* The record is still being written. */
+			break;
+		}
+
+		pxRecords[ uxCount ] = *pxRecord;
+
+		/* If a writer has re-used the entry during the copy, the copy may be
+		mixed up. */
+		if( ( __atomic_load_n( &ulTraceHead, __ATOMIC_ACQUIRE ) - ulTraceTail ) > configTRACE_RING_RECORDS )
+		{
+			( *pulLost )++;
+		}
+		else
+		{
+			uxCount++;
+		}
+
+		ulTraceTail++;
+	}
+
+	return uxCount;
+}
+/*-----------------------------------------------------------*/
+
+void vTraceRingStartUDP( uint32_t ulHostIP, uint16_t usPort )
+{
+	ulTraceHostIP = ulHostIP;
+	usTraceHostPort = usPort;
+
+	if( xTraceUDPTaskHandle == NULL )
+	{
+		xTaskCreate( prvTraceUDPTask, "TraceUDP", 2u * configMINIMAL_STACK_SIZE, NULL, tskIDLE_PRIORITY + 1u, &xTraceUDPTaskHandle );
+	}
+}
+/*-----------------------------------------------------------*/
+
+static void prvSendTaskNames( Socket_t xSocket, struct freertos_sockaddr *pxAddress )
+{
+TraceDatagramHeader_t *pxHeader = ( TraceDatagramHeader_t * ) ucTraceDatagram;
+TraceTaskName_t *pxNames = ( TraceTaskName_t * ) ( ucTraceDatagram + sizeof( *pxHeader ) );
+UBaseType_t uxIndex, uxCount = 0u;
+
+	for( uxIndex = 0u; uxIndex < configTRACE_RING_MAX_TASKS; uxIndex++ )
+	{
+		if( xTraceTaskNames[ uxIndex ].ulTask != 0u )
+		{
+			pxNames[ uxCount++ ] = xTraceTaskNames[ uxIndex ];
+		}
+	}
+
+	pxHeader->ulMagic = traceringMAGIC;
+	pxHeader->ulCountsPerUs = configTRACE_RING_COUNTS_PER_US;
+	pxHeader->ulLost = ulTraceLost;
+	pxHeader->ulTimestamp = configTRACE_RING_TIMESTAMP();
+	pxHeader->usType = traceringTYPE_TASK_NAMES;
+	pxHeader->usCount = ( uint16_t ) uxCount;
+
+	FreeRTOS_sendto( xSocket, ucTraceDatagram, sizeof( *pxHeader ) + uxCount * sizeof( TraceTaskName_t ), 0,
+		pxAddress, sizeof( *pxAddress ) );
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvSendRecords( Socket_t xSocket, struct freertos_sockaddr *pxAddress )
+{
+TraceDatagramHeader_t *pxHeader = ( TraceDatagramHeader_t * ) ucTraceDatagram;
+size_t uxCount;
+
+	uxCount = uxTraceRingRead( ( TraceRecord_t * ) ( ucTraceDatagram + sizeof( *pxHeader ) ),
+		traceringRECORDS_PER_DATAGRAM, &ulTraceLost );
+
+	if( uxCount != 0u )
+	{
+		pxHeader->ulMagic = traceringMAGIC;
+		pxHeader->ulCountsPerUs = configTRACE_RING_COUNTS_PER_US;
+		pxHeader->ulLost = ulTraceLost;
+		pxHeader->ulTimestamp = configTRACE_RING_TIMESTAMP();
+		pxHeader->usType = traceringTYPE_RECORDS;
+		pxHeader->usCount = ( uint16_t ) uxCount;
+
+		FreeRTOS_sendto( xSocket, ucTraceDatagram, sizeof( *pxHeader ) + uxCount * sizeof( TraceRecord_t ), 0,
+			pxAddress, sizeof( *pxAddress ) );
+	}
+
+	/* Continue while full datagrams can be sent. */
+	return ( uxCount == traceringRECORDS_PER_DATAGRAM ) ? pdTRUE : pdFALSE;
+}
+/*-----------------------------------------------------------*/
+
+static void prvTraceUDPTask( void *pvParameters )
+{
+Socket_t xSocket;
+struct freertos_sockaddr xAddress;
+UBaseType_t uxPeriods = 0u;
+
+	( void ) pvParameters;
+
+	xSocket = FreeRTOS_socket( FREERTOS_AF_INET, FREERTOS_SOCK_DGRAM, FREERTOS_IPPROTO_UDP );
+	configASSERT( xSocket != FREERTOS_INVALID_SOCKET );
+
+	for( ;; )
+	{
+		xAddress.sin_addr = ulTraceHostIP;
+		xAddress.sin_port = FreeRTOS_htons( usTraceHostPort );
+
+		/* The names are repeated, so that a host that starts listening later
+		can still show them. */
+		if( ( uxPeriods % traceringNAMES_INTERVAL ) == 0u )
+		{
+			prvSendTaskNames( xSocket, &xAddress );
+		}
+
+		uxPeriods++;
+
+		while( prvSendRecords( xSocket, &xAddress ) != pdFALSE )
+		{
+		}
+
+		vTaskDelay( pdMS_TO_TICKS( configTRACE_RING_UDP_PERIOD_MS ) );
+	}
+}
+/*-----------------------------------------------------------*/
+
+#endif /* configUSE_TRACE_RING == 1 */
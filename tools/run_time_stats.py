@@ -0,0 +1,147 @@
+#!/usr/bin/env python3
+"""
+run_time_stats.py
+
+Shows the snapshots of the run-time statistics (Src/run_time_stats.c): the
+CPU load of every task and of the instrumented interrupts, the stack
+high-water marks and the heap usage.  The load is computed from the
+difference between two consecutive snapshots.
+
+The time of an interrupt is also counted in the time of the task that it
+interrupted.
+
+Receive live from the target (configRUN_TIME_STATS_UDP_PORT), stop with
+Ctrl-C:
+
+    tools/run_time_stats.py --listen 5007
+
+Print one JSON object per interval instead, e.g. to log the load:
+
+    tools/run_time_stats.py --listen 5007 --json >> load.jsonl
+"""
+
+import argparse
+import json
+import socket
+import struct
+import sys
+
+MAGIC = 0x54535452
+
+HEADER = struct.Struct("<IIIIIHH")
+TASK = struct.Struct("<I16sIHBB")
+ISR = struct.Struct("<16sII")
+
+# eTaskState in FreeRTOS task.h.
+STATES = {0: "running", 1: "ready", 2: "blocked", 3: "suspended", 4: "deleted"}
+
+WORD_SIZE = 4
+
+
+def name_of(raw):
+    return raw.split(b"\0", 1)[0].decode("ascii", "replace")
+
+
+def parse(data):
+    """Return the snapshot as a dict, or None when it is not valid."""
+    if len(data) < HEADER.size:
+        return None
+    magic, counts_per_us, timestamp, free_heap, min_free_heap, task_count, isr_count = HEADER.unpack_from(data)
+    if magic != MAGIC:
+        return None
+    if len(data) < HEADER.size + task_count * TASK.size + isr_count * ISR.size:
+        return None
+
+    offset = HEADER.size
+    tasks = {}
+    for _ in range(task_count):
+        handle, name, run_time, stack, priority, state = TASK.unpack_from(data, offset)
+        tasks[handle] = {"name": name_of(name), "run_time": run_time, "stack_free": stack * WORD_SIZE,
+                         "priority": priority, "state": STATES.get(state, str(state))}
+        offset += TASK.size
+
+    isrs = {}
+    for _ in range(isr_count):
+        name, count, run_time = ISR.unpack_from(data, offset)
+        isrs[name_of(name)] = {"count": count, "run_time": run_time}
+        offset += ISR.size
+
+    return {"counts_per_us": max(counts_per_us, 1), "timestamp": timestamp, "free_heap": free_heap,
+            "min_free_heap": min_free_heap, "tasks": tasks, "isrs": isrs}
+
+
+def delta(new, old):
+    """The difference of two 32-bit counters that may have wrapped."""
+    return (new - old) & 0xFFFFFFFF
+
+
+def interval(previous, current):
+    """Return the load over the interval between two snapshots."""
+    elapsed = delta(current["timestamp"], previous["timestamp"]) or 1
+    tasks = []
+    for handle, task in current["tasks"].items():
+        before = previous["tasks"].get(handle)
+        # A task that was created during the interval started at zero.
+        run_time = delta(task["run_time"], before["run_time"] if before else 0)
+        tasks.append({"name": task["name"], "handle": "0x%08x" % handle, "state": task["state"],
+                      "priority": task["priority"], "cpu": 100.0 * run_time / elapsed,
+                      "stack_free": task["stack_free"]})
+    tasks.sort(key=lambda t: t["cpu"], reverse=True)
+
+    isrs = []
+    for name, isr in current["isrs"].items():
+        before = previous["isrs"].get(name, {"count": 0, "run_time": 0})
+        count = delta(isr["count"], before["count"])
+        run_time = delta(isr["run_time"], before["run_time"])
+        isrs.append({"name": name, "cpu": 100.0 * run_time / elapsed, "count": count,
+                     "average_us": (run_time / count / current["counts_per_us"]) if count else 0.0})
+
+    return {"interval_ms": elapsed / current["counts_per_us"] / 1000.0, "tasks": tasks, "isrs": isrs,
+            "free_heap": current["free_heap"], "min_free_heap": current["min_free_heap"]}
+
+
+def print_table(report):
+    print("interval %.1f ms, heap free %d bytes, minimum ever %d bytes" %
+          (report["interval_ms"], report["free_heap"], report["min_free_heap"]))
+    print("  %-16s %-9s %4s %7s %11s" % ("task", "state", "prio", "cpu %", "stack free"))
+    for task in report["tasks"]:
+        print("  %-16s %-9s %4d %7.2f %11d" %
+              (task["name"], task["state"], task["priority"], task["cpu"], task["stack_free"]))
+    for isr in report["isrs"]:
+        print("  %-16s %-9s %4s %7.2f %5d x %.1f us" %
+              (isr["name"], "ISR", "", isr["cpu"], isr["count"], isr["average_us"]))
+    print()
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Show the run-time statistics snapshots of the target.")
+    parser.add_argument("--listen", type=int, metavar="PORT", required=True, help="receive snapshots on this UDP port")
+    parser.add_argument("--json", action="store_true", help="print one JSON object per interval")
+    args = parser.parse_args()
+
+    sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+    sock.bind(("", args.listen))
+    print("Listening on UDP port %d, Ctrl-C to stop" % args.listen, file=sys.stderr)
+
+    previous = None
+    try:
+        while True:
+            data, _ = sock.recvfrom(65536)
+            current = parse(data)
+            if current is None:
+                continue
+            if previous is not None:
+                report = interval(previous, current)
+                if args.json:
+                    print(json.dumps(report), flush=True)
+                else:
+                    print_table(report)
+            previous = current
+    except KeyboardInterrupt:
+        pass
+    finally:
+        sock.close()
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,235 @@
+#!/usr/bin/env python3
+"""
+trace_decode.py
+
+Decodes the datagrams of the trace ring (Src/trace_ring.c) into a timeline in
+the Chrome trace event format, which can be opened in chrome://tracing or in
+the Perfetto UI (https://ui.perfetto.dev).
+
+Every task gets a track that shows when it was running, an extra track shows
+the events written from interrupts.  Network buffers are shown as async
+slices from the moment they are obtained until they are released, so it can
+be seen where packets wait between the USB interrupt, the EMAC task, the
+IP-task and the application.
+
+Receive live from the target (configTRACE_RING_UDP_PORT), stop with Ctrl-C:
+
+    tools/trace_decode.py --listen 5005 --save run.bin -o run.json
+
+Decode a saved run again:
+
+    tools/trace_decode.py --input run.bin -o run.json
+"""
+
+import argparse
+import json
+import socket
+import struct
+import sys
+
+MAGIC = 0x54524352
+TYPE_RECORDS = 1
+TYPE_TASK_NAMES = 2
+
+HEADER = struct.Struct("<IIIIHH")
+RECORD = struct.Struct("<IBBHII")
+TASK_NAME = struct.Struct("<I16s")
+
+FLAG_ISR = 0x01
+ISR_TID = 0
+
+# Must match the traceringXXX codes in Inc/trace_ring.h.
+EVENT_NAMES = {
+    0x01: "task switched in",
+    0x02: "task create",
+    0x03: "task delete",
+    0x04: "task delay",
+    0x05: "queue receive block",
+    0x06: "queue send block",
+    0x07: "notify take block",
+    0x08: "notify give from ISR",
+    0x20: "network buffer obtained",
+    0x21: "network buffer released",
+    0x22: "network buffer failed",
+    0x23: "ethernet rx event lost",
+    0x24: "stack tx event lost",
+    0x25: "network event received",
+    0x26: "network interface receive",
+    0x27: "network interface transmit",
+    0x28: "sending UDP packet",
+    0x29: "packet dropped for ARP",
+    0x2A: "ARP entry created",
+    0x2B: "ARP entry expired",
+    0x2C: "recvfrom discarding",
+    0x2D: "network down",
+    0x40: "USB rx frame",
+    0x41: "USB tx frame",
+}
+
+TASK_SWITCHED_IN = 0x01
+BUFFER_OBTAINED = 0x20
+BUFFER_RELEASED = 0x21
+
+
+def read_datagrams(args):
+    """Yield the raw datagrams, from a saved file or from a UDP port."""
+    if args.input:
+        with open(args.input, "rb") as f:
+            while True:
+                length = f.read(2)
+                if len(length) < 2:
+                    break
+                yield f.read(struct.unpack("<H", length)[0])
+        return
+
+    save = open(args.save, "wb") if args.save else None
+    sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+    sock.bind(("", args.listen))
+    print("Listening on UDP port %d, Ctrl-C to stop" % args.listen, file=sys.stderr)
+    try:
+        while True:
+            data, _ = sock.recvfrom(65536)
+            if save:
+                save.write(struct.pack("<H", len(data)) + data)
+            yield data
+    except KeyboardInterrupt:
+        pass
+    finally:
+        sock.close()
+        if save:
+            save.close()
+
+
+def parse(datagrams):
+    """Return the records, the task names, the counts per us and the losses."""
+    records = []
+    names = {}
+    counts_per_us = 1
+    losses = []
+
+    for data in datagrams:
+        if len(data) < HEADER.size:
+            continue
+        magic, counts_per_us, lost, _, kind, count = HEADER.unpack_from(data)
+        if magic != MAGIC:
+            continue
+        offset = HEADER.size
+        if kind == TYPE_RECORDS:
+            losses.append((len(records), lost))
+            for _ in range(count):
+                records.append(RECORD.unpack_from(data, offset))
+                offset += RECORD.size
+        elif kind == TYPE_TASK_NAMES:
+            for _ in range(count):
+                handle, name = TASK_NAME.unpack_from(data, offset)
+                names[handle] = name.split(b"\0", 1)[0].decode("ascii", "replace")
+                offset += TASK_NAME.size
+
+    return records, names, max(counts_per_us, 1), losses
+
+
+def unwrap(records, counts_per_us):
+    """Convert the 32-bit timestamps into microseconds since the first record."""
+    times = []
+    total = 0
+    last = None
+    for record in records:
+        raw = record[0]
+        if last is not None:
+            delta = (raw - last) & 0xFFFFFFFF
+            # A record that was reserved before, but stamped after a record
+            # written by an interrupt, looks a little older.
+            if delta >= 0x80000000:
+                delta -= 0x100000000
+            total += delta
+        last = raw
+        times.append(total / counts_per_us)
+    return times
+
+
+def build_trace(records, names, counts_per_us, losses):
+    events = []
+    tids = {}
+
+    def tid_of(handle):
+        if handle not in tids:
+            tids[handle] = len(tids) + 1
+        return tids[handle]
+
+    times = unwrap(records, counts_per_us)
+    running = None
+    running_since = 0.0
+    previous_lost = 0
+    loss_at = dict(losses)
+
+    for index, record in enumerate(records):
+        _, event, flags, _, obj, value = record
+        ts = times[index]
+
+        if index in loss_at and loss_at[index] != previous_lost:
+            events.append({"name": "%d records lost" % (loss_at[index] - previous_lost),
+                           "ph": "i", "s": "g", "ts": ts, "pid": 1, "tid": ISR_TID})
+            previous_lost = loss_at[index]
+
+        if event == TASK_SWITCHED_IN:
+            if running is not None and obj != running:
+                events.append({"name": names.get(running, "0x%08x" % running), "ph": "X",
+                               "ts": running_since, "dur": ts - running_since,
+                               "pid": 1, "tid": tid_of(running)})
+            if obj != running:
+                running = obj
+                running_since = ts
+            continue
+
+        if flags & FLAG_ISR:
+            tid = ISR_TID
+        elif running is not None:
+            tid = tid_of(running)
+        else:
+            tid = ISR_TID
+
+        name = EVENT_NAMES.get(event, "user event 0x%02x" % event)
+        events.append({"name": name, "ph": "i", "s": "t", "ts": ts, "pid": 1, "tid": tid,
+                       "args": {"object": "0x%08x" % obj, "value": value}})
+
+        if event == BUFFER_OBTAINED:
+            events.append({"name": "network buffer", "cat": "buffer", "ph": "b", "id": "0x%08x" % obj,
+                           "ts": ts, "pid": 1, "tid": tid})
+        elif event == BUFFER_RELEASED:
+            events.append({"name": "network buffer", "cat": "buffer", "ph": "e", "id": "0x%08x" % obj,
+                           "ts": ts, "pid": 1, "tid": tid})
+
+    if running is not None and records:
+        events.append({"name": names.get(running, "0x%08x" % running), "ph": "X",
+                       "ts": running_since, "dur": times[-1] - running_since,
+                       "pid": 1, "tid": tid_of(running)})
+
+    events.append({"name": "process_name", "ph": "M", "pid": 1, "args": {"name": "target"}})
+    events.append({"name": "thread_name", "ph": "M", "pid": 1, "tid": ISR_TID, "args": {"name": "ISR"}})
+    for handle, tid in tids.items():
+        events.append({"name": "thread_name", "ph": "M", "pid": 1, "tid": tid,
+                       "args": {"name": names.get(handle, "0x%08x" % handle)}})
+
+    return {"traceEvents": events, "displayTimeUnit": "ns"}
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Decode trace ring datagrams into a Chrome trace / Perfetto JSON file.")
+    source = parser.add_mutually_exclusive_group(required=True)
+    source.add_argument("--listen", type=int, metavar="PORT", help="receive datagrams on this UDP port")
+    source.add_argument("--input", metavar="FILE", help="read datagrams saved with --save")
+    parser.add_argument("--save", metavar="FILE", help="save the received datagrams")
+    parser.add_argument("-o", "--output", metavar="FILE", default="trace.json", help="the JSON file to write")
+    args = parser.parse_args()
+
+    records, names, counts_per_us, losses = parse(read_datagrams(args))
+    trace = build_trace(records, names, counts_per_us, losses)
+
+    with open(args.output, "w") as f:
+        json.dump(trace, f)
+
+    print("%d records, %d tasks, written to %s" % (len(records), len(names), args.output), file=sys.stderr)
+
+
+if __name__ == "__main__":
+    main()